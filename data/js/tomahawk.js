@@ -215,6 +215,41 @@ var TomahawkResolver = {
         });
     },
     testConfig: function () {
+    },
+    /**
+     * Resolvers may implement resolveBatch(queries) to get many queries in a
+     * single call. Each query is either { qid, artist, album, track } or
+     * { qid, query } for a full text search. Return (a Promise of) an array
+     * of { qid, results } objects, queries left out are reported without
+     * results. Resolvers without resolveBatch keep getting resolve() calls.
+     */
+    _adapter_resolveBatch: function (queries) {
+        var reportBatch = function (batchResults) {
+            var reported = {};
+            var results = [];
+            (batchResults || []).forEach(function (item) {
+                reported[item.qid] = true;
+                results.push({
+                    'qid': item.qid,
+                    'results': item.results || []
+                });
+            });
+            queries.forEach(function (query) {
+                if (!reported[query.qid]) {
+                    results.push({
+                        'qid': query.qid,
+                        'results': []
+                    });
+                }
+            });
+
+            Tomahawk.addTrackResultsBatch(results);
+        };
+
+        Promise.resolve(this.resolveBatch(queries)).then(reportBatch, function (error) {
+            Tomahawk.log("resolveBatch failed: " + error);
+            reportBatch([]);
+        });
     }
 };
 
@@ -31,13 +31,21 @@
 
 #include "Api_v1_5.h"
 #include "Pipeline.h"
+#include "RangeStream.h"
 #include "Result.h"
+#include "ResultsStream.h"
 #include "Source.h"
 #include "StatResponseHandler.h"
 #include "UrlHandler.h"
 
 #include <QHash>
 
+// queries a single resolve_batch request may submit
+#define MAX_BATCH_QUERIES 1000
+// default and maximum time get_results_stream holds a request open, in seconds
+#define STREAM_TIMEOUT 30
+#define MAX_STREAM_TIMEOUT 120
+
 using namespace Tomahawk;
 using namespace TomahawkUtils;
 
@@ -183,6 +191,8 @@ Api_v1::api( QxtWebRequestEvent* event, const QString& version, const QString& m
           if ( method == "stat" )        return stat( event );
           if ( method == "resolve" )     return resolve( event );
           if ( method == "get_results" ) return get_results( event );
+          if ( method == "resolve_batch" ) return resolve_batch( event );
+          if ( method == "get_results_stream" ) return get_results_stream( event );
       }
 
       send404( event );
@@ -258,13 +268,43 @@ Api_v1::processSid( QxtWebRequestEvent* event, const Tomahawk::result_ptr rp, co
     {
         return send404( event ); // 503?
     }
-    m_ioDevice = iodev;
 
-    QxtWebPageEvent* e = new QxtWebPageEvent( event->sessionID, event->requestID, iodev.data() );
-    e->streaming = iodev->isSequential();
+    qint64 size = iodev->isSequential() ? rp->size() : iodev->size();
+    if ( size <= 0 )
+        size = rp->size() > 0 ? rp->size() : -1;
+
+    // we only know how to serve ranges if we know where the stream ends
+    qint64 start = 0;
+    qint64 end = size - 1;
+    const bool partial = size > 0 && TomahawkUtils::parseRange( headerValue( event, "Range" ), size, start, end );
+    if ( partial && start >= size )
+    {
+        QxtWebPageEvent* e = new QxtWebPageEvent( event->sessionID, event->requestID, QByteArray() );
+        e->status = 416;
+        e->statusMessage = "Requested Range Not Satisfiable";
+        e->headers.insert( "Content-Range", QString( "bytes */%1" ).arg( size ) );
+        postEvent( e );
+        return;
+    }
+
+    RangeStream* stream = new RangeStream( iodev, start, size > 0 ? end - start + 1 : -1 );
+
+    QxtWebPageEvent* e = new QxtWebPageEvent( event->sessionID, event->requestID, stream );
+    e->streaming = stream->isStreaming();
     e->contentType = rp->mimetype().toLatin1();
-    if ( rp->size() > 0 )
-        e->headers.insert( "Content-Length", QString::number( rp->size() ) );
+    if ( size > 0 )
+    {
+        // with a Content-Length there's no need for chunks
+        e->chunked = false;
+        e->headers.insert( "Content-Length", QString::number( end - start + 1 ) );
+        e->headers.insert( "Accept-Ranges", "bytes" );
+    }
+    if ( partial )
+    {
+        e->status = 206;
+        e->statusMessage = "Partial Content";
+        e->headers.insert( "Content-Range", QString( "bytes %1-%2/%3" ).arg( start ).arg( end ).arg( size ) );
+    }
 
     postEvent( e );
 }
@@ -356,6 +396,88 @@ Api_v1::resolve( QxtWebRequestEvent* event )
 }
 
 
+void
+Api_v1::resolve_batch( QxtWebRequestEvent* event )
+{
+    if ( event->content.isNull() )
+    {
+        tDebug( LOGVERBOSE ) << "Malformed HTTP resolve_batch request";
+        return send404( event );
+    }
+
+    // the body may still be on its way
+    if ( event->content->bytesNeeded() > 0 )
+    {
+        m_pendingBatches.insert( event->content.data(), event );
+        connect( event->content.data(), SIGNAL( readyRead() ), SLOT( onBatchContentReady() ), Qt::UniqueConnection );
+        connect( event->content.data(), SIGNAL( readChannelFinished() ), SLOT( onBatchContentReady() ), Qt::UniqueConnection );
+        return;
+    }
+
+    bool ok;
+    QVariant body = TomahawkUtils::parseJson( event->content->readAll(), &ok );
+    if ( ok && body.type() == QVariant::Map )
+        body = body.toMap().value( "queries" );
+
+    const QVariantList list = body.toList();
+    if ( !ok || list.isEmpty() || list.count() > MAX_BATCH_QUERIES )
+    {
+        tDebug( LOGVERBOSE ) << "Malformed HTTP resolve_batch request";
+        return sendJsonError( event, QString( "Expected a list of up to %1 queries" ).arg( MAX_BATCH_QUERIES ) );
+    }
+
+    QList< query_ptr > queries;
+    QVariantList qids;
+    foreach ( const QVariant& v, list )
+    {
+        const QVariantMap m = v.toMap();
+        const QString artist = m.value( "artist" ).toString();
+        const QString track = m.value( "track" ).toString();
+        if ( artist.trimmed().isEmpty() || track.trimmed().isEmpty() )
+        {
+            qids << QVariant();
+            continue;
+        }
+
+        QString qid = m.value( "qid" ).toString();
+        if ( qid.isEmpty() )
+            qid = uuid();
+
+        query_ptr qry = Query::get( artist, track, m.value( "album" ).toString(), qid, false );
+        if ( qry.isNull() )
+        {
+            qids << QVariant();
+            continue;
+        }
+
+        queries << qry;
+        qids << qid;
+    }
+
+    // one call, so the Pipeline can hand them to the resolvers in batches
+    Pipeline::instance()->resolve( queries, true, true );
+
+    QVariantMap r;
+    r.insert( "qids", qids );
+    sendJSON( r, event );
+}
+
+
+void
+Api_v1::onBatchContentReady()
+{
+    QxtWebContent* content = qobject_cast< QxtWebContent* >( sender() );
+    // a dropped connection sets bytesNeeded() to 0 as well, parsing fails then
+    if ( !content || content->bytesNeeded() > 0 )
+        return;
+
+    disconnect( content, 0, this, 0 );
+    QxtWebRequestEvent* event = m_pendingBatches.take( content );
+    if ( event )
+        resolve_batch( event );
+}
+
+
 void
 Api_v1::staticdata( QxtWebRequestEvent* event, const QString& file )
 {
@@ -434,6 +556,60 @@ Api_v1::get_results( QxtWebRequestEvent* event )
 }
 
 
+void
+Api_v1::get_results_stream( QxtWebRequestEvent* event )
+{
+    QList< query_ptr > queries;
+    typedef QPair< QString, QString > QueryItem;
+    foreach ( const QueryItem& item, urlQueryItems( event->url ) )
+    {
+        if ( item.first != "qid" )
+            continue;
+
+        query_ptr qry = Pipeline::instance()->query( item.second );
+        if ( !qry.isNull() )
+            queries << qry;
+    }
+
+    if ( queries.isEmpty() )
+    {
+        tDebug( LOGVERBOSE ) << "Malformed HTTP get_results_stream request";
+        send404( event );
+        return;
+    }
+
+    // EventSource sends this, everyone else gets JSON lines
+    const ResultsStream::Format format = headerValue( event, "Accept" ).contains( "text/event-stream" ) ?
+                                         ResultsStream::EventStream : ResultsStream::JsonLines;
+
+    int timeout = STREAM_TIMEOUT;
+    if ( urlHasQueryItem( event->url, "timeout" ) )
+        timeout = qBound( 1, urlQueryItemValue( event->url, "timeout" ).toInt(), MAX_STREAM_TIMEOUT );
+
+    ResultsStream* stream = new ResultsStream( queries, format, timeout * 1000 );
+
+    QxtWebPageEvent* e = new QxtWebPageEvent( event->sessionID, event->requestID, stream );
+    e->streaming = true;
+    e->contentType = ResultsStream::contentType( format );
+    e->headers.insert( "Cache-Control", "no-cache" );
+    e->headers.insert( "Access-Control-Allow-Origin", "*" );
+    postEvent( e );
+}
+
+
+QString
+Api_v1::headerValue( QxtWebRequestEvent* event, const QString& name )
+{
+    for ( QMultiHash< QString, QString >::const_iterator it = event->headers.constBegin(); it != event->headers.constEnd(); ++it )
+    {
+        if ( it.key().compare( name, Qt::CaseInsensitive ) == 0 )
+            return it.value();
+    }
+
+    return QString();
+}
+
+
 void
 Api_v1::sendJSON( const QVariantMap& m, QxtWebRequestEvent* event )
 {
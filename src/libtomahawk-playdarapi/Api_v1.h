@@ -32,6 +32,7 @@
 #include <QxtWeb/QxtWebPageEvent>
 
 #include <QFile>
+#include <QHash>
 #include <QSharedPointer>
 #include <QStringList>
 
@@ -70,9 +71,13 @@ public slots:
     void send404( QxtWebRequestEvent* event );
     void stat( QxtWebRequestEvent* event );
     void resolve( QxtWebRequestEvent* event );
+    // POST a JSON list of queries, answers with their qids in the same order
+    void resolve_batch( QxtWebRequestEvent* event );
     void staticdata( QxtWebRequestEvent* event, const QString& file );
     void staticdata( QxtWebRequestEvent* event, const QString& path, const QString& file );
     void get_results( QxtWebRequestEvent* event );
+    // holds the request open and pushes results of one or more qids as they come in
+    void get_results_stream( QxtWebRequestEvent* event );
     void sendJSON( const QVariantMap& m, QxtWebRequestEvent* event );
 
     void sendJsonError( QxtWebRequestEvent* event, const QString& message );
@@ -84,14 +89,21 @@ public slots:
 
     void index( QxtWebRequestEvent* event );
 
+protected slots:
+    void onBatchContentReady();
+
 protected:
     void apiCallFailed( QxtWebRequestEvent* event, const QString& method );
     void sendPlain404( QxtWebRequestEvent* event, const QString& message, const QString& statusmessage );
 
 private:
+    /// Header names are case-insensitive, QxtWebRequestEvent keeps them the way the client sent them.
+    static QString headerValue( QxtWebRequestEvent* event, const QString& name );
+
     void processSid( QxtWebRequestEvent* event, const Tomahawk::result_ptr, const QString url, QSharedPointer< QIODevice > );
 
-    QSharedPointer< QIODevice > m_ioDevice;
+    // resolve_batch requests waiting for the rest of their body
+    QHash< QObject*, QxtWebRequestEvent* > m_pendingBatches;
     Api_v1_5* m_api_v1_5;
 };
 
@@ -0,0 +1,147 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "RangeStream.h"
+
+#include "utils/Logger.h"
+
+#include <QFile>
+
+// how much of a sequential source we throw away at once while skipping to the range
+#define SKIP_BLOCK_SIZE 65536
+
+
+RangeStream::RangeStream( const QSharedPointer< QIODevice >& source, qint64 offset, qint64 length )
+    : QIODevice()
+    , m_source( source )
+    , m_localFile( false )
+    , m_skip( 0 )
+    , m_remaining( length )
+    , m_sourceFinished( false )
+{
+    open( QIODevice::ReadOnly | QIODevice::Unbuffered );
+
+    // a file's data can be read right away, no need to wait for it
+    m_localFile = qobject_cast< QFile* >( source.data() ) && !source->isSequential();
+
+    if ( source->isSequential() || !source->seek( offset ) )
+        m_skip = offset;
+
+    connect( source.data(), SIGNAL( readyRead() ), SLOT( onSourceReadyRead() ) );
+    connect( source.data(), SIGNAL( readChannelFinished() ), SLOT( onSourceFinished() ) );
+    connect( source.data(), SIGNAL( aboutToClose() ), SLOT( onSourceFinished() ) );
+
+    // there may be data already, but nobody will tell us about it
+    QMetaObject::invokeMethod( this, "onSourceReadyRead", Qt::QueuedConnection );
+}
+
+
+RangeStream::~RangeStream()
+{
+    if ( m_source )
+        m_source->disconnect( this );
+}
+
+
+qint64
+RangeStream::bytesAvailable() const
+{
+    const qint64 available = m_source->bytesAvailable() - m_skip;
+    if ( available <= 0 )
+        return 0;
+
+    return m_remaining < 0 ? available : qMin( available, m_remaining );
+}
+
+
+qint64
+RangeStream::readData( char* data, qint64 maxSize )
+{
+    if ( !skip() )
+        return 0;
+
+    const qint64 size = m_source->read( data, m_remaining < 0 ? maxSize : qMin( maxSize, m_remaining ) );
+    if ( size > 0 && m_remaining > 0 )
+        m_remaining -= size;
+
+    checkFinished();
+    return qMax( size, Q_INT64_C( 0 ) );
+}
+
+
+qint64
+RangeStream::writeData( const char* data, qint64 maxSize )
+{
+    Q_UNUSED( data );
+    Q_UNUSED( maxSize );
+    return -1;
+}
+
+
+void
+RangeStream::onSourceReadyRead()
+{
+    if ( skip() && bytesAvailable() > 0 )
+        emit readyRead();
+    else
+        checkFinished();
+}
+
+
+void
+RangeStream::onSourceFinished()
+{
+    m_sourceFinished = true;
+    checkFinished();
+}
+
+
+void
+RangeStream::closeStream()
+{
+    if ( isOpen() )
+        close();
+}
+
+
+bool
+RangeStream::skip()
+{
+    while ( m_skip > 0 && m_source->bytesAvailable() > 0 )
+    {
+        const QByteArray discarded = m_source->read( qMin( m_skip, (qint64)SKIP_BLOCK_SIZE ) );
+        if ( discarded.isEmpty() )
+            break;
+
+        m_skip -= discarded.size();
+    }
+
+    return m_skip == 0;
+}
+
+
+void
+RangeStream::checkFinished()
+{
+    // closing tells the session manager the response is complete
+    // atEnd() of sequential devices only means their buffer ran empty
+    const bool sourceDone = m_sourceFinished || ( !m_source->isSequential() && m_source->atEnd() );
+    if ( m_remaining == 0 || ( sourceDone && !m_source->bytesAvailable() ) )
+        QMetaObject::invokeMethod( this, "closeStream", Qt::QueuedConnection );
+}
@@ -0,0 +1,75 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef RANGESTREAM_H
+#define RANGESTREAM_H
+
+#include <QIODevice>
+#include <QSharedPointer>
+
+/**
+ * Serves a byte range of a stream to one /sid/ request.
+ *
+ * Keeps its own reference to the device UrlHandler gave us, so every
+ * request owns its stream and any number of them can run at once. The
+ * QxtHttpSessionManager deletes us once the response is done.
+ *
+ * Random access devices are seeked to the start of the range, sequential
+ * ones skip ahead by reading and discarding.
+ */
+class RangeStream : public QIODevice
+{
+Q_OBJECT
+
+public:
+    /// Serves length bytes from offset on, or everything from offset on if length is -1.
+    RangeStream( const QSharedPointer< QIODevice >& source, qint64 offset, qint64 length );
+    virtual ~RangeStream();
+
+    /**
+     * False if all data is available right away, the session manager then
+     * doesn't wait for readyRead() / aboutToClose() from us.
+     */
+    bool isStreaming() const { return !m_localFile; }
+
+    virtual bool isSequential() const { return true; }
+    virtual qint64 bytesAvailable() const;
+
+protected:
+    virtual qint64 readData( char* data, qint64 maxSize );
+    virtual qint64 writeData( const char* data, qint64 maxSize );
+
+private slots:
+    void onSourceReadyRead();
+    void onSourceFinished();
+    void closeStream();
+
+private:
+    bool skip();
+    void checkFinished();
+
+    QSharedPointer< QIODevice > m_source;
+    bool m_localFile;
+    qint64 m_skip;
+    qint64 m_remaining;
+    bool m_sourceFinished;
+};
+
+#endif // RANGESTREAM_H
@@ -0,0 +1,209 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ResultsStream.h"
+
+#include "utils/Json.h"
+#include "utils/Logger.h"
+
+#include "Query.h"
+#include "Result.h"
+
+
+ResultsStream::ResultsStream( const QList< Tomahawk::query_ptr >& queries, Format format, int timeout )
+    : QIODevice()
+    , m_pending( 0 )
+    , m_format( format )
+    , m_finished( false )
+    , m_timedOut( false )
+{
+    open( QIODevice::ReadOnly | QIODevice::Unbuffered );
+
+    m_timeout.setSingleShot( true );
+    m_timeout.setInterval( timeout );
+    connect( &m_timeout, SIGNAL( timeout() ), SLOT( finish() ) );
+
+    foreach ( const Tomahawk::query_ptr& query, queries )
+    {
+        if ( m_queries.contains( query.data() ) )
+            continue;
+        m_queries.insert( query.data(), query );
+
+        // what we have so far, later updates only carry what's new
+        push( query, query->results(), query->resolvingFinished() );
+        if ( query->resolvingFinished() )
+            continue;
+
+        m_pending++;
+        connect( query.data(), SIGNAL( resultsAdded( QList<Tomahawk::result_ptr> ) ),
+                 SLOT( onResultsAdded( QList<Tomahawk::result_ptr> ) ) );
+        connect( query.data(), SIGNAL( resolvingFinished( bool ) ),
+                 SLOT( onResolvingFinished( bool ) ) );
+    }
+
+    if ( m_pending )
+        m_timeout.start();
+    else
+        finish();
+}
+
+
+ResultsStream::~ResultsStream()
+{
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << m_queries.count() << "queries," << ( m_timedOut ? "timed out" : "done" );
+}
+
+
+qint64
+ResultsStream::bytesAvailable() const
+{
+    return m_buffer.size() + QIODevice::bytesAvailable();
+}
+
+
+QByteArray
+ResultsStream::contentType( Format format )
+{
+    if ( format == EventStream )
+        return "text/event-stream; charset=utf-8";
+
+    return "application/x-json-stream; charset=utf-8";
+}
+
+
+qint64
+ResultsStream::readData( char* data, qint64 maxSize )
+{
+    const qint64 size = qMin( maxSize, (qint64)m_buffer.size() );
+    memcpy( data, m_buffer.constData(), size );
+    m_buffer.remove( 0, size );
+
+    // only close once everything got sent, closing ends the response right away
+    if ( m_finished && m_buffer.isEmpty() )
+        QMetaObject::invokeMethod( this, "closeStream", Qt::QueuedConnection );
+
+    return size;
+}
+
+
+qint64
+ResultsStream::writeData( const char* data, qint64 maxSize )
+{
+    Q_UNUSED( data );
+    Q_UNUSED( maxSize );
+    return -1;
+}
+
+
+void
+ResultsStream::onResultsAdded( const QList< Tomahawk::result_ptr >& results )
+{
+    const Tomahawk::query_ptr query = m_queries.value( sender() );
+    if ( !query || m_finished )
+        return;
+
+    // offline results don't make it into the update, there may be nothing new to tell
+    foreach ( const Tomahawk::result_ptr& result, results )
+    {
+        if ( result->isOnline() )
+        {
+            push( query, results, false );
+            return;
+        }
+    }
+}
+
+
+void
+ResultsStream::onResolvingFinished( bool hasResults )
+{
+    Q_UNUSED( hasResults );
+
+    const Tomahawk::query_ptr query = m_queries.value( sender() );
+    if ( !query || m_finished )
+        return;
+
+    disconnect( query.data(), 0, this, 0 );
+    push( query, QList< Tomahawk::result_ptr >(), true );
+
+    if ( --m_pending == 0 )
+        finish();
+}
+
+
+void
+ResultsStream::finish()
+{
+    if ( m_finished )
+        return;
+
+    m_timedOut = m_pending > 0;
+    m_timeout.stop();
+
+    foreach ( QObject* query, m_queries.keys() )
+        disconnect( query, 0, this, 0 );
+
+    QVariantMap done;
+    done[ "done" ] = true;
+    done[ "timedout" ] = m_timedOut;
+    write( done );
+
+    m_finished = true;
+}
+
+
+void
+ResultsStream::closeStream()
+{
+    if ( isOpen() )
+        close();
+}
+
+
+void
+ResultsStream::push( const Tomahawk::query_ptr& query, const QList< Tomahawk::result_ptr >& results, bool finished )
+{
+    QVariantList list;
+    foreach ( const Tomahawk::result_ptr& result, results )
+    {
+        if ( result->isOnline() )
+            list << result->toVariant();
+    }
+
+    QVariantMap update;
+    update[ "qid" ] = query->id();
+    update[ "solved" ] = query->playable();
+    update[ "finished" ] = finished;
+    update[ "results" ] = list;
+    write( update );
+}
+
+
+void
+ResultsStream::write( const QVariantMap& update )
+{
+    const QByteArray json = TomahawkUtils::toJson( update );
+
+    if ( m_format == EventStream )
+        m_buffer += "data: " + json + "\n\n";
+    else
+        m_buffer += json + "\n";
+
+    emit readyRead();
+}
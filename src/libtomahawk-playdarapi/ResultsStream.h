@@ -0,0 +1,79 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef RESULTSSTREAM_H
+#define RESULTSSTREAM_H
+
+#include "Typedefs.h"
+
+#include <QHash>
+#include <QIODevice>
+#include <QTimer>
+
+/**
+ * Holds a get_results request open and pushes results as they come in,
+ * instead of letting web clients poll for the full list again and again.
+ *
+ * Every update is a JSON object on a line of its own, or an event when the
+ * client asked for server-sent events. Each one only carries the results
+ * that were added since the last update of that query. The stream ends
+ * once all queries finished resolving or after the timeout.
+ *
+ * The QxtHttpSessionManager owns and deletes the stream.
+ */
+class ResultsStream : public QIODevice
+{
+Q_OBJECT
+
+public:
+    enum Format { JsonLines, EventStream };
+
+    ResultsStream( const QList< Tomahawk::query_ptr >& queries, Format format, int timeout );
+    virtual ~ResultsStream();
+
+    virtual bool isSequential() const { return true; }
+    virtual qint64 bytesAvailable() const;
+
+    static QByteArray contentType( Format format );
+
+protected:
+    virtual qint64 readData( char* data, qint64 maxSize );
+    virtual qint64 writeData( const char* data, qint64 maxSize );
+
+private slots:
+    void onResultsAdded( const QList< Tomahawk::result_ptr >& results );
+    void onResolvingFinished( bool hasResults );
+    void finish();
+    void closeStream();
+
+private:
+    void push( const Tomahawk::query_ptr& query, const QList< Tomahawk::result_ptr >& results, bool finished );
+    void write( const QVariantMap& update );
+
+    QHash< QObject*, Tomahawk::query_ptr > m_queries;
+    int m_pending;
+    Format m_format;
+    QByteArray m_buffer;
+    bool m_finished;
+    bool m_timedOut;
+    QTimer m_timeout;
+};
+
+#endif // RESULTSSTREAM_H
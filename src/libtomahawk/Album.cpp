@@ -23,6 +23,7 @@
 #include "database/DatabaseImpl.h"
 #include "database/IdThreadWorker.h"
 #include "utils/TomahawkUtilsGui.h"
+#include "utils/ThumbnailCache.h"
 #include "utils/Logger.h"
 
 #include "Artist.h"
@@ -237,20 +238,20 @@ Album::sortname() const
 }
 
 
-QPixmap
-Album::cover( const QSize& size, bool forceLoad ) const
+bool
+Album::loadCover( bool forceLoad ) const
 {
     Q_D( const Album );
     if ( d->name.isEmpty() )
     {
         d->coverLoaded = true;
-        return QPixmap();
+        return false;
     }
 
     if ( !d->coverLoaded && !d->coverLoading )
     {
         if ( !forceLoad )
-            return QPixmap();
+            return false;
 
         Tomahawk::InfoSystem::InfoStringHash trackInfo;
         trackInfo["artist"] = d->artist->name();
@@ -276,11 +277,22 @@ Album::cover( const QSize& size, bool forceLoad ) const
         d->coverLoading = true;
     }
 
+    return true;
+}
+
+
+QPixmap
+Album::cover( const QSize& size, bool forceLoad ) const
+{
+    Q_D( const Album );
+    if ( !loadCover( forceLoad ) )
+        return QPixmap();
+
     if ( !d->cover && !d->coverBuffer.isEmpty() )
     {
+        // the buffer stays around, thumbnail() scales from it
         QPixmap cover;
         cover.loadFromData( d->coverBuffer );
-        d->coverBuffer.clear();
 
         d->cover = new QPixmap( TomahawkUtils::squareCenterPixmap( cover ) );
     }
@@ -306,6 +318,18 @@ Album::cover( const QSize& size, bool forceLoad ) const
 }
 
 
+QPixmap
+Album::thumbnail( const QSize& size, bool forceLoad ) const
+{
+    Q_D( const Album );
+    if ( !loadCover( forceLoad ) )
+        return QPixmap();
+
+    return Tomahawk::Utils::ThumbnailCache::instance()->thumbnail( infoid(), d->coverBuffer, size, const_cast< Album* >( this ),
+                                                                   std::bind( &Album::coverChanged, const_cast< Album* >( this ) ) );
+}
+
+
 bool
 Album::coverLoaded() const
 {
@@ -314,6 +338,14 @@ Album::coverLoaded() const
 }
 
 
+bool
+Album::hasCover() const
+{
+    Q_D( const Album );
+    return !d->coverBuffer.isEmpty();
+}
+
+
 void
 Album::infoSystemInfo( const Tomahawk::InfoSystem::InfoRequestData& requestData, const QVariant& output )
 {
@@ -332,8 +364,11 @@ Album::infoSystemInfo( const Tomahawk::InfoSystem::InfoRequestData& requestData,
     {
         QVariantMap returnedData = output.value< QVariantMap >();
         const QByteArray ba = returnedData["imgbytes"].toByteArray();
-        if ( !ba.isEmpty() )
+        if ( !ba.isEmpty() && ba != d->coverBuffer )
         {
+            if ( !d->coverBuffer.isEmpty() )
+                Tomahawk::Utils::ThumbnailCache::instance()->invalidate( infoid() );
+
             d->coverBuffer = ba;
         }
 
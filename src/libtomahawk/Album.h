@@ -60,7 +60,14 @@ public:
 
     artist_ptr artist() const;
     QPixmap cover( const QSize& size, bool forceLoad = true ) const;
+    /**
+     * Like cover(), but decoded and scaled in the background for views showing lots of covers.
+     * Returns a null pixmap until it's ready, coverChanged() is emitted then.
+     */
+    QPixmap thumbnail( const QSize& size, bool forceLoad = true ) const;
     bool coverLoaded() const;
+    /// Whether a cover was found, thumbnail() may still be busy scaling it.
+    bool hasCover() const;
 
     QList<Tomahawk::query_ptr> tracks( ModelMode mode = Mixed, const Tomahawk::collection_ptr& collection = Tomahawk::collection_ptr() );
     Tomahawk::playlistinterface_ptr playlistInterface( ModelMode mode, const Tomahawk::collection_ptr& collection = Tomahawk::collection_ptr() );
@@ -91,6 +98,8 @@ private:
     Q_DECLARE_PRIVATE( Album )
     Q_DISABLE_COPY( Album )
     QString infoid() const;
+    /// Requests the cover unless it's loaded or being loaded, returns false if there's nothing to show (yet).
+    bool loadCover( bool forceLoad ) const;
     void setIdFuture( QFuture<unsigned int> future );
 
     static QHash< QString, album_wptr > s_albumsByName;
@@ -28,6 +28,7 @@
 #include "database/DatabaseCommand_TrackStats.h"
 #include "database/IdThreadWorker.h"
 #include "utils/TomahawkUtilsGui.h"
+#include "utils/ThumbnailCache.h"
 #include "utils/Logger.h"
 
 #include "ArtistPlaylistInterface.h"
@@ -513,8 +514,11 @@ Artist::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVari
             else if ( output.isValid() )
             {
                 const QByteArray ba = returnedData["imgbytes"].toByteArray();
-                if ( !ba.isEmpty() )
+                if ( !ba.isEmpty() && ba != m_coverBuffer )
                 {
+                    if ( !m_coverBuffer.isEmpty() )
+                        Tomahawk::Utils::ThumbnailCache::instance()->invalidate( infoid() );
+
                     m_coverBuffer = ba;
                 }
 
@@ -583,13 +587,13 @@ Artist::infoSystemFinished( QString target )
 }
 
 
-QPixmap
-Artist::cover( const QSize& size, bool forceLoad ) const
+bool
+Artist::loadCover( bool forceLoad ) const
 {
     if ( !m_coverLoaded && !m_coverLoading )
     {
         if ( !forceLoad )
-            return QPixmap();
+            return false;
 
         Tomahawk::InfoSystem::InfoStringHash trackInfo;
         trackInfo["artist"] = name();
@@ -614,11 +618,21 @@ Artist::cover( const QSize& size, bool forceLoad ) const
         m_coverLoading = true;
     }
 
+    return true;
+}
+
+
+QPixmap
+Artist::cover( const QSize& size, bool forceLoad ) const
+{
+    if ( !loadCover( forceLoad ) )
+        return QPixmap();
+
     if ( !m_cover && !m_coverBuffer.isEmpty() )
     {
+        // the buffer stays around, thumbnail() scales from it
         QPixmap cover;
         cover.loadFromData( m_coverBuffer );
-        m_coverBuffer.clear();
 
         m_cover = new QPixmap( TomahawkUtils::squareCenterPixmap( cover ) );
     }
@@ -644,6 +658,17 @@ Artist::cover( const QSize& size, bool forceLoad ) const
 }
 
 
+QPixmap
+Artist::thumbnail( const QSize& size, bool forceLoad ) const
+{
+    if ( !loadCover( forceLoad ) )
+        return QPixmap();
+
+    return Tomahawk::Utils::ThumbnailCache::instance()->thumbnail( infoid(), m_coverBuffer, size, const_cast< Artist* >( this ),
+                                                                   std::bind( &Artist::coverChanged, const_cast< Artist* >( this ) ) );
+}
+
+
 Tomahawk::playlistinterface_ptr
 Artist::playlistInterface( ModelMode mode, const Tomahawk::collection_ptr& collection )
 {
@@ -66,7 +66,14 @@ public:
     QString biography() const;
 
     QPixmap cover( const QSize& size, bool forceLoad = true ) const;
+    /**
+     * Like cover(), but decoded and scaled in the background for views showing lots of images.
+     * Returns a null pixmap until it's ready, coverChanged() is emitted then.
+     */
+    QPixmap thumbnail( const QSize& size, bool forceLoad = true ) const;
     bool coverLoaded() const { return m_coverLoaded; }
+    /// Whether an image was found, thumbnail() may still be busy scaling it.
+    bool hasCover() const { return !m_coverBuffer.isEmpty(); }
 
     Tomahawk::playlistinterface_ptr playlistInterface();
 
@@ -99,6 +106,8 @@ private slots:
 private:
     Artist();
     QString infoid() const;
+    /// Requests the image unless it's loaded or being loaded, returns false if there's nothing to show (yet).
+    bool loadCover( bool forceLoad ) const;
 
     void setIdFuture( QFuture<unsigned int> idFuture );
 
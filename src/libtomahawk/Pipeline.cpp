@@ -18,7 +18,9 @@
 
 #include "Pipeline_p.h"
 
+#include <QDir>
 #include <QMutexLocker>
+#include <qmath.h>
 
 #include "database/Database.h"
 #include "resolvers/ExternalResolver.h"
@@ -31,11 +33,14 @@
 #include "Result.h"
 #include "Source.h"
 #include "SourceList.h"
+#include "TomahawkSettings.h"
 
 #define DEFAULT_CONCURRENT_QUERIES 4
 #define MAX_CONCURRENT_QUERIES 16
+#define MAX_BATCH_SIZE 100
 #define CLEANUP_TIMEOUT 5 * 60 * 1000
 #define MINSCORE 0.5
+#define RESULT_CACHE_FILE "resultcache.dat"
 
 using namespace Tomahawk;
 
@@ -61,6 +66,11 @@ Pipeline::Pipeline( QObject* parent )
 
     d->temporaryQueryTimer.setInterval( CLEANUP_TIMEOUT );
     connect( &d->temporaryQueryTimer, SIGNAL( timeout() ), SLOT( onTemporaryQueryTimer() ) );
+
+    d->budgetTimer.start();
+    d->budgetClock = std::bind( &QElapsedTimer::elapsed, &d->budgetTimer );
+    d->throttleTimer.setSingleShot( true );
+    connect( &d->throttleTimer, SIGNAL( timeout() ), SLOT( shuntNext() ) );
 }
 
 
@@ -91,7 +101,7 @@ unsigned int
 Pipeline::pendingQueryCount() const
 {
     Q_D( const Pipeline );
-    return d->queries_pending.count();
+    return d->scheduler.pendingCount();
 }
 
 
@@ -99,13 +109,30 @@ unsigned int
 Pipeline::activeQueryCount() const
 {
     Q_D( const Pipeline );
-    return d->qidsState.count();
+    return d->scheduler.activeCount();
+}
+
+
+unsigned int
+Pipeline::maxConcurrentQueries() const
+{
+    Q_D( const Pipeline );
+    return d->maxConcurrentQueries;
 }
 
 
 void
 Pipeline::databaseReady()
 {
+    Q_D( Pipeline );
+
+    const QDir cacheDir( TomahawkSettings::instance()->storageCacheLocation() );
+    cacheDir.mkpath( "." );
+    d->resultCachePath = cacheDir.absoluteFilePath( RESULT_CACHE_FILE );
+    d->resultCache.load( d->resultCachePath );
+
+    setBackgroundResolveRate( TomahawkSettings::instance()->backgroundResolveRate() );
+
     connect( Database::instance(), SIGNAL( ready() ), this, SLOT( start() ), Qt::QueuedConnection );
     Database::instance()->loadIndex();
 }
@@ -116,7 +143,7 @@ Pipeline::start()
 {
     Q_D( Pipeline );
 
-    tDebug() << Q_FUNC_INFO << "Shunting" << d->queries_pending.size() << "queries!";
+    tDebug() << Q_FUNC_INFO << "Shunting" << d->scheduler.pendingCount() << "queries!";
     d->running = true;
     emit running();
 
@@ -130,6 +157,16 @@ Pipeline::stop()
     Q_D( Pipeline );
 
     d->running = false;
+
+    foreach ( const QString& resolver, d->resultCache.resolvers() )
+    {
+        const ResultCache::Statistics stats = d->resultCache.statistics( resolver );
+        tLog() << "Result cache for" << resolver << "- hits:" << stats.hits << "negative hits:" << stats.negativeHits
+               << "misses:" << stats.misses << "hit rate:" << stats.hitRate();
+    }
+
+    if ( !d->resultCachePath.isEmpty() )
+        d->resultCache.save( d->resultCachePath );
 }
 
 
@@ -141,6 +178,7 @@ Pipeline::removeResolver( Resolver* r )
 
     tDebug() << "Removed resolver:" << r->name();
     d->resolvers.removeAll( r );
+    d->budgets.remove( r );
     if ( d->running ) {
         // Only notify if Pipeline is still active.
         emit resolverRemoved( r );
@@ -249,45 +287,68 @@ Pipeline::resolverForPath( const QString& scriptPath )
 
 void
 Pipeline::resolve( const QList<query_ptr>& qlist, bool prioritized, bool temporaryQuery )
+{
+    enqueue( qlist, prioritized ? LaneVisible : LaneBackground, prioritized, temporaryQuery );
+}
+
+
+void
+Pipeline::schedule( const QList<query_ptr>& qlist, ResolveLane lane, bool temporaryQuery )
+{
+    enqueue( qlist, lane, true, temporaryQuery );
+}
+
+
+void
+Pipeline::deprioritize( const QList<query_ptr>& qlist )
+{
+    Q_D( Pipeline );
+    QMutexLocker lock( &d->mut );
+
+    d->scheduler.reprioritize( qlist, LaneBackground );
+}
+
+
+void
+Pipeline::enqueue( const QList<query_ptr>& qlist, ResolveLane lane, bool prioritized, bool temporaryQuery )
 {
     Q_D( Pipeline );
 
     {
         QMutexLocker lock( &d->mut );
 
-        int i = 0;
+        QList< query_ptr > queries;
+        queries.reserve( qlist.count() );
         foreach ( const query_ptr& q, qlist )
         {
-            if ( q->resolvingFinished() )
+            if ( q.isNull() || q->resolvingFinished() )
                 continue;
-            if ( d->qidsState.contains( q->id() ) )
-                continue;
-            if ( d->queries_pending.contains( q ) )
+            if ( d->scheduler.isActive( q->id() ) )
             {
-                if ( prioritized )
-                {
-                    d->queries_pending.insert( i++, d->queries_pending.takeAt( d->queries_pending.indexOf( q ) ) );
-                }
+                // the remaining resolvers shouldn't hold it back anymore
+                if ( lane != LaneBackground )
+                    d->throttledQueries.remove( q->id() );
                 continue;
             }
 
-            if ( !d->qids.contains( q->id() ) )
-                d->qids.insert( q->id(), q );
-
-            if ( prioritized )
-                d->queries_pending.insert( i++, q );
-            else
-                d->queries_pending << q;
-
-            if ( temporaryQuery )
+            if ( !d->scheduler.isPending( q->id() ) )
             {
-                d->queries_temporary << q;
+                d->scheduler.addQuery( q );
+
+                if ( temporaryQuery )
+                {
+                    d->queries_temporary << q;
 
-                if ( d->temporaryQueryTimer.isActive() )
-                    d->temporaryQueryTimer.stop();
-                d->temporaryQueryTimer.start();
+                    if ( d->temporaryQueryTimer.isActive() )
+                        d->temporaryQueryTimer.stop();
+                    d->temporaryQueryTimer.start();
+                }
             }
+
+            queries << q;
         }
+
+        d->scheduler.enqueue( queries, lane, prioritized );
     }
 
     shuntNext();
@@ -299,7 +360,8 @@ Pipeline::isResolving( const query_ptr& q ) const
 {
     Q_D( const Pipeline );
 
-    return d->qids.contains( q->id() ) && d->qidsState.contains( q->id() );
+    return d->scheduler.isKnown( q->id() ) &&
+           ( d->scheduler.isActive( q->id() ) || d->parkedQueries.contains( q->id() ) );
 }
 
 
@@ -323,12 +385,12 @@ Pipeline::resolve( QID qid, bool prioritized, bool temporaryQuery )
 
 
 void
-Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
+Pipeline::reportResults( QID qid, const QList< result_ptr >& results, Resolver* resolver )
 {
     Q_D( Pipeline );
     if ( !d->running )
         return;
-    if ( !d->qids.contains( qid ) )
+    if ( !d->scheduler.isKnown( qid ) )
     {
         if ( !results.isEmpty() )
         {
@@ -344,7 +406,7 @@ Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
         }
         return;
     }
-    const query_ptr& q = d->qids.value( qid );
+    const query_ptr q = d->scheduler.query( qid );
 
     Q_ASSERT( !q.isNull() );
     if ( q.isNull() )
@@ -368,9 +430,19 @@ Pipeline::reportResults( QID qid, const QList< result_ptr >& results )
     {
         const ResultUrlChecker* checker = new ResultUrlChecker( q, httpResults );
         connect( checker, SIGNAL( done() ), SLOT( onResultUrlCheckerDone() ) );
+
+        if ( resolver )
+        {
+            PipelinePrivate::PendingCheck& pending = d->pendingChecks[ checker ];
+            pending.resolver = resolver;
+            pending.results = cleanResults;
+        }
     }
     else
     {
+        if ( resolver )
+            cacheResults( resolver, q, cleanResults );
+
         decQIDState( q );
     }
 
@@ -412,9 +484,26 @@ Pipeline::addResultsToQuery( const query_ptr& query, const QList< result_ptr >&
 }
 
 
+void
+Pipeline::cacheResults( Resolver* r, const query_ptr& query, const QList< result_ptr >& results )
+{
+    Q_D( Pipeline );
+
+    // resolvers that got removed in the meantime may still report results, don't keep those around
+    {
+        QMutexLocker lock( &d->mut );
+        if ( !d->resolvers.contains( r ) )
+            return;
+    }
+
+    d->resultCache.insert( r, query, results );
+}
+
+
 void
 Pipeline::onResultUrlCheckerDone()
 {
+    Q_D( Pipeline );
     ResultUrlChecker* checker = qobject_cast< ResultUrlChecker* >( sender() );
     if ( !checker )
         return;
@@ -423,6 +512,14 @@ Pipeline::onResultUrlCheckerDone()
 
     const query_ptr q = checker->query();
     addResultsToQuery( q, checker->validResults() );
+
+    if ( d->pendingChecks.contains( checker ) )
+    {
+        const PipelinePrivate::PendingCheck pending = d->pendingChecks.take( checker );
+        if ( pending.resolver )
+            cacheResults( pending.resolver.data(), q, pending.results + checker->validResults() );
+    }
+
 /*    if ( q && !q->isFullTextQuery() )
     {
         setQIDState( q, 0 );
@@ -440,12 +537,12 @@ Pipeline::reportAlbums( QID qid, const QList< album_ptr >& albums )
     if ( !d->running )
         return;
 
-    if ( !d->qids.contains( qid ) )
+    if ( !d->scheduler.isKnown( qid ) )
     {
         tDebug() << "Albums arrived too late for:" << qid;
         return;
     }
-    const query_ptr& q = d->qids.value( qid );
+    const query_ptr q = d->scheduler.query( qid );
     Q_ASSERT( q->isFullTextQuery() );
 
     QList< album_ptr > cleanAlbums;
@@ -470,12 +567,12 @@ Pipeline::reportArtists( QID qid, const QList< artist_ptr >& artists )
     if ( !d->running )
         return;
 
-    if ( !d->qids.contains( qid ) )
+    if ( !d->scheduler.isKnown( qid ) )
     {
         tDebug() << "Artists arrived too late for:" << qid;
         return;
     }
-    const query_ptr& q = d->qids.value( qid );
+    const query_ptr q = d->scheduler.query( qid );
     Q_ASSERT( q->isFullTextQuery() );
 
     QList< artist_ptr > cleanArtists;
@@ -502,30 +599,98 @@ Pipeline::shuntNext()
 
     unsigned int rc;
     query_ptr q;
+    Resolver* batchResolver = 0;
+    QList< query_ptr > batch;
     {
         QMutexLocker lock( &d->mut );
 
         rc = d->resolvers.count();
-        if ( d->queries_pending.isEmpty() )
+        if ( !d->scheduler.pendingCount() )
         {
-            if ( d->qidsState.isEmpty() )
+            if ( !d->scheduler.activeCount() )
                 emit idle();
             return;
         }
 
         // Check if we are ready to dispatch more queries
-        if ( d->qidsState.count() >= d->maxConcurrentQueries )
+        if ( d->scheduler.activeCount() >= d->maxConcurrentQueries )
             return;
 
+        // Every query of a batch takes up a slot, so batches only fill the free ones.
+        // Background queries are only dispatched as fast as the budget of
+        // the resolver they'd be asked first allows
+        int budget = qMin( MAX_BATCH_SIZE, d->maxConcurrentQueries - d->scheduler.activeCount() );
+        const bool throttled = ( d->scheduler.nextLane() == LaneBackground && d->backgroundRate > 0 );
+        Resolver* r = nextResolver( d->scheduler.peekNext() );
+        if ( throttled && r )
+        {
+            int wait = 0;
+            budget = qMin( backgroundBudget( r, &wait ), budget );
+            if ( budget < 1 )
+            {
+                if ( !d->throttleTimer.isActive() )
+                    d->throttleTimer.start( wait );
+                return;
+            }
+        }
+
         /*
             Since resolvers are async, we now dispatch to the highest weighted ones
             and after timeout, dispatch to next highest etc, aborting when solved
         */
-        q = d->queries_pending.takeFirst();
-        q->setCurrentResolver( 0 );
+        q = d->scheduler.takeNext();
+        const bool resumed = d->parkedQueries.contains( q->id() );
+        if ( resumed )
+        {
+            // picks up where it left off, at the resolver it waited for
+            rc = d->parkedQueries.take( q->id() );
+        }
+        else
+            q->setCurrentResolver( 0 );
+        if ( throttled )
+            d->throttledQueries.insert( q->id() );
+
+        // Resolvers that take batches get all the following queries they'd
+        // be asked first anyway in a single call
+        if ( r && r->supportsBatchResolve() && !resumed )
+        {
+            batch << q;
+            while ( batch.count() < budget )
+            {
+                const query_ptr next = d->scheduler.peekNext();
+                if ( next.isNull() || nextResolver( next ) != r || d->parkedQueries.contains( next->id() ) )
+                    break;
+                // throttled queries don't get to tag along with more important ones
+                if ( !throttled && d->backgroundRate > 0 && d->scheduler.nextLane() == LaneBackground )
+                    break;
+
+                d->scheduler.takeNext();
+                next->setCurrentResolver( 0 );
+                if ( throttled )
+                    d->throttledQueries.insert( next->id() );
+                batch << next;
+            }
+
+            if ( batch.count() > 1 )
+            {
+                batchResolver = r;
+                foreach ( const query_ptr& query, batch )
+                    d->scheduler.setState( query->id(), rc );
+
+                // single queries get charged once shunt() dispatches them
+                if ( throttled )
+                    d->budgets[ r ].tokens -= batch.count();
+            }
+        }
     }
 
-    setQIDState( q, rc );
+    if ( batchResolver )
+    {
+        dispatch( batchResolver, batch );
+        new FuncTimeout( 0, std::bind( &Pipeline::shuntNext, this ), this );
+    }
+    else
+        setQIDState( q, rc );
 }
 
 
@@ -557,10 +722,73 @@ Pipeline::shunt( const query_ptr& q )
 
     if ( r )
     {
+        {
+            QMutexLocker lock( &d->mut );
+            if ( d->throttledQueries.contains( q->id() ) )
+            {
+                int wait = 0;
+                if ( backgroundBudget( r, &wait ) < 1 )
+                {
+                    // Wait in front of the background lane instead of in a slot,
+                    // more important queries may need it in the meantime
+                    d->parkedQueries.insert( q->id(), d->scheduler.state( q->id() ) );
+                    d->scheduler.clearState( q->id() );
+                    d->throttledQueries.remove( q->id() );
+                    d->scheduler.enqueue( QList< query_ptr >() << q, LaneBackground, true );
+
+                    lock.unlock();
+                    shuntNext();
+                    return;
+                }
+
+                d->budgets[ r ].tokens -= 1;
+            }
+        }
+
         tLog( LOGVERBOSE ) << "Dispatching to resolver" << r->name() << q->toString() << q->solved() << q->id();
+        dispatch( r, QList< query_ptr >() << q );
+    }
+    else
+    {
+        // we get here if we disable a resolver while a query is resolving
+        setQIDState( q, 0 );
+        return;
+    }
+
+    shuntNext();
+}
+
+
+void
+Pipeline::dispatch( Resolver* r, const QList< query_ptr >& queries )
+{
+    Q_D( Pipeline );
 
+    // answer what we can from the cache, only ask the resolver for the rest
+    QList< query_ptr > misses;
+    QList< QPair< query_ptr, QList< result_ptr > > > hits;
+    foreach ( const query_ptr& q, queries )
+    {
+        QList< result_ptr > results;
+        if ( d->resultCache.lookup( r, q, results ) )
+            hits << qMakePair( q, results );
+        else
+            misses << q;
+    }
+
+    if ( misses.count() > 1 )
+        tLog( LOGVERBOSE ) << "Dispatching batch of" << misses.count() << "queries to resolver" << r->name();
+
+    foreach ( const query_ptr& q, queries )
         q->setCurrentResolver( r );
-        r->resolve( q );
+
+    if ( misses.count() == 1 )
+        r->resolve( misses.first() );
+    else if ( !misses.isEmpty() )
+        r->resolveBatch( misses );
+
+    foreach ( const query_ptr& q, misses )
+    {
         emit resolving( q );
 
         if ( r->timeout() > 0 )
@@ -569,17 +797,95 @@ Pipeline::shunt( const query_ptr& q )
             new FuncTimeout( r->timeout(), std::bind( &Pipeline::timeoutShunt, this, q ), this );
         }
     }
-    else
+
+    for ( int i = 0; i < hits.count(); i++ )
     {
-        // we get here if we disable a resolver while a query is resolving
-        setQIDState( q, 0 );
-        return;
+        emit resolving( hits.at( i ).first );
+        reportResults( hits.at( i ).first->id(), hits.at( i ).second );
+    }
+}
+
+
+const ResultCache*
+Pipeline::resultCache() const
+{
+    Q_D( const Pipeline );
+    return &d->resultCache;
+}
+
+
+void
+Pipeline::invalidateResultCache( Resolver* r )
+{
+    Q_D( Pipeline );
+    d->resultCache.invalidate( r->name() );
+}
+
+
+unsigned int
+Pipeline::backgroundResolveRate() const
+{
+    Q_D( const Pipeline );
+    return d->backgroundRate;
+}
+
+
+void
+Pipeline::setBackgroundResolveRate( unsigned int queriesPerSecond )
+{
+    Q_D( Pipeline );
+    {
+        QMutexLocker lock( &d->mut );
+
+        tDebug() << Q_FUNC_INFO << "Resolving background queries at" << queriesPerSecond << "queries/s per resolver";
+        d->backgroundRate = queriesPerSecond;
+        d->budgets.clear();
     }
 
     shuntNext();
 }
 
 
+void
+Pipeline::setBudgetClock( const std::function< qint64 () >& clock )
+{
+    Q_D( Pipeline );
+    QMutexLocker lock( &d->mut );
+
+    // timestamps of the old clock mean nothing to the new one
+    d->budgetClock = clock;
+    d->budgets.clear();
+}
+
+
+int
+Pipeline::backgroundBudget( Resolver* r, int* wait )
+{
+    Q_D( Pipeline );
+    if ( !d->backgroundRate )
+        return MAX_BATCH_SIZE;
+
+    // buckets refill continuously and hold up to a second's worth of queries
+    const qint64 now = d->budgetClock();
+    if ( !d->budgets.contains( r ) )
+    {
+        PipelinePrivate::ResolveBudget budget;
+        budget.tokens = d->backgroundRate;
+        budget.updated = now;
+        d->budgets.insert( r, budget );
+    }
+
+    PipelinePrivate::ResolveBudget& budget = d->budgets[ r ];
+    budget.tokens = qMin( (double)d->backgroundRate, budget.tokens + ( now - budget.updated ) * d->backgroundRate / 1000.0 );
+    budget.updated = now;
+
+    if ( wait )
+        *wait = qMax( 1, (int)qCeil( ( 1.0 - budget.tokens ) * 1000.0 / d->backgroundRate ) );
+
+    return (int)budget.tokens;
+}
+
+
 Tomahawk::Resolver*
 Pipeline::nextResolver( const Tomahawk::query_ptr& query ) const
 {
@@ -616,17 +922,18 @@ Pipeline::setQIDState( const Tomahawk::query_ptr& query, int state )
 
     if ( state > 0 )
     {
-        d->qidsState.insert( query->id(), state );
+        d->scheduler.setState( query->id(), state );
 
         new FuncTimeout( 0, std::bind( &Pipeline::shunt, this, query ), this );
     }
     else
     {
-        d->qidsState.remove( query->id() );
+        d->scheduler.clearState( query->id() );
+        d->throttledQueries.remove( query->id() );
         query->onResolvingFinished();
 
         if ( !d->queries_temporary.contains( query ) )
-            d->qids.remove( query->id() );
+            d->scheduler.removeQuery( query->id() );
 
         new FuncTimeout( 0, std::bind( &Pipeline::shuntNext, this ), this );
     }
@@ -640,11 +947,11 @@ Pipeline::incQIDState( const Tomahawk::query_ptr& query )
     QMutexLocker lock( &d->mut );
 
     int state = 1;
-    if ( d->qidsState.contains( query->id() ) )
+    if ( d->scheduler.isActive( query->id() ) )
     {
-        state = d->qidsState.value( query->id() ) + 1;
+        state = d->scheduler.state( query->id() ) + 1;
     }
-    d->qidsState.insert( query->id(), state );
+    d->scheduler.setState( query->id(), state );
 
     return state;
 }
@@ -658,10 +965,10 @@ Pipeline::decQIDState( const Tomahawk::query_ptr& query )
     {
         QMutexLocker lock( &d->mut );
 
-        if ( !d->qidsState.contains( query->id() ) )
+        if ( !d->scheduler.isActive( query->id() ) )
             return 0;
 
-        state = d->qidsState.value( query->id() ) - 1;
+        state = d->scheduler.state( query->id() ) - 1;
     }
 
     setQIDState( query, state );
@@ -682,7 +989,7 @@ Pipeline::onTemporaryQueryTimer()
     {
         query_ptr q = d->queries_temporary.takeAt( i );
 
-        d->qids.remove( q->id() );
+        d->scheduler.removeQuery( q->id() );
         foreach ( const Tomahawk::result_ptr& r, q->results() )
             d->rids.remove( r->id() );
     }
@@ -693,7 +1000,7 @@ query_ptr
 Pipeline::query( const QID& qid ) const
 {
     Q_D( const Pipeline );
-    return d->qids.value( qid );
+    return d->scheduler.query( qid );
 }
 
 
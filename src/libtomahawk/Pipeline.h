@@ -36,6 +36,7 @@ namespace Tomahawk
 
 class PipelinePrivate;
 class Resolver;
+class ResultCache;
 class ExternalResolver;
 typedef std::function<Tomahawk::ExternalResolver*( QString, QString, QStringList )> ResolverFactoryFunc;
 
@@ -44,6 +45,15 @@ class DLLEXPORT Pipeline : public QObject
 Q_OBJECT
 
 public:
+    /// Pending queries are dispatched from the most important lane first.
+    enum ResolveLane
+    {
+        LaneVisible = 0,    // rows the user is currently looking at
+        LanePrefetch,       // rows likely to become visible soon
+        LaneBackground,     // everything else
+        LaneCount
+    };
+
     static Pipeline* instance();
 
     explicit Pipeline( QObject* parent = nullptr );
@@ -53,8 +63,14 @@ public:
 
     unsigned int pendingQueryCount() const;
     unsigned int activeQueryCount() const;
-
-    void reportResults( QID qid, const QList< result_ptr >& results );
+    /// How many queries get resolved at the same time, batches included
+    unsigned int maxConcurrentQueries() const;
+
+    /**
+     * Results for a query. Pass the resolver they came from to have them
+     * cached, see Resolver::resultCacheTtl().
+     */
+    void reportResults( QID qid, const QList< result_ptr >& results, Tomahawk::Resolver* resolver = 0 );
     void reportAlbums( QID qid, const QList< album_ptr >& albums );
     void reportArtists( QID qid, const QList< artist_ptr >& artists );
 
@@ -73,11 +89,37 @@ public:
 
     bool isResolving( const query_ptr& q ) const;
 
+    /// Per resolver hit rates are available from the cache's statistics().
+    const ResultCache* resultCache() const;
+    /// Forget the cached results of a resolver, e.g. after its configuration changed.
+    void invalidateResultCache( Tomahawk::Resolver* r );
+
+    /**
+     * Queries per second each resolver gets from the background lane, 0 for
+     * unlimited. Visible and prefetched queries are never throttled.
+     */
+    unsigned int backgroundResolveRate() const;
+    void setBackgroundResolveRate( unsigned int queriesPerSecond );
+    /**
+     * The clock (in ms) the background budgets refill by. Defaults to a
+     * monotonic clock started along with the Pipeline, tests can drive it.
+     */
+    void setBudgetClock( const std::function< qint64 () >& clock );
+
 public slots:
     void resolve( const query_ptr& q, bool prioritized = true, bool temporaryQuery = false );
     void resolve( const QList<query_ptr>& qlist, bool prioritized = true, bool temporaryQuery = false );
     void resolve( QID qid, bool prioritized = true, bool temporaryQuery = false );
 
+    /**
+     * Enqueue queries in a specific lane. Queries that are already pending
+     * are moved to the front of that lane, unless they sit in a more
+     * important one already.
+     */
+    void schedule( const QList<Tomahawk::query_ptr>& qlist, Tomahawk::Pipeline::ResolveLane lane, bool temporaryQuery = false );
+    /// Move still pending queries to the background lane, e.g. after they got scrolled out of view.
+    void deprioritize( const QList<Tomahawk::query_ptr>& qlist );
+
     void start();
     void stop();
     void databaseReady();
@@ -104,8 +146,12 @@ private slots:
 private:
     Q_DECLARE_PRIVATE( Pipeline )
 
+    void enqueue( const QList<query_ptr>& qlist, ResolveLane lane, bool prioritized, bool temporaryQuery );
     void addResultsToQuery( const query_ptr& query, const QList< result_ptr >& results );
+    void cacheResults( Tomahawk::Resolver* r, const query_ptr& query, const QList< result_ptr >& results );
     Tomahawk::Resolver* nextResolver( const Tomahawk::query_ptr& query ) const;
+    int backgroundBudget( Tomahawk::Resolver* r, int* wait = 0 );
+    void dispatch( Tomahawk::Resolver* r, const QList< Tomahawk::query_ptr >& queries );
 
     void setQIDState( const Tomahawk::query_ptr& query, int state );
     int incQIDState( const Tomahawk::query_ptr& query );
@@ -0,0 +1,242 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PipelineScheduler.h"
+
+#include "Query.h"
+
+using namespace Tomahawk;
+
+
+PipelineScheduler::PipelineScheduler()
+{
+    for ( int i = 0; i < Pipeline::LaneCount; i++ )
+        m_laneCount[ i ] = 0;
+}
+
+
+PipelineScheduler::~PipelineScheduler()
+{
+}
+
+
+bool
+PipelineScheduler::isKnown( const QID& qid ) const
+{
+    return m_queries.contains( qid );
+}
+
+
+query_ptr
+PipelineScheduler::query( const QID& qid ) const
+{
+    return m_queries.value( qid );
+}
+
+
+void
+PipelineScheduler::addQuery( const query_ptr& query )
+{
+    if ( !m_queries.contains( query->id() ) )
+        m_queries.insert( query->id(), query );
+}
+
+
+void
+PipelineScheduler::removeQuery( const QID& qid )
+{
+    m_queries.remove( qid );
+}
+
+
+void
+PipelineScheduler::enqueue( const QList< query_ptr >& queries, Pipeline::ResolveLane lane, bool prioritized )
+{
+    // Prioritized batches are inserted in front of whatever was pending
+    // before, in their original order. We keep one insertion point per lane,
+    // as already pending queries never get demoted to a less important lane.
+    Lane::iterator cursor[ Pipeline::LaneCount ];
+    for ( int i = 0; i < Pipeline::LaneCount; i++ )
+        cursor[ i ] = prioritized ? m_lanes[ i ].begin() : m_lanes[ i ].end();
+
+    foreach ( const query_ptr& q, queries )
+    {
+        const QID qid = q->id();
+
+        QHash< QID, PendingEntry >::iterator pending = m_pending.find( qid );
+        if ( pending == m_pending.end() )
+        {
+            PendingEntry entry;
+            entry.lane = lane;
+            entry.it = m_lanes[ lane ].insert( cursor[ lane ], q );
+            m_pending.insert( qid, entry );
+            m_laneCount[ lane ]++;
+            continue;
+        }
+
+        const Pipeline::ResolveLane target = qMin( pending->lane, lane );
+        if ( target == pending->lane && !prioritized )
+            continue;
+
+        if ( pending->it == cursor[ target ] )
+        {
+            // already sitting exactly where it would be moved to
+            ++cursor[ target ];
+            continue;
+        }
+
+        m_lanes[ target ].splice( cursor[ target ], m_lanes[ pending->lane ], pending->it );
+        m_laneCount[ pending->lane ]--;
+        m_laneCount[ target ]++;
+        pending->lane = target;
+    }
+}
+
+
+void
+PipelineScheduler::reprioritize( const QList< query_ptr >& queries, Pipeline::ResolveLane lane )
+{
+    foreach ( const query_ptr& q, queries )
+    {
+        QHash< QID, PendingEntry >::iterator pending = m_pending.find( q->id() );
+        if ( pending == m_pending.end() )
+            continue;
+
+        m_lanes[ lane ].splice( m_lanes[ lane ].end(), m_lanes[ pending->lane ], pending->it );
+        m_laneCount[ pending->lane ]--;
+        m_laneCount[ lane ]++;
+        pending->lane = lane;
+    }
+}
+
+
+bool
+PipelineScheduler::dequeue( const QID& qid )
+{
+    QHash< QID, PendingEntry >::iterator pending = m_pending.find( qid );
+    if ( pending == m_pending.end() )
+        return false;
+
+    m_lanes[ pending->lane ].erase( pending->it );
+    m_laneCount[ pending->lane ]--;
+    m_pending.erase( pending );
+
+    return true;
+}
+
+
+query_ptr
+PipelineScheduler::takeNext()
+{
+    for ( int i = 0; i < Pipeline::LaneCount; i++ )
+    {
+        if ( m_lanes[ i ].empty() )
+            continue;
+
+        const query_ptr q = m_lanes[ i ].front();
+        m_lanes[ i ].pop_front();
+        m_laneCount[ i ]--;
+        m_pending.remove( q->id() );
+
+        return q;
+    }
+
+    return query_ptr();
+}
+
+
+query_ptr
+PipelineScheduler::peekNext() const
+{
+    for ( int i = 0; i < Pipeline::LaneCount; i++ )
+    {
+        if ( !m_lanes[ i ].empty() )
+            return m_lanes[ i ].front();
+    }
+
+    return query_ptr();
+}
+
+
+Pipeline::ResolveLane
+PipelineScheduler::nextLane() const
+{
+    for ( int i = 0; i < Pipeline::LaneCount; i++ )
+    {
+        if ( !m_lanes[ i ].empty() )
+            return (Pipeline::ResolveLane)i;
+    }
+
+    return Pipeline::LaneCount;
+}
+
+
+bool
+PipelineScheduler::isPending( const QID& qid ) const
+{
+    return m_pending.contains( qid );
+}
+
+
+int
+PipelineScheduler::pendingCount() const
+{
+    return m_pending.count();
+}
+
+
+int
+PipelineScheduler::pendingCount( Pipeline::ResolveLane lane ) const
+{
+    return m_laneCount[ lane ];
+}
+
+
+bool
+PipelineScheduler::isActive( const QID& qid ) const
+{
+    return m_states.contains( qid );
+}
+
+
+unsigned int
+PipelineScheduler::state( const QID& qid ) const
+{
+    return m_states.value( qid, 0 );
+}
+
+
+void
+PipelineScheduler::setState( const QID& qid, unsigned int state )
+{
+    m_states.insert( qid, state );
+}
+
+
+void
+PipelineScheduler::clearState( const QID& qid )
+{
+    m_states.remove( qid );
+}
+
+
+int
+PipelineScheduler::activeCount() const
+{
+    return m_states.count();
+}
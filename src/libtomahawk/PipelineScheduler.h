@@ -0,0 +1,105 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef PIPELINESCHEDULER_H
+#define PIPELINESCHEDULER_H
+
+#include "Pipeline.h"
+#include "Typedefs.h"
+
+#include <QHash>
+#include <QList>
+
+#include <list>
+
+namespace Tomahawk
+{
+
+/**
+ * Bookkeeping for the Pipeline: all queries it knows about, the ones waiting
+ * to be dispatched (split into priority lanes) and the ones currently being
+ * resolved along with their outstanding resolver count.
+ *
+ * Every operation is O(1) (amortized) per query. The scheduler does no
+ * locking of its own, the Pipeline guards it with its mutex.
+ */
+class PipelineScheduler
+{
+public:
+    PipelineScheduler();
+    ~PipelineScheduler();
+
+    /// Queries known to the Pipeline, pending, active or temporary.
+    bool isKnown( const QID& qid ) const;
+    query_ptr query( const QID& qid ) const;
+    void addQuery( const query_ptr& query );
+    void removeQuery( const QID& qid );
+
+    /**
+     * Enqueue a batch of queries in the given lane. Prioritized batches are
+     * put in front of the lane, keeping their relative order. Queries that
+     * are already pending are moved if the batch is prioritized or targets
+     * a more important lane, otherwise they keep their position.
+     */
+    void enqueue( const QList< query_ptr >& queries, Pipeline::ResolveLane lane, bool prioritized );
+
+    /// Move the given queries to the back of a lane, if they are still pending.
+    void reprioritize( const QList< query_ptr >& queries, Pipeline::ResolveLane lane );
+
+    /// Drop a query from the pending lanes without forgetting about it.
+    bool dequeue( const QID& qid );
+
+    /// Take the most important pending query, or a null pointer.
+    query_ptr takeNext();
+    /// The query takeNext() would return, without taking it.
+    query_ptr peekNext() const;
+    /// The lane takeNext() would take from, LaneCount if nothing is pending.
+    Pipeline::ResolveLane nextLane() const;
+
+    bool isPending( const QID& qid ) const;
+    int pendingCount() const;
+    int pendingCount( Pipeline::ResolveLane lane ) const;
+
+    /// Resolver bookkeeping for queries that have been dispatched.
+    bool isActive( const QID& qid ) const;
+    unsigned int state( const QID& qid ) const;
+    void setState( const QID& qid, unsigned int state );
+    void clearState( const QID& qid );
+    int activeCount() const;
+
+private:
+    typedef std::list< query_ptr > Lane;
+
+    struct PendingEntry
+    {
+        Pipeline::ResolveLane lane;
+        Lane::iterator it;
+    };
+
+    Lane m_lanes[ Pipeline::LaneCount ];
+    int m_laneCount[ Pipeline::LaneCount ];
+
+    QHash< QID, PendingEntry > m_pending;
+    QHash< QID, unsigned int > m_states;
+    QHash< QID, query_ptr > m_queries;
+};
+
+} // Tomahawk
+
+#endif // PIPELINESCHEDULER_H
@@ -22,19 +22,27 @@
 #define PIPELINE_P_H
 
 #include "Pipeline.h"
+#include "PipelineScheduler.h"
+#include "ResultCache.h"
 
+#include <QElapsedTimer>
 #include <QMutex>
+#include <QPointer>
+#include <QSet>
 #include <QTimer>
 
 namespace Tomahawk
 {
 
+class ResultUrlChecker;
+
 class PipelinePrivate
 {
 public:
     PipelinePrivate( Pipeline* q )
         : q_ptr( q )
         , running( false )
+        , backgroundRate( 0 )
     {
     }
 
@@ -46,14 +54,23 @@ private:
     QList< QPointer<Tomahawk::ExternalResolver> > scriptResolvers;
     QList< ResolverFactoryFunc > resolverFactories;
     QMap< QID, bool > qidsTimeout;
-    QMap< QID, unsigned int > qidsState;
-    QMap< QID, query_ptr > qids;
     QMap< RID, result_ptr > rids;
 
-    QMutex mut; // for m_qids, m_rids
+    ResultCache resultCache;
+    QString resultCachePath;
+    // results to cache once their urls got checked, with the resolver they came from
+    struct PendingCheck
+    {
+        QPointer< Tomahawk::Resolver > resolver;
+        QList< result_ptr > results;
+    };
+    QHash< const ResultUrlChecker*, PendingCheck > pendingChecks;
+
+    QMutex mut; // for scheduler, rids
 
-    // store queries here until DB index is loaded, then shunt them all
-    QList< query_ptr > queries_pending;
+    // known, pending and active queries. pending ones are also stored
+    // here until DB index is loaded, then shunted all at once
+    PipelineScheduler scheduler;
     // store temporary queries here and clean up after timeout threshold
     QList< query_ptr > queries_temporary;
 
@@ -61,6 +78,23 @@ private:
     bool running;
     QTimer temporaryQueryTimer;
 
+    // token bucket per resolver for queries from the background lane
+    struct ResolveBudget
+    {
+        double tokens;
+        qint64 updated;
+    };
+    QHash< const Tomahawk::Resolver*, ResolveBudget > budgets;
+    unsigned int backgroundRate; // queries per second and resolver, 0 for unlimited
+    QElapsedTimer budgetTimer;
+    std::function< qint64 () > budgetClock;
+    QTimer throttleTimer;
+    // active queries that were dispatched from the background lane
+    QSet< QID > throttledQueries;
+    // throttled queries waiting in the background lane for the budget of their
+    // next resolver, with the resolver count they resume at
+    QHash< QID, unsigned int > parkedQueries;
+
     static Pipeline* s_instance;
 };
 
@@ -479,9 +479,27 @@ Playlist::setNewRevision( const QString& rev,
     Q_UNUSED( oldorderedguids );
     Q_UNUSED( is_newest_rev );
 
+    // metadata updates keep the order, no need to rebuild anything
+    if ( addedmap.isEmpty() && neworderedguids.count() == d->entries.count() )
+    {
+        int i = 0;
+        while ( i < neworderedguids.count() && d->entries.at( i )->guid() == neworderedguids.at( i ) )
+            i++;
+
+        if ( i == neworderedguids.count() )
+        {
+            PlaylistRevision pr;
+            pr.oldrevisionguid = d->currentrevision;
+            pr.revisionguid = rev;
+            pr.newlist = d->entries;
+            return pr;
+        }
+    }
+
     // build up correctly ordered new list of plentry_ptrs from
     // existing ones, and the ones that have been added
-    QMap<QString, plentry_ptr> entriesmap;
+    QHash<QString, plentry_ptr> entriesmap;
+    entriesmap.reserve( d->entries.count() );
     foreach ( const plentry_ptr& p, d->entries )
     {
         entriesmap.insert( p->guid(), p );
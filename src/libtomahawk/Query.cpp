@@ -34,6 +34,8 @@
 #include <QtAlgorithms>
 #include <QDebug>
 
+#include <algorithm>
+
 using namespace Tomahawk;
 
 
@@ -124,8 +126,12 @@ Query::Query( const track_ptr& track, const result_ptr& result )
 Query::Query( const QString& query, const QID& qid )
     : d_ptr( new QueryPrivate( this, query, qid ) )
 {
+    Q_D( Query );
     init();
 
+    d->fullTextSortname = DatabaseImpl::sortname( query );
+    d->fullTextArtistSortname = DatabaseImpl::sortname( query, true );
+
     if ( !qid.isEmpty() )
     {
         connect( Database::instance(), SIGNAL( indexReady() ), SLOT( refreshResults() ), Qt::QueuedConnection );
@@ -177,6 +183,11 @@ void
 Query::addResults( const QList< Tomahawk::result_ptr >& newresults )
 {
     Q_D( Query );
+
+    // score new results before taking the lock, this is where the expensive edit distances are computed
+    foreach ( const result_ptr& rp, newresults )
+        howSimilar( rp );
+
     {
         QMutexLocker lock( &d->mutex );
 
@@ -191,12 +202,10 @@ Query::addResults( const QList< Tomahawk::result_ptr >& newresults )
                 m_results.append( result );
         }*/
 
-        d->results << newresults;
-        qStableSort( d->results.begin(), d->results.end(), std::bind( &Query::resultSorter, this, std::placeholders::_1, std::placeholders::_2 ) );
-
         // hook up signals, and check solved status
         foreach( const result_ptr& rp, newresults )
         {
+            insertSorted( rp );
             connect( rp.data(), SIGNAL( statusChanged() ), SLOT( onResultStatusChanged() ) );
         }
     }
@@ -271,6 +280,7 @@ Query::removeResult( const Tomahawk::result_ptr& result )
         Q_D( Query );
         QMutexLocker lock( &d->mutex );
         d->results.removeAll( result );
+        d->scores.remove( result->id() );
     }
 
     emit resultsRemoved( result );
@@ -290,6 +300,7 @@ Query::clearResults()
     {
         QMutexLocker lock( &d->mutex );
         d->results.clear();
+        d->scores.clear();
     }
 
     emit playableStateChanged( false );
@@ -394,8 +405,8 @@ Query::id() const
 bool
 Query::resultSorter( const result_ptr& left, const result_ptr& right )
 {
-    const float ls = left->isOnline() ? howSimilar( left ) : 0.0;
-    const float rs = right->isOnline() ? howSimilar( right ) : 0.0;
+    const float ls = left->isOnline() ? cachedScore( left ) : 0.0;
+    const float rs = right->isOnline() ? cachedScore( right ) : 0.0;
 
     if ( ls == rs )
     {
@@ -520,7 +531,7 @@ Query::checkResults()
             if ( rp->playable() )
                 playable = true;
 
-            if ( rp->isOnline() && howSimilar( rp ) > 0.99 )
+            if ( rp->isOnline() && cachedScore( rp ) > 0.99 )
             {
                 solved = true;
             }
@@ -611,31 +622,70 @@ Query::score() const
 }
 
 
-// TODO make clever (ft. featuring live (stuff) etc)
 float
 Query::howSimilar( const Tomahawk::result_ptr& r )
 {
     Q_D( Query );
+    {
+        QMutexLocker lock( &d->mutex );
+        QHash< RID, float >::const_iterator it = d->scores.constFind( r->id() );
+        if ( it != d->scores.constEnd() )
+            return it.value();
+    }
+
+    // a query's names never change, so neither does a result's score
+    const float score = computeSimilarity( r );
+    {
+        QMutexLocker lock( &d->mutex );
+        d->scores.insert( r->id(), score );
+    }
+
+    return score;
+}
+
+
+float
+Query::cachedScore( const Tomahawk::result_ptr& r ) const
+{
+    Q_D( const Query );
+
+    // called while holding d->mutex. Results added via addResults are always scored,
+    // only a fixed result may not have been yet
+    QHash< RID, float >::const_iterator it = d->scores.constFind( r->id() );
+    if ( it != d->scores.constEnd() )
+        return it.value();
+
+    return computeSimilarity( r );
+}
+
+
+void
+Query::insertSorted( const Tomahawk::result_ptr& r )
+{
+    Q_D( Query );
+
+    // d->results is always kept sorted, so new results only need to find their spot.
+    // Inserting after equal results keeps the order of a stable sort.
+    QList< result_ptr >::iterator it = std::upper_bound( d->results.begin(), d->results.end(), r,
+                                                         std::bind( &Query::resultSorter, this, std::placeholders::_1, std::placeholders::_2 ) );
+    d->results.insert( it, r );
+}
+
+
+// TODO make clever (ft. featuring live (stuff) etc)
+float
+Query::computeSimilarity( const Tomahawk::result_ptr& r ) const
+{
+    Q_D( const Query );
     // result values
     const QString& rArtistname = r->track()->artistSortname();
     const QString& rAlbumname  = r->track()->albumSortname();
     const QString& rTrackname  = r->track()->trackSortname();
-    QString qArtistname;
-    QString qAlbumname;
-    QString qTrackname;
 
-    if ( isFullTextQuery() )
-    {
-        qArtistname = DatabaseImpl::sortname( d->fullTextQuery, true );
-        qAlbumname = DatabaseImpl::sortname( d->fullTextQuery );
-        qTrackname = qAlbumname;
-    }
-    else
-    {
-        qArtistname = queryTrack()->artistSortname();
-        qAlbumname  = queryTrack()->albumSortname();
-        qTrackname  = queryTrack()->trackSortname();
-    }
+    const bool fullText = isFullTextQuery();
+    const QString& qArtistname = fullText ? d->fullTextArtistSortname : queryTrack()->artistSortname();
+    const QString& qAlbumname  = fullText ? d->fullTextSortname : queryTrack()->albumSortname();
+    const QString& qTrackname  = fullText ? d->fullTextSortname : queryTrack()->trackSortname();
 
     // normal edit distance
     const int artdist = TomahawkUtils::levenshtein( qArtistname, rArtistname );
@@ -658,9 +708,9 @@ Query::howSimilar( const Tomahawk::result_ptr& r )
         dcalb = (float)( mlalb - albdist ) / mlalb;
     }
 
-    if ( isFullTextQuery() )
+    if ( fullText )
     {
-        const QString artistTrackname = DatabaseImpl::sortname( fullTextQuery() );
+        const QString& artistTrackname = d->fullTextSortname;
         const QString rArtistTrackname = DatabaseImpl::sortname( r->track()->artist() + " " + r->track()->track() );
 
         const int atrdist = TomahawkUtils::levenshtein( artistTrackname, rArtistTrackname );
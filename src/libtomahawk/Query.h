@@ -57,6 +57,7 @@ public:
     virtual ~Query();
 
     bool equals( const Tomahawk::query_ptr& other, bool ignoreCase = false, bool ignoreAlbum = false ) const;
+    /// similarity score of a result, computed once per result and cached
     float howSimilar( const Tomahawk::result_ptr& r );
 
     QVariant toVariant() const;
@@ -110,7 +111,7 @@ public:
     QWeakPointer< Tomahawk::Query > weakRef();
     void setWeakRef( QWeakPointer< Tomahawk::Query > weakRef );
 
-    /// sorter for list of results
+    /// sorter for list of results, both results must have been scored with howSimilar() before
     bool resultSorter( const result_ptr& left, const result_ptr& right );
 
 signals:
@@ -155,6 +156,10 @@ private:
 
     void init();
 
+    float computeSimilarity( const Tomahawk::result_ptr& r ) const;
+    float cachedScore( const Tomahawk::result_ptr& r ) const;
+    void insertSorted( const Tomahawk::result_ptr& r );
+
     void setCurrentResolver( Tomahawk::Resolver* resolver );
     void clearResults();
     void checkResults();
@@ -3,6 +3,7 @@
 
 #include "Query.h"
 
+#include <QHash>
 #include <QMutex>
 
 namespace Tomahawk
@@ -48,6 +49,12 @@ private:
     mutable QID qid;
 
     QString fullTextQuery;
+    // normalized names of the full text query, computed once
+    QString fullTextSortname;
+    QString fullTextArtistSortname;
+
+    // similarity of the results we have been offered, by RID. Dropped along with the result
+    QHash< Tomahawk::RID, float > scores;
 
     QString resultHint;
     bool saveResultHint;
@@ -0,0 +1,451 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ResultCache.h"
+
+#include "resolvers/Resolver.h"
+#include "utils/Logger.h"
+#include "DownloadJob.h"
+#include "Query.h"
+#include "Result.h"
+#include "Track.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <vector>
+
+#define CACHE_FILE_MAGIC 0x52434846 // "RCHF"
+#define CACHE_FILE_VERSION 1
+
+using namespace Tomahawk;
+
+
+static QVariantMap
+resultToVariant( const result_ptr& result )
+{
+    const track_ptr track = result->track();
+
+    QVariantMap m;
+    m[ "url" ] = result->url();
+    m[ "artist" ] = track->artist();
+    m[ "track" ] = track->track();
+    m[ "album" ] = track->album();
+    m[ "albumArtist" ] = track->albumArtist();
+    m[ "composer" ] = track->composer();
+    m[ "duration" ] = track->duration();
+    m[ "albumpos" ] = track->albumpos();
+    m[ "discnumber" ] = track->discnumber();
+    m[ "mimetype" ] = result->mimetype();
+    m[ "bitrate" ] = result->bitrate();
+    m[ "size" ] = result->size();
+    m[ "preview" ] = result->isPreview();
+    m[ "purchaseUrl" ] = result->purchaseUrl();
+    m[ "linkUrl" ] = result->linkUrl();
+
+    QVariantList formats;
+    foreach ( const DownloadFormat& format, result->downloadFormats() )
+    {
+        QVariantMap f;
+        f[ "url" ] = format.url;
+        f[ "extension" ] = format.extension;
+        f[ "mimetype" ] = format.mimetype;
+        formats << f;
+    }
+    if ( !formats.isEmpty() )
+        m[ "downloadFormats" ] = formats;
+
+    return m;
+}
+
+
+static result_ptr
+resultFromVariant( const QVariantMap& m, Resolver* resolver )
+{
+    const track_ptr track = Track::get( m.value( "artist" ).toString(),
+                                        m.value( "track" ).toString(),
+                                        m.value( "album" ).toString(),
+                                        m.value( "albumArtist" ).toString(),
+                                        m.value( "duration" ).toInt(),
+                                        m.value( "composer" ).toString(),
+                                        m.value( "albumpos" ).toUInt(),
+                                        m.value( "discnumber" ).toUInt() );
+    if ( !track )
+        return result_ptr();
+
+    const result_ptr result = Result::get( m.value( "url" ).toString(), track );
+    if ( !result )
+        return result_ptr();
+
+    result->setRID( uuid() );
+    result->setMimetype( m.value( "mimetype" ).toString() );
+    result->setBitrate( m.value( "bitrate" ).toUInt() );
+    result->setSize( m.value( "size" ).toUInt() );
+    result->setPreview( m.value( "preview" ).toBool() );
+    result->setPurchaseUrl( m.value( "purchaseUrl" ).toString() );
+    result->setLinkUrl( m.value( "linkUrl" ).toString() );
+    // only results that passed the url check get cached
+    result->setChecked( true );
+
+    QList< DownloadFormat > formats;
+    foreach ( const QVariant& v, m.value( "downloadFormats" ).toList() )
+    {
+        const QVariantMap f = v.toMap();
+
+        DownloadFormat format;
+        format.url = f.value( "url" ).toUrl();
+        format.extension = f.value( "extension" ).toString();
+        format.mimetype = f.value( "mimetype" ).toString();
+        formats << format;
+    }
+    result->setDownloadFormats( formats );
+
+    result->setResolvedByResolver( resolver );
+    result->setFriendlySource( resolver->name() );
+
+    return result;
+}
+
+
+ResultCache::ResultCache( int capacity )
+    : m_count( 0 )
+    , m_capacity( capacity )
+    , m_clock( 0 )
+{
+}
+
+
+ResultCache::~ResultCache()
+{
+}
+
+
+QString
+ResultCache::key( const query_ptr& query )
+{
+    if ( query->isFullTextQuery() )
+        return QString( "search\t%1" ).arg( query->fullTextQuery().simplified().toLower() );
+
+    const track_ptr track = query->queryTrack();
+    return QString( "%1\t%2\t%3" ).arg( track->artist().simplified().toLower() )
+                                  .arg( track->album().simplified().toLower() )
+                                  .arg( track->track().simplified().toLower() );
+}
+
+
+bool
+ResultCache::lookup( Resolver* resolver, const query_ptr& query, QList< result_ptr >& results )
+{
+    if ( !resolver->resultCacheTtl() && !resolver->negativeResultCacheTtl() )
+        return false;
+
+    QVariantList cached;
+    {
+        QMutexLocker lock( &m_mutex );
+
+        const QString name = resolver->name();
+        Statistics& stats = m_statistics[ name ];
+
+        QHash< QString, QHash< QString, Entry > >::iterator rit = m_entries.find( name );
+        if ( rit == m_entries.end() )
+        {
+            stats.misses++;
+            return false;
+        }
+
+        QHash< QString, Entry >::iterator it = rit->find( key( query ) );
+        if ( it == rit->end() )
+        {
+            stats.misses++;
+            return false;
+        }
+
+        if ( it->expires < QDateTime::currentMSecsSinceEpoch() )
+        {
+            rit->erase( it );
+            m_count--;
+            stats.misses++;
+            return false;
+        }
+
+        stats.hits++;
+        if ( it->results.isEmpty() )
+            stats.negativeHits++;
+
+        it->used = ++m_clock;
+        cached = it->results;
+    }
+
+    // creating Tracks & Results may call into other singletons, do it unlocked
+    results.clear();
+    foreach ( const QVariant& v, cached )
+    {
+        const result_ptr result = resultFromVariant( v.toMap(), resolver );
+        if ( result )
+            results << result;
+    }
+
+    return true;
+}
+
+
+void
+ResultCache::insert( Resolver* resolver, const query_ptr& query, const QList< result_ptr >& results )
+{
+    const qint64 ttl = results.isEmpty() ? resolver->negativeResultCacheTtl() : resolver->resultCacheTtl();
+    if ( ttl <= 0 )
+        return;
+
+    Entry entry;
+    entry.expires = QDateTime::currentMSecsSinceEpoch() + ttl;
+    foreach ( const result_ptr& result, results )
+        entry.results << resultToVariant( result );
+
+    QMutexLocker lock( &m_mutex );
+
+    entry.used = ++m_clock;
+    QHash< QString, Entry >& entries = m_entries[ resolver->name() ];
+    const QString k = key( query );
+    if ( !entries.contains( k ) )
+        m_count++;
+    entries.insert( k, entry );
+
+    if ( m_count > m_capacity )
+        prune( QDateTime::currentMSecsSinceEpoch() );
+}
+
+
+void
+ResultCache::invalidate( const QString& resolverName )
+{
+    QMutexLocker lock( &m_mutex );
+
+    m_count -= m_entries.value( resolverName ).count();
+    m_entries.remove( resolverName );
+
+    tDebug() << Q_FUNC_INFO << "Invalidated cached results for" << resolverName;
+}
+
+
+void
+ResultCache::clear()
+{
+    QMutexLocker lock( &m_mutex );
+
+    m_entries.clear();
+    m_count = 0;
+}
+
+
+int
+ResultCache::count() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_count;
+}
+
+
+QStringList
+ResultCache::resolvers() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_statistics.keys();
+}
+
+
+ResultCache::Statistics
+ResultCache::statistics( const QString& resolverName ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_statistics.value( resolverName );
+}
+
+
+void
+ResultCache::prune( qint64 now )
+{
+    // expired entries first, then the least recently used ones until we're well below capacity again
+    const int target = m_capacity * 9 / 10;
+
+    QHash< QString, QHash< QString, Entry > >::iterator rit = m_entries.begin();
+    for ( ; rit != m_entries.end(); ++rit )
+    {
+        QHash< QString, Entry >::iterator it = rit->begin();
+        while ( it != rit->end() )
+        {
+            if ( it->expires < now )
+            {
+                it = rit->erase( it );
+                m_count--;
+            }
+            else
+                ++it;
+        }
+    }
+
+    if ( m_count <= target )
+        return;
+
+    std::vector< quint64 > stamps;
+    stamps.reserve( m_count );
+    for ( rit = m_entries.begin(); rit != m_entries.end(); ++rit )
+    {
+        foreach ( const Entry& entry, rit.value() )
+            stamps.push_back( entry.used );
+    }
+
+    // stamps are unique, so this drops exactly m_count - target entries
+    std::vector< quint64 >::iterator cutoff = stamps.begin() + ( m_count - target - 1 );
+    std::nth_element( stamps.begin(), cutoff, stamps.end() );
+    const quint64 oldest = *cutoff;
+
+    for ( rit = m_entries.begin(); rit != m_entries.end(); ++rit )
+    {
+        QHash< QString, Entry >::iterator it = rit->begin();
+        while ( it != rit->end() )
+        {
+            if ( it->used <= oldest )
+            {
+                it = rit->erase( it );
+                m_count--;
+            }
+            else
+                ++it;
+        }
+    }
+}
+
+
+bool
+ResultCache::load( const QString& path )
+{
+    QFile file( path );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_8 );
+
+    quint32 magic, version;
+    stream >> magic >> version;
+    if ( magic != CACHE_FILE_MAGIC || version != CACHE_FILE_VERSION )
+    {
+        tLog() << Q_FUNC_INFO << "Ignoring incompatible result cache:" << path;
+        return false;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash< QString, QHash< QString, Entry > > entries;
+    int count = 0;
+    quint64 clock = 0;
+
+    quint32 resolverCount;
+    stream >> resolverCount;
+    for ( quint32 i = 0; i < resolverCount && stream.status() == QDataStream::Ok; i++ )
+    {
+        QString name;
+        quint32 entryCount;
+        stream >> name >> entryCount;
+
+        QHash< QString, Entry >& resolverEntries = entries[ name ];
+        for ( quint32 j = 0; j < entryCount && stream.status() == QDataStream::Ok; j++ )
+        {
+            QString k;
+            Entry entry;
+            stream >> k >> entry.expires >> entry.results;
+
+            if ( entry.expires < now )
+                continue;
+
+            // access times aren't saved, file order is as good as any
+            entry.used = ++clock;
+            resolverEntries.insert( k, entry );
+            count++;
+        }
+    }
+
+    if ( stream.status() != QDataStream::Ok )
+    {
+        tLog() << Q_FUNC_INFO << "Result cache is corrupt:" << path;
+        return false;
+    }
+
+    QMutexLocker lock( &m_mutex );
+    m_entries = entries;
+    m_count = count;
+    m_clock = clock;
+    if ( m_count > m_capacity )
+        prune( now );
+
+    tDebug() << Q_FUNC_INFO << "Loaded" << m_count << "cached results from" << path;
+    return true;
+}
+
+
+bool
+ResultCache::save( const QString& path ) const
+{
+    // write to a temporary file first, so a crash doesn't leave a truncated cache behind
+    QFile file( path + ".tmp" );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        tLog() << Q_FUNC_INFO << "Can't write result cache:" << path << file.errorString();
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_8 );
+    stream << (quint32)CACHE_FILE_MAGIC << (quint32)CACHE_FILE_VERSION;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    {
+        QMutexLocker lock( &m_mutex );
+
+        stream << (quint32)m_entries.count();
+        QHash< QString, QHash< QString, Entry > >::const_iterator rit = m_entries.constBegin();
+        for ( ; rit != m_entries.constEnd(); ++rit )
+        {
+            quint32 entryCount = 0;
+            foreach ( const Entry& entry, rit.value() )
+            {
+                if ( entry.expires >= now )
+                    entryCount++;
+            }
+
+            stream << rit.key() << entryCount;
+
+            QHash< QString, Entry >::const_iterator it = rit->constBegin();
+            for ( ; it != rit->constEnd(); ++it )
+            {
+                if ( it->expires >= now )
+                    stream << it.key() << it->expires << it->results;
+            }
+        }
+    }
+
+    file.close();
+    if ( file.error() != QFile::NoError )
+        return false;
+
+    QFile::remove( path );
+    return file.rename( path );
+}
@@ -0,0 +1,111 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include "DllMacro.h"
+#include "Typedefs.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+namespace Tomahawk
+{
+
+class Resolver;
+
+/**
+ * Remembers what each resolver reported for a track, so the Pipeline can
+ * answer queries it has already seen without asking the resolver again.
+ *
+ * Entries are keyed by resolver name plus the normalized artist, album and
+ * track (or the full text query) and expire after the resolver's
+ * resultCacheTtl(). "No results" are cached as well, for
+ * negativeResultCacheTtl(). Resolvers returning 0 for both aren't cached.
+ *
+ * When full, the least recently used entries are evicted first.
+ *
+ * Results are stored as plain data, so the cache can be saved to and
+ * restored from disk.
+ */
+class DLLEXPORT ResultCache
+{
+public:
+    struct Statistics
+    {
+        Statistics() : hits( 0 ), negativeHits( 0 ), misses( 0 ) {}
+
+        /// Lookups answered from the cache, including negative ones.
+        quint64 hits;
+        quint64 negativeHits;
+        quint64 misses;
+
+        double hitRate() const { return hits + misses ? (double)hits / ( hits + misses ) : 0.0; }
+    };
+
+    explicit ResultCache( int capacity = 50000 );
+    ~ResultCache();
+
+    static QString key( const query_ptr& query );
+
+    /**
+     * Returns true if the resolver's answer for this query is cached, the
+     * results list is then filled (and stays empty for a negative entry).
+     */
+    bool lookup( Resolver* resolver, const query_ptr& query, QList< result_ptr >& results );
+    void insert( Resolver* resolver, const query_ptr& query, const QList< result_ptr >& results );
+
+    /// Drop everything a resolver reported, e.g. after it got reconfigured.
+    void invalidate( const QString& resolverName );
+    void clear();
+
+    int count() const;
+    QStringList resolvers() const;
+    Statistics statistics( const QString& resolverName ) const;
+
+    /// Expired entries are skipped on load and on save.
+    bool load( const QString& path );
+    bool save( const QString& path ) const;
+
+private:
+    struct Entry
+    {
+        qint64 expires; // msecs since epoch
+        quint64 used; // m_clock at the last insert or hit
+        QVariantList results;
+    };
+
+    void prune( qint64 now );
+
+    mutable QMutex m_mutex;
+    QHash< QString, QHash< QString, Entry > > m_entries;
+    QHash< QString, Statistics > m_statistics;
+    int m_count;
+    int m_capacity;
+    quint64 m_clock;
+};
+
+}
+
+#endif // RESULTCACHE_H
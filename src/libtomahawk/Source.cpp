@@ -779,7 +779,8 @@ void
 Source::updateTracks()
 {
     {
-        DatabaseCommand* cmd = new DatabaseCommand_UpdateSearchIndex();
+        // AddFiles / DeleteFiles keep the index up to date, just make sure our part of it is complete
+        DatabaseCommand* cmd = new DatabaseCommand_UpdateSearchIndex( SourceList::instance()->get( id() ) );
         Database::instance()->enqueue( Tomahawk::dbcmd_ptr( cmd ) );
     }
 
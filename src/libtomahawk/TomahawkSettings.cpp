@@ -685,6 +685,13 @@ TomahawkSettings::doUpgrade( int oldVersion, int newVersion )
         Tomahawk::DatabaseFuzzyIndex::wipeIndex();
         updateIndex();
     }
+    else if ( oldVersion == 17 )
+    {
+        // Track and album ids are indexed now, so documents can be updated
+        // and removed one by one. Force a reindex.
+        Tomahawk::DatabaseFuzzyIndex::wipeIndex();
+        updateIndex();
+    }
 }
 
 
@@ -702,6 +709,20 @@ TomahawkSettings::acceptedLegalWarning() const
 }
 
 
+uint
+TomahawkSettings::backgroundResolveRate() const
+{
+    return value( "resolvers/background-rate", 50 ).toUInt();
+}
+
+
+void
+TomahawkSettings::setBackgroundResolveRate( uint queriesPerSecond )
+{
+    setValue( "resolvers/background-rate", queriesPerSecond );
+}
+
+
 void
 TomahawkSettings::setInfoSystemCacheVersion( uint version )
 {
@@ -1462,6 +1483,20 @@ TomahawkSettings::setExternalPort(int externalPort)
 }
 
 
+int
+TomahawkSettings::uploadRateLimit() const
+{
+    return value( "network/upload-rate-limit", 0 ).toInt();
+}
+
+
+void
+TomahawkSettings::setUploadRateLimit( int kbps )
+{
+    setValue( "network/upload-rate-limit", kbps );
+}
+
+
 QString
 TomahawkSettings::xmppBotServer() const
 {
@@ -31,7 +31,7 @@
 #include <QNetworkProxy>
 #include <QStringList>
 
-#define TOMAHAWK_SETTINGS_VERSION 17
+#define TOMAHAWK_SETTINGS_VERSION 18
 
 /**
  * Convenience wrapper around QSettings for tomahawk-specific config
@@ -77,6 +77,10 @@ public:
     bool acceptedLegalWarning() const;
     void setAcceptedLegalWarning( bool accept );
 
+    /// Queries per second each resolver gets from the background lane, 0 for unlimited
+    uint backgroundResolveRate() const;
+    void setBackgroundResolveRate( uint queriesPerSecond );
+
     /// UI settings
     QByteArray mainWindowGeometry() const;
     void setMainWindowGeometry( const QByteArray& geom );
@@ -173,6 +177,10 @@ public:
     int externalPort() const;
     void setExternalPort( int externalPort );
 
+    /// Upload limit for each stream to a peer in KB/s, 0 for unlimited
+    int uploadRateLimit() const;
+    void setUploadRateLimit( int kbps );
+
     QString proxyHost() const;
     void setProxyHost( const QString& host );
     QString proxyNoProxyHosts() const;
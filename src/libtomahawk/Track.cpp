@@ -679,6 +679,23 @@ Track::cover( const QSize& size, bool forceLoad ) const
 }
 
 
+QPixmap
+Track::thumbnail( const QSize& size, bool forceLoad ) const
+{
+    const QPixmap thumbnail = albumPtr()->thumbnail( size, forceLoad );
+    if ( albumPtr()->coverLoaded() )
+    {
+        // don't fall back to the artist while the album cover is still being scaled
+        if ( albumPtr()->hasCover() )
+            return thumbnail;
+
+        return artistPtr()->thumbnail( size, forceLoad );
+    }
+
+    return QPixmap();
+}
+
+
 bool
 Track::coverLoaded() const
 {
@@ -686,7 +703,7 @@ Track::coverLoaded() const
     if ( d->albumPtr.isNull() )
         return false;
 
-    if ( d->albumPtr->coverLoaded() && !d->albumPtr->cover( QSize( 0, 0 ) ).isNull() )
+    if ( d->albumPtr->coverLoaded() && d->albumPtr->hasCover() )
         return true;
 
     return d->artistPtr->coverLoaded();
@@ -89,6 +89,8 @@ public:
     Tomahawk::artist_ptr composerPtr() const;
 
     QPixmap cover( const QSize& size, bool forceLoad = true ) const;
+    /// The album's or else the artist's thumbnail, see Album::thumbnail().
+    QPixmap thumbnail( const QSize& size, bool forceLoad = true ) const;
     bool coverLoaded() const;
 
     void setLoved( bool loved, bool postToInfoSystem = true );
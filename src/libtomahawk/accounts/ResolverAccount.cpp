@@ -434,6 +434,9 @@ ResolverAccount::errorMessage() const
 void
 ResolverAccount::removeFromConfig()
 {
+    if ( !m_resolver.isNull() )
+        Pipeline::instance()->invalidateResultCache( m_resolver.data() );
+
     // TODO
     Account::removeFromConfig();
 }
@@ -443,8 +446,13 @@ void
 ResolverAccount::saveConfig()
 {
     Account::saveConfig();
-    if ( !m_resolver.isNull() )
-        m_resolver.data()->saveConfig();
+    if ( m_resolver.isNull() )
+        return;
+
+    m_resolver.data()->saveConfig();
+
+    // different credentials or settings may well give different results
+    Pipeline::instance()->invalidateResultCache( m_resolver.data() );
 }
 
 
@@ -619,6 +627,10 @@ AtticaResolverAccount::setPath( const QString& path )
     config[ "path" ] = path;
     setConfiguration( config );
 
+    // the new script doesn't have to agree with what the old one found
+    if ( !m_resolver.isNull() )
+        Pipeline::instance()->invalidateResultCache( m_resolver.data() );
+
     hookupResolver();
 
     sync();
@@ -23,12 +23,15 @@
 #include "utils/Logger.h"
 
 #include "DatabaseCommand.h"
+#include "DatabaseCommandQueue.h"
 #include "DatabaseImpl.h"
+#include "DatabaseStatistics.h"
 #include "DatabaseWorker.h"
 #include "IdThreadWorker.h"
 #include "PlaylistEntry.h"
 
 #include "DatabaseCommand_AddFiles.h"
+#include "DatabaseCommand_CompactPlaylistRevisions.h"
 #include "DatabaseCommand_CreatePlaylist.h"
 #include "DatabaseCommand_DeleteFiles.h"
 #include "DatabaseCommand_DeletePlaylist.h"
@@ -43,6 +46,8 @@
 #include "DatabaseCommand_SetCollectionAttributes.h"
 #include "DatabaseCommand_SetTrackAttributes.h"
 
+#include <QCoreApplication>
+
 // Forward Declarations breaking QSharedPointer
 #if QT_VERSION < QT_VERSION_CHECK( 5, 0, 0 )
     #include "collection/Collection.h"
@@ -90,6 +95,8 @@ Database::Database( const QString& dbname, QObject* parent )
     , m_impl( new DatabaseImpl( dbname ) )
     , m_workerRW( new DatabaseWorkerThread( this, true ) )
     , m_idWorker( new IdThreadWorker( this ) )
+    , m_readQueue( 0 )
+    , m_statistics( new DatabaseStatistics() )
 {
     s_instance = this;
 
@@ -115,6 +122,7 @@ Database::Database( const QString& dbname, QObject* parent )
         m_maxConcurrentThreads = qBound( DEFAULT_WORKER_THREADS, QThread::idealThreadCount(), MAX_WORKER_THREADS );
 
     tDebug() << Q_FUNC_INFO << "Using" << m_maxConcurrentThreads << "database worker threads";
+    m_readQueue = new DatabaseCommandQueue( m_maxConcurrentThreads );
 
     connect( m_impl, SIGNAL( indexReady() ), SLOT( markAsReady() ) );
     connect( m_impl, SIGNAL( indexStarted() ), SIGNAL( indexStarted() ) );
@@ -125,7 +133,7 @@ Database::Database( const QString& dbname, QObject* parent )
 
     while ( m_workerThreads.count() < m_maxConcurrentThreads )
     {
-        QPointer< DatabaseWorkerThread > workerThread( new DatabaseWorkerThread( this, false ) );
+        QPointer< DatabaseWorkerThread > workerThread( new DatabaseWorkerThread( this, false, m_readQueue ) );
         Q_ASSERT( workerThread );
         workerThread.data()->start();
         m_workerThreads << workerThread;
@@ -171,6 +179,12 @@ Database::~Database()
     }
     m_workerThreads.clear();
 
+    if ( qApp->arguments().contains( "--verbose" ) )
+        m_statistics->dump();
+
+    delete m_readQueue;
+    delete m_statistics;
+
     qDeleteAll( m_implHash.values() );
     qDeleteAll( m_commandFactories.values() );
     delete m_impl;
@@ -203,6 +217,8 @@ Database::enqueue( const QList< Tomahawk::dbcmd_ptr >& lc )
         {
             factory->notifyCreated( cmd );
         }
+
+        cmd->markEnqueued();
     }
 
     tDebug( LOGVERBOSE ) << "Enqueueing" << lc.count() << "commands to rw thread";
@@ -227,6 +243,8 @@ Database::enqueue( const Tomahawk::dbcmd_ptr& lc )
         factory->notifyCreated( lc );
     }
 
+    lc->markEnqueued();
+
     if ( lc->doesMutates() )
     {
         tDebug( LOGVERBOSE ) << "Enqueueing command to rw thread:" << lc->commandname();
@@ -235,50 +253,12 @@ Database::enqueue( const Tomahawk::dbcmd_ptr& lc )
     }
     else
     {
-        // find thread for commandname with lowest amount of outstanding jobs and enqueue job
-        int busyThreads = 0;
-        QPointer< DatabaseWorkerThread > workerThread;
-        QPointer< DatabaseWorker > happyWorker;
-        for ( int i = 0; i < m_workerThreads.count(); i++ )
-        {
-            workerThread = m_workerThreads.at( i );
-
-            if ( !workerThread || !workerThread->worker() )
-            {
-                // We have no valid worker for the current thread so skip it.
-                continue;
-            }
-
-            if ( !workerThread->worker()->busy() )
-            {
-                // Case 1: We have a workerThread with no outstanding jobs.
-                // As this is the optimal situation we do not need to look at
-                // the other workers.
-                happyWorker = workerThread->worker();
-                break;
-            }
-            else
-            {
-                busyThreads++;
-
-                if ( !happyWorker )
-                {
-                    // Case 2: We have not yet got a happyWorker but the current
-                    // workerThread has a worker so use it as a fallback.
-                    happyWorker = workerThread->worker();
-                }
-                else if ( workerThread->worker()->outstandingJobs() < happyWorker->outstandingJobs() )
-                {
-                    // Case 3: We have a worker and the current worker is less busy
-                    // than the previous minimum.
-                    happyWorker = workerThread->worker();
-                }
-            }
-        }
-
-        tDebug( LOGVERBOSE ) << "Enqueueing command to thread:" << happyWorker << busyThreads << lc->commandname();
-        Q_ASSERT( happyWorker );
-        happyWorker->enqueue( lc );
+        // Idle workers pick up commands from the shared queue on their own,
+        // we only need to wake one up if they've all gone to sleep.
+        DatabaseWorker* idleWorker = m_readQueue->enqueue( lc );
+        tDebug( LOGVERBOSE ) << "Enqueueing command to read queue:" << lc->commandname() << "waking worker:" << idleWorker;
+        if ( idleWorker )
+            QMetaObject::invokeMethod( idleWorker, "doQueuedWork", Qt::QueuedConnection );
     }
 }
 
@@ -317,6 +297,9 @@ Database::markAsReady()
 
     m_ready = true;
     emit ready();
+
+    // prune playlist histories that grew since the last start
+    enqueue( Tomahawk::dbcmd_ptr( new DatabaseCommand_CompactPlaylistRevisions() ) );
 }
 
 
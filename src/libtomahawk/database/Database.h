@@ -33,6 +33,8 @@ namespace Tomahawk
 
 class DatabaseImpl;
 class DatabaseCommand;
+class DatabaseCommandQueue;
+class DatabaseStatistics;
 class DatabaseWorkerThread;
 class DatabaseWorker;
 class IdThreadWorker;
@@ -70,7 +72,8 @@ protected:
     and provide an async api. You create a DatabaseCommand object, and add it to
     the queue of work. There is a threadpool responsible for exec'ing all
     the non-mutating (readonly) commands and one separate thread for mutating ones,
-    so sqlite doesn't write to the Database from multiple threads.
+    so sqlite doesn't write to the Database from multiple threads. The readonly
+    threads share one queue, where bulk commands can't starve the quick ones.
 */
 class DLLEXPORT Database : public QObject
 {
@@ -87,6 +90,9 @@ public:
 
     DatabaseImpl* impl();
 
+    /// Queue-wait and exec-time histograms for every kind of command run so far.
+    DatabaseStatistics* statistics() const { return m_statistics; }
+
     dbcmd_ptr createCommandInstance( const QVariant& op, const Tomahawk::source_ptr& source );
 
     // Template implementations need to stay in header!
@@ -132,6 +138,9 @@ private:
     IdThreadWorker* m_idWorker;
     int m_maxConcurrentThreads;
 
+    DatabaseCommandQueue* m_readQueue;
+    DatabaseStatistics* m_statistics;
+
     QHash< QString, DatabaseCommandFactory* > m_commandFactories;
     QHash< QString, QString> m_commandNameClassNameMapping;
 
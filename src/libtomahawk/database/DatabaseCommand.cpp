@@ -65,10 +65,42 @@ void
 DatabaseCommand::_exec( DatabaseImpl* lib )
 {
     Q_D( DatabaseCommand );
+    if ( d->enqueueTimer.isValid() )
+        d->queueTime = d->enqueueTimer.nsecsElapsed() / 1000;
+
+    QElapsedTimer timer;
+    timer.start();
+
     d->state = RUNNING;
     emitRunning();
     exec( lib );
     d->state = FINISHED;
+
+    d->execTime = timer.nsecsElapsed() / 1000;
+}
+
+
+void
+DatabaseCommand::markEnqueued()
+{
+    Q_D( DatabaseCommand );
+    d->enqueueTimer.start();
+}
+
+
+qint64
+DatabaseCommand::queueTime() const
+{
+    Q_D( const DatabaseCommand );
+    return d->queueTime;
+}
+
+
+qint64
+DatabaseCommand::execTime() const
+{
+    Q_D( const DatabaseCommand );
+    return d->execTime;
 }
 
 
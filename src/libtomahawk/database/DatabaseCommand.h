@@ -45,6 +45,11 @@ public:
         FINISHED = 2
     };
 
+    enum LatencyClass {
+        LatencySensitive = 0,
+        Bulk = 1
+    };
+
     explicit DatabaseCommand( QObject* parent = nullptr );
     explicit DatabaseCommand( const Tomahawk::source_ptr& src, QObject* parent = nullptr );
 
@@ -56,6 +61,15 @@ public:
     virtual bool doesMutates() const { return true; }
     State state() const;
 
+    // read-only commands that may take long (e.g. listing a whole collection)
+    // should be Bulk, so they don't hold up the quick ones queued behind them.
+    virtual LatencyClass latencyClass() const { return LatencySensitive; }
+
+    // timing in microseconds, as measured by the Database workers
+    void markEnqueued();
+    qint64 queueTime() const;
+    qint64 execTime() const;
+
     // if i make this pure virtual, i get compile errors in qmetatype.h.
     // we need Q_DECLARE_METATYPE to use in queued sig/slot connections.
     virtual void exec( DatabaseImpl* /*lib*/ ) { Q_ASSERT( false ); }
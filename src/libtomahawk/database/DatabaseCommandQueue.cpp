@@ -0,0 +1,116 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseCommandQueue.h"
+
+#include "utils/Logger.h"
+
+namespace Tomahawk
+{
+
+DatabaseCommandQueue::DatabaseCommandQueue( int workerCount )
+    : m_maxBulk( qMax( 1, workerCount - 1 ) )
+    , m_runningBulk( 0 )
+{
+}
+
+
+DatabaseCommandQueue::~DatabaseCommandQueue()
+{
+    if ( !m_latencySensitive.isEmpty() || !m_bulk.isEmpty() )
+        tDebug() << Q_FUNC_INFO << "Dropping" << m_latencySensitive.count() + m_bulk.count() << "outstanding db commands";
+}
+
+
+DatabaseWorker*
+DatabaseCommandQueue::enqueue( const Tomahawk::dbcmd_ptr& cmd )
+{
+    QMutexLocker lock( &m_mutex );
+
+    if ( cmd->latencyClass() == DatabaseCommand::Bulk )
+    {
+        m_bulk.enqueue( cmd );
+        if ( m_runningBulk >= m_maxBulk )
+            return 0;
+    }
+    else
+        m_latencySensitive.enqueue( cmd );
+
+    if ( m_idleWorkers.isEmpty() )
+        return 0;
+
+    return m_idleWorkers.takeLast();
+}
+
+
+Tomahawk::dbcmd_ptr
+DatabaseCommandQueue::take( DatabaseWorker* worker )
+{
+    QMutexLocker lock( &m_mutex );
+
+    if ( !m_latencySensitive.isEmpty() )
+        return m_latencySensitive.dequeue();
+
+    if ( !m_bulk.isEmpty() && m_runningBulk < m_maxBulk )
+    {
+        m_runningBulk++;
+        return m_bulk.dequeue();
+    }
+
+    if ( !m_idleWorkers.contains( worker ) )
+        m_idleWorkers << worker;
+
+    return Tomahawk::dbcmd_ptr();
+}
+
+
+void
+DatabaseCommandQueue::finished( const Tomahawk::dbcmd_ptr& cmd )
+{
+    if ( cmd->latencyClass() != DatabaseCommand::Bulk )
+        return;
+
+    QMutexLocker lock( &m_mutex );
+    m_runningBulk--;
+}
+
+
+void
+DatabaseCommandQueue::removeWorker( DatabaseWorker* worker )
+{
+    QMutexLocker lock( &m_mutex );
+    m_idleWorkers.removeAll( worker );
+}
+
+
+int
+DatabaseCommandQueue::pendingCount( DatabaseCommand::LatencyClass latencyClass ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return latencyClass == DatabaseCommand::Bulk ? m_bulk.count() : m_latencySensitive.count();
+}
+
+
+int
+DatabaseCommandQueue::runningBulkCount() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_runningBulk;
+}
+
+}
@@ -0,0 +1,85 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DATABASECOMMANDQUEUE_H
+#define DATABASECOMMANDQUEUE_H
+
+#include "DatabaseCommand.h"
+#include "Typedefs.h"
+
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+
+namespace Tomahawk
+{
+
+class DatabaseWorker;
+
+/**
+ * Shared queue for the read-only database workers. Instead of binding a
+ * command to a worker when it is enqueued, workers take the next command
+ * whenever they are done with the previous one, so a long running command
+ * never holds up anything queued behind it while another worker is idle.
+ *
+ * Latency sensitive commands always go first. Bulk commands never occupy
+ * more than all but one of the workers, so there is always one worker left
+ * to pick up latency sensitive work.
+ */
+class DatabaseCommandQueue
+{
+public:
+    explicit DatabaseCommandQueue( int workerCount );
+    ~DatabaseCommandQueue();
+
+    /**
+     * Adds a command to the queue. Returns an idle worker that should be
+     * woken up to process it, or 0 if the command has to wait.
+     */
+    DatabaseWorker* enqueue( const Tomahawk::dbcmd_ptr& cmd );
+
+    /**
+     * Takes the next command for the given worker. If there is nothing it is
+     * allowed to run right now, the worker is marked idle and will be handed
+     * out by enqueue() again later.
+     */
+    Tomahawk::dbcmd_ptr take( DatabaseWorker* worker );
+
+    /// Has to be called once a command returned by take() has been run.
+    void finished( const Tomahawk::dbcmd_ptr& cmd );
+
+    void removeWorker( DatabaseWorker* worker );
+
+    int pendingCount( DatabaseCommand::LatencyClass latencyClass ) const;
+    int runningBulkCount() const;
+
+private:
+    mutable QMutex m_mutex;
+
+    QQueue< Tomahawk::dbcmd_ptr > m_latencySensitive;
+    QQueue< Tomahawk::dbcmd_ptr > m_bulk;
+    QList< DatabaseWorker* > m_idleWorkers;
+
+    int m_maxBulk;
+    int m_runningBulk;
+};
+
+}
+
+#endif // DATABASECOMMANDQUEUE_H
@@ -29,8 +29,14 @@
 #include "DatabaseImpl.h"
 #include "PlaylistEntry.h"
 #include "SourceList.h"
+#include "fuzzyindex/DatabaseFuzzyIndex.h"
 
 #include <QSqlQuery>
+#include <QTime>
+
+// Rows per multi-row INSERT. Keeps us below SQLite's default limit of 999
+// bound parameters for all tables we insert into.
+#define ROWS_PER_INSERT 100
 
 using namespace Tomahawk;
 
@@ -40,12 +46,11 @@ QVariantList
 DatabaseCommand_AddFiles::files() const
 {
     QVariantList list;
-    foreach ( const QVariant& v, m_files )
+    foreach ( const ScannedFile& file, m_files )
     {
         // replace url with the id, we don't leak file paths over the network.
-        QVariantMap m = v.toMap();
-        m.remove( "url" );
-        m.insert( "url", QString::number( m.value( "id" ).toInt() ) );
+        QVariantMap m = file.toVariant();
+        m.insert( "url", QString::number( file.id ) );
         list.append( m );
     }
     return list;
@@ -65,114 +70,276 @@ DatabaseCommand_AddFiles::postCommitHook()
 
     emit notify( m_ids );
 
+    // only now that the files are committed, otherwise a rollback would leave
+    // documents pointing nowhere in the index
+    DatabaseImpl* dbi = Database::instance()->impl();
+    if ( dbi->m_fuzzyIndex )
+        dbi->m_fuzzyIndex->updateDocuments( m_indexData );
+    m_indexData.clear();
+
     if ( source()->isLocal() )
         Servent::instance()->triggerDBSync();
 }
 
 
+namespace
+{
+
+// "INSERT INTO table(a, b) VALUES (?, ?), (?, ?), ..." for the given amount of rows
+QString
+multiRowInsert( const QString& table, const QStringList& columns, int rows )
+{
+    QStringList placeholders;
+    for ( int i = 0; i < columns.count(); i++ )
+        placeholders << "?";
+
+    const QString row = QString( "(%1)" ).arg( placeholders.join( ", " ) );
+
+    QStringList values;
+    for ( int i = 0; i < rows; i++ )
+        values << row;
+
+    return QString( "INSERT INTO %1(%2) VALUES %3" ).arg( table ).arg( columns.join( ", " ) ).arg( values.join( ", " ) );
+}
+
+
+/*
+ * Inserts rows in batches of ROWS_PER_INSERT with reused prepared statements.
+ * If a batch fails (e.g. because one of its rows violates a constraint), its
+ * rows are retried one by one so only the offending rows are skipped.
+ * Returns the indexes of the rows that could not be inserted.
+ */
+QSet< int >
+bulkInsert( DatabaseImpl* dbi, const QString& table, const QStringList& columns, const QList< QVariantList >& rows )
+{
+    QSet< int > failed;
+    if ( rows.isEmpty() )
+        return failed;
+
+    TomahawkSqlQuery batchQuery = dbi->newquery();
+    TomahawkSqlQuery tailQuery = dbi->newquery();
+    TomahawkSqlQuery singleQuery = dbi->newquery();
+    batchQuery.prepare( multiRowInsert( table, columns, ROWS_PER_INSERT ) );
+    singleQuery.prepare( multiRowInsert( table, columns, 1 ) );
+
+    const int tail = rows.count() % ROWS_PER_INSERT;
+    if ( tail )
+        tailQuery.prepare( multiRowInsert( table, columns, tail ) );
+
+    for ( int offset = 0; offset < rows.count(); offset += ROWS_PER_INSERT )
+    {
+        const int count = qMin( ROWS_PER_INSERT, rows.count() - offset );
+        TomahawkSqlQuery& query = count == ROWS_PER_INSERT ? batchQuery : tailQuery;
+
+        int pos = 0;
+        for ( int i = offset; i < offset + count; i++ )
+        {
+            foreach ( const QVariant& value, rows.at( i ) )
+                query.bindValue( pos++, value );
+        }
+
+        if ( query.exec() )
+            continue;
+
+        tDebug() << "Bulk insert into" << table << "failed, falling back to single rows";
+        for ( int i = offset; i < offset + count; i++ )
+        {
+            pos = 0;
+            foreach ( const QVariant& value, rows.at( i ) )
+                singleQuery.bindValue( pos++, value );
+
+            if ( !singleQuery.exec() )
+            {
+                tDebug() << "Error inserting into" << table << "table";
+                failed << i;
+            }
+        }
+    }
+
+    return failed;
+}
+
+
+/*
+ * The next id AUTOINCREMENT would hand out for table, i.e. above every id that
+ * was ever used, not just the ones still around. Peers and the oplog refer to
+ * files by id, so ids of deleted files must never come back.
+ */
+int
+nextAutoIncrementId( DatabaseImpl* dbi, const QString& table )
+{
+    TomahawkSqlQuery query = dbi->newquery();
+    query.prepare( "SELECT seq FROM sqlite_sequence WHERE name = ?" );
+    query.bindValue( 0, table );
+    query.exec();
+    int id = query.next() ? query.value( 0 ).toInt() : 0;
+
+    query.exec( QString( "SELECT MAX(id) FROM %1" ).arg( table ) );
+    if ( query.next() )
+        id = qMax( id, query.value( 0 ).toInt() );
+
+    return id + 1;
+}
+
+
+// Raise the sequence in the same transaction, SQLite does that for explicit ids as well but let's not rely on it
+void
+reserveAutoIncrementIds( DatabaseImpl* dbi, const QString& table, int lastId )
+{
+    TomahawkSqlQuery query = dbi->newquery();
+    query.prepare( "UPDATE sqlite_sequence SET seq = ? WHERE name = ? AND seq < ?" );
+    query.bindValue( 0, lastId );
+    query.bindValue( 1, table );
+    query.bindValue( 2, lastId );
+    query.exec();
+}
+
+}
+
+
 void
 DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
 {
     qDebug() << Q_FUNC_INFO;
     Q_ASSERT( !source().isNull() );
 
-    TomahawkSqlQuery query_file = dbi->newquery();
-    TomahawkSqlQuery query_filejoin = dbi->newquery();
-    TomahawkSqlQuery query_trackattr = dbi->newquery();
-
-    query_file.prepare( "INSERT INTO file(source, url, size, mtime, md5, mimetype, duration, bitrate) VALUES (?, ?, ?, ?, ?, ?, ?, ?)" );
-    query_filejoin.prepare( "INSERT INTO file_join(file, artist, album, track, albumpos, composer, discnumber) VALUES (?, ?, ?, ?, ?, ?, ?)" );
-    query_trackattr.prepare( "INSERT INTO track_attributes(id, k, v) VALUES (?, ?, ?)" );
+    QTime t;
+    t.start();
 
-    int added = 0;
-    QVariant srcid = source()->isLocal() ? QVariant( QVariant::Int ) : source()->id();
+    const QVariant srcid = source()->isLocal() ? QVariant( QVariant::Int ) : source()->id();
     qDebug() << "Adding" << m_files.length() << "files to db for source" << srcid;
 
-    QList<QVariant>::iterator it;
-    for ( it = m_files.begin(); it != m_files.end(); ++it )
+    // We are the only writer and run inside a transaction, so we can hand out
+    // the file ids ourselves, the way AUTOINCREMENT would.
+    const int firstFileId = nextAutoIncrementId( dbi, "file" );
+
+    QList< QVariantList > fileRows;
+    fileRows.reserve( m_files.count() );
+
+    for ( int i = 0; i < m_files.count(); i++ )
+    {
+        ScannedFile& file = m_files[ i ];
+        file.id = firstFileId + i;
+
+        fileRows << ( QVariantList() << file.id << srcid << file.url << file.size << file.mtime
+                                     << file.hash << file.mimetype << file.duration << file.bitrate );
+    }
+
+    const QSet< int > failedFiles = bulkInsert( dbi, "file",
+                                                QStringList() << "id" << "source" << "url" << "size" << "mtime" << "md5" << "mimetype" << "duration" << "bitrate",
+                                                fileRows );
+    fileRows.clear();
+    if ( !m_files.isEmpty() )
+        reserveAutoIncrementIds( dbi, "file", firstFileId + m_files.count() - 1 );
+
+    QList< QVariantList > joinRows;
+    QList< QVariantList > attributeRows;
+    QList< unsigned int > joinFileIds;
+    QList< IndexData > indexData;
+
+    for ( int i = 0; i < m_files.count(); i++ )
     {
-        QVariant& v = *it;
-        QVariantMap m = v.toMap();
-
-        int fileid = 0, artistid = 0, albumartistid = 0, albumid = 0, trackid = 0, composerid = 0;
-
-        const QString url         = m.value( "url" ).toString();
-        const int mtime           = m.value( "mtime" ).toInt();
-        const uint size           = m.value( "size" ).toUInt();
-        const QString hash        = m.value( "hash" ).toString();
-        const QString mimetype    = m.value( "mimetype" ).toString();
-        const uint duration       = m.value( "duration" ).toUInt();
-        const uint bitrate        = m.value( "bitrate" ).toUInt();
-        const QString artist      = m.value( "artist" ).toString();
-        const QString albumartist = m.value( "albumartist" ).toString();
-        const QString album       = m.value( "album" ).toString();
-        const QString track       = m.value( "track" ).toString();
-        const uint albumpos       = m.value( "albumpos" ).toUInt();
-        const QString composer    = m.value( "composer" ).toString();
-        const uint discnumber     = m.value( "discnumber" ).toUInt();
-        const int year            = m.value( "year" ).toInt();
-
-        query_file.bindValue( 0, srcid );
-        query_file.bindValue( 1, url );
-        query_file.bindValue( 2, size );
-        query_file.bindValue( 3, mtime );
-        query_file.bindValue( 4, hash );
-        query_file.bindValue( 5, mimetype );
-        query_file.bindValue( 6, duration );
-        query_file.bindValue( 7, bitrate );
-        query_file.exec();
-
-        if ( added % 1000 == 0 )
-            qDebug() << "Inserted" << added;
-
-        // get internal IDs for art/alb/trk
-        fileid = query_file.lastInsertId().toInt();
-        m.insert( "id", fileid );
-        // this is the qvariant(map) the remote will get
-        v = m;
+        ScannedFile& file = m_files[ i ];
+        if ( failedFiles.contains( i ) )
+        {
+            file.id = 0;
+            continue;
+        }
+
+        int artistid = 0, albumartistid = 0, albumid = 0, trackid = 0, composerid = 0;
 
         // add the album artist to the artist database.
-        if ( !albumartist.trimmed().isEmpty() )
-            albumartistid = dbi->artistId( albumartist, true );
-        
-        if ( !artist.trimmed().isEmpty() )
-            artistid = dbi->artistId( artist, true );
+        if ( !file.albumartist.isEmpty() )
+            albumartistid = dbi->artistId( file.albumartist, true );
+
+        if ( !file.artist.isEmpty() )
+            artistid = dbi->artistId( file.artist, true );
         if ( artistid < 1 )
             continue;
-        trackid = dbi->trackId( artistid, track, true );
+        trackid = dbi->trackId( artistid, file.track, true );
         if ( trackid < 1 )
             continue;
         // If there's an album artist, use it. Otherwise use the track artist
-        albumid = dbi->albumId( albumartistid > 0 ? albumartistid : artistid, album, true );
+        albumid = dbi->albumId( albumartistid > 0 ? albumartistid : artistid, file.album, true );
 
-        if ( !composer.trimmed().isEmpty() )
-            composerid = dbi->artistId( composer, true );
+        if ( !file.composer.isEmpty() )
+            composerid = dbi->artistId( file.composer, true );
 
         // Now add the association
-        query_filejoin.bindValue( 0, fileid );
-        query_filejoin.bindValue( 1, artistid );
-        query_filejoin.bindValue( 2, albumid > 0 ? albumid : QVariant( QVariant::Int ) );
-        query_filejoin.bindValue( 3, trackid );
-        query_filejoin.bindValue( 4, albumpos );
-        query_filejoin.bindValue( 5, composerid > 0 ? composerid : QVariant( QVariant::Int ) );
-        query_filejoin.bindValue( 6, discnumber );
-        if ( !query_filejoin.exec() )
-        {
-            qDebug() << "Error inserting into file_join table";
+        joinRows << ( QVariantList() << file.id << artistid
+                                     << ( albumid > 0 ? albumid : QVariant( QVariant::Int ) )
+                                     << trackid << file.albumpos
+                                     << ( composerid > 0 ? composerid : QVariant( QVariant::Int ) )
+                                     << file.discnumber );
+        attributeRows << ( QVariantList() << trackid << "releaseyear" << file.year );
+        joinFileIds << file.id;
+
+        IndexData ida;
+        ida.id = trackid;
+        ida.artistId = artistid;
+        ida.artist = file.artist;
+        ida.track = file.track;
+        ida.album = file.album;
+        indexData << ida;
+    }
+
+    const QSet< int > failedJoins = bulkInsert( dbi, "file_join",
+                                                QStringList() << "file" << "artist" << "album" << "track" << "albumpos" << "composer" << "discnumber",
+                                                joinRows );
+
+    // Every track and album we touched gets (re-)indexed once the transaction
+    // is committed. Tracks that lost all their files may have been dropped
+    // from the index, so this isn't limited to newly created ids.
+    QSet< unsigned int > indexedTracks;
+    QSet< unsigned int > indexedAlbums;
+
+    QList< QVariantList > addedAttributeRows;
+    for ( int i = 0; i < joinFileIds.count(); i++ )
+    {
+        if ( failedJoins.contains( i ) )
             continue;
+
+        m_ids << joinFileIds.at( i );
+        addedAttributeRows << attributeRows.at( i );
+
+        const IndexData& ida = indexData.at( i );
+        if ( !indexedTracks.contains( ida.id ) )
+        {
+            indexedTracks << ida.id;
+
+            IndexData track = ida;
+            track.album.clear();
+            m_indexData << track;
         }
 
-        query_trackattr.bindValue( 0, trackid );
-        query_trackattr.bindValue( 1, "releaseyear" );
-        query_trackattr.bindValue( 2, year );
-        query_trackattr.exec();
+        const unsigned int albumid = joinRows.at( i ).at( 2 ).toUInt();
+        if ( albumid > 0 && !ida.album.isEmpty() && !indexedAlbums.contains( albumid ) )
+        {
+            indexedAlbums << albumid;
 
-        m_ids << fileid;
-        added++;
+            IndexData album;
+            album.id = albumid;
+            album.artistId = 0;
+            album.album = ida.album;
+            m_indexData << album;
+        }
     }
 
-    qDebug() << "Inserted" << added << "tracks to database";
+    bulkInsert( dbi, "track_attributes", QStringList() << "id" << "k" << "v", addedAttributeRows );
+
+    const int added = m_ids.count();
+    const int elapsed = qMax( 1, t.elapsed() );
+    qDebug() << "Inserted" << added << "tracks to database in" << elapsed << "ms," << added * 1000 / elapsed << "rows/sec";
+
     tDebug() << "Committing" << added << "tracks...";
 
-    emit done( m_files, source()->dbCollection() );
+    if ( receivers( SIGNAL( done( QList<QVariant>, Tomahawk::collection_ptr ) ) ) > 0 )
+    {
+        QVariantList files;
+        foreach ( const ScannedFile& file, m_files )
+            files << file.toVariant();
+
+        emit done( files, source()->dbCollection() );
+    }
 }
+
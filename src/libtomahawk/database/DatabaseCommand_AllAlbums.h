@@ -55,6 +55,7 @@ public:
 
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "allalbums"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
     virtual void enqueue() { Database::instance()->enqueue( Tomahawk::dbcmd_ptr( this ) ); }
 
@@ -53,6 +53,7 @@ public:
 
     bool doesMutates() const Q_DECL_OVERRIDE { return false; }
     QString commandname() const Q_DECL_OVERRIDE { return "allartists"; }
+    LatencyClass latencyClass() const Q_DECL_OVERRIDE { return Bulk; }
 
     void enqueue() Q_DECL_OVERRIDE { Database::instance()->enqueue( Tomahawk::dbcmd_ptr( this ) ); }
 
@@ -62,6 +62,7 @@ public:
 
     bool doesMutates() const override { return false; }
     QString commandname() const override { return "alltracks"; }
+    LatencyClass latencyClass() const override { return Bulk; }
 
     void enqueue() override { Database::instance()->enqueue( Tomahawk::dbcmd_ptr( this ) ); }
 
@@ -42,6 +42,7 @@ public:
 
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "calculateplaytime"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
 
 signals:
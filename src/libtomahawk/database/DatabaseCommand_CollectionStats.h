@@ -38,6 +38,7 @@ public:
     virtual void exec( DatabaseImpl* lib );
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "collectionstats"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
 signals:
     void done( const QVariantMap& );
@@ -0,0 +1,61 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "DatabaseCommand_CompactPlaylistRevisions.h"
+
+#include "utils/Logger.h"
+
+#include "DatabaseImpl.h"
+#include "PlaylistRevisionStore.h"
+#include "TomahawkSqlQuery.h"
+
+#include <QTime>
+
+// revisions kept per playlist, enough to diff recent changes
+#define KEEP_REVISIONS 20
+
+namespace Tomahawk
+{
+
+DatabaseCommand_CompactPlaylistRevisions::DatabaseCommand_CompactPlaylistRevisions( QObject* parent )
+    : DatabaseCommand( parent )
+{
+}
+
+
+void
+DatabaseCommand_CompactPlaylistRevisions::exec( DatabaseImpl* lib )
+{
+    QTime t;
+    t.start();
+
+    QStringList playlists;
+    TomahawkSqlQuery query = lib->newquery();
+    query.exec( QString( "SELECT playlist FROM playlist_revision GROUP BY playlist HAVING COUNT(*) > %1" ).arg( KEEP_REVISIONS ) );
+    while ( query.next() )
+        playlists << query.value( 0 ).toString();
+
+    int deleted = 0;
+    foreach ( const QString& playlist, playlists )
+        deleted += lib->playlistRevisions()->compact( lib, playlist, KEEP_REVISIONS );
+
+    tLog( LOGVERBOSE ) << Q_FUNC_INFO << "Deleted" << deleted << "revisions of" << playlists.count() << "playlists in" << t.elapsed() << "ms";
+}
+
+}
@@ -0,0 +1,46 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DATABASECOMMAND_COMPACTPLAYLISTREVISIONS_H
+#define DATABASECOMMAND_COMPACTPLAYLISTREVISIONS_H
+
+#include "DatabaseCommand.h"
+#include "DllMacro.h"
+
+namespace Tomahawk
+{
+
+/**
+ * Prunes the revision history of all playlists down to the latest revisions
+ * of their current revision chain. Runs once the database is ready.
+ */
+class DLLEXPORT DatabaseCommand_CompactPlaylistRevisions : public DatabaseCommand
+{
+Q_OBJECT
+public:
+    explicit DatabaseCommand_CompactPlaylistRevisions( QObject* parent = 0 );
+
+    virtual QString commandname() const { return "compactplaylistrevisions"; }
+    virtual bool doesMutates() const { return true; }
+    virtual void exec( DatabaseImpl* lib );
+};
+
+}
+
+#endif // DATABASECOMMAND_COMPACTPLAYLISTREVISIONS_H
@@ -24,6 +24,7 @@
 #include "collection/Collection.h"
 #include "database/Database.h"
 #include "database/DatabaseImpl.h"
+#include "database/fuzzyindex/DatabaseFuzzyIndex.h"
 #include "network/Servent.h"
 #include "utils/Logger.h"
 #include "utils/TomahawkUtils.h"
@@ -33,9 +34,42 @@
 #include "PlaylistEntry.h"
 #include "Source.h"
 
+// Max ids per "IN ( ... )" clause
+#define IDS_PER_STATEMENT 500
+
 using namespace Tomahawk;
 
 
+namespace
+{
+
+// Runs query (containing a %1 placeholder for an id list) for ids in chunks and collects the first column
+QSet< unsigned int >
+selectIds( DatabaseImpl* dbi, const QString& query, const QList< unsigned int >& ids )
+{
+    QSet< unsigned int > result;
+
+    for ( int offset = 0; offset < ids.count(); offset += IDS_PER_STATEMENT )
+    {
+        QStringList idList;
+        foreach ( unsigned int id, ids.mid( offset, IDS_PER_STATEMENT ) )
+            idList << QString::number( id );
+
+        TomahawkSqlQuery q = dbi->newquery();
+        q.exec( query.arg( idList.join( ", " ) ) );
+        while ( q.next() )
+        {
+            if ( !q.value( 0 ).isNull() )
+                result << q.value( 0 ).toUInt();
+        }
+    }
+
+    return result;
+}
+
+}
+
+
 // After changing a collection, we need to tell other bits of the system:
 void
 DatabaseCommand_DeleteFiles::postCommitHook()
@@ -53,6 +87,10 @@ DatabaseCommand_DeleteFiles::postCommitHook()
     tDebug() << "Notifying of deleted tracks:" << m_idList.size() << "from source" << source()->id();
     emit notify( m_idList );
 
+    DatabaseImpl* dbi = Database::instance()->impl();
+    if ( dbi->m_fuzzyIndex )
+        dbi->m_fuzzyIndex->removeDocuments( m_orphanedTracks, m_orphanedAlbums );
+
     if ( source()->isLocal() )
         Servent::instance()->triggerDBSync();
 }
@@ -102,6 +140,8 @@ DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
 
     if ( m_deleteAll )
     {
+        collectOrphanCandidates( dbi );
+
         delquery.prepare( QString( "DELETE FROM file WHERE source %1" )
                     .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) ) );
         delquery.exec();
@@ -129,6 +169,8 @@ DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
             idstring.chop( 2 ); //remove the trailing ", "
         }
 
+        collectOrphanCandidates( dbi );
+
         delquery.prepare( QString( "DELETE FROM file WHERE source %1 AND id IN ( %2 )" )
                              .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) )
                              .arg( idstring ) );
@@ -136,7 +178,25 @@ DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
     }
 
     if ( !m_idList.isEmpty() )
+    {
+        // the tracks and albums we were the last file of drop out of the fuzzy index
+        const QSet< unsigned int > tracks = selectIds( dbi, "SELECT DISTINCT track FROM file_join WHERE track IN ( %1 )", m_orphanedTracks );
+        const QSet< unsigned int > albums = selectIds( dbi, "SELECT DISTINCT album FROM file_join WHERE album IN ( %1 )", m_orphanedAlbums );
+        m_orphanedTracks = ( m_orphanedTracks.toSet() - tracks ).toList();
+        m_orphanedAlbums = ( m_orphanedAlbums.toSet() - albums ).toList();
+
         source()->updateIndexWhenSynced();
+    }
 
     emit done( m_idList, source()->dbCollection() );
 }
+
+
+void
+DatabaseCommand_DeleteFiles::collectOrphanCandidates( DatabaseImpl* dbi )
+{
+    // remember which tracks and albums the doomed files belong to, whatever
+    // has no files left once they are gone gets removed from the index
+    m_orphanedTracks = selectIds( dbi, "SELECT DISTINCT track FROM file_join WHERE file IN ( %1 )", m_idList ).toList();
+    m_orphanedAlbums = selectIds( dbi, "SELECT DISTINCT album FROM file_join WHERE file IN ( %1 )", m_idList ).toList();
+}
@@ -81,10 +81,16 @@ signals:
     void notify( const QList<unsigned int>& ids );
 
 private:
+    void collectOrphanCandidates( DatabaseImpl* dbi );
+
     QDir m_dir;
     QVariantList m_ids;
     QList<unsigned int> m_idList;
     bool m_deleteAll;
+
+    // tracks and albums without any files left, to be removed from the fuzzy index
+    QList<unsigned int> m_orphanedTracks;
+    QList<unsigned int> m_orphanedAlbums;
 };
 
 }
@@ -55,6 +55,7 @@ public:
     virtual void exec( DatabaseImpl* );
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "filemtimes"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
 signals:
     void done( const QMap< QString, QMap< unsigned int, unsigned int > >& );
@@ -24,6 +24,7 @@
 #include "DatabaseImpl.h"
 #include "Playlist.h"
 #include "PlaylistEntry.h"
+#include "PlaylistRevisionStore.h"
 #include "Source.h"
 
 #include <QSqlQuery>
@@ -100,8 +101,12 @@ DatabaseCommand_LoadAllPlaylists::exec( DatabaseImpl* dbi )
 
         if ( d->returnPlEntryIds )
         {
-            QStringList trackIds = TomahawkUtils::parseJson( query.value( 8 ).toByteArray() ).toStringList();
-            phash.insert( p, trackIds );
+            // snapshots can be used as they are, deltas need their previous revisions
+            const QVariant entries = TomahawkUtils::parseJson( query.value( 8 ).toByteArray() );
+            if ( entries.type() == QVariant::Map )
+                phash.insert( p, dbi->playlistRevisions()->entries( dbi, query.value( 6 ).toString() ) );
+            else
+                phash.insert( p, entries.toStringList() );
         }
     }
 
@@ -21,6 +21,8 @@
 #include "DatabaseImpl.h"
 #include "TomahawkSqlQuery.h"
 #include "Source.h"
+#include "network/DbOpCodec.h"
+#include "utils/Json.h"
 #include "utils/Logger.h"
 
 namespace Tomahawk
@@ -53,8 +55,9 @@ DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
                    "FROM oplog "
                    "WHERE source %1 "
                    "AND id > coalesce((SELECT id FROM oplog WHERE guid = ?),0) "
-                   "ORDER BY id ASC"
+                   "ORDER BY id ASC %2"
                    ).arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) )
+                    .arg( m_limit > 0 ? QString( "LIMIT %1" ).arg( m_limit ) : QString() )
                   );
     query.addBindValue( m_since );
     query.exec();
@@ -68,6 +71,20 @@ DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
         op->payload = query.value( 2 ).toByteArray();
         op->compressed = query.value( 3 ).toBool();
         op->singleton = query.value( 4 ).toBool();
+        op->binary = false;
+
+        if ( m_binary )
+        {
+            // done here on the db thread, so the connection doesn't have to
+            bool ok;
+            const QVariant json = TomahawkUtils::parseJson( op->compressed ? qUncompress( op->payload ) : op->payload, &ok );
+            if ( ok )
+            {
+                op->payload = DbOpCodec::encode( json );
+                op->compressed = false;
+                op->binary = true;
+            }
+        }
 
         lastguid = op->guid;
         ops << op;
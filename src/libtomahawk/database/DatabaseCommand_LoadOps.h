@@ -34,20 +34,31 @@ class DLLEXPORT DatabaseCommand_loadOps : public DatabaseCommand
 Q_OBJECT
 public:
     explicit DatabaseCommand_loadOps( const Tomahawk::source_ptr& src, QString since, QObject* parent = 0 )
-        : DatabaseCommand( src ), m_since( since )
+        : DatabaseCommand( src ), m_since( since ), m_limit( 0 ), m_binary( false )
     {
         Q_UNUSED( parent );
     }
 
+    /// Load at most limit ops, 0 loads everything since the given guid.
+    void setLimit( int limit ) { m_limit = limit; }
+    int limit() const { return m_limit; }
+
+    /// Convert the ops' payloads to DbOpCodec's binary encoding for peers that support it.
+    void setBinary( bool binary ) { m_binary = binary; }
+    bool binary() const { return m_binary; }
+
     virtual void exec( DatabaseImpl* db );
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "loadops"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
 signals:
     void done( QString sinceguid, QString lastguid, QList< dbop_ptr > ops );
 
 private:
     QString m_since; // guid to load from
+    int m_limit;
+    bool m_binary;
 };
 
 }
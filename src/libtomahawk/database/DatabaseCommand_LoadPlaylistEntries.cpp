@@ -18,11 +18,11 @@
 
 #include "DatabaseCommand_LoadPlaylistEntries.h"
 
-#include "utils/Json.h"
 #include "utils/Logger.h"
 
 #include "DatabaseImpl.h"
 #include "PlaylistEntry.h"
+#include "PlaylistRevisionStore.h"
 #include "Query.h"
 #include "Source.h"
 
@@ -44,7 +44,7 @@ void
 DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query_entries = dbi->newquery();
-    query_entries.prepare( "SELECT entries, playlist, author, timestamp, previous_revision "
+    query_entries.prepare( "SELECT entries IS NULL, playlist, author, timestamp, previous_revision "
                            "FROM playlist_revision "
                            "WHERE guid = :guid" );
     query_entries.bindValue( ":guid", m_revguid );
@@ -52,17 +52,13 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
 
     tLog( LOGVERBOSE ) << "trying to load playlist entries for guid:" << m_revguid;
     QString prevrev;
-    bool ok;
 
     if ( query_entries.next() )
     {
-        if ( !query_entries.value( 0 ).isNull() )
+        if ( !query_entries.value( 0 ).toBool() )
         {
-            // entries should be a list of strings:
-            QVariant v = TomahawkUtils::parseJson( query_entries.value( 0 ).toByteArray(), &ok );
-            Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-
-            m_guids = v.toStringList();
+            // entries are stored as deltas, the store puts them back together
+            m_guids = dbi->playlistRevisions()->entries( dbi, m_revguid );
             QString inclause = QString( "('%1')" ).arg( m_guids.join( "', '" ) );
 
             TomahawkSqlQuery query = dbi->newquery();
@@ -107,7 +103,7 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
     if ( !prevrev.isEmpty() )
     {
         TomahawkSqlQuery query_entries_old = dbi->newquery();
-        query_entries_old.prepare( "SELECT entries, "
+        query_entries_old.prepare( "SELECT entries IS NULL, "
                                    "(SELECT currentrevision = ? FROM playlist WHERE guid = ?) "
                                    "FROM playlist_revision "
                                    "WHERE guid = ?" );
@@ -122,11 +118,9 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
             Q_ASSERT( false );
         }
 
-        if ( !query_entries_old.value( 0 ).isNull() )
+        if ( !query_entries_old.value( 0 ).toBool() )
         {
-            QVariant v = TomahawkUtils::parseJson( query_entries_old.value( 0 ).toByteArray(), &ok );
-            Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-            m_oldentries = v.toStringList();
+            m_oldentries = dbi->playlistRevisions()->entries( dbi, prevrev );
         }
         m_islatest = query_entries_old.value( 1 ).toBool();
     }
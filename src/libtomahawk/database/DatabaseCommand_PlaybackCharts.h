@@ -44,6 +44,7 @@ public:
 
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "playbackcharts"; }
+    virtual LatencyClass latencyClass() const { return Bulk; }
 
     void setLimit( unsigned int amount ) { m_amount = amount; }
 
@@ -27,15 +27,28 @@
 #include "SourceList.h"
 #include "Track.h"
 
+#include <QSet>
+
+// Number of track ids we look up per SQL statement
+#define TRACKS_PER_STATEMENT 500
+
 using namespace Tomahawk;
 
 
 DatabaseCommand_Resolve::DatabaseCommand_Resolve( const query_ptr& query )
     : DatabaseCommand()
-    , m_query( query )
 {
     // FIXME: We need to run tests of this DbCmd without a Pipeline
     // Q_ASSERT( Pipeline::instance()->isRunning() );
+
+    m_queries << query;
+}
+
+
+DatabaseCommand_Resolve::DatabaseCommand_Resolve( const QList< query_ptr >& queries )
+    : DatabaseCommand()
+    , m_queries( queries )
+{
 }
 
 
@@ -52,235 +65,226 @@ DatabaseCommand_Resolve::exec( DatabaseImpl* lib )
      *        1) find list of trk/art/alb IDs that are reasonable matches to the metadata given
      *        2) find files in database by permitted sources and calculate score, ignoring
      *           results that are less than MINSCORE
+     *
+     *        Regular queries are resolved as one batch, full-text queries one by one.
      */
 
-    if ( !m_query->resultHint().isEmpty() )
+    QList< query_ptr > batch;
+    foreach ( const query_ptr& query, m_queries )
     {
-        tDebug() << "Using result-hint to speed up resolving:" << m_query->resultHint();
+        if ( resolveFromHint( lib, query ) )
+            continue;
 
-        Tomahawk::result_ptr result = lib->resultFromHint( m_query );
-        if ( result && ( !result->resolvedByCollection() || result->resolvedByCollection()->isOnline() ) )
-        {
-            QList<Tomahawk::result_ptr> res;
-            res << result;
-            emit results( m_query->id(), res );
-            return;
-        }
+        if ( query->isFullTextQuery() )
+            fullTextResolve( lib, query );
+        else
+            batch << query;
     }
 
-    if ( m_query->isFullTextQuery() )
-        fullTextResolve( lib );
-    else
-        resolve( lib );
+    if ( !batch.isEmpty() )
+        resolve( lib, batch );
 }
 
 
-void
-DatabaseCommand_Resolve::resolve( DatabaseImpl* lib )
+bool
+DatabaseCommand_Resolve::resolveFromHint( DatabaseImpl* lib, const query_ptr& query )
 {
-    QList<Tomahawk::result_ptr> res;
+    if ( query->resultHint().isEmpty() )
+        return false;
 
-    // STEP 1
-    QList< QPair<int, float> > tracks = lib->search( m_query );
+    tDebug() << "Using result-hint to speed up resolving:" << query->resultHint();
 
-    if ( tracks.isEmpty() )
+    Tomahawk::result_ptr result = lib->resultFromHint( query );
+    if ( result && ( !result->resolvedByCollection() || result->resolvedByCollection()->isOnline() ) )
     {
-        qDebug() << "No candidates found in first pass, aborting resolve" << m_query->queryTrack()->toString();
-        emit results( m_query->id(), res );
-        return;
+        QList<Tomahawk::result_ptr> res;
+        res << result;
+        emit results( query->id(), res );
+        return true;
     }
 
-    // STEP 2
-    TomahawkSqlQuery files_query = lib->newquery();
-
-    QStringList trksl;
-    for ( int k = 0; k < tracks.count(); k++ )
-        trksl.append( QString::number( tracks.at( k ).first ) );
-
-    QString trksToken = QString( "file_join.track IN (%1)" ).arg( trksl.join( "," ) );
-
-    QString sql = QString( "SELECT "
-                            "url, mtime, size, md5, mimetype, duration, bitrate, "  //0
-                            "file_join.artist, file_join.album, file_join.track, "  //7
-                            "file_join.composer, file_join.discnumber, "            //10
-                            "artist.name as artname, "                              //12
-                            "album.name as albname, "                               //13
-                            "track.name as trkname, "                               //14
-                            "composer.name as cmpname, "                            //15
-                            "file.source, "                                         //16
-                            "file_join.albumpos, "                                  //17
-                            "artist.id as artid, "                                  //18
-                            "album.id as albid, "                                   //19
-                            "composer.id as cmpid, "                                //20
-                            "albumArtist.id as albumartistid, "                     //21
-                            "albumArtist.name as albumartistname "                  //22
-                            "FROM file, file_join, artist, track "
-                            "LEFT JOIN album ON album.id = file_join.album "
-                            "LEFT JOIN artist AS composer ON composer.id = file_join.composer "
-                            "LEFT JOIN artist AS albumArtist ON albumArtist.id = album.artist "
-                            "WHERE "
-                            "artist.id = file_join.artist AND "
-                            "track.id = file_join.track AND "
-                            "file.id = file_join.file AND "
-                            "(%1)" )
-         .arg( trksToken );
-
-    files_query.prepare( sql );
-    files_query.exec();
-
-    while ( files_query.next() )
+    return false;
+}
+
+
+void
+DatabaseCommand_Resolve::resolve( DatabaseImpl* lib, const QList< query_ptr >& queries )
+{
+    // STEP 1
+    const QHash< QID, QList< QPair<int, float> > > candidates = lib->search( queries );
+
+    QList< int > trackIds;
+    QSet< int > seen;
+    foreach ( const query_ptr& query, queries )
     {
-        QString url = files_query.value( 0 ).toString();
-        source_ptr s = SourceList::instance()->get( files_query.value( 16 ).toUInt() );
-        if ( !s )
+        typedef QPair<int, float> scorepair_t;
+        foreach ( const scorepair_t& pair, candidates.value( query->id() ) )
         {
-            tDebug() << "Could not find source" << files_query.value( 16 ).toUInt();
-            continue;
+            if ( !seen.contains( pair.first ) )
+            {
+                seen.insert( pair.first );
+                trackIds << pair.first;
+            }
         }
-        if ( !s->isLocal() )
-            url = QString( "servent://%1\t%2" ).arg( s->nodeId() ).arg( url );
+    }
 
-        Tomahawk::result_ptr result = Tomahawk::Result::getCached( url );
-        if ( result )
+    // STEP 2
+    const QHash< int, QList< Tomahawk::result_ptr > > files = resultsForTracks( lib, trackIds );
+
+    foreach ( const query_ptr& query, queries )
+    {
+        const QList< QPair<int, float> > tracks = candidates.value( query->id() );
+        if ( tracks.isEmpty() )
         {
-            tDebug( LOGVERBOSE ) << "Result already cached:" << result->toString();
-            res << result;
-            continue;
+            tDebug( LOGVERBOSE ) << "No candidates found in first pass, aborting resolve" << query->queryTrack()->toString();
         }
 
-        track_ptr track = Track::get( files_query.value( 9 ).toUInt(), files_query.value( 12 ).toString(), files_query.value( 14 ).toString(),
-                                      files_query.value( 13 ).toString(), files_query.value( 22 ).toString(), files_query.value( 5 ).toUInt(),
-                                      files_query.value( 15 ).toString(), files_query.value( 17 ).toUInt(), files_query.value( 11 ).toUInt() );
-        if ( !track )
-            continue;
-        track->loadAttributes();
-
-        result = Result::get( url, track );
-        if ( !result )
-            continue;
+        QList<Tomahawk::result_ptr> res;
+        for ( int k = 0; k < tracks.count(); k++ )
+            res << files.value( tracks.at( k ).first );
 
-        result->setModificationTime( files_query.value( 1 ).toUInt() );
-        result->setSize( files_query.value( 2 ).toUInt() );
-        result->setMimetype( files_query.value( 4 ).toString() );
-        result->setBitrate( files_query.value( 6 ).toUInt() );
-        result->setRID( uuid() );
-        result->setResolvedByCollection( s->dbCollection() );
-
-        res << result;
+        emit results( query->id(), res );
     }
-
-    emit results( m_query->id(), res );
 }
 
 
 void
-DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib )
+DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib, const query_ptr& query )
 {
-    QList<Tomahawk::result_ptr> res;
     typedef QPair<int, float> scorepair_t;
 
     // STEP 1
-    QList< QPair<int, float> > trackPairs = lib->search( m_query );
-    QList< QPair<int, float> > albumPairs = lib->searchAlbum( m_query, 20 );
+    QList< QPair<int, float> > trackPairs = lib->search( query );
+    QList< QPair<int, float> > albumPairs = lib->searchAlbum( query, 20 );
 
-    TomahawkSqlQuery query = lib->newquery();
-    query.prepare( "SELECT album.name, artist.id, artist.name FROM album, artist WHERE artist.id = album.artist AND album.id = ?" );
+    TomahawkSqlQuery albumQuery = lib->newquery();
+    albumQuery.prepare( "SELECT album.name, artist.id, artist.name FROM album, artist WHERE artist.id = album.artist AND album.id = ?" );
 
     foreach ( const scorepair_t& albumPair, albumPairs )
     {
-        query.bindValue( 0, albumPair.first );
-        query.exec();
+        albumQuery.bindValue( 0, albumPair.first );
+        albumQuery.exec();
 
         QList<Tomahawk::album_ptr> albumList;
-        while ( query.next() )
+        while ( albumQuery.next() )
         {
-            Tomahawk::artist_ptr artist = Tomahawk::Artist::get( query.value( 1 ).toUInt(), query.value( 2 ).toString() );
-            Tomahawk::album_ptr album = Tomahawk::Album::get( albumPair.first, query.value( 0 ).toString(), artist );
+            Tomahawk::artist_ptr artist = Tomahawk::Artist::get( albumQuery.value( 1 ).toUInt(), albumQuery.value( 2 ).toString() );
+            Tomahawk::album_ptr album = Tomahawk::Album::get( albumPair.first, albumQuery.value( 0 ).toString(), artist );
             albumList << album;
         }
 
-        emit albums( m_query->id(), albumList );
+        emit albums( query->id(), albumList );
     }
 
+    QList<Tomahawk::result_ptr> res;
     if ( trackPairs.isEmpty() )
     {
-        qDebug() << "No candidates found in first pass, aborting resolve" << m_query->fullTextQuery();
-        emit results( m_query->id(), res );
+        qDebug() << "No candidates found in first pass, aborting resolve" << query->fullTextQuery();
+        emit results( query->id(), res );
         return;
     }
 
     // STEP 2
-    TomahawkSqlQuery files_query = lib->newquery();
-
-    QStringList trksl;
-    for ( int k = 0; k < trackPairs.count(); k++ )
-        trksl.append( QString::number( trackPairs.at( k ).first ) );
-
-    QString trksToken = QString( "file_join.track IN (%1)" ).arg( trksl.join( "," ) );
-    QString sql = QString( "SELECT "
-                            "url, mtime, size, md5, mimetype, duration, bitrate, "  //0
-                            "file_join.artist, file_join.album, file_join.track, "  //7
-                            "file_join.composer, file_join.discnumber, "            //10
-                            "artist.name as artname, "                              //12
-                            "album.name as albname, "                               //13
-                            "track.name as trkname, "                               //14
-                            "composer.name as cmpname, "                            //15
-                            "file.source, "                                         //16
-                            "file_join.albumpos, "                                  //17
-                            "artist.id as artid, "                                  //18
-                            "album.id as albid, "                                   //19
-                            "composer.id as cmpid, "                                //20
-                            "albumArtist.id as albumartistid, "                     //21
-                            "albumArtist.name as albumartistname "                  //22
-                            "FROM file, file_join, artist, track "
-                            "LEFT JOIN album ON album.id = file_join.album "
-                            "LEFT JOIN artist AS composer ON composer.id = file_join.composer "
-                            "LEFT JOIN artist AS albumArtist ON albumArtist.id = album.artist "
-                            "WHERE "
-                            "artist.id = file_join.artist AND "
-                            "track.id = file_join.track AND "
-                            "file.id = file_join.file AND "
-                            "%1" )
-                        .arg( !trksl.isEmpty() ? trksToken : QString( "0" ) );
-
-    files_query.prepare( sql );
-    files_query.exec();
-
-    while ( files_query.next() )
-    {
-        QString url = files_query.value( 0 ).toString();
-        source_ptr s = SourceList::instance()->get( files_query.value( 16 ).toUInt() );
-        if ( !s )
-        {
-            tDebug() << "Could not find source" << files_query.value( 16 ).toUInt();
-            continue;
-        }
-        if ( !s->isLocal() )
-            url = QString( "servent://%1\t%2" ).arg( s->nodeId() ).arg( url );
+    QList< int > trackIds;
+    foreach ( const scorepair_t& trackPair, trackPairs )
+        trackIds << trackPair.first;
 
-        Tomahawk::result_ptr result = Tomahawk::Result::getCached( url );
-        if ( result )
-        {
-            tDebug( LOGVERBOSE ) << "Result already cached:" << result->toString();
-            res << result;
-            continue;
-        }
+    const QHash< int, QList< Tomahawk::result_ptr > > files = resultsForTracks( lib, trackIds );
+    foreach ( int trackId, trackIds )
+        res << files.value( trackId );
 
-        track_ptr track = Track::get( files_query.value( 9 ).toUInt(), files_query.value( 12 ).toString(), files_query.value( 14 ).toString(),
-                                      files_query.value( 13 ).toString(), files_query.value( 22 ).toString(), files_query.value( 5 ).toUInt(),
-                                      files_query.value( 15 ).toString(), files_query.value( 17 ).toUInt(), files_query.value( 11 ).toUInt() );
-        track->loadAttributes();
+    emit results( query->id(), res );
+}
 
-        result = Result::get( url, track );
-        result->setModificationTime( files_query.value( 1 ).toUInt() );
-        result->setSize( files_query.value( 2 ).toUInt() );
-        result->setMimetype( files_query.value( 4 ).toString() );
-        result->setBitrate( files_query.value( 6 ).toUInt() );
-        result->setRID( uuid() );
-        result->setResolvedByCollection( s->dbCollection() );
 
-        res << result;
+QHash< int, QList< Tomahawk::result_ptr > >
+DatabaseCommand_Resolve::resultsForTracks( DatabaseImpl* lib, const QList< int >& trackIds )
+{
+    QHash< int, QList< Tomahawk::result_ptr > > res;
+
+    for ( int offset = 0; offset < trackIds.count(); offset += TRACKS_PER_STATEMENT )
+    {
+        const int count = qMin( TRACKS_PER_STATEMENT, trackIds.count() - offset );
+
+        QStringList trksl;
+        for ( int k = offset; k < offset + count; k++ )
+            trksl.append( QString::number( trackIds.at( k ) ) );
+
+        QString trksToken = QString( "file_join.track IN (%1)" ).arg( trksl.join( "," ) );
+
+        QString sql = QString( "SELECT "
+                                "url, mtime, size, md5, mimetype, duration, bitrate, "  //0
+                                "file_join.artist, file_join.album, file_join.track, "  //7
+                                "file_join.composer, file_join.discnumber, "            //10
+                                "artist.name as artname, "                              //12
+                                "album.name as albname, "                               //13
+                                "track.name as trkname, "                               //14
+                                "composer.name as cmpname, "                            //15
+                                "file.source, "                                         //16
+                                "file_join.albumpos, "                                  //17
+                                "artist.id as artid, "                                  //18
+                                "album.id as albid, "                                   //19
+                                "composer.id as cmpid, "                                //20
+                                "albumArtist.id as albumartistid, "                     //21
+                                "albumArtist.name as albumartistname "                  //22
+                                "FROM file, file_join, artist, track "
+                                "LEFT JOIN album ON album.id = file_join.album "
+                                "LEFT JOIN artist AS composer ON composer.id = file_join.composer "
+                                "LEFT JOIN artist AS albumArtist ON albumArtist.id = album.artist "
+                                "WHERE "
+                                "artist.id = file_join.artist AND "
+                                "track.id = file_join.track AND "
+                                "file.id = file_join.file AND "
+                                "(%1)" )
+             .arg( trksToken );
+
+        TomahawkSqlQuery files_query = lib->newquery();
+        files_query.prepare( sql );
+        files_query.exec();
+
+        while ( files_query.next() )
+        {
+            const int trackId = files_query.value( 9 ).toInt();
+
+            QString url = files_query.value( 0 ).toString();
+            source_ptr s = SourceList::instance()->get( files_query.value( 16 ).toUInt() );
+            if ( !s )
+            {
+                tDebug() << "Could not find source" << files_query.value( 16 ).toUInt();
+                continue;
+            }
+            if ( !s->isLocal() )
+                url = QString( "servent://%1\t%2" ).arg( s->nodeId() ).arg( url );
+
+            Tomahawk::result_ptr result = Tomahawk::Result::getCached( url );
+            if ( result )
+            {
+                tDebug( LOGVERBOSE ) << "Result already cached:" << result->toString();
+                res[ trackId ] << result;
+                continue;
+            }
+
+            track_ptr track = Track::get( files_query.value( 9 ).toUInt(), files_query.value( 12 ).toString(), files_query.value( 14 ).toString(),
+                                          files_query.value( 13 ).toString(), files_query.value( 22 ).toString(), files_query.value( 5 ).toUInt(),
+                                          files_query.value( 15 ).toString(), files_query.value( 17 ).toUInt(), files_query.value( 11 ).toUInt() );
+            if ( !track )
+                continue;
+            track->loadAttributes();
+
+            result = Result::get( url, track );
+            if ( !result )
+                continue;
+
+            result->setModificationTime( files_query.value( 1 ).toUInt() );
+            result->setSize( files_query.value( 2 ).toUInt() );
+            result->setMimetype( files_query.value( 4 ).toString() );
+            result->setBitrate( files_query.value( 6 ).toUInt() );
+            result->setRID( uuid() );
+            result->setResolvedByCollection( s->dbCollection() );
+
+            res[ trackId ] << result;
+        }
     }
 
-    emit results( m_query->id(), res );
+    return res;
 }
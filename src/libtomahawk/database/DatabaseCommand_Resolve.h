@@ -37,8 +37,16 @@ class DLLEXPORT DatabaseCommand_Resolve : public DatabaseCommand
 Q_OBJECT
 public:
     explicit DatabaseCommand_Resolve( const Tomahawk::query_ptr& query );
+    /**
+     * Resolves a whole batch of queries at once, with a single pass over the
+     * fuzzy index and one SQL lookup for all candidate tracks. Results are
+     * still reported for each query separately.
+     */
+    explicit DatabaseCommand_Resolve( const QList< Tomahawk::query_ptr >& queries );
     virtual ~DatabaseCommand_Resolve();
 
+    QList< Tomahawk::query_ptr > queries() const { return m_queries; }
+
     QString commandname() const override { return "dbresolve"; }
     bool doesMutates() const override { return false; }
 
@@ -52,10 +60,14 @@ signals:
 private:
     DatabaseCommand_Resolve();
 
-    void fullTextResolve( DatabaseImpl* lib );
-    void resolve( DatabaseImpl* lib );
+    bool resolveFromHint( DatabaseImpl* lib, const Tomahawk::query_ptr& query );
+    void fullTextResolve( DatabaseImpl* lib, const Tomahawk::query_ptr& query );
+    void resolve( DatabaseImpl* lib, const QList< Tomahawk::query_ptr >& queries );
+
+    // all results for the given tracks, by track id
+    QHash< int, QList< Tomahawk::result_ptr > > resultsForTracks( DatabaseImpl* lib, const QList< int >& trackIds );
 
-    Tomahawk::query_ptr m_query;
+    QList< Tomahawk::query_ptr > m_queries;
 };
 
 }
@@ -25,6 +25,7 @@
 
 #include "DatabaseImpl.h"
 #include "PlaylistEntry.h"
+#include "PlaylistRevisionStore.h"
 #include "Source.h"
 #include "TomahawkSqlQuery.h"
 #include "Track.h"
@@ -147,9 +148,6 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
         return;
     }
 
-    QVariantList vlist = m_orderedguids;
-    const QByteArray entries = TomahawkUtils::toJson( vlist );
-
     // add any new items:
     TomahawkSqlQuery adde = lib->newquery();
     if ( m_localOnly )
@@ -224,6 +222,29 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
         }
     }
 
+    QStringList orderedguids;
+    foreach( const QVariant& v, m_orderedguids )
+        orderedguids << v.toString();
+
+    // Compaction may have deleted the revision a peer built this one on. Don't
+    // refer to it then (that would break the foreign key), encode() falls back
+    // to a snapshot as it can't load it either.
+    QString previousRevision = m_oldrev;
+    if ( !previousRevision.isEmpty() )
+    {
+        TomahawkSqlQuery query = lib->newquery();
+        query.prepare( "SELECT 1 FROM playlist_revision WHERE guid = ?" );
+        query.addBindValue( previousRevision );
+        if ( !query.exec() || !query.next() )
+        {
+            tDebug() << "Previous revision" << previousRevision << "is gone, storing" << m_newrev << "without it";
+            previousRevision.clear();
+        }
+    }
+
+    // stored as a delta against the previous revision where that pays off
+    const QByteArray entries = lib->playlistRevisions()->encode( lib, m_newrev, previousRevision, orderedguids );
+
     // add / update the revision:
     TomahawkSqlQuery query = lib->newquery();
     QString sql = "INSERT INTO playlist_revision(guid, playlist, entries, author, timestamp, previous_revision) "
@@ -235,7 +256,7 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
     query.addBindValue( entries );
     query.addBindValue( source()->isLocal() ? QVariant(QVariant::Int) : source()->id() );
     query.addBindValue( 0 ); //ts
-    query.addBindValue( m_oldrev.isEmpty() ? QVariant(QVariant::String) : m_oldrev );
+    query.addBindValue( previousRevision.isEmpty() ? QVariant(QVariant::String) : previousRevision );
     query.exec();
 
     tDebug() << "Currentrevision:" << currentRevision << "oldrev:" << m_oldrev;
@@ -252,22 +273,10 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
 
         m_applied = true;
 
-        // load previous revision entries, which we need to pass on
-        // so the change can be diffed
-        TomahawkSqlQuery query_entries = lib->newquery();
-        query_entries.prepare( "SELECT entries, playlist, author, timestamp, previous_revision "
-                               "FROM playlist_revision "
-                               "WHERE guid = :guid" );
-        query_entries.bindValue( ":guid", m_oldrev );
-        query_entries.exec();
-        if ( query_entries.next() )
-        {
-            bool ok;
-            QVariant v = TomahawkUtils::parseJson( query_entries.value( 0 ).toByteArray(), &ok );
-            Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-
-            m_previous_rev_orderedguids = v.toStringList();
-        }
+        // previous revision entries, which we need to pass on
+        // so the change can be diffed. encode() has them cached already
+        if ( !m_oldrev.isEmpty() )
+            m_previous_rev_orderedguids = lib->playlistRevisions()->entries( lib, m_oldrev );
     }
     else if ( !m_oldrev.isEmpty() )
     {
@@ -38,6 +38,12 @@ DatabaseCommand_UpdateSearchIndex::DatabaseCommand_UpdateSearchIndex()
 }
 
 
+DatabaseCommand_UpdateSearchIndex::DatabaseCommand_UpdateSearchIndex( const source_ptr& source )
+    : DatabaseCommand( source )
+{
+}
+
+
 DatabaseCommand_UpdateSearchIndex::~DatabaseCommand_UpdateSearchIndex()
 {
     tDebug() << Q_FUNC_INFO;
@@ -46,6 +52,16 @@ DatabaseCommand_UpdateSearchIndex::~DatabaseCommand_UpdateSearchIndex()
 
 void
 DatabaseCommand_UpdateSearchIndex::exec( DatabaseImpl* db )
+{
+    if ( source().isNull() )
+        rebuildIndex( db );
+    else
+        checkSource( db );
+}
+
+
+void
+DatabaseCommand_UpdateSearchIndex::rebuildIndex( DatabaseImpl* db )
 {
     db->m_fuzzyIndex->beginIndexing();
 
@@ -77,4 +93,48 @@ DatabaseCommand_UpdateSearchIndex::exec( DatabaseImpl* db )
     db->m_fuzzyIndex->endIndexing();
 }
 
+
+void
+DatabaseCommand_UpdateSearchIndex::checkSource( DatabaseImpl* db )
+{
+    const QString sourceClause = source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() );
+    QList< IndexData > data;
+
+    TomahawkSqlQuery q = db->newquery();
+    q.exec( QString( "SELECT DISTINCT track.id, track.name, artist.name, artist.id "
+                     "FROM file, file_join, track, artist "
+                     "WHERE file.source %1 AND file_join.file = file.id "
+                     "AND track.id = file_join.track AND artist.id = track.artist" ).arg( sourceClause ) );
+    while ( q.next() )
+    {
+        IndexData ida;
+        ida.id = q.value( 0 ).toUInt();
+        ida.artistId = q.value( 3 ).toUInt();
+        ida.track = q.value( 1 ).toString();
+        ida.artist = q.value( 2 ).toString();
+
+        data << ida;
+    }
+
+    q.exec( QString( "SELECT DISTINCT album.id, album.name "
+                     "FROM file, file_join, album "
+                     "WHERE file.source %1 AND file_join.file = file.id "
+                     "AND album.id = file_join.album" ).arg( sourceClause ) );
+    while ( q.next() )
+    {
+        IndexData ida;
+        ida.id = q.value( 0 ).toUInt();
+        ida.album = q.value( 1 ).toString();
+
+        data << ida;
+    }
+
+    const int missing = db->m_fuzzyIndex->missingDocuments( data ).count();
+    tDebug( LOGVERBOSE ) << "Checked index for source" << source()->id() << "-" << missing << "of" << data.count() << "documents missing";
+
+    // re-index the source's whole slice, whatever got lost may be stale elsewhere too
+    if ( missing > 0 )
+        db->m_fuzzyIndex->updateDocuments( data );
+}
+
 }
@@ -39,12 +39,22 @@ class DLLEXPORT DatabaseCommand_UpdateSearchIndex : public DatabaseCommand
 {
 Q_OBJECT
 public:
+    /// Rebuilds the whole index from scratch.
     explicit DatabaseCommand_UpdateSearchIndex();
+    /**
+     * Checks that all of source's tracks and albums are in the index and
+     * re-indexes them if any are missing.
+     */
+    explicit DatabaseCommand_UpdateSearchIndex( const Tomahawk::source_ptr& source );
     virtual ~DatabaseCommand_UpdateSearchIndex();
 
     virtual QString commandname() const { return "updatesearchindex"; }
     virtual bool doesMutates() const { return true; }
     virtual void exec( DatabaseImpl* db );
+
+private:
+    void rebuildIndex( DatabaseImpl* db );
+    void checkSource( DatabaseImpl* db );
 };
 
 }
@@ -23,6 +23,8 @@
 
 #include "DatabaseCommand.h"
 
+#include <QElapsedTimer>
+
 namespace Tomahawk
 {
 
@@ -32,6 +34,8 @@ public:
     explicit DatabaseCommandPrivate( DatabaseCommand* q )
         : q_ptr( q )
         , state( DatabaseCommand::PENDING )
+        , queueTime( 0 )
+        , execTime( 0 )
     {
     }
 
@@ -39,6 +43,8 @@ public:
         : q_ptr( q )
         , source( src )
         , state( DatabaseCommand::PENDING )
+        , queueTime( 0 )
+        , execTime( 0 )
     {
     }
 
@@ -52,6 +58,10 @@ private:
     QVariant data;
     QWeakPointer< Tomahawk::DatabaseCommand > ownRef;
 
+    QElapsedTimer enqueueTimer;
+    qint64 queueTime;
+    qint64 execTime;
+
 };
 
 } // Tomahawk
@@ -0,0 +1,145 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseIdCache.h"
+
+#include "utils/Logger.h"
+
+#include "DatabaseImpl.h"
+
+#include <QTime>
+
+namespace Tomahawk
+{
+
+DatabaseIdCache::DatabaseIdCache( int artistCapacity, int albumCapacity, int trackCapacity )
+{
+    m_ids[ Artist ].setMaxCost( artistCapacity );
+    m_ids[ Album ].setMaxCost( albumCapacity );
+    m_ids[ Track ].setMaxCost( trackCapacity );
+
+    for ( int i = 0; i < KindCount; i++ )
+    {
+        m_hits[ i ] = 0;
+        m_misses[ i ] = 0;
+    }
+}
+
+
+DatabaseIdCache::~DatabaseIdCache()
+{
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO
+                         << "artists:" << hits( Artist ) << "hits" << misses( Artist ) << "misses,"
+                         << "albums:" << hits( Album ) << "hits" << misses( Album ) << "misses,"
+                         << "tracks:" << hits( Track ) << "hits" << misses( Track ) << "misses";
+}
+
+
+int
+DatabaseIdCache::id( Kind kind, int artistId, const QString& name )
+{
+    QMutexLocker lock( &m_mutex );
+
+    const int* id = m_ids[ kind ].object( Key( artistId, name ) );
+    if ( !id )
+    {
+        m_misses[ kind ]++;
+        return 0;
+    }
+
+    m_hits[ kind ]++;
+    return *id;
+}
+
+
+void
+DatabaseIdCache::insert( Kind kind, int artistId, const QString& name, int id )
+{
+    if ( id <= 0 )
+        return;
+
+    QMutexLocker lock( &m_mutex );
+    m_ids[ kind ].insert( Key( artistId, name ), new int( id ) );
+}
+
+
+void
+DatabaseIdCache::clear()
+{
+    QMutexLocker lock( &m_mutex );
+
+    for ( int i = 0; i < KindCount; i++ )
+        m_ids[ i ].clear();
+}
+
+
+void
+DatabaseIdCache::warmUp( DatabaseImpl* lib )
+{
+    QTime t;
+    t.start();
+
+    TomahawkSqlQuery query = lib->newquery();
+
+    query.prepare( "SELECT id, name FROM artist ORDER BY id DESC LIMIT ?" );
+    query.addBindValue( m_ids[ Artist ].maxCost() );
+    query.exec();
+    while ( query.next() )
+        insert( Artist, 0, query.value( 1 ).toString(), query.value( 0 ).toInt() );
+
+    query.prepare( "SELECT id, artist, name FROM album ORDER BY id DESC LIMIT ?" );
+    query.addBindValue( m_ids[ Album ].maxCost() );
+    query.exec();
+    while ( query.next() )
+        insert( Album, query.value( 1 ).toInt(), query.value( 2 ).toString(), query.value( 0 ).toInt() );
+
+    query.prepare( "SELECT id, artist, name FROM track ORDER BY id DESC LIMIT ?" );
+    query.addBindValue( m_ids[ Track ].maxCost() );
+    query.exec();
+    while ( query.next() )
+        insert( Track, query.value( 1 ).toInt(), query.value( 2 ).toString(), query.value( 0 ).toInt() );
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Loaded" << count( Artist ) << "artists," << count( Album ) << "albums and"
+                         << count( Track ) << "tracks in" << t.elapsed() << "ms";
+}
+
+
+quint64
+DatabaseIdCache::hits( Kind kind ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_hits[ kind ];
+}
+
+
+quint64
+DatabaseIdCache::misses( Kind kind ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_misses[ kind ];
+}
+
+
+int
+DatabaseIdCache::count( Kind kind ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_ids[ kind ].count();
+}
+
+}
@@ -0,0 +1,82 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DATABASEIDCACHE_H
+#define DATABASEIDCACHE_H
+
+#include "DllMacro.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+namespace Tomahawk
+{
+
+class DatabaseImpl;
+
+/**
+ * Remembers the ids of artists, albums and tracks by the name they were
+ * looked up with, so DatabaseImpl::artistId() & co. don't have to hit the
+ * database (or even compute a sortname) for names they have seen before.
+ *
+ * Albums and tracks are keyed by their artist id plus name. Every kind is
+ * bounded on its own and drops the least recently used entries first.
+ * One instance is shared by all DatabaseImpl clones, so it is thread-safe.
+ */
+class DLLEXPORT DatabaseIdCache
+{
+public:
+    enum Kind
+    {
+        Artist = 0,
+        Album,
+        Track,
+        KindCount
+    };
+
+    DatabaseIdCache( int artistCapacity, int albumCapacity, int trackCapacity );
+    ~DatabaseIdCache();
+
+    /// Returns the cached id, or 0 if we don't know it (yet).
+    int id( Kind kind, int artistId, const QString& name );
+    void insert( Kind kind, int artistId, const QString& name, int id );
+
+    void clear();
+
+    /// Fill the cache with the most recently added rows of each kind.
+    void warmUp( DatabaseImpl* lib );
+
+    quint64 hits( Kind kind ) const;
+    quint64 misses( Kind kind ) const;
+    int count( Kind kind ) const;
+
+private:
+    typedef QPair< int, QString > Key;
+
+    mutable QMutex m_mutex;
+    QCache< Key, int > m_ids[ KindCount ];
+    quint64 m_hits[ KindCount ];
+    quint64 m_misses[ KindCount ];
+};
+
+}
+
+#endif // DATABASEIDCACHE_H
@@ -28,6 +28,8 @@
 
 #include "Album.h"
 #include "Artist.h"
+#include "DatabaseIdCache.h"
+#include "PlaylistRevisionStore.h"
 #include "fuzzyindex/DatabaseFuzzyIndex.h"
 #include "PlaylistEntry.h"
 #include "Result.h"
@@ -50,7 +52,15 @@
 
 #define CURRENT_SCHEMA_VERSION 31
 
-Tomahawk::DatabaseImpl::DatabaseImpl( const QString& dbname )
+#define ARTIST_ID_CACHE_SIZE 20000
+#define ALBUM_ID_CACHE_SIZE 20000
+#define TRACK_ID_CACHE_SIZE 100000
+// in entry guids
+#define PLAYLIST_REVISION_CACHE_SIZE 200000
+
+Tomahawk::DatabaseImpl::DatabaseImpl( const QString& dbname, const QString& indexPath )
+    : m_idCache( new DatabaseIdCache( ARTIST_ID_CACHE_SIZE, ALBUM_ID_CACHE_SIZE, TRACK_ID_CACHE_SIZE ) )
+    , m_playlistRevisions( new PlaylistRevisionStore( PLAYLIST_REVISION_CACHE_SIZE ) )
 {
     QTime t;
     t.start();
@@ -82,14 +92,20 @@ Tomahawk::DatabaseImpl::DatabaseImpl( const QString& dbname )
     init();
     query.exec( "PRAGMA auto_vacuum = FULL" );
     query.exec( "PRAGMA synchronous = NORMAL" );
+    // readers work on a snapshot, so they never wait for the rw worker
+    query.exec( "PRAGMA journal_mode = WAL" );
 
     tDebug( LOGVERBOSE ) << "Tweaked db pragmas:" << t.elapsed();
 
+    m_idCache->warmUp( this );
+
+    tDebug( LOGVERBOSE ) << "Loaded id cache:" << t.elapsed();
+
     // in case of unclean shutdown last time:
     query.exec( "UPDATE source SET isonline = 'false'" );
     query.exec( "DELETE FROM oplog WHERE source IS NULL AND singleton = 'true'" );
 
-    m_fuzzyIndex = new Tomahawk::DatabaseFuzzyIndex( this, schemaUpdated );
+    m_fuzzyIndex = new Tomahawk::DatabaseFuzzyIndex( this, schemaUpdated, indexPath );
 
     tDebug( LOGVERBOSE ) << "Loaded index:" << t.elapsed();
     if ( qApp->arguments().contains( "--dumpdb" ) )
@@ -111,8 +127,6 @@ Tomahawk::DatabaseImpl::DatabaseImpl( const QString& dbname, bool internal )
 void
 Tomahawk::DatabaseImpl::init()
 {
-    m_lastartid = m_lastalbid = m_lasttrkid = 0;
-
     TomahawkSqlQuery query = newquery();
 
      // make sqlite behave how we want:
@@ -164,6 +178,8 @@ Tomahawk::DatabaseImpl::clone() const
     DatabaseImpl* impl = new DatabaseImpl( m_db.databaseName(), true );
     impl->setDatabaseID( m_dbid );
     impl->setFuzzyIndex( m_fuzzyIndex );
+    impl->setIdCache( m_idCache );
+    impl->setPlaylistRevisions( m_playlistRevisions );
     return impl;
 }
 
@@ -330,13 +346,46 @@ Tomahawk::DatabaseImpl::file( int fid )
 }
 
 
+int
+Tomahawk::DatabaseImpl::knownId( DatabaseIdCache::Kind kind, int artistId, const QString& name )
+{
+    const int id = m_createdIds[ kind ].value( qMakePair( artistId, name ) );
+    if ( id )
+        return id;
+
+    return m_idCache->id( kind, artistId, name );
+}
+
+
+void
+Tomahawk::DatabaseImpl::commitCreatedIds()
+{
+    for ( int kind = 0; kind < DatabaseIdCache::KindCount; kind++ )
+    {
+        QHash< QPair< int, QString >, int >::const_iterator it = m_createdIds[ kind ].constBegin();
+        for ( ; it != m_createdIds[ kind ].constEnd(); ++it )
+            m_idCache->insert( (DatabaseIdCache::Kind)kind, it.key().first, it.key().second, it.value() );
+
+        m_createdIds[ kind ].clear();
+    }
+}
+
+
+void
+Tomahawk::DatabaseImpl::discardCreatedIds()
+{
+    for ( int kind = 0; kind < DatabaseIdCache::KindCount; kind++ )
+        m_createdIds[ kind ].clear();
+}
+
+
 int
 Tomahawk::DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
 {
-    if ( m_lastart == name_orig )
-        return m_lastartid;
+    int id = knownId( DatabaseIdCache::Artist, 0, name_orig );
+    if ( id )
+        return id;
 
-    int id = 0;
     QString sortname = Tomahawk::DatabaseImpl::sortname( name_orig );
 
     TomahawkSqlQuery query = newquery();
@@ -349,8 +398,7 @@ Tomahawk::DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
     }
     if ( id )
     {
-        m_lastart = name_orig;
-        m_lastartid = id;
+        m_idCache->insert( DatabaseIdCache::Artist, 0, name_orig, id );
         return id;
     }
 
@@ -367,8 +415,7 @@ Tomahawk::DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
         }
 
         id = query.lastInsertId().toInt();
-        m_lastart = name_orig;
-        m_lastartid = id;
+        m_createdIds[ DatabaseIdCache::Artist ].insert( qMakePair( 0, name_orig ), id );
     }
 
     return id;
@@ -378,9 +425,11 @@ Tomahawk::DatabaseImpl::artistId( const QString& name_orig, bool autoCreate )
 int
 Tomahawk::DatabaseImpl::trackId( int artistid, const QString& name_orig, bool autoCreate )
 {
-    int id = 0;
+    int id = knownId( DatabaseIdCache::Track, artistid, name_orig );
+    if ( id )
+        return id;
+
     QString sortname = Tomahawk::DatabaseImpl::sortname( name_orig );
-    //if( ( id = m_artistcache[sortname] ) ) return id;
 
     TomahawkSqlQuery query = newquery();
     query.prepare( "SELECT id FROM track WHERE artist = ? AND sortname = ?" );
@@ -394,7 +443,7 @@ Tomahawk::DatabaseImpl::trackId( int artistid, const QString& name_orig, bool au
     }
     if ( id )
     {
-        //m_trackcache[sortname]=id;
+        m_idCache->insert( DatabaseIdCache::Track, artistid, name_orig, id );
         return id;
     }
 
@@ -412,6 +461,7 @@ Tomahawk::DatabaseImpl::trackId( int artistid, const QString& name_orig, bool au
         }
 
         id = query.lastInsertId().toInt();
+        m_createdIds[ DatabaseIdCache::Track ].insert( qMakePair( artistid, name_orig ), id );
     }
 
     return id;
@@ -427,12 +477,11 @@ Tomahawk::DatabaseImpl::albumId( int artistid, const QString& name_orig, bool au
         return 0;
     }
 
-    if ( m_lastartid == artistid && m_lastalb == name_orig )
-        return m_lastalbid;
+    int id = knownId( DatabaseIdCache::Album, artistid, name_orig );
+    if ( id )
+        return id;
 
-    int id = 0;
     QString sortname = Tomahawk::DatabaseImpl::sortname( name_orig );
-    //if( ( id = m_albumcache[sortname] ) ) return id;
 
     TomahawkSqlQuery query = newquery();
     query.prepare( "SELECT id FROM album WHERE artist = ? AND sortname = ?" );
@@ -445,8 +494,7 @@ Tomahawk::DatabaseImpl::albumId( int artistid, const QString& name_orig, bool au
     }
     if ( id )
     {
-        m_lastalb = name_orig;
-        m_lastalbid = id;
+        m_idCache->insert( DatabaseIdCache::Album, artistid, name_orig, id );
         return id;
     }
 
@@ -464,8 +512,7 @@ Tomahawk::DatabaseImpl::albumId( int artistid, const QString& name_orig, bool au
         }
 
         id = query.lastInsertId().toInt();
-        m_lastalb = name_orig;
-        m_lastalbid = id;
+        m_createdIds[ DatabaseIdCache::Album ].insert( qMakePair( artistid, name_orig ), id );
     }
 
     return id;
@@ -497,6 +544,33 @@ Tomahawk::DatabaseImpl::search( const Tomahawk::query_ptr& query, uint limit )
 }
 
 
+QHash< Tomahawk::QID, QList< QPair<int, float> > >
+Tomahawk::DatabaseImpl::search( const QList< Tomahawk::query_ptr >& queries, uint limit )
+{
+    QHash< Tomahawk::QID, QList< QPair<int, float> > > results;
+
+    const QHash< Tomahawk::QID, QMap< int, float > > resultsmaps = m_fuzzyIndex->search( queries );
+    foreach ( const Tomahawk::query_ptr& query, queries )
+    {
+        const QMap< int, float > resultsmap = resultsmaps.value( query->id() );
+
+        QList< QPair<int, float> > resultslist;
+        for ( QMap< int, float >::const_iterator it = resultsmap.constBegin(); it != resultsmap.constEnd(); ++it )
+        {
+            resultslist << QPair<int, float>( it.key(), it.value() );
+        }
+        qSort( resultslist.begin(), resultslist.end(), Tomahawk::DatabaseImpl::scorepairSorter );
+
+        if ( limit && resultslist.count() > (int)limit )
+            resultslist = resultslist.mid( 0, limit );
+
+        results.insert( query->id(), resultslist );
+    }
+
+    return results;
+}
+
+
 QList< QPair<int, float> >
 Tomahawk::DatabaseImpl::searchAlbum( const Tomahawk::query_ptr& query, uint limit )
 {
@@ -757,7 +831,8 @@ Tomahawk::DatabaseImpl::openDatabase( const QString& dbname, bool checkSchema )
 
         QSqlDatabase db = QSqlDatabase::addDatabase( sqlDriver, connName );
         db.setDatabaseName( dbname );
-        db.setConnectOptions( "QSQLITE_ENABLE_SHARED_CACHE=1" );
+        // No shared cache: connections sharing one take table locks on
+        // each other, which would defeat WAL for the read-only workers.
         if ( !db.open() )
         {
             tLog() << "Failed to open database" << dbname << "with driver" << sqlDriver;
@@ -31,8 +31,10 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QHash>
+#include <QSharedPointer>
 #include <QThread>
 
+#include "DatabaseIdCache.h"
 #include "DllMacro.h"
 #include "TomahawkSqlQuery.h"
 #include "Typedefs.h"
@@ -43,16 +45,20 @@ namespace Tomahawk
 
 class Database;
 class DatabaseFuzzyIndex;
+class PlaylistRevisionStore;
 
 class DLLEXPORT DatabaseImpl : public QObject
 {
 Q_OBJECT
 
 friend class DatabaseFuzzyIndex;
+friend class DatabaseCommand_AddFiles;
+friend class DatabaseCommand_DeleteFiles;
 friend class DatabaseCommand_UpdateSearchIndex;
 
 public:
-    DatabaseImpl( const QString& dbname );
+    /// @param indexPath where the search index is kept, defaults to tomahawk.lucene in the data dir
+    explicit DatabaseImpl( const QString& dbname, const QString& indexPath = QString() );
     ~DatabaseImpl();
 
     DatabaseImpl* clone() const;
@@ -64,7 +70,16 @@ public:
     int trackId( int artistid, const QString& name_orig, bool autoCreate );
     int albumId( int artistid, const QString& name_orig, bool autoCreate );
 
+    /// Shared by all clones, only knows the ids of committed rows.
+    DatabaseIdCache* idCache() const { return m_idCache.data(); }
+    /// The artists, albums and tracks we created are only shared once the transaction is committed.
+    void commitCreatedIds();
+    void discardCreatedIds();
+    /// Shared by all clones, reads and writes the entries of playlist revisions.
+    PlaylistRevisionStore* playlistRevisions() const { return m_playlistRevisions.data(); }
+
     QList< QPair<int, float> > search( const Tomahawk::query_ptr& query, uint limit = 0 );
+    QHash< Tomahawk::QID, QList< QPair<int, float> > > search( const QList< Tomahawk::query_ptr >& queries, uint limit = 0 );
     QList< QPair<int, float> > searchAlbum( const Tomahawk::query_ptr& query, uint limit = 0 );
     QList< int > getTrackFids( int tid );
 
@@ -97,6 +112,10 @@ private:
     DatabaseImpl( const QString& dbname, bool internal );
     void setFuzzyIndex( DatabaseFuzzyIndex* fi ) { m_fuzzyIndex = fi; }
     void setDatabaseID( const QString& dbid ) { m_dbid = dbid; }
+    void setIdCache( const QSharedPointer< DatabaseIdCache >& cache ) { m_idCache = cache; }
+    void setPlaylistRevisions( const QSharedPointer< PlaylistRevisionStore >& store ) { m_playlistRevisions = store; }
+
+    int knownId( DatabaseIdCache::Kind kind, int artistId, const QString& name );
 
     void init();
     bool openDatabase( const QString& dbname, bool checkSchema = true );
@@ -107,8 +126,9 @@ private:
     bool m_ready;
     QSqlDatabase m_db;
 
-    QString m_lastart, m_lastalb, m_lasttrk;
-    int m_lastartid, m_lastalbid, m_lasttrkid;
+    QSharedPointer< DatabaseIdCache > m_idCache;
+    QHash< QPair< int, QString >, int > m_createdIds[ DatabaseIdCache::KindCount ];
+    QSharedPointer< PlaylistRevisionStore > m_playlistRevisions;
 
     QString m_dbid;
     Tomahawk::DatabaseFuzzyIndex* m_fuzzyIndex;
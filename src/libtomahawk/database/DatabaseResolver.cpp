@@ -27,6 +27,11 @@
 #include "PlaylistEntry.h"
 #include "Source.h"
 
+#include <QTimer>
+
+// Upper limit of queries we resolve with one DatabaseCommand_Resolve
+#define MAX_BATCH_SIZE 100
+
 
 DatabaseResolver::DatabaseResolver( int weight )
     : Resolver()
@@ -38,16 +43,33 @@ DatabaseResolver::DatabaseResolver( int weight )
 void
 DatabaseResolver::resolve( const Tomahawk::query_ptr& query )
 {
-    Tomahawk::DatabaseCommand_Resolve* cmd = new Tomahawk::DatabaseCommand_Resolve( query );
+    if ( m_pending.isEmpty() )
+        QTimer::singleShot( 0, this, SLOT( dispatchPending() ) );
+
+    m_pending << query;
+}
 
-    connect( cmd, SIGNAL( results( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ),
-                    SLOT( gotResults( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ), Qt::QueuedConnection );
-    connect( cmd, SIGNAL( albums( Tomahawk::QID, QList< Tomahawk::album_ptr > ) ),
-                    SLOT( gotAlbums( Tomahawk::QID, QList< Tomahawk::album_ptr > ) ), Qt::QueuedConnection );
-    connect( cmd, SIGNAL( artists( Tomahawk::QID, QList< Tomahawk::artist_ptr > ) ),
-                    SLOT( gotArtists( Tomahawk::QID, QList< Tomahawk::artist_ptr > ) ), Qt::QueuedConnection );
 
-    Tomahawk::Database::instance()->enqueue( Tomahawk::dbcmd_ptr( cmd ) );
+void
+DatabaseResolver::dispatchPending()
+{
+    while ( !m_pending.isEmpty() )
+    {
+        const QList< Tomahawk::query_ptr > batch = m_pending.mid( 0, MAX_BATCH_SIZE );
+        m_pending = m_pending.mid( batch.count() );
+
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Resolving batch of" << batch.count() << "queries";
+        Tomahawk::DatabaseCommand_Resolve* cmd = new Tomahawk::DatabaseCommand_Resolve( batch );
+
+        connect( cmd, SIGNAL( results( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ),
+                        SLOT( gotResults( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ), Qt::QueuedConnection );
+        connect( cmd, SIGNAL( albums( Tomahawk::QID, QList< Tomahawk::album_ptr > ) ),
+                        SLOT( gotAlbums( Tomahawk::QID, QList< Tomahawk::album_ptr > ) ), Qt::QueuedConnection );
+        connect( cmd, SIGNAL( artists( Tomahawk::QID, QList< Tomahawk::artist_ptr > ) ),
+                        SLOT( gotArtists( Tomahawk::QID, QList< Tomahawk::artist_ptr > ) ), Qt::QueuedConnection );
+
+        Tomahawk::Database::instance()->enqueue( Tomahawk::dbcmd_ptr( cmd ) );
+    }
 }
 
 
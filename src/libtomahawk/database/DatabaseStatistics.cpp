@@ -0,0 +1,166 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseStatistics.h"
+
+#include "utils/Logger.h"
+
+#include <QStringList>
+
+namespace Tomahawk
+{
+
+DatabaseCommandStatistics::DatabaseCommandStatistics()
+    : m_count( 0 )
+    , m_totalQueueTime( 0 )
+    , m_totalExecTime( 0 )
+    , m_maxQueueTime( 0 )
+    , m_maxExecTime( 0 )
+    , m_queueTime( BucketCount, 0 )
+    , m_execTime( BucketCount, 0 )
+{
+}
+
+
+void
+DatabaseCommandStatistics::record( qint64 queueTime, qint64 execTime )
+{
+    m_count++;
+    m_totalQueueTime += queueTime;
+    m_totalExecTime += execTime;
+    m_maxQueueTime = qMax( m_maxQueueTime, queueTime );
+    m_maxExecTime = qMax( m_maxExecTime, execTime );
+
+    m_queueTime[ bucket( queueTime ) ]++;
+    m_execTime[ bucket( execTime ) ]++;
+}
+
+
+qint64
+DatabaseCommandStatistics::queueTimeQuantile( double q ) const
+{
+    return quantile( m_queueTime, q );
+}
+
+
+qint64
+DatabaseCommandStatistics::execTimeQuantile( double q ) const
+{
+    return quantile( m_execTime, q );
+}
+
+
+int
+DatabaseCommandStatistics::bucket( qint64 usecs )
+{
+    int b = 0;
+    while ( usecs > 0 && b < BucketCount - 1 )
+    {
+        usecs >>= 1;
+        b++;
+    }
+
+    return b;
+}
+
+
+qint64
+DatabaseCommandStatistics::bucketUpperBound( int bucket )
+{
+    return Q_INT64_C( 1 ) << bucket;
+}
+
+
+qint64
+DatabaseCommandStatistics::quantile( const QVector< quint64 >& histogram, double q ) const
+{
+    if ( !m_count )
+        return 0;
+
+    const quint64 rank = qMax( Q_UINT64_C( 1 ), (quint64)( qBound( 0.0, q, 1.0 ) * m_count + 0.5 ) );
+    quint64 seen = 0;
+    for ( int i = 0; i < histogram.count(); i++ )
+    {
+        seen += histogram.at( i );
+        if ( seen >= rank )
+            return bucketUpperBound( i );
+    }
+
+    return bucketUpperBound( histogram.count() - 1 );
+}
+
+
+DatabaseStatistics::DatabaseStatistics()
+{
+}
+
+
+DatabaseStatistics::~DatabaseStatistics()
+{
+}
+
+
+void
+DatabaseStatistics::record( const QString& commandName, qint64 queueTime, qint64 execTime )
+{
+    QMutexLocker lock( &m_mutex );
+    m_stats[ commandName ].record( queueTime, execTime );
+}
+
+
+QHash< QString, DatabaseCommandStatistics >
+DatabaseStatistics::snapshot() const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_stats;
+}
+
+
+DatabaseCommandStatistics
+DatabaseStatistics::statistics( const QString& commandName ) const
+{
+    QMutexLocker lock( &m_mutex );
+    return m_stats.value( commandName );
+}
+
+
+void
+DatabaseStatistics::reset()
+{
+    QMutexLocker lock( &m_mutex );
+    m_stats.clear();
+}
+
+
+void
+DatabaseStatistics::dump() const
+{
+    const QHash< QString, DatabaseCommandStatistics > stats = snapshot();
+
+    QStringList names = stats.keys();
+    names.sort();
+    foreach ( const QString& name, names )
+    {
+        const DatabaseCommandStatistics& s = stats[ name ];
+        tLog() << "Database command" << name << "ran" << s.count() << "times -"
+               << "queue p50/p99/max:" << s.queueTimeQuantile( 0.5 ) << s.queueTimeQuantile( 0.99 ) << s.maxQueueTime() << "us,"
+               << "exec p50/p99/max:" << s.execTimeQuantile( 0.5 ) << s.execTimeQuantile( 0.99 ) << s.maxExecTime() << "us";
+    }
+}
+
+}
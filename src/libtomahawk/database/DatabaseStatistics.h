@@ -0,0 +1,106 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DATABASESTATISTICS_H
+#define DATABASESTATISTICS_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace Tomahawk
+{
+
+/**
+ * Queue-wait and exec-time histograms for a single kind of DatabaseCommand.
+ *
+ * Times are kept in log2 buckets of microseconds: bucket 0 holds everything
+ * below 1us, bucket n everything in [2^(n-1), 2^n) and the last bucket is
+ * open-ended.
+ */
+class DLLEXPORT DatabaseCommandStatistics
+{
+public:
+    enum { BucketCount = 26 };
+
+    DatabaseCommandStatistics();
+
+    void record( qint64 queueTime, qint64 execTime );
+
+    quint64 count() const { return m_count; }
+
+    qint64 totalQueueTime() const { return m_totalQueueTime; }
+    qint64 totalExecTime() const { return m_totalExecTime; }
+    qint64 maxQueueTime() const { return m_maxQueueTime; }
+    qint64 maxExecTime() const { return m_maxExecTime; }
+
+    const QVector< quint64 >& queueTimeHistogram() const { return m_queueTime; }
+    const QVector< quint64 >& execTimeHistogram() const { return m_execTime; }
+
+    /// Upper bound (in us) of the bucket the given quantile (0.0 - 1.0) falls into.
+    qint64 queueTimeQuantile( double quantile ) const;
+    qint64 execTimeQuantile( double quantile ) const;
+
+    static int bucket( qint64 usecs );
+    static qint64 bucketUpperBound( int bucket );
+
+private:
+    qint64 quantile( const QVector< quint64 >& histogram, double quantile ) const;
+
+    quint64 m_count;
+    qint64 m_totalQueueTime;
+    qint64 m_totalExecTime;
+    qint64 m_maxQueueTime;
+    qint64 m_maxExecTime;
+
+    QVector< quint64 > m_queueTime;
+    QVector< quint64 > m_execTime;
+};
+
+
+/**
+ * Collects DatabaseCommandStatistics per command name. Thread-safe, all the
+ * database workers report into the same instance.
+ */
+class DLLEXPORT DatabaseStatistics
+{
+public:
+    DatabaseStatistics();
+    ~DatabaseStatistics();
+
+    void record( const QString& commandName, qint64 queueTime, qint64 execTime );
+
+    QHash< QString, DatabaseCommandStatistics > snapshot() const;
+    DatabaseCommandStatistics statistics( const QString& commandName ) const;
+    void reset();
+
+    /// Writes a summary line per command to the log.
+    void dump() const;
+
+private:
+    mutable QMutex m_mutex;
+    QHash< QString, DatabaseCommandStatistics > m_stats;
+};
+
+}
+
+#endif // DATABASESTATISTICS_H
@@ -25,7 +25,11 @@
 #include "Database.h"
 #include "DatabaseImpl.h"
 #include "DatabaseCommandLoggable.h"
+#include "DatabaseCommandQueue.h"
+#include "DatabaseIdCache.h"
+#include "DatabaseStatistics.h"
 #include "PlaylistEntry.h"
+#include "PlaylistRevisionStore.h"
 #include "Source.h"
 #include "TomahawkSqlQuery.h"
 
@@ -41,10 +45,11 @@
 namespace Tomahawk
 {
 
-DatabaseWorkerThread::DatabaseWorkerThread( Database* db, bool mutates )
+DatabaseWorkerThread::DatabaseWorkerThread( Database* db, bool mutates, DatabaseCommandQueue* queue )
     : QThread()
     , m_db( db )
     , m_mutates( mutates )
+    , m_queue( queue )
 {
     m_startupMutex.lock();
 }
@@ -54,7 +59,7 @@ void
 DatabaseWorkerThread::run()
 {
     tDebug() << Q_FUNC_INFO << "DatabaseWorkerThread starting...";
-    m_worker = QPointer< DatabaseWorker >( new DatabaseWorker( m_db, m_mutates ) );
+    m_worker = QPointer< DatabaseWorker >( new DatabaseWorker( m_db, m_mutates, m_queue ) );
     m_startupMutex.unlock();
     exec();
     tDebug() << Q_FUNC_INFO << "DatabaseWorkerThread finishing...";
@@ -84,13 +89,18 @@ DatabaseWorkerThread::waitForEventLoopStart()
 }
 
 
-DatabaseWorker::DatabaseWorker( Database* db, bool mutates )
+DatabaseWorker::DatabaseWorker( Database* db, bool mutates, DatabaseCommandQueue* queue )
     : QObject()
     , m_db( db )
     , m_outstanding( 0 )
+    , m_queue( queue )
 {
     Q_UNUSED( mutates );
     tDebug() << Q_FUNC_INFO << "New db connection with name:" << Database::instance()->impl()->database().connectionName() << "on thread" << this->thread();
+
+    // pick up whatever got queued before we were around
+    if ( m_queue )
+        QTimer::singleShot( 0, this, SLOT( doQueuedWork() ) );
 }
 
 
@@ -98,6 +108,9 @@ DatabaseWorker::~DatabaseWorker()
 {
     tDebug() << Q_FUNC_INFO << m_outstanding;
 
+    if ( m_queue )
+        m_queue->removeWorker( this );
+
     if ( m_outstanding )
     {
         foreach ( const Tomahawk::dbcmd_ptr& cmd, m_commands )
@@ -172,6 +185,7 @@ DatabaseWorker::doWork()
             {
                 completed++;
                 cmd->_exec( impl ); // runs actual SQL stuff
+                m_db->statistics()->record( cmd->commandname(), cmd->queueTime(), cmd->execTime() );
 
                 if ( cmd->loggable() )
                 {
@@ -232,6 +246,8 @@ DatabaseWorker::doWork()
                     tDebug() << "FAILED TO COMMIT TRANSACTION*";
                     throw "commit failed";
                 }
+
+                impl->commitCreatedIds();
             }
 
 #ifdef DEBUG_TIMING
@@ -258,16 +274,28 @@ DatabaseWorker::doWork()
                  << endl;
 
         if ( cmd->doesMutates() )
+        {
             impl->database().rollback();
 
+            // ids handed out and revisions written during the transaction are gone now
+            impl->discardCreatedIds();
+            impl->playlistRevisions()->clear();
+        }
+
         Q_ASSERT( false );
     }
     catch (...)
     {
         qDebug() << "Uncaught exception processing dbcmd";
         if ( cmd->doesMutates() )
+        {
             impl->database().rollback();
 
+            // ids handed out and revisions written during the transaction are gone now
+            impl->discardCreatedIds();
+            impl->playlistRevisions()->clear();
+        }
+
         Q_ASSERT( false );
         throw;
     }
@@ -282,6 +310,47 @@ DatabaseWorker::doWork()
 }
 
 
+void
+DatabaseWorker::doQueuedWork()
+{
+    Tomahawk::dbcmd_ptr cmd = m_queue->take( this );
+    if ( !cmd )
+    {
+        // we are idle now, the queue hands us out again when there is work
+        return;
+    }
+
+    Q_ASSERT( !cmd->doesMutates() );
+    DatabaseImpl* impl = Database::instance()->impl();
+
+    try
+    {
+        cmd->_exec( impl );
+        cmd->postCommit();
+    }
+    catch ( const char * msg )
+    {
+        tLog() << endl
+                 << "*ERROR* processing databasecommand:"
+                 << cmd->commandname()
+                 << msg
+                 << impl->database().lastError().databaseText()
+                 << impl->database().lastError().driverText()
+                 << endl;
+
+        Q_ASSERT( false );
+    }
+
+    m_db->statistics()->record( cmd->commandname(), cmd->queueTime(), cmd->execTime() );
+    m_queue->finished( cmd );
+
+    cmd->emitFinished();
+
+    // back to the event loop before taking the next one
+    QTimer::singleShot( 0, this, SLOT( doQueuedWork() ) );
+}
+
+
 // this should take a const command, need to check/make json stuff mutable for some objs tho maybe.
 void
 DatabaseWorker::logOp( DatabaseCommandLoggable* command )
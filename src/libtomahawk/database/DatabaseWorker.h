@@ -32,13 +32,14 @@ namespace Tomahawk
 
 class Database;
 class DatabaseCommandLoggable;
+class DatabaseCommandQueue;
 
 class DatabaseWorker : public QObject
 {
 Q_OBJECT
 
 public:
-    DatabaseWorker( Database* db, bool mutates );
+    DatabaseWorker( Database* db, bool mutates, DatabaseCommandQueue* queue = 0 );
     ~DatabaseWorker();
 
     bool busy() const { return m_outstanding > 0; }
@@ -51,6 +52,9 @@ public slots:
 private slots:
     void doWork();
 
+    // read-only workers take their commands from the shared DatabaseCommandQueue
+    void doQueuedWork();
+
 private:
     void logOp( DatabaseCommandLoggable* command );
 
@@ -58,6 +62,8 @@ private:
     Database* m_db;
     QList< Tomahawk::dbcmd_ptr > m_commands;
     int m_outstanding;
+
+    DatabaseCommandQueue* m_queue;
 };
 
 class DatabaseWorkerThread : public QThread
@@ -65,7 +71,7 @@ class DatabaseWorkerThread : public QThread
 Q_OBJECT
 
 public:
-    DatabaseWorkerThread( Database* db, bool mutates );
+    DatabaseWorkerThread( Database* db, bool mutates, DatabaseCommandQueue* queue = 0 );
     ~DatabaseWorkerThread();
 
     QPointer< DatabaseWorker > worker() const;
@@ -84,6 +90,7 @@ private:
     QPointer< DatabaseWorker > m_worker;
     Database* m_db;
     bool m_mutates;
+    DatabaseCommandQueue* m_queue;
 
     /**
      * Locks until we've started the event loop.
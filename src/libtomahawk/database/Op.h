@@ -29,6 +29,7 @@ struct DBOp
     QByteArray payload;
     bool compressed;
     bool singleton;
+    bool binary; // payload is in DbOpCodec's encoding instead of JSON
 };
 
 typedef QSharedPointer<DBOp> dbop_ptr;
@@ -0,0 +1,419 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "PlaylistRevisionStore.h"
+
+#include "utils/Json.h"
+#include "utils/Logger.h"
+
+#include "DatabaseImpl.h"
+#include "TomahawkSqlQuery.h"
+
+#include <QSet>
+
+// write a full snapshot after this many deltas in a row
+#define SNAPSHOT_INTERVAL 50
+// reorderings needing more moves than this are stored as a snapshot
+#define MAX_MOVES 64
+// guards against cycles in broken revision chains
+#define MAX_CHAIN_LENGTH 10000
+
+namespace Tomahawk
+{
+
+static QByteArray
+snapshot( const QStringList& entries )
+{
+    QVariantList list;
+    foreach ( const QString& guid, entries )
+        list << guid;
+
+    return TomahawkUtils::toJson( list );
+}
+
+
+PlaylistRevisionStore::PlaylistRevisionStore( int capacity )
+{
+    m_revisions.setMaxCost( capacity );
+}
+
+
+PlaylistRevisionStore::~PlaylistRevisionStore()
+{
+}
+
+
+QVariantList
+PlaylistRevisionStore::diff( const QStringList& from, const QStringList& to, bool* ok )
+{
+    QVariantList ops;
+    *ok = false;
+
+    // most edits touch a single spot, only look at what's between the common prefix and suffix
+    const int common = qMin( from.count(), to.count() );
+    int prefix = 0;
+    while ( prefix < common && from.at( prefix ) == to.at( prefix ) )
+        prefix++;
+    int suffix = 0;
+    while ( suffix < common - prefix && from.at( from.count() - suffix - 1 ) == to.at( to.count() - suffix - 1 ) )
+        suffix++;
+
+    QStringList current = from.mid( prefix, from.count() - prefix - suffix );
+    const QStringList target = to.mid( prefix, to.count() - prefix - suffix );
+    const QSet< QString > oldGuids = current.toSet();
+    const QSet< QString > newGuids = target.toSet();
+    int cost = 0;
+
+    // runs of removed entries
+    for ( int i = 0; i < current.count(); )
+    {
+        if ( newGuids.contains( current.at( i ) ) )
+        {
+            i++;
+            continue;
+        }
+
+        int count = 1;
+        while ( i + count < current.count() && !newGuids.contains( current.at( i + count ) ) )
+            count++;
+
+        ops << QVariant( QVariantList() << "-" << prefix + i << count );
+        cost++;
+        current.erase( current.begin() + i, current.begin() + i + count );
+    }
+
+    // bring the entries we keep into their new order, moving runs of them
+    QStringList kept;
+    foreach ( const QString& guid, target )
+    {
+        if ( oldGuids.contains( guid ) )
+            kept << guid;
+    }
+    if ( kept.count() != current.count() )
+        return QVariantList();
+
+    int moves = 0;
+    for ( int i = 0; i < kept.count(); )
+    {
+        if ( current.at( i ) == kept.at( i ) )
+        {
+            i++;
+            continue;
+        }
+
+        const int pos = current.indexOf( kept.at( i ), i + 1 );
+        if ( pos < 0 || ++moves > MAX_MOVES )
+            return QVariantList();
+
+        int count = 1;
+        while ( i + count < kept.count() && pos + count < current.count() &&
+                current.at( pos + count ) == kept.at( i + count ) )
+            count++;
+
+        ops << QVariant( QVariantList() << "m" << prefix + pos << count << prefix + i );
+        cost++;
+
+        const QStringList run = current.mid( pos, count );
+        current.erase( current.begin() + pos, current.begin() + pos + count );
+        for ( int j = 0; j < count; j++ )
+            current.insert( i + j, run.at( j ) );
+
+        i += count;
+    }
+
+    // runs of inserted entries, in ascending order everything before them is in place already
+    for ( int i = 0; i < target.count(); )
+    {
+        if ( oldGuids.contains( target.at( i ) ) )
+        {
+            i++;
+            continue;
+        }
+
+        QVariantList guids;
+        while ( i + guids.count() < target.count() && !oldGuids.contains( target.at( i + guids.count() ) ) )
+            guids << target.at( i + guids.count() );
+
+        ops << QVariant( QVariantList() << "+" << prefix + i << QVariant( guids ) );
+        cost += 1 + guids.count();
+        i += guids.count();
+    }
+
+    // not worth it, a snapshot is about as small
+    if ( cost * 2 > to.count() )
+        return QVariantList();
+
+    // duplicate guids could throw the above off, never store a delta that doesn't work out
+    QStringList check = from;
+    if ( !apply( check, ops ) || check != to )
+    {
+        tDebug() << Q_FUNC_INFO << "Delta doesn't reproduce the revision, storing a snapshot";
+        return QVariantList();
+    }
+
+    *ok = true;
+    return ops;
+}
+
+
+bool
+PlaylistRevisionStore::apply( QStringList& entries, const QVariantList& ops )
+{
+    foreach ( const QVariant& v, ops )
+    {
+        const QVariantList op = v.toList();
+        if ( op.count() < 3 )
+            return false;
+
+        const QString type = op.at( 0 ).toString();
+        const int pos = op.at( 1 ).toInt();
+
+        if ( type == "+" )
+        {
+            if ( pos < 0 || pos > entries.count() )
+                return false;
+
+            int i = pos;
+            foreach ( const QVariant& guid, op.at( 2 ).toList() )
+                entries.insert( i++, guid.toString() );
+        }
+        else if ( type == "-" )
+        {
+            const int count = op.at( 2 ).toInt();
+            if ( pos < 0 || count < 0 || pos + count > entries.count() )
+                return false;
+
+            entries.erase( entries.begin() + pos, entries.begin() + pos + count );
+        }
+        else if ( type == "m" && op.count() == 4 )
+        {
+            const int count = op.at( 2 ).toInt();
+            const int to = op.at( 3 ).toInt();
+            if ( pos < 0 || count < 0 || pos + count > entries.count() || to < 0 || to > entries.count() - count )
+                return false;
+
+            const QStringList run = entries.mid( pos, count );
+            entries.erase( entries.begin() + pos, entries.begin() + pos + count );
+            for ( int i = 0; i < count; i++ )
+                entries.insert( to + i, run.at( i ) );
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+QStringList
+PlaylistRevisionStore::entries( DatabaseImpl* lib, const QString& revision, bool* ok )
+{
+    Revision result;
+    const bool loaded = load( lib, revision, result );
+    if ( ok )
+        *ok = loaded;
+
+    return result.entries;
+}
+
+
+QByteArray
+PlaylistRevisionStore::encode( DatabaseImpl* lib, const QString& revision, const QString& previousRevision, const QStringList& entries )
+{
+    Revision previous;
+    if ( !previousRevision.isEmpty() && previousRevision != revision &&
+         load( lib, previousRevision, previous ) && previous.depth + 1 < SNAPSHOT_INTERVAL )
+    {
+        bool ok;
+        const QVariantList ops = diff( previous.entries, entries, &ok );
+        if ( ok )
+        {
+            QVariantMap delta;
+            delta[ "depth" ] = previous.depth + 1;
+            delta[ "ops" ] = ops;
+
+            insert( revision, entries, previous.depth + 1 );
+            return TomahawkUtils::toJson( delta );
+        }
+    }
+
+    insert( revision, entries, 0 );
+    return snapshot( entries );
+}
+
+
+int
+PlaylistRevisionStore::compact( DatabaseImpl* lib, const QString& playlist, int keep )
+{
+    TomahawkSqlQuery query = lib->newquery();
+    query.prepare( "SELECT currentrevision FROM playlist WHERE guid = ?" );
+    query.addBindValue( playlist );
+    if ( !query.exec() || !query.next() )
+        return 0;
+
+    // the revisions we keep: the current one and its predecessors
+    QStringList chain;
+    QString revision = query.value( 0 ).toString();
+    query.prepare( "SELECT previous_revision FROM playlist_revision WHERE guid = ? AND playlist = ?" );
+    while ( !revision.isEmpty() && chain.count() < keep && !chain.contains( revision ) )
+    {
+        query.bindValue( 0, revision );
+        query.bindValue( 1, playlist );
+        if ( !query.exec() || !query.next() )
+            break;
+
+        chain << revision;
+        revision = query.value( 0 ).toString();
+    }
+    if ( chain.isEmpty() )
+        return 0;
+
+    query.prepare( "SELECT COUNT(*) FROM playlist_revision WHERE playlist = ?" );
+    query.addBindValue( playlist );
+    if ( !query.exec() || !query.next() || query.value( 0 ).toInt() <= chain.count() )
+        return 0;
+
+    // the oldest revision we keep can't refer to its predecessors anymore
+    Revision oldest;
+    if ( !load( lib, chain.last(), oldest ) )
+    {
+        tLog() << Q_FUNC_INFO << "Can't reconstruct revision" << chain.last() << "of playlist" << playlist << "- not compacting it";
+        return 0;
+    }
+
+    query.prepare( "UPDATE playlist_revision SET entries = ?, previous_revision = NULL WHERE guid = ?" );
+    query.addBindValue( snapshot( oldest.entries ) );
+    query.addBindValue( chain.last() );
+    query.exec();
+    insert( chain.last(), oldest.entries, 0 );
+
+    QStringList placeholders;
+    for ( int i = 0; i < chain.count(); i++ )
+        placeholders << "?";
+
+    query.prepare( QString( "DELETE FROM playlist_revision WHERE playlist = ? AND guid NOT IN ( %1 )" ).arg( placeholders.join( ", " ) ) );
+    query.addBindValue( playlist );
+    foreach ( const QString& guid, chain )
+        query.addBindValue( guid );
+    if ( !query.exec() )
+        return 0;
+
+    return query.numRowsAffected();
+}
+
+
+void
+PlaylistRevisionStore::clear()
+{
+    QMutexLocker lock( &m_mutex );
+    m_revisions.clear();
+}
+
+
+bool
+PlaylistRevisionStore::load( DatabaseImpl* lib, const QString& revision, Revision& result )
+{
+    // walk back to the closest snapshot, or to a revision we know already
+    QList< QVariantList > deltas;
+    QString guid = revision;
+    bool found = false;
+
+    TomahawkSqlQuery query = lib->newquery();
+    query.prepare( "SELECT entries, previous_revision FROM playlist_revision WHERE guid = ?" );
+
+    while ( deltas.count() < MAX_CHAIN_LENGTH )
+    {
+        {
+            QMutexLocker lock( &m_mutex );
+            if ( Revision* cached = m_revisions.object( guid ) )
+            {
+                result = *cached;
+                found = true;
+                break;
+            }
+        }
+
+        query.bindValue( 0, guid );
+        if ( !query.exec() || !query.next() )
+            break;
+
+        // no entries at all is how empty playlists used to be stored
+        if ( query.value( 0 ).isNull() )
+        {
+            result.entries.clear();
+            result.depth = 0;
+            found = true;
+            break;
+        }
+
+        bool ok;
+        const QVariant v = TomahawkUtils::parseJson( query.value( 0 ).toByteArray(), &ok );
+        if ( !ok )
+            break;
+
+        if ( v.type() == QVariant::List )
+        {
+            result.entries = v.toStringList();
+            result.depth = 0;
+            found = true;
+            break;
+        }
+
+        deltas.prepend( v.toMap().value( "ops" ).toList() );
+        guid = query.value( 1 ).toString();
+        if ( guid.isEmpty() )
+            break;
+    }
+
+    if ( !found )
+    {
+        tLog() << Q_FUNC_INFO << "Broken revision chain for revision" << revision << "at" << guid;
+        return false;
+    }
+
+    foreach ( const QVariantList& ops, deltas )
+    {
+        if ( !apply( result.entries, ops ) )
+        {
+            tLog() << Q_FUNC_INFO << "Can't apply delta for revision" << revision;
+            return false;
+        }
+        result.depth++;
+    }
+
+    insert( revision, result.entries, result.depth );
+
+    return true;
+}
+
+
+void
+PlaylistRevisionStore::insert( const QString& revision, const QStringList& entries, int depth )
+{
+    Revision* r = new Revision;
+    r->entries = entries;
+    r->depth = depth;
+
+    QMutexLocker lock( &m_mutex );
+    m_revisions.insert( revision, r, qMax( 1, entries.count() ) );
+}
+
+}
@@ -0,0 +1,103 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef PLAYLISTREVISIONSTORE_H
+#define PLAYLISTREVISIONSTORE_H
+
+#include "DllMacro.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QStringList>
+#include <QVariant>
+
+namespace Tomahawk
+{
+
+class DatabaseImpl;
+
+/**
+ * Stores the ordered entry guids of playlist revisions.
+ *
+ * Instead of writing the whole list for every revision, a revision only
+ * stores the edit operations (runs of inserted, removed and moved entries)
+ * that turn its previous revision into it. Every SNAPSHOT_INTERVAL
+ * revisions, or when the delta wouldn't be any smaller, the full list gets
+ * written again. Snapshots are plain JSON lists, just like the entries
+ * column always held, deltas are JSON objects:
+ *
+ *   { "depth": 3, "ops": [ [ "-", 4, 2 ], [ "m", 10, 3, 0 ], [ "+", 7, [ guid, ... ] ] ] }
+ *
+ * Reconstructed lists are cached, so the next revision of a playlist can be
+ * diffed without going back to the database. One instance is shared by all
+ * DatabaseImpl clones, so it is thread-safe.
+ */
+class DLLEXPORT PlaylistRevisionStore
+{
+public:
+    explicit PlaylistRevisionStore( int capacity );
+    ~PlaylistRevisionStore();
+
+    /**
+     * Computes the operations turning from into to. Sets ok to false if
+     * there's no delta that is cheaper than storing to as a whole.
+     */
+    static QVariantList diff( const QStringList& from, const QStringList& to, bool* ok );
+    /// Applies the operations from diff() to entries, false if they don't fit.
+    static bool apply( QStringList& entries, const QVariantList& ops );
+
+    /**
+     * The entry guids of revision, walking back its previous revisions to
+     * the last snapshot if need be. Sets ok to false if the chain is broken.
+     */
+    QStringList entries( DatabaseImpl* lib, const QString& revision, bool* ok = 0 );
+
+    /**
+     * What to store in the entries column for a new revision: a delta
+     * against previousRevision where possible, a snapshot otherwise.
+     */
+    QByteArray encode( DatabaseImpl* lib, const QString& revision, const QString& previousRevision, const QStringList& entries );
+
+    /**
+     * Drops all revisions of playlist except for the keep latest ones of
+     * its current revision's chain, the oldest of which becomes a snapshot.
+     * Returns the number of deleted revisions.
+     */
+    int compact( DatabaseImpl* lib, const QString& playlist, int keep );
+
+    void clear();
+
+private:
+    struct Revision
+    {
+        QStringList entries;
+        int depth;
+    };
+
+    bool load( DatabaseImpl* lib, const QString& revision, Revision& result );
+    void insert( const QString& revision, const QStringList& entries, int depth );
+
+    mutable QMutex m_mutex;
+    QCache< QString, Revision > m_revisions;
+};
+
+}
+
+#endif // PLAYLISTREVISIONSTORE_H
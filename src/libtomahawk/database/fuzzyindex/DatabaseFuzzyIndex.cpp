@@ -29,8 +29,8 @@ namespace Tomahawk {
 
 static QString s_indexPathName = "tomahawk.lucene";
 
-DatabaseFuzzyIndex::DatabaseFuzzyIndex( QObject* parent, bool wipe )
-    : FuzzyIndex( parent, s_indexPathName, wipe )
+DatabaseFuzzyIndex::DatabaseFuzzyIndex( QObject* parent, bool wipe, const QString& path )
+    : FuzzyIndex( parent, path.isEmpty() ? s_indexPathName : path, wipe )
 {
 }
 
@@ -38,6 +38,10 @@ DatabaseFuzzyIndex::DatabaseFuzzyIndex( QObject* parent, bool wipe )
 void
 DatabaseFuzzyIndex::updateIndex()
 {
+    // e.g. a standalone DatabaseImpl in the test tools
+    if ( !Tomahawk::Database::instance() )
+        return;
+
     Tomahawk::DatabaseCommand* cmd = new Tomahawk::DatabaseCommand_UpdateSearchIndex();
     Tomahawk::Database::instance()->enqueue( Tomahawk::dbcmd_ptr( cmd ) );
 }
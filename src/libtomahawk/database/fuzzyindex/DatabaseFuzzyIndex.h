@@ -26,7 +26,8 @@ namespace Tomahawk {
 class DatabaseFuzzyIndex : public FuzzyIndex
 {
 public:
-    explicit DatabaseFuzzyIndex( QObject* parent, bool wipe = false );
+    /// An empty path means the default index in the data dir, the one wipeIndex() removes.
+    explicit DatabaseFuzzyIndex( QObject* parent, bool wipe = false, const QString& path = QString() );
 
     virtual void updateIndex();
     static void wipeIndex();
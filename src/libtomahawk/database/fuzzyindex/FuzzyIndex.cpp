@@ -45,8 +45,7 @@ FuzzyIndex::FuzzyIndex( QObject* parent, const QString& filename, bool wipe )
     {
         m_analyzer = newLucene<SimpleAnalyzer>();
         m_luceneDir = FSDirectory::open( m_lucenePath.toStdWString() );
-        m_luceneReader = IndexReader::open( m_luceneDir );
-        m_luceneSearcher = newLucene<IndexSearcher>( m_luceneReader );
+        setReader( IndexReader::open( m_luceneDir ) );
     }
     catch ( LuceneException& error )
     {
@@ -68,6 +67,9 @@ FuzzyIndex::FuzzyIndex( QObject* parent, const QString& filename, bool wipe )
 FuzzyIndex::~FuzzyIndex()
 {
     tLog( LOGVERBOSE ) << Q_FUNC_INFO;
+
+    QMutexLocker lock( &m_mutex );
+    closeWriter();
 }
 
 
@@ -100,6 +102,7 @@ FuzzyIndex::beginIndexing()
     try
     {
         tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Starting indexing:" << m_lucenePath;
+        closeWriter();
         m_luceneWriter = newLucene<IndexWriter>( m_luceneDir, m_analyzer, true, IndexWriter::MaxFieldLengthLIMITED );
     }
     catch( LuceneException& error )
@@ -118,8 +121,7 @@ FuzzyIndex::endIndexing()
     m_luceneWriter->close();
     m_luceneWriter.reset();
 
-    m_luceneReader = IndexReader::open( m_luceneDir );
-    m_luceneSearcher = newLucene<IndexSearcher>( m_luceneReader );
+    setReader( IndexReader::open( m_luceneDir ) );
 
     m_mutex.unlock();
     emit indexReady();
@@ -148,7 +150,7 @@ FuzzyIndex::appendFields( const Tomahawk::IndexData& data )
                                        Field::STORE_YES, Field::INDEX_NO ) );
 
             doc->add(newLucene<Field>( L"trackid", QString::number( data.id ).toStdWString(),
-                                       Field::STORE_YES, Field::INDEX_NO ) );
+                                       Field::STORE_YES, Field::INDEX_NOT_ANALYZED_NO_NORMS ) );
         }
         else if ( !data.album.isEmpty() )
         {
@@ -156,7 +158,7 @@ FuzzyIndex::appendFields( const Tomahawk::IndexData& data )
                                        Field::STORE_NO, Field::INDEX_NOT_ANALYZED_NO_NORMS ) );
 
             doc->add(newLucene<Field>( L"albumid", QString::number( data.id ).toStdWString(),
-                                       Field::STORE_YES, Field::INDEX_NO ) );
+                                       Field::STORE_YES, Field::INDEX_NOT_ANALYZED_NO_NORMS ) );
         }
         else
             return;
@@ -172,17 +174,199 @@ FuzzyIndex::appendFields( const Tomahawk::IndexData& data )
 }
 
 
+void
+FuzzyIndex::updateDocuments( const QList< Tomahawk::IndexData >& data )
+{
+    if ( data.isEmpty() )
+        return;
+
+    QMutexLocker lock( &m_mutex );
+
+    QTime t;
+    t.start();
+
+    try
+    {
+        openWriter();
+
+        foreach ( const Tomahawk::IndexData& d, data )
+        {
+            const TermPtr term = documentTerm( d );
+            if ( term )
+                m_luceneWriter->deleteDocuments( term );
+
+            appendFields( d );
+        }
+
+        commitAndReopen();
+    }
+    catch( LuceneException& error )
+    {
+        tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() );
+        closeWriter();
+
+        QTimer::singleShot( 0, this, SLOT( wipeIndex() ) );
+        return;
+    }
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Updated" << data.count() << "documents in index in" << t.elapsed() << "ms";
+}
+
+
+void
+FuzzyIndex::removeDocuments( const QList< unsigned int >& trackIds, const QList< unsigned int >& albumIds )
+{
+    if ( trackIds.isEmpty() && albumIds.isEmpty() )
+        return;
+
+    QMutexLocker lock( &m_mutex );
+
+    try
+    {
+        openWriter();
+
+        foreach ( unsigned int id, trackIds )
+            m_luceneWriter->deleteDocuments( newLucene<Term>( L"trackid", QString::number( id ).toStdWString() ) );
+        foreach ( unsigned int id, albumIds )
+            m_luceneWriter->deleteDocuments( newLucene<Term>( L"albumid", QString::number( id ).toStdWString() ) );
+
+        commitAndReopen();
+    }
+    catch( LuceneException& error )
+    {
+        tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() );
+        closeWriter();
+
+        QTimer::singleShot( 0, this, SLOT( wipeIndex() ) );
+        return;
+    }
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Removed" << trackIds.count() << "tracks and" << albumIds.count() << "albums from index";
+}
+
+
+QList< Tomahawk::IndexData >
+FuzzyIndex::missingDocuments( const QList< Tomahawk::IndexData >& data )
+{
+    QList< Tomahawk::IndexData > missing;
+
+    IndexReaderPtr reader;
+    IndexSearcherPtr searcher;
+    currentReader( reader, searcher );
+    if ( !reader )
+        return data;
+
+    try
+    {
+        foreach ( const Tomahawk::IndexData& d, data )
+        {
+            const TermPtr term = documentTerm( d );
+            if ( !term )
+                continue;
+
+            // docFreq() would still count deleted documents
+            TermDocsPtr docs = reader->termDocs( term );
+            if ( !docs->next() )
+                missing << d;
+            docs->close();
+        }
+    }
+    catch( LuceneException& error )
+    {
+        tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() );
+        return data;
+    }
+
+    return missing;
+}
+
+
+TermPtr
+FuzzyIndex::documentTerm( const Tomahawk::IndexData& data ) const
+{
+    if ( !data.track.isEmpty() )
+        return newLucene<Term>( L"trackid", QString::number( data.id ).toStdWString() );
+    if ( !data.album.isEmpty() )
+        return newLucene<Term>( L"albumid", QString::number( data.id ).toStdWString() );
+
+    return TermPtr();
+}
+
+
+void
+FuzzyIndex::openWriter()
+{
+    // The writer is kept open between updates, so the reader can be
+    // refreshed from it instead of being reopened from disk every time.
+    if ( !m_luceneWriter )
+        m_luceneWriter = newLucene<IndexWriter>( m_luceneDir, m_analyzer, false, IndexWriter::MaxFieldLengthLIMITED );
+}
+
+
+void
+FuzzyIndex::closeWriter()
+{
+    if ( !m_luceneWriter )
+        return;
+
+    try
+    {
+        m_luceneWriter->close();
+    }
+    catch( LuceneException& error )
+    {
+        tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() );
+    }
+
+    m_luceneWriter.reset();
+}
+
+
+void
+FuzzyIndex::commitAndReopen()
+{
+    m_luceneWriter->commit();
+
+    // near real-time reader, shares all unchanged segments with the previous one
+    setReader( m_luceneWriter->getReader() );
+}
+
+
+void
+FuzzyIndex::setReader( const IndexReaderPtr& reader )
+{
+    IndexSearcherPtr searcher = reader ? newLucene<IndexSearcher>( reader ) : IndexSearcherPtr();
+
+    QMutexLocker lock( &m_readerMutex );
+    m_luceneReader = reader;
+    m_luceneSearcher = searcher;
+}
+
+
+void
+FuzzyIndex::currentReader( IndexReaderPtr& reader, IndexSearcherPtr& searcher ) const
+{
+    QMutexLocker lock( &m_readerMutex );
+    reader = m_luceneReader;
+    searcher = m_luceneSearcher;
+}
+
+
 void
 FuzzyIndex::deleteIndex()
 {
-    if ( m_luceneReader )
+    closeWriter();
+
+    IndexReaderPtr reader;
+    IndexSearcherPtr searcher;
+    currentReader( reader, searcher );
+    if ( reader )
     {
         tDebug( LOGVERBOSE ) << "Deleting old lucene stuff.";
 
-        m_luceneSearcher->close();
-        m_luceneReader->close();
-        m_luceneSearcher.reset();
-        m_luceneReader.reset();
+        setReader( IndexReaderPtr() );
+        searcher->close();
+        reader->close();
     }
 
     TomahawkUtils::removeDirectory( m_lucenePath );
@@ -206,66 +390,86 @@ FuzzyIndex::loadLuceneIndex()
 QMap< int, float >
 FuzzyIndex::search( const Tomahawk::query_ptr& query )
 {
-//    QMutexLocker lock( &m_mutex );
-    QMap< int, float > resultsmap;
-    if ( !m_luceneReader || !m_luceneSearcher )
-        return resultsmap;
-
-    try
-    {
-//        float minScore = 0.00;
-        Collection<String> fields; // = newCollection<String>();
-        BooleanQueryPtr qry = newLucene<BooleanQuery>();
-
-        if ( query->isFullTextQuery() )
-        {
-            const QString q = Tomahawk::DatabaseImpl::sortname( query->fullTextQuery() );
+    return search( QList< Tomahawk::query_ptr >() << query ).value( query->id() );
+}
 
-            FuzzyQueryPtr fqry = newLucene<FuzzyQuery>( newLucene<Term>( L"track", q.toStdWString() ) );
-            qry->add( boost::dynamic_pointer_cast<Query>( fqry ), BooleanClause::SHOULD );
 
-            FuzzyQueryPtr fqry2 = newLucene<FuzzyQuery>( newLucene<Term>( L"artist", q.toStdWString() ) );
-            qry->add( boost::dynamic_pointer_cast<Query>( fqry2 ), BooleanClause::SHOULD );
+QHash< Tomahawk::QID, QMap< int, float > >
+FuzzyIndex::search( const QList< Tomahawk::query_ptr >& queries )
+{
+    QHash< Tomahawk::QID, QMap< int, float > > results;
+
+    // hold on to the current searcher for the whole batch, even if the index gets reloaded meanwhile
+    IndexReaderPtr reader;
+    IndexSearcherPtr searcher;
+    currentReader( reader, searcher );
+    if ( !reader || !searcher )
+        return results;
+
+    // A batch tends to ask for the same artists (and often the same tracks)
+    // over and over again. Expanding a fuzzy term against the index is the
+    // expensive part of a search, so every distinct term only gets rewritten
+    // once and we keep the doc -> trackid mapping around for the whole batch.
+    QHash< QString, QueryPtr > rewritten;
+    QHash< int32_t, int > trackIds;
+
+    foreach ( const Tomahawk::query_ptr& query, queries )
+    {
+        QMap< int, float >& resultsmap = results[ query->id() ];
 
-            FuzzyQueryPtr fqry3 = newLucene<FuzzyQuery>( newLucene<Term>( L"fulltext", q.toStdWString() ) );
-            qry->add( boost::dynamic_pointer_cast<Query>( fqry3 ), BooleanClause::SHOULD );
-        }
-        else
+        try
         {
-            const QString track = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->track() );
-            const QString artist = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->artist() );
-            //QString album = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->album() );
+//            float minScore = 0.00;
+            BooleanQueryPtr qry = newLucene<BooleanQuery>();
 
-            FuzzyQueryPtr fqry = newLucene<FuzzyQuery>( newLucene<Term>( L"track", track.toStdWString() ), 0.5, 3 );
-            qry->add( boost::dynamic_pointer_cast<Query>( fqry ), BooleanClause::MUST );
+            if ( query->isFullTextQuery() )
+            {
+                const QString q = Tomahawk::DatabaseImpl::sortname( query->fullTextQuery() );
 
-            FuzzyQueryPtr fqry2 = newLucene<FuzzyQuery>( newLucene<Term>( L"artist", artist.toStdWString() ), 0.5, 3 );
-            qry->add( boost::dynamic_pointer_cast<Query>( fqry2 ), BooleanClause::MUST );
-        }
+                qry->add( fuzzyQuery( rewritten, reader, L"track", q ), BooleanClause::SHOULD );
+                qry->add( fuzzyQuery( rewritten, reader, L"artist", q ), BooleanClause::SHOULD );
+                qry->add( fuzzyQuery( rewritten, reader, L"fulltext", q ), BooleanClause::SHOULD );
+            }
+            else
+            {
+                const QString track = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->track() );
+                const QString artist = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->artist() );
+                //QString album = Tomahawk::DatabaseImpl::sortname( query->queryTrack()->album() );
 
-        TopScoreDocCollectorPtr collector = TopScoreDocCollector::create( 20, true );
-        m_luceneSearcher->search( qry, collector );
-        Collection<ScoreDocPtr> hits = collector->topDocs()->scoreDocs;
+                qry->add( fuzzyQuery( rewritten, reader, L"track", track, 0.5, 3 ), BooleanClause::MUST );
+                qry->add( fuzzyQuery( rewritten, reader, L"artist", artist, 0.5, 3 ), BooleanClause::MUST );
+            }
 
-        for ( int i = 0; i < collector->getTotalHits() && i < 20; i++ )
-        {
-            DocumentPtr d = m_luceneSearcher->doc( hits[i]->doc );
-            const float score = hits[i]->score;
-            const int id = QString::fromStdWString( d->get( L"trackid" ) ).toInt();
+            TopScoreDocCollectorPtr collector = TopScoreDocCollector::create( 20, true );
+            searcher->search( qry, collector );
+            Collection<ScoreDocPtr> hits = collector->topDocs()->scoreDocs;
 
-//            if ( score > minScore )
+            for ( int i = 0; i < collector->getTotalHits() && i < 20; i++ )
             {
-                resultsmap.insert( id, score );
-//                tDebug() << "Index hit:" << id << score << QString::fromWCharArray( ((Query*)qry)->toString() );
+                const int32_t doc = hits[i]->doc;
+                const float score = hits[i]->score;
+
+                QHash< int32_t, int >::const_iterator it = trackIds.constFind( doc );
+                if ( it == trackIds.constEnd() )
+                {
+                    DocumentPtr d = searcher->doc( doc );
+                    it = trackIds.insert( doc, QString::fromStdWString( d->get( L"trackid" ) ).toInt() );
+                }
+
+//                if ( score > minScore )
+                {
+                    resultsmap.insert( it.value(), score );
+//                    tDebug() << "Index hit:" << it.value() << score << QString::fromWCharArray( ((Query*)qry)->toString() );
+                }
             }
         }
-    }
-    catch( LuceneException& error )
-    {
-        tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() ) << query->toString();
+        catch( LuceneException& error )
+        {
+            tDebug() << "Caught Lucene error:" << QString::fromWCharArray( error.getError().c_str() ) << query->toString();
+        }
     }
 
-    return resultsmap;
+    return results;
 }
 
 
@@ -274,9 +478,11 @@ FuzzyIndex::searchAlbum( const Tomahawk::query_ptr& query )
 {
     Q_ASSERT( query->isFullTextQuery() );
 
-//    QMutexLocker lock( &m_mutex );
     QMap< int, float > resultsmap;
-    if ( !m_luceneReader || !m_luceneSearcher )
+    IndexReaderPtr reader;
+    IndexSearcherPtr searcher;
+    currentReader( reader, searcher );
+    if ( !reader || !searcher )
         return resultsmap;
 
     try
@@ -286,12 +492,12 @@ FuzzyIndex::searchAlbum( const Tomahawk::query_ptr& query )
 
         FuzzyQueryPtr qry = newLucene<FuzzyQuery>( newLucene<Term>( L"album", q.toStdWString() ) );
         TopScoreDocCollectorPtr collector = TopScoreDocCollector::create( 99999, false );
-        m_luceneSearcher->search( boost::dynamic_pointer_cast<Query>( qry ), collector );
+        searcher->search( boost::dynamic_pointer_cast<Query>( qry ), collector );
         Collection<ScoreDocPtr> hits = collector->topDocs()->scoreDocs;
 
         for ( int i = 0; i < collector->getTotalHits(); i++ )
         {
-            DocumentPtr d = m_luceneSearcher->doc( hits[i]->doc );
+            DocumentPtr d = searcher->doc( hits[i]->doc );
             float score = hits[i]->score;
             int id = QString::fromStdWString( d->get( L"albumid" ) ).toInt();
 
@@ -309,3 +515,24 @@ FuzzyIndex::searchAlbum( const Tomahawk::query_ptr& query )
 
     return resultsmap;
 }
+
+
+QueryPtr
+FuzzyIndex::fuzzyQuery( QHash< QString, QueryPtr >& cache, const IndexReaderPtr& reader,
+                        const String& field, const QString& text, double minSimilarity, int prefixLength )
+{
+    const QString key = QString( "%1\t%2\t%3\t%4" ).arg( QString::fromStdWString( field ) )
+                                                    .arg( minSimilarity )
+                                                    .arg( prefixLength )
+                                                    .arg( text );
+
+    QHash< QString, QueryPtr >::const_iterator it = cache.constFind( key );
+    if ( it != cache.constEnd() )
+        return it.value();
+
+    FuzzyQueryPtr fqry = newLucene<FuzzyQuery>( newLucene<Term>( field, text.toStdWString() ), minSimilarity, prefixLength );
+    QueryPtr qry = fqry->rewrite( reader );
+    cache.insert( key, qry );
+
+    return qry;
+}
@@ -42,6 +42,18 @@ public:
     void endIndexing();
     void appendFields( const Tomahawk::IndexData& data );
 
+    /**
+     * Adds documents to the existing index, replacing any document with the
+     * same track / album id, and makes them searchable right away without
+     * rebuilding the whole index. Must not be called between
+     * beginIndexing() and endIndexing().
+     */
+    void updateDocuments( const QList< Tomahawk::IndexData >& data );
+    void removeDocuments( const QList< unsigned int >& trackIds, const QList< unsigned int >& albumIds );
+
+    /// The entries of data that have no document in the index yet.
+    QList< Tomahawk::IndexData > missingDocuments( const QList< Tomahawk::IndexData >& data );
+
     /**
      * Delete the index from the harddrive.
      *
@@ -60,13 +72,28 @@ public slots:
     bool wipeIndex();
 
     QMap< int, float > search( const Tomahawk::query_ptr& query );
+    QHash< Tomahawk::QID, QMap< int, float > > search( const QList< Tomahawk::query_ptr >& queries );
     QMap< int, float > searchAlbum( const Tomahawk::query_ptr& query );
 
 private slots:
     void updateIndexSlot();
 
 private:
+    Lucene::TermPtr documentTerm( const Tomahawk::IndexData& data ) const;
+    void openWriter();
+    void closeWriter();
+    void commitAndReopen();
+    void setReader( const Lucene::IndexReaderPtr& reader );
+    void currentReader( Lucene::IndexReaderPtr& reader, Lucene::IndexSearcherPtr& searcher ) const;
+
+    Lucene::QueryPtr fuzzyQuery( QHash< QString, Lucene::QueryPtr >& cache, const Lucene::IndexReaderPtr& reader,
+                                 const Lucene::String& field, const QString& text,
+                                 double minSimilarity = 0.5, int prefixLength = 0 );
+
     QMutex m_mutex;
+    // guards swapping m_luceneReader / m_luceneSearcher. m_mutex is held for
+    // whole indexing runs, searches must not wait for those.
+    mutable QMutex m_readerMutex;
     QString m_lucenePath;
 
     boost::shared_ptr<Lucene::SimpleAnalyzer> m_analyzer;
@@ -35,6 +35,12 @@
 
 #include "config.h"
 
+#include <QFutureWatcher>
+#include <qtconcurrentrun.h>
+
+// how many files per tag reading thread may be queued up in the scanner
+#define SCAN_QUEUE_SLOTS_PER_THREAD 16
+
 using namespace Tomahawk;
 
 void
@@ -79,7 +85,12 @@ DirLister::scanDir( QDir dir, int depth )
     dir.setSorting( QDir::Name );
     filteredEntries = dir.entryInfoList();
     foreach ( const QFileInfo& di, filteredEntries )
+    {
+        if ( !waitForQueueSlot() )
+            break;
+
         emit fileToScan( di );
+    }
 
     dir.setFilter( QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot );
     filteredEntries = dir.entryInfoList();
@@ -99,8 +110,23 @@ DirLister::scanDir( QDir dir, int depth )
 }
 
 
+bool
+DirLister::waitForQueueSlot()
+{
+    // block until the scanner has caught up, but keep an eye on being stopped
+    while ( !m_queueSlots->tryAcquire( 1, 100 ) )
+    {
+        if ( isDeleting() )
+            return false;
+    }
+
+    return true;
+}
+
+
 DirListerThreadController::DirListerThreadController( QObject *parent )
     : QThread( parent )
+    , m_queueSlots( 0 )
 {
     tDebug( LOGVERBOSE ) << Q_FUNC_INFO;
 }
@@ -115,7 +141,7 @@ DirListerThreadController::~DirListerThreadController()
 void
 DirListerThreadController::run()
 {
-    m_dirLister = QPointer< DirLister >( new DirLister( m_paths ) );
+    m_dirLister = QPointer< DirLister >( new DirLister( m_paths, m_queueSlots ) );
     connect( m_dirLister.data(), SIGNAL( fileToScan( QFileInfo ) ),
              parent(), SLOT( scanFile( QFileInfo ) ), Qt::QueuedConnection );
 
@@ -131,6 +157,14 @@ DirListerThreadController::run()
 }
 
 
+void
+DirListerThreadController::abort()
+{
+    if ( !m_dirLister.isNull() )
+        m_dirLister->setIsDeleting();
+}
+
+
 MusicScanner::MusicScanner( MusicScanner::ScanMode scanMode, const QStringList& paths, quint32 bs )
     : QObject()
     , m_scanMode( scanMode )
@@ -140,6 +174,8 @@ MusicScanner::MusicScanner( MusicScanner::ScanMode scanMode, const QStringList&
     , m_verbose( false )
     , m_cmdQueue( 0 )
     , m_batchsize( bs )
+    , m_threadCount( qMax( 1, QThread::idealThreadCount() ) )
+    , m_postOpsPending( false )
     , m_dirListerThreadController( 0 )
 {
 }
@@ -151,6 +187,7 @@ MusicScanner::~MusicScanner()
 
     if ( m_dirListerThreadController )
     {
+        m_dirListerThreadController->abort();
         m_dirListerThreadController->quit();
         m_dirListerThreadController->wait( 60000 );
 
@@ -188,6 +225,27 @@ MusicScanner::verbose()
 }
 
 
+void
+MusicScanner::setThreadCount( int threadCount )
+{
+    m_threadCount = qMax( 1, threadCount );
+}
+
+
+int
+MusicScanner::threadCount() const
+{
+    return m_threadCount;
+}
+
+
+unsigned int
+MusicScanner::scannedFiles() const
+{
+    return m_scanned;
+}
+
+
 void
 MusicScanner::startScan()
 {
@@ -224,8 +282,12 @@ MusicScanner::scan()
 {
     tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Num saved file mtimes from last scan:" << m_filemtimes.size();
 
-    connect( this, SIGNAL( batchReady( QVariantList, QVariantList ) ),
-                     SLOT( commitBatch( QVariantList, QVariantList ) ), Qt::DirectConnection );
+    connect( this, SIGNAL( batchReady( QList< Tomahawk::ScannedFile >, QVariantList ) ),
+                     SLOT( commitBatch( QList< Tomahawk::ScannedFile >, QVariantList ) ), Qt::DirectConnection );
+
+    m_tagReaderPool.setMaxThreadCount( m_threadCount );
+    m_queueSlots.release( m_threadCount * SCAN_QUEUE_SLOTS_PER_THREAD );
+    m_postOpsPending = false;
 
     if ( m_scanMode == MusicScanner::FileScan )
     {
@@ -235,6 +297,7 @@ MusicScanner::scan()
 
     m_dirListerThreadController = new DirListerThreadController( this );
     m_dirListerThreadController->setPaths( m_paths );
+    m_dirListerThreadController->setQueueSlots( &m_queueSlots );
     m_dirListerThreadController->start( QThread::IdlePriority );
 }
 
@@ -259,6 +322,14 @@ MusicScanner::postOps()
 {
     tDebug( LOGVERBOSE ) << Q_FUNC_INFO;
 
+    // wait for the tag readers to finish, tagsRead() calls us again
+    if ( !m_pendingFiles.isEmpty() )
+    {
+        m_postOpsPending = true;
+        return;
+    }
+    m_postOpsPending = false;
+
     if ( m_scanMode == MusicScanner::DirScan )
     {
         // any remaining stuff that wasnt emitted as a batch:
@@ -276,11 +347,9 @@ MusicScanner::postOps()
 
     if ( !m_filesToDelete.isEmpty() || !m_scannedfiles.isEmpty() )
     {
+        // AddFiles updates the search index with the tracks it adds
         if ( !m_dryRun )
-        {
-            SourceList::instance()->getLocal()->updateIndexWhenSynced();
             commitBatch( m_scannedfiles, m_filesToDelete );
-        }
         m_scannedfiles.clear();
         m_filesToDelete.clear();
     }
@@ -297,6 +366,7 @@ MusicScanner::cleanup()
 {
     if ( m_dirListerThreadController )
     {
+        m_dirListerThreadController->abort();
         m_dirListerThreadController->quit();
         m_dirListerThreadController->wait( 60000 );
 
@@ -310,7 +380,7 @@ MusicScanner::cleanup()
 
 
 void
-MusicScanner::commitBatch( const QVariantList& tracks, const QVariantList& deletethese )
+MusicScanner::commitBatch( const QList< ScannedFile >& tracks, const QVariantList& deletethese )
 {
     if ( !deletethese.isEmpty() )
     {
@@ -351,7 +421,10 @@ MusicScanner::scanFile( const QFileInfo& fi )
 {
     // Don't process a single file twice, this might happen if you add a subfolder of another collection folder to your collection
     if ( m_processedFiles.contains( fi.canonicalFilePath() ) )
+    {
+        releaseQueueSlot();
         return;
+    }
     else
         m_processedFiles << fi.canonicalFilePath();
 
@@ -362,6 +435,7 @@ MusicScanner::scanFile( const QFileInfo& fi )
                 fi.lastModified().toUTC().toTime_t() == m_filemtimes.value( "file://" + fi.canonicalFilePath() ).values().first() )
         {
             m_filemtimes.remove( "file://" + fi.canonicalFilePath() );
+            releaseQueueSlot();
             return;
         }
 
@@ -370,17 +444,35 @@ MusicScanner::scanFile( const QFileInfo& fi )
         m_filemtimes.remove( "file://" + fi.canonicalFilePath() );
     }
 
-    QVariant m = readFile( fi );
-    if ( m.toMap().isEmpty() )
-        return;
+    readFile( fi );
+}
+
+
+void
+MusicScanner::releaseQueueSlot()
+{
+    // only files coming from the DirLister occupy a queue slot
+    if ( m_scanMode == MusicScanner::DirScan )
+        m_queueSlots.release();
+}
+
 
-    m_scannedfiles << m;
-    if ( m_batchsize != 0 && (quint32)m_scannedfiles.length() >= m_batchsize )
+void
+MusicScanner::tagsRead()
+{
+    QFutureWatcher< ScannedFile >* watcher = static_cast< QFutureWatcher< ScannedFile >* >( sender() );
+    watcher->deleteLater();
+
+    // results are committed in the order files were listed, no matter which reader finished first
+    while ( !m_pendingFiles.isEmpty() && m_pendingFiles.first().second.isFinished() )
     {
-        emit batchReady( m_scannedfiles, m_filesToDelete );
-        m_scannedfiles.clear();
-        m_filesToDelete.clear();
+        const QPair< QFileInfo, QFuture< ScannedFile > > file = m_pendingFiles.takeFirst();
+        addScannedFile( file.first, file.second.result() );
+        releaseQueueSlot();
     }
+
+    if ( m_pendingFiles.isEmpty() && m_postOpsPending )
+        postOps();
 }
 
 
@@ -447,11 +539,33 @@ MusicScanner::readTags( const QFileInfo& fi )
 }
 
 
-QVariant
+ScannedFile
+MusicScanner::readScannedFile( const QFileInfo& fi )
+{
+    return ScannedFile::fromVariant( readTags( fi ) );
+}
+
+
+void
 MusicScanner::readFile( const QFileInfo& fi )
 {
-    const QVariant m = readTags( fi );
+    // readTags only reads the file itself and constant lookup tables, so it's safe to run in parallel
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 4, 0 )
+    QFuture< ScannedFile > future = QtConcurrent::run( &m_tagReaderPool, &MusicScanner::readScannedFile, fi );
+#else
+    QFuture< ScannedFile > future = QtConcurrent::run( &MusicScanner::readScannedFile, fi );
+#endif
+    m_pendingFiles << qMakePair( fi, future );
+
+    QFutureWatcher< ScannedFile >* watcher = new QFutureWatcher< ScannedFile >( this );
+    connect( watcher, SIGNAL( finished() ), SLOT( tagsRead() ), Qt::QueuedConnection );
+    watcher->setFuture( future );
+}
 
+
+void
+MusicScanner::addScannedFile( const QFileInfo& fi, const ScannedFile& file )
+{
     if ( m_scanned )
         if ( m_scanned % 3 == 0 )
             emit progress( m_scanned );
@@ -459,7 +573,7 @@ MusicScanner::readFile( const QFileInfo& fi )
     if ( m_scanned % 100 == 0 || m_verbose )
         tDebug( LOGINFO ) << Q_FUNC_INFO << "Scanning file:" << m_scanned << fi.canonicalFilePath();
 
-    if ( m.toMap().isEmpty() )
+    if ( !file.isValid() )
     {
         m_skippedFiles << fi.canonicalFilePath();
         m_skipped++;
@@ -467,8 +581,14 @@ MusicScanner::readFile( const QFileInfo& fi )
     else
     {
         m_scanned++;
-    }
 
-    return m;
+        m_scannedfiles << file;
+        if ( m_batchsize != 0 && (quint32)m_scannedfiles.length() >= m_batchsize )
+        {
+            emit batchReady( m_scannedfiles, m_filesToDelete );
+            m_scannedfiles.clear();
+            m_filesToDelete.clear();
+        }
+    }
 }
 
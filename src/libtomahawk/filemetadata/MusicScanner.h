@@ -22,6 +22,7 @@
 
 #include "database/Database.h"
 #include "database/DatabaseCommand.h"
+#include "filemetadata/ScannedFile.h"
 #include "TomahawkSettings.h"
 
 /* taglib */
@@ -31,11 +32,14 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <QFuture>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QPointer>
+#include <QSemaphore>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QVariantMap>
 
@@ -48,8 +52,8 @@ Q_OBJECT
 
 public:
 
-    DirLister( const QStringList& dirs )
-        : QObject(), m_dirs( dirs ), m_opcount( 0 ), m_deleting( false )
+    DirLister( const QStringList& dirs, QSemaphore* queueSlots )
+        : QObject(), m_dirs( dirs ), m_queueSlots( queueSlots ), m_opcount( 0 ), m_deleting( false )
     {
         qDebug() << Q_FUNC_INFO;
     }
@@ -71,8 +75,12 @@ private slots:
     void scanDir( QDir dir, int depth );
 
 private:
+    bool waitForQueueSlot();
+
     QStringList m_dirs;
     QSet< QString > m_processedDirs;
+    // one slot per file that may be in flight in the scanner, bounds its queue
+    QSemaphore* m_queueSlots;
 
     uint m_opcount;
     QMutex m_deletingMutex;
@@ -88,11 +96,16 @@ public:
     virtual ~DirListerThreadController();
 
     void setPaths( const QStringList& paths ) { m_paths = paths; }
+    void setQueueSlots( QSemaphore* queueSlots ) { m_queueSlots = queueSlots; }
     void run();
 
+    /// Stop listing, the DirLister may be waiting for a free queue slot.
+    void abort();
+
 private:
     QPointer< DirLister > m_dirLister;
     QStringList m_paths;
+    QSemaphore* m_queueSlots;
 };
 
 class DLLEXPORT MusicScanner : public QObject
@@ -104,6 +117,8 @@ public:
     enum ScanType { None, Full, Normal, File };
 
     static QVariant readTags( const QFileInfo& fi );
+    /// Like readTags(), returns an invalid ScannedFile for unsupported / untagged files.
+    static Tomahawk::ScannedFile readScannedFile( const QFileInfo& fi );
 
     MusicScanner( MusicScanner::ScanMode scanMode, const QStringList& paths, quint32 bs = 0 );
     ~MusicScanner();
@@ -124,14 +139,26 @@ public:
     void setVerbose( bool _verbose );
     bool verbose();
 
+    /**
+     * Number of threads reading tags in parallel. Defaults to
+     * QThread::idealThreadCount(). Has to be set before the scan is started.
+     */
+    void setThreadCount( int threadCount );
+    int threadCount() const;
+
+    /// Number of files with valid tags found by the last scan
+    unsigned int scannedFiles() const;
+
 signals:
     //void fileScanned( QVariantMap );
     void finished();
-    void batchReady( const QVariantList&, const QVariantList& );
+    void batchReady( const QList< Tomahawk::ScannedFile >&, const QVariantList& );
     void progress( unsigned int files );
 
 private:
-    QVariant readFile( const QFileInfo& fi );
+    void readFile( const QFileInfo& fi );
+    void addScannedFile( const QFileInfo& fi, const Tomahawk::ScannedFile& file );
+    void releaseQueueSlot();
     void executeCommand( Tomahawk::dbcmd_ptr cmd );
 
 private slots:
@@ -141,8 +168,9 @@ private slots:
     void startScan();
     void scan();
     void cleanup();
-    void commitBatch( const QVariantList& tracks, const QVariantList& deletethese );
+    void commitBatch( const QList< Tomahawk::ScannedFile >& tracks, const QVariantList& deletethese );
     void commandFinished();
+    void tagsRead();
 
 private:
     void scanFilePaths();
@@ -160,10 +188,17 @@ private:
     unsigned int m_cmdQueue;
 
     QSet< QString > m_processedFiles;
-    QVariantList m_scannedfiles;
+    QList< Tomahawk::ScannedFile > m_scannedfiles;
     QVariantList m_filesToDelete;
     quint32 m_batchsize;
 
+    // files handed to the tag reader pool, in the order they have to be committed in
+    QList< QPair< QFileInfo, QFuture< Tomahawk::ScannedFile > > > m_pendingFiles;
+    QThreadPool m_tagReaderPool;
+    QSemaphore m_queueSlots;
+    int m_threadCount;
+    bool m_postOpsPending;
+
     DirListerThreadController* m_dirListerThreadController;
 };
 
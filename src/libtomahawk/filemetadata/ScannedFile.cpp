@@ -0,0 +1,102 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScannedFile.h"
+
+namespace Tomahawk
+{
+
+ScannedFile::ScannedFile()
+    : id( 0 )
+    , mtime( 0 )
+    , size( 0 )
+    , duration( 0 )
+    , bitrate( 0 )
+    , albumpos( 0 )
+    , discnumber( 0 )
+    , year( 0 )
+{
+}
+
+
+ScannedFile
+ScannedFile::fromVariant( const QVariant& v )
+{
+    const QVariantMap m = v.toMap();
+
+    ScannedFile file;
+    file.id          = m.value( "id" ).toUInt();
+    file.url         = m.value( "url" ).toString();
+    file.mtime       = m.value( "mtime" ).toUInt();
+    file.size        = m.value( "size" ).toUInt();
+    file.hash        = m.value( "hash" ).toString();
+    file.mimetype    = m.value( "mimetype" ).toString();
+    file.duration    = m.value( "duration" ).toUInt();
+    file.bitrate     = m.value( "bitrate" ).toUInt();
+    file.artist      = m.value( "artist" ).toString().trimmed();
+    file.albumartist = m.value( "albumartist" ).toString().trimmed();
+    file.album       = m.value( "album" ).toString().trimmed();
+    file.track       = m.value( "track" ).toString().trimmed();
+    file.composer    = m.value( "composer" ).toString().trimmed();
+    file.albumpos    = m.value( "albumpos" ).toUInt();
+    file.discnumber  = m.value( "discnumber" ).toUInt();
+    file.year        = m.value( "year" ).toInt();
+
+    return file;
+}
+
+
+QList< ScannedFile >
+ScannedFile::fromVariantList( const QVariantList& list )
+{
+    QList< ScannedFile > files;
+    files.reserve( list.count() );
+
+    foreach ( const QVariant& v, list )
+        files << fromVariant( v );
+
+    return files;
+}
+
+
+QVariantMap
+ScannedFile::toVariant() const
+{
+    QVariantMap m;
+    if ( id )
+        m["id"]      = id;
+    m["url"]         = url;
+    m["mtime"]       = mtime;
+    m["size"]        = size;
+    m["hash"]        = hash;
+    m["mimetype"]    = mimetype;
+    m["duration"]    = duration;
+    m["bitrate"]     = bitrate;
+    m["artist"]      = artist;
+    m["albumartist"] = albumartist;
+    m["album"]       = album;
+    m["track"]       = track;
+    m["composer"]    = composer;
+    m["albumpos"]    = albumpos;
+    m["discnumber"]  = discnumber;
+    m["year"]        = year;
+
+    return m;
+}
+
+}
@@ -0,0 +1,73 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef SCANNEDFILE_H
+#define SCANNEDFILE_H
+
+#include "DllMacro.h"
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+namespace Tomahawk
+{
+
+/**
+ * A file's metadata as it gets added to the database, typed and normalized
+ * (names trimmed) once by whoever produces it, instead of on every access.
+ *
+ * Peers send the same data as a QVariantMap in their addfiles ops, use
+ * fromVariant() / toVariant() to convert between the two.
+ */
+class DLLEXPORT ScannedFile
+{
+public:
+    ScannedFile();
+
+    static ScannedFile fromVariant( const QVariant& v );
+    static QList< ScannedFile > fromVariantList( const QVariantList& list );
+    QVariantMap toVariant() const;
+
+    /// Without artist and track there's nothing we could add to the database.
+    bool isValid() const { return !artist.isEmpty() && !track.isEmpty(); }
+
+    unsigned int id; // set once the file is in the database
+    QString url;
+    unsigned int mtime;
+    unsigned int size;
+    QString hash;
+    QString mimetype;
+    unsigned int duration;
+    unsigned int bitrate;
+    QString artist;
+    QString albumartist;
+    QString album;
+    QString track;
+    QString composer;
+    unsigned int albumpos;
+    unsigned int discnumber;
+    int year;
+};
+
+typedef QList< ScannedFile > ScannedFileList;
+
+}
+
+#endif // SCANNEDFILE_H
@@ -25,10 +25,19 @@
 #include "utils/Logger.h"
 #include "Source.h"
 
+#include <QDataStream>
 #include <QDir>
 #include <QSettings>
+#include <QSqlError>
+#include <QSqlQuery>
 #include <QCryptographicHash>
 
+// evict least recently used entries once the cache grows beyond this
+#define CACHE_SIZE_LIMIT ( 256 * 1024 * 1024 )
+// and keep evicting until it's below this again
+#define CACHE_SIZE_LOW_WATERMARK ( CACHE_SIZE_LIMIT / 10 * 9 )
+#define CACHE_MMAP_SIZE ( 256 * 1024 * 1024 )
+
 namespace Tomahawk
 {
 
@@ -40,6 +49,7 @@ const int InfoSystemCache::s_infosystemCacheVersion = 4;
 InfoSystemCache::InfoSystemCache( QObject* parent )
     : QObject( parent )
     , m_cacheBaseDir( TomahawkSettings::instance()->storageCacheLocation() + "/InfoSystemCache/" )
+    , m_cacheSize( 0 )
 {
     tDebug() << Q_FUNC_INFO;
 
@@ -49,6 +59,9 @@ InfoSystemCache::InfoSystemCache( QObject* parent )
         TomahawkSettings::instance()->setInfoSystemCacheVersion( s_infosystemCacheVersion );
     }
 
+    if ( openDatabase() )
+        migrateFileCache();
+
     m_pruneTimer.setInterval( 300000 );
     m_pruneTimer.setSingleShot( false );
     connect( &m_pruneTimer, SIGNAL( timeout() ), SLOT( pruneTimerFired() ) );
@@ -59,36 +72,118 @@ InfoSystemCache::InfoSystemCache( QObject* parent )
 InfoSystemCache::~InfoSystemCache()
 {
     tDebug() << Q_FUNC_INFO;
+
+    const QString connectionName = m_db.connectionName();
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase( connectionName );
+}
+
+
+bool
+InfoSystemCache::openDatabase()
+{
+    QDir dir( m_cacheBaseDir );
+    if ( !dir.exists() && !dir.mkpath( m_cacheBaseDir ) )
+    {
+        tLog() << "Failed to create cache dir! Bailing...";
+        return false;
+    }
+
+    m_db = QSqlDatabase::addDatabase( "QSQLITE", "InfoSystemCache" );
+    m_db.setDatabaseName( m_cacheBaseDir + "cache.db" );
+    if ( !m_db.open() )
+    {
+        tLog() << "Failed to open infosystem cache database:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query( m_db );
+    query.exec( "PRAGMA journal_mode = WAL" );
+    query.exec( "PRAGMA synchronous = NORMAL" );
+    query.exec( QString( "PRAGMA mmap_size = %1" ).arg( CACHE_MMAP_SIZE ) );
+
+    query.exec( "CREATE TABLE IF NOT EXISTS cache ("
+                "type INTEGER NOT NULL,"
+                "hash TEXT NOT NULL,"
+                "expires INTEGER NOT NULL,"
+                "accessed INTEGER NOT NULL,"
+                "size INTEGER NOT NULL,"
+                "data BLOB NOT NULL,"
+                "PRIMARY KEY( type, hash ) )" );
+    query.exec( "CREATE INDEX IF NOT EXISTS cache_expires ON cache( expires )" );
+    query.exec( "CREATE INDEX IF NOT EXISTS cache_accessed ON cache( accessed )" );
+
+    // only done once on startup, afterwards we keep track of it ourselves
+    query.exec( "SELECT SUM( size ) FROM cache" );
+    if ( query.next() )
+        m_cacheSize = query.value( 0 ).toLongLong();
+
+    tDebug() << Q_FUNC_INFO << "Opened infosystem cache, size:" << m_cacheSize;
+    return true;
 }
 
 
 void
-InfoSystemCache::pruneTimerFired()
+InfoSystemCache::migrateFileCache()
 {
-    qDebug() << Q_FUNC_INFO << "Pruning infosystemcache";
-    qlonglong currentMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    // Older versions stored every entry as an INI file named <md5>.<expiry>
+    // in a directory per InfoType. Import what's still valid, then drop it.
+    const QStringList typeDirs = QDir( m_cacheBaseDir ).entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+    if ( typeDirs.isEmpty() )
+        return;
+
+    tLog() << Q_FUNC_INFO << "Migrating file based infosystem cache";
+    const qlonglong currentMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
 
-    for ( int i = InfoNoInfo; i <= InfoLastInfo; i++ )
+    m_db.transaction();
+    foreach ( const QString& typeDir, typeDirs )
     {
-        InfoType type = (InfoType)(i);
-        QHash< QString, QString > fileLocationHash = m_fileLocationCache[type];
-        const QString cacheDirName = m_cacheBaseDir + QString::number( (int)type );
-        QFileInfoList fileList = QDir( cacheDirName ).entryInfoList( QDir::Files | QDir::NoDotAndDotDot );
-        foreach ( QFileInfo file, fileList )
+        bool ok;
+        const int type = typeDir.toInt( &ok );
+        const QString cacheDirName = m_cacheBaseDir + typeDir;
+        if ( ok && type >= InfoNoInfo && type <= InfoLastInfo )
         {
-            QString baseName = file.baseName();
-            if ( file.suffix().toLongLong() < currentMSecsSinceEpoch )
+            QFileInfoList fileList = QDir( cacheDirName ).entryInfoList( QDir::Files | QDir::NoDotAndDotDot );
+            foreach ( const QFileInfo& file, fileList )
             {
-                if ( !QFile::remove( file.canonicalFilePath() ) )
-                    tLog() << "Failed to remove stale cache file" << file.canonicalFilePath();
-                else
-                    qDebug() << "Removed stale cache file" << file.canonicalFilePath();
+                const qlonglong expires = file.suffix().toLongLong();
+                if ( expires < currentMSecsSinceEpoch )
+                    continue;
+
+                QSettings cachedSettings( file.canonicalFilePath(), QSettings::IniFormat );
+                storeEntry( (InfoType)type, file.baseName(), expires, cachedSettings.value( "data" ) );
             }
-            if ( fileLocationHash.contains( baseName ) )
-                fileLocationHash.remove( baseName );
         }
-        m_fileLocationCache[type] = fileLocationHash;
+
+        TomahawkUtils::removeDirectory( cacheDirName );
     }
+    m_db.commit();
+
+    evictLeastRecentlyUsed();
+}
+
+
+void
+InfoSystemCache::pruneTimerFired()
+{
+    qDebug() << Q_FUNC_INFO << "Pruning infosystemcache";
+    const qlonglong currentMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+
+    // both statements only walk the expired range of the expiry index
+    QSqlQuery query( m_db );
+    query.prepare( "SELECT SUM( size ) FROM cache WHERE expires < ?" );
+    query.addBindValue( currentMSecsSinceEpoch );
+    query.exec();
+    if ( query.next() )
+        m_cacheSize -= query.value( 0 ).toLongLong();
+
+    query.prepare( "DELETE FROM cache WHERE expires < ?" );
+    query.addBindValue( currentMSecsSinceEpoch );
+    if ( !query.exec() )
+        tLog() << "Failed to prune infosystem cache:" << query.lastError().text();
+    else
+        qDebug() << "Removed" << query.numRowsAffected() << "stale cache entries";
 }
 
 
@@ -98,82 +193,52 @@ InfoSystemCache::getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteri
     QObject* sendingObj = sender();
     const QString criteriaHashVal = criteriaMd5( criteria );
     const QString criteriaHashValWithType = criteriaMd5( criteria, requestData.type );
-    QHash< QString, QString > fileLocationHash = m_fileLocationCache[ requestData.type ];
-    if ( !fileLocationHash.contains( criteriaHashVal ) )
-    {
-        if ( !fileLocationHash.isEmpty() )
-        {
-            //We already know of some values, so no need to re-read the directory again as it's already happened
-            //qDebug() << Q_FUNC_INFO << "notInCache -- filelocationhash empty";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
-
-        const QString cacheDir = m_cacheBaseDir + QString::number( (int)requestData.type );
-        QDir dir( cacheDir );
-        if ( !dir.exists() )
-        {
-            //Dir doesn't exist so clearly not in cache
-            //qDebug() << Q_FUNC_INFO << "notInCache -- dir doesn't exist";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
-
-        QFileInfoList fileList = dir.entryInfoList( QDir::Files | QDir::NoDotAndDotDot );
-        foreach ( QFileInfo file, fileList )
-        {
-            QString baseName = file.baseName();
-            fileLocationHash[ baseName ] = file.canonicalFilePath();
-        }
+    const qlonglong currentMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
 
-        //Store what we've loaded up
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
-        if ( !fileLocationHash.contains( criteriaHashVal ) )
-        {
-            //Still didn't find it? It's really not in the cache then
-            //qDebug() << Q_FUNC_INFO << "notInCache -- filelocationhash doesn't contain criteria val";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
+    QSqlQuery query( m_db );
+    query.prepare( "SELECT expires FROM cache WHERE type = ? AND hash = ?" );
+    query.addBindValue( (int)requestData.type );
+    query.addBindValue( criteriaHashVal );
+    if ( !query.exec() || !query.next() )
+    {
+        notInCache( sendingObj, criteria, requestData );
+        return;
     }
 
-    QFileInfo file( fileLocationHash[ criteriaHashVal ] );
-    qlonglong currMaxAge = file.suffix().toLongLong();
-
-    if ( currMaxAge < QDateTime::currentMSecsSinceEpoch() )
+    qlonglong expires = query.value( 0 ).toLongLong();
+    if ( expires < currentMSecsSinceEpoch )
     {
-        if ( !QFile::remove( file.canonicalFilePath() ) )
-            tLog() << "Failed to remove stale cache file" << file.canonicalFilePath();
-        else
-            qDebug() << "Removed stale cache file" << file.canonicalFilePath();
-
-        fileLocationHash.remove( criteriaHashVal );
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
+        removeEntry( requestData.type, criteriaHashVal );
         m_dataCache.remove( criteriaHashValWithType );
 
-        qDebug() << Q_FUNC_INFO << "notInCache -- file was stale";
+        qDebug() << Q_FUNC_INFO << "notInCache -- entry was stale";
         notInCache( sendingObj, criteria, requestData );
         return;
     }
     else if ( newMaxAge > 0 )
     {
-        const QString newFilePath = QString( file.dir().canonicalPath() + '/' + criteriaHashVal + '.' + QString::number( QDateTime::currentMSecsSinceEpoch() + newMaxAge ) );
+        expires = currentMSecsSinceEpoch + newMaxAge;
+    }
 
-        if ( !QFile::rename( file.canonicalFilePath(), newFilePath ) )
+    query.prepare( "UPDATE cache SET expires = ?, accessed = ? WHERE type = ? AND hash = ?" );
+    query.addBindValue( expires );
+    query.addBindValue( currentMSecsSinceEpoch );
+    query.addBindValue( (int)requestData.type );
+    query.addBindValue( criteriaHashVal );
+    query.exec();
+
+    if ( !m_dataCache.contains( criteriaHashValWithType ) )
+    {
+        query.prepare( "SELECT data FROM cache WHERE type = ? AND hash = ?" );
+        query.addBindValue( (int)requestData.type );
+        query.addBindValue( criteriaHashVal );
+        if ( !query.exec() || !query.next() )
         {
-            qDebug() << Q_FUNC_INFO << "notInCache -- failed to move old cache file to new location";
             notInCache( sendingObj, criteria, requestData );
             return;
         }
 
-        fileLocationHash[ criteriaHashVal ] = newFilePath;
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
-    }
-
-    if ( !m_dataCache.contains( criteriaHashValWithType ) )
-    {
-        QSettings cachedSettings( fileLocationHash[ criteriaHashVal ], QSettings::IniFormat );
-        QVariant output = cachedSettings.value( "data" );
+        QVariant output = deserialize( query.value( 0 ).toByteArray() );
         m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
         emit info( requestData, output );
@@ -197,50 +262,108 @@ InfoSystemCache::updateCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria,
 {
     const QString criteriaHashVal = criteriaMd5( criteria );
     const QString criteriaHashValWithType = criteriaMd5( criteria, type );
-    const QString cacheDir = m_cacheBaseDir + QString::number( (int)type );
-    const QString settingsFilePath( cacheDir + '/' + criteriaHashVal + '.' + QString::number( QDateTime::currentMSecsSinceEpoch() + maxAge ) );
 
-    QHash< QString, QString > fileLocationHash = m_fileLocationCache[ type ];
-    if ( fileLocationHash.contains( criteriaHashVal ) )
-    {
-        if ( !QFile::rename( fileLocationHash[ criteriaHashVal ], settingsFilePath ) )
-        {
-            tLog() << "Failed to move old cache file to new location!";
-            return;
-        }
-        fileLocationHash[ criteriaHashVal ] = settingsFilePath;
-        m_fileLocationCache[ type ] = fileLocationHash;
+    storeEntry( type, criteriaHashVal, QDateTime::currentMSecsSinceEpoch() + maxAge, output );
+    m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
-        QSettings cachedSettings( fileLocationHash[ criteriaHashVal ], QSettings::IniFormat );
-        cachedSettings.setValue( "data", output );
+    if ( m_cacheSize > CACHE_SIZE_LIMIT )
+        evictLeastRecentlyUsed();
+}
 
-        m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
+void
+InfoSystemCache::storeEntry( InfoType type, const QString& criteriaHashVal, qlonglong expires, const QVariant& output )
+{
+    const QByteArray data = serialize( output );
+
+    QSqlQuery query( m_db );
+    query.prepare( "SELECT size FROM cache WHERE type = ? AND hash = ?" );
+    query.addBindValue( (int)type );
+    query.addBindValue( criteriaHashVal );
+    if ( query.exec() && query.next() )
+        m_cacheSize -= query.value( 0 ).toLongLong();
+
+    query.prepare( "INSERT OR REPLACE INTO cache( type, hash, expires, accessed, size, data ) VALUES( ?, ?, ?, ?, ?, ? )" );
+    query.addBindValue( (int)type );
+    query.addBindValue( criteriaHashVal );
+    query.addBindValue( expires );
+    query.addBindValue( QDateTime::currentMSecsSinceEpoch() );
+    query.addBindValue( data.size() );
+    query.addBindValue( data );
+    if ( !query.exec() )
+    {
+        tLog() << "Failed to store infosystem cache entry:" << query.lastError().text();
         return;
     }
 
-    QDir dir( cacheDir );
-    if( !dir.exists( cacheDir ) )
+    m_cacheSize += data.size();
+}
+
+
+void
+InfoSystemCache::removeEntry( InfoType type, const QString& criteriaHashVal )
+{
+    QSqlQuery query( m_db );
+    query.prepare( "SELECT size FROM cache WHERE type = ? AND hash = ?" );
+    query.addBindValue( (int)type );
+    query.addBindValue( criteriaHashVal );
+    if ( query.exec() && query.next() )
+        m_cacheSize -= query.value( 0 ).toLongLong();
+
+    query.prepare( "DELETE FROM cache WHERE type = ? AND hash = ?" );
+    query.addBindValue( (int)type );
+    query.addBindValue( criteriaHashVal );
+    if ( !query.exec() )
+        tLog() << "Failed to remove infosystem cache entry:" << query.lastError().text();
+}
+
+
+void
+InfoSystemCache::evictLeastRecentlyUsed()
+{
+    if ( m_cacheSize <= CACHE_SIZE_LIMIT )
+        return;
+
+    tDebug() << Q_FUNC_INFO << "Cache size" << m_cacheSize << "exceeds limit, evicting least recently used entries";
+
+    m_db.transaction();
+    QSqlQuery query( m_db );
+    QSqlQuery deleteQuery( m_db );
+    deleteQuery.prepare( "DELETE FROM cache WHERE rowid = ?" );
+
+    // walk the access index from the oldest entry on
+    query.setForwardOnly( true );
+    query.exec( "SELECT rowid, size FROM cache ORDER BY accessed ASC" );
+    while ( m_cacheSize > CACHE_SIZE_LOW_WATERMARK && query.next() )
     {
-        qDebug() << "Creating cache directory" << cacheDir;
-        if( !dir.mkpath( cacheDir ) )
-        {
-            tLog() << "Failed to create cache dir! Bailing...";
-            return;
-        }
+        deleteQuery.addBindValue( query.value( 0 ) );
+        if ( deleteQuery.exec() )
+            m_cacheSize -= query.value( 1 ).toLongLong();
     }
+    query.finish();
+    m_db.commit();
+}
 
-    QSettings cachedSettings( settingsFilePath, QSettings::IniFormat );
-    QStringList keys = criteria.keys();
-    cachedSettings.beginGroup( "criteria" );
-    for( int i = 0; i < criteria.size(); i++ )
-        cachedSettings.setValue( keys.at( i ), criteria[keys.at( i )] );
-    cachedSettings.endGroup();
-    cachedSettings.setValue( "data", output );
-
-    fileLocationHash[criteriaHashVal] = settingsFilePath;
-    m_fileLocationCache[type] = fileLocationHash;
-    m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
+
+QByteArray
+InfoSystemCache::serialize( const QVariant& output )
+{
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+    stream << output;
+
+    return data;
+}
+
+
+QVariant
+InfoSystemCache::deserialize( const QByteArray& data )
+{
+    QVariant output;
+    QDataStream stream( data );
+    stream >> output;
+
+    return output;
 }
 
 
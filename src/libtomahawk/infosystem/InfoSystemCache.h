@@ -23,6 +23,7 @@
 #include <QCache>
 #include <QDateTime>
 #include <QObject>
+#include <QSqlDatabase>
 #include <QtDebug>
 #include <QTimer>
 
@@ -34,6 +35,14 @@ namespace Tomahawk
 namespace InfoSystem
 {
 
+/**
+ * Persistent cache for InfoSystem responses.
+ *
+ * All entries live in a single SQLite database (memory mapped where the
+ * platform allows it), indexed by expiry time and by last access. Expired
+ * entries are pruned with an index range delete, and once the cache grows
+ * beyond its size limit the least recently used entries are evicted.
+ */
 class DLLEXPORT InfoSystemCache : public QObject
 {
 Q_OBJECT
@@ -64,8 +73,18 @@ private:
     void notInCache( QObject *receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData );
     const QString criteriaMd5( const Tomahawk::InfoSystem::InfoStringHash &criteria, Tomahawk::InfoSystem::InfoType type = Tomahawk::InfoSystem::InfoNoInfo ) const;
 
+    bool openDatabase();
+    void migrateFileCache();
+    void storeEntry( InfoType type, const QString& criteriaHashVal, qlonglong expires, const QVariant& output );
+    void removeEntry( InfoType type, const QString& criteriaHashVal );
+    void evictLeastRecentlyUsed();
+
+    static QByteArray serialize( const QVariant& output );
+    static QVariant deserialize( const QByteArray& data );
+
     QString m_cacheBaseDir;
-    QHash< InfoType, QHash< QString, QString > > m_fileLocationCache;
+    QSqlDatabase m_db;
+    qlonglong m_cacheSize;
     QTimer m_pruneTimer;
     QCache< QString, QVariant > m_dataCache;
 };
@@ -21,18 +21,22 @@
 #include "BufferIoDevice_p.h"
 
 #include <QCoreApplication>
+#include <QDir>
 #include <QMutexLocker>
 #include <QThread>
 
 #include "utils/Logger.h"
 
-// Msgs are framed, this is the size each msg we send containing audio data:
+// Msgs are framed, this is the size of each msg containing audio data for peers
+// that don't negotiate a block size:
 #define BLOCKSIZE 4096
+// Block data kept in memory, the rest goes to a temporary file
+#define MEMORY_WINDOW ( 2 * 1024 * 1024 )
 
 
 BufferIODevice::BufferIODevice( unsigned int size, QObject* parent )
     : QIODevice( parent )
-    , d_ptr( new BufferIODevicePrivate( this, size ) )
+    , d_ptr( new BufferIODevicePrivate( this, size, BLOCKSIZE ) )
 {
 }
 
@@ -117,13 +121,22 @@ void
 BufferIODevice::addData( int block, const QByteArray& ba )
 {
     Q_D( BufferIODevice );
+    if ( ba.isEmpty() )
+        return;
+
+    bool duplicate;
     {
         QMutexLocker lock( &d->mut );
 
-        while ( d->buffer.count() <= block )
-            d->buffer << QByteArray();
+        if ( d->present.size() <= block )
+            d->present.resize( qMax( block + 1, maxBlocks() ) );
+        duplicate = d->present.testBit( block );
+        d->present.setBit( block );
+
+        d->memoryUsage += ba.size() - d->memory.value( block ).size();
+        d->memory.insert( block, ba );
 
-        d->buffer.replace( block, ba );
+        spillBlocks();
     }
 
     // If this was the last block of the transfer, check if we need to fill up gaps
@@ -135,7 +148,8 @@ BufferIODevice::addData( int block, const QByteArray& ba )
         }
     }
 
-    d->received += ba.count();
+    if ( !duplicate )
+        d->received += ba.count();
     emit bytesWritten( ba.count() );
     emit readyRead();
 }
@@ -214,7 +228,12 @@ BufferIODevice::clear()
     QMutexLocker lock( &d->mut );
 
     d->pos = 0;
-    d->buffer.clear();
+    d->present.clear();
+    d->memory.clear();
+    d->memoryUsage = 0;
+    d->firstEmptyBlock = 0;
+    d->spillFile.reset();
+    d->spillFailed = false;
 }
 
 
@@ -226,12 +245,29 @@ BufferIODevice::openMode() const
 
 
 unsigned int
-BufferIODevice::blockSize()
+BufferIODevice::defaultBlockSize()
 {
     return BLOCKSIZE;
 }
 
 
+unsigned int
+BufferIODevice::blockSize() const
+{
+    Q_D( const BufferIODevice );
+    return d->blockSize;
+}
+
+
+void
+BufferIODevice::setBlockSize( unsigned int blockSize )
+{
+    Q_D( BufferIODevice );
+    Q_ASSERT( d->received == 0 );
+    d->blockSize = blockSize;
+}
+
+
 int
 BufferIODevice::blockForPos( qint64 pos ) const
 {
@@ -239,7 +275,7 @@ BufferIODevice::blockForPos( qint64 pos ) const
     // 4095 / 4096 -> block 0
     // 4096 / 4096 -> block 1
 
-    return pos / BLOCKSIZE;
+    return pos / blockSize();
 }
 
 
@@ -250,7 +286,7 @@ BufferIODevice::offsetForPos( qint64 pos ) const
     // 4095 % 4096 -> offset 4095
     // 4096 % 4096 -> offset 0
 
-    return pos % BLOCKSIZE;
+    return pos % blockSize();
 }
 
 
@@ -258,20 +294,16 @@ int
 BufferIODevice::nextEmptyBlock() const
 {
     Q_D( const BufferIODevice );
+    QMutexLocker lock( &d->mut );
 
-    int i = 0;
-    foreach( const QByteArray& ba, d->buffer )
-    {
-        if ( ba.isEmpty() )
-            return i;
-
-        i++;
-    }
+    // blocks never go away, so we can continue where we stopped last time
+    while ( d->firstEmptyBlock < d->present.size() && d->present.testBit( d->firstEmptyBlock ) )
+        d->firstEmptyBlock++;
 
-    if ( i == maxBlocks() )
+    if ( d->firstEmptyBlock == maxBlocks() )
         return -1;
 
-    return i;
+    return d->firstEmptyBlock;
 }
 
 
@@ -280,9 +312,9 @@ BufferIODevice::maxBlocks() const
 {
     Q_D( const BufferIODevice );
 
-    int i = d->size / BLOCKSIZE;
+    int i = d->size / d->blockSize;
 
-    if ( ( d->size % BLOCKSIZE ) > 0 )
+    if ( ( d->size % d->blockSize ) > 0 )
         i++;
 
     return i;
@@ -293,10 +325,19 @@ bool
 BufferIODevice::isBlockEmpty( int block ) const
 {
     Q_D( const BufferIODevice );
-    if ( block >= d->buffer.count() )
-        return true;
+    QMutexLocker lock( &d->mut );
 
-    return d->buffer.at( block ).isEmpty();
+    return block >= d->present.size() || !d->present.testBit( block );
+}
+
+
+qint64
+BufferIODevice::memoryUsage() const
+{
+    Q_D( const BufferIODevice );
+    QMutexLocker lock( &d->mut );
+
+    return d->memoryUsage;
 }
 
 
@@ -310,17 +351,85 @@ BufferIODevice::getData( qint64 pos, qint64 size )
     int offset = offsetForPos( pos );
 
     QMutexLocker lock( &d->mut );
-    while( ba.count() < size )
+    while ( ba.count() < size && block < d->present.size() && d->present.testBit( block ) )
     {
-        if ( block > maxBlocks() )
+        const QByteArray data = blockData( block++ );
+        if ( data.count() <= offset )
             break;
 
-        if ( isBlockEmpty( block ) )
-            break;
-
-        ba.append( d->buffer.at( block++ ).mid( offset ) );
+        ba.append( data.constData() + offset, qMin< qint64 >( data.count() - offset, size - ba.count() ) );
+        offset = 0;
     }
 
 //    qDebug() << Q_FUNC_INFO << pos << size << 2;
-    return ba.left( size );
+    return ba;
+}
+
+
+QByteArray
+BufferIODevice::blockData( int block )
+{
+    Q_D( BufferIODevice );
+
+    QHash< int, QByteArray >::const_iterator it = d->memory.constFind( block );
+    if ( it != d->memory.constEnd() )
+        return it.value();
+
+    // spilled, only the last block may be shorter
+    const qint64 offset = qint64( block ) * d->blockSize;
+    const qint64 length = qMin< qint64 >( d->blockSize, d->size - offset );
+    if ( !d->spillFile || length <= 0 || !d->spillFile->seek( offset ) )
+        return QByteArray();
+
+    return d->spillFile->read( length );
+}
+
+
+void
+BufferIODevice::spillBlocks()
+{
+    Q_D( BufferIODevice );
+
+    // we need the size to know how long spilled blocks are
+    if ( d->size == 0 || d->spillFailed )
+        return;
+
+    const int readBlock = blockForPos( d->pos );
+    while ( d->memoryUsage > MEMORY_WINDOW && d->memory.count() > 1 )
+    {
+        if ( !d->spillFile )
+        {
+            d->spillFile.reset( new QTemporaryFile( QDir::tempPath() + "/tomahawk-stream-XXXXXX" ) );
+            if ( !d->spillFile->open() )
+            {
+                tLog() << Q_FUNC_INFO << "Can't create a temporary file, keeping everything in memory";
+                d->spillFile.reset();
+                d->spillFailed = true;
+                return;
+            }
+        }
+
+        // the block farthest from the read position goes first
+        int victim = -1;
+        int distance = -1;
+        for ( QHash< int, QByteArray >::const_iterator it = d->memory.constBegin(); it != d->memory.constEnd(); ++it )
+        {
+            if ( qAbs( it.key() - readBlock ) > distance )
+            {
+                victim = it.key();
+                distance = qAbs( it.key() - readBlock );
+            }
+        }
+
+        const QByteArray data = d->memory.take( victim );
+        if ( !d->spillFile->seek( qint64( victim ) * d->blockSize ) || d->spillFile->write( data ) != data.count() )
+        {
+            tLog() << Q_FUNC_INFO << "Failed writing to" << d->spillFile->fileName() << "keeping everything in memory";
+            d->memory.insert( victim, data );
+            d->spillFailed = true;
+            return;
+        }
+
+        d->memoryUsage -= data.count();
+    }
 }
@@ -20,11 +20,18 @@
 #ifndef BUFFERIODEVICE_H
 #define BUFFERIODEVICE_H
 
+#include "DllMacro.h"
+
 #include <QIODevice>
 
 class BufferIODevicePrivate;
 
-class BufferIODevice : public QIODevice
+/**
+ * Random access device for data that arrives in blocks, in any order, e.g.
+ * a track streamed from a peer. Keeps a bounded window of blocks around the
+ * read position in memory and spills the others to a temporary file.
+ */
+class DLLEXPORT BufferIODevice : public QIODevice
 {
 Q_OBJECT
 
@@ -52,12 +59,19 @@ public:
 
     virtual bool isSequential() const;
 
-    static unsigned int blockSize();
+    /// Block size of peers that don't negotiate one
+    static unsigned int defaultBlockSize();
+    unsigned int blockSize() const;
+    /// Only call this before any data was added.
+    void setBlockSize( unsigned int blockSize );
 
     int maxBlocks() const;
     int nextEmptyBlock() const;
     bool isBlockEmpty( int block ) const;
 
+    /// Bytes of block data currently held in memory
+    qint64 memoryUsage() const;
+
 signals:
     void blockRequest( int block );
 
@@ -69,6 +83,8 @@ private:
     int blockForPos( qint64 pos ) const;
     int offsetForPos( qint64 pos ) const;
     QByteArray getData( qint64 pos, qint64 size );
+    QByteArray blockData( int block );
+    void spillBlocks();
 
     Q_DECLARE_PRIVATE( BufferIODevice )
     BufferIODevicePrivate* d_ptr;
@@ -22,28 +22,44 @@
 
 #include "BufferIoDevice.h"
 
+#include <QBitArray>
+#include <QHash>
 #include <QMutex>
+#include <QScopedPointer>
+#include <QTemporaryFile>
 
 class BufferIODevicePrivate
 {
 public:
-    BufferIODevicePrivate( BufferIODevice* q, unsigned int size = 0 )
+    BufferIODevicePrivate( BufferIODevice* q, unsigned int size, unsigned int blockSize )
         : q_ptr ( q )
+        , blockSize( blockSize )
         , size( size )
         , received( 0 )
         , pos( 0 )
-
+        , firstEmptyBlock( 0 )
+        , memoryUsage( 0 )
+        , spillFailed( false )
     {
     }
     BufferIODevice* q_ptr;
     Q_DECLARE_PUBLIC ( BufferIODevice )
 
 private:
-    QList<QByteArray> buffer;
+    // which blocks we have, wherever they are
+    QBitArray present;
+    // blocks around the read position, the others are in spillFile
+    QHash< int, QByteArray > memory;
+    QScopedPointer< QTemporaryFile > spillFile;
     mutable QMutex mut;
+    unsigned int blockSize;
     unsigned int size;
     unsigned int received;
     unsigned int pos;
+    // no block before this one is empty
+    mutable int firstEmptyBlock;
+    qint64 memoryUsage;
+    bool spillFailed;
 };
 
 #endif // BUFFERIODEVICE_P_H
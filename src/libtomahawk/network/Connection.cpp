@@ -35,6 +35,8 @@
 #include <QThread>
 
 #define PROTOVER "4" // must match remote peer, or we can't talk.
+// Msgs handled per readyRead() before giving the event loop a turn
+#define MAX_MSGS_PER_READ 256
 
 
 Connection::Connection( Servent* parent )
@@ -47,6 +49,9 @@ Connection::Connection( Servent* parent )
     connect( &d_func()->msgprocessor_out, SIGNAL( ready( msg_ptr ) ),
              SLOT( sendMsg_now( msg_ptr ) ), Qt::QueuedConnection );
 
+    connect( &d_func()->msgprocessor_out, SIGNAL( empty() ),
+             SLOT( flushMsgs() ), Qt::QueuedConnection );
+
     connect( &d_func()->msgprocessor_in,  SIGNAL( ready( msg_ptr ) ),
              SLOT( handleMsg( msg_ptr ) ), Qt::QueuedConnection );
 
@@ -204,8 +209,13 @@ Connection::actualShutdown()
     }
     d->actually_shutting_down = true;
 
+    tDebug( LOGVERBOSE ) << "Connection" << id() << "sent" << d->tx_bytes << "received" << d->rx_bytes << "bytes,"
+                         << "compression saved" << compressionBytesSaved() << "bytes"
+                         << "spending" << compressionTime() << "ms on it";
+
     if ( !d->sock.isNull() && d->sock->isOpen() )
     {
+        d->framer.flush();
         d->sock->disconnectFromHost();
     }
 
@@ -276,12 +286,42 @@ Connection::bytesSent() const
     return d_func()->tx_bytes;
 }
 
+int
+Connection::queuedMessages() const
+{
+    return d_func()->tx_msgs_queued;
+}
+
+qint64
+Connection::bytesToWrite() const
+{
+    Q_D( const Connection );
+
+    return d->sock.isNull() ? 0 : d->sock->bytesToWrite() + d->framer.bufferedBytes();
+}
+
 qint64
 Connection::bytesReceived() const
 {
     return d_func()->rx_bytes;
 }
 
+qint64
+Connection::compressionBytesSaved() const
+{
+    Q_D( const Connection );
+
+    return d->msgprocessor_out.bytesSaved() + d->msgprocessor_in.bytesSaved();
+}
+
+qint64
+Connection::compressionTime() const
+{
+    Q_D( const Connection );
+
+    return d->msgprocessor_out.compressionTime() + d->msgprocessor_in.compressionTime();
+}
+
 void
 Connection::setMsgProcessorModeOut(quint32 m)
 {
@@ -294,6 +334,12 @@ Connection::setMsgProcessorModeIn(quint32 m)
     d_func()->msgprocessor_in.setMode( m );
 }
 
+void
+Connection::setCompressionCodec( MsgCompression::Codec codec )
+{
+    d_func()->msgprocessor_out.setCodec( codec );
+}
+
 const QHostAddress
 Connection::peerIpAddress() const
 {
@@ -310,6 +356,7 @@ Connection::start( QTcpSocket* sock )
     Q_ASSERT( sock->isValid() );
 
     d->sock = sock;
+    d->framer.setDevice( sock );
 
     if ( d->name.isEmpty() )
     {
@@ -542,40 +589,29 @@ Connection::readyRead()
 //    qDebug() << "readyRead, bytesavail:" << m_sock->bytesAvailable();
     Q_D( Connection );
 
-    if ( d->msg.isNull() )
+    // handle everything that arrived, but don't starve the event loop
+    for ( int i = 0; i < MAX_MSGS_PER_READ; i++ )
     {
-        if ( d->sock->bytesAvailable() < Msg::headerSize() )
+        if ( d->sock.isNull() )
             return;
 
-        char msgheader[ Msg::headerSize() ];
-        if ( d->sock->read( (char*) &msgheader, Msg::headerSize() ) != Msg::headerSize() )
+        bool ok;
+        d->msg = d->framer.read( &ok );
+        if ( !ok )
         {
-            tDebug() << "Failed reading msg header";
+            tDebug() << "Failed to read full msg";
             this->markAsFailed();
             return;
         }
+        if ( d->msg.isNull() )
+            return;
 
-        d->msg = Msg::begin( (char*) &msgheader );
-        d->rx_bytes += Msg::headerSize();
+        d->rx_bytes += Msg::headerSize() + d->msg->length();
+        handleReadMsg(); // process m_msg and clear() it
     }
 
-    if ( d->sock->bytesAvailable() < d->msg->length() )
-        return;
-
-    QByteArray ba = d->sock->read( d->msg->length() );
-    if ( ba.length() != (qint32)d->msg->length() )
-    {
-        tDebug() << "Failed to read full msg payload";
-        this->markAsFailed();
-        return;
-    }
-    d->msg->fill( ba );
-    d->rx_bytes += ba.length();
-
-    handleReadMsg(); // process m_msg and clear() it
-
     // since there is no explicit threading, use the event loop to schedule this:
-    if ( d->sock->bytesAvailable() )
+    if ( !d->sock.isNull() && d->sock->bytesAvailable() )
     {
         QTimer::singleShot( 0, this, SLOT( readyRead() ) );
     }
@@ -648,6 +684,7 @@ Connection::sendMsg( msg_ptr msg )
     }
 
     d_func()->tx_bytes_requested += msg->length() + Msg::headerSize();
+    d_func()->tx_msgs_queued++;
     d_func()->msgprocessor_out.append( msg );
 }
 
@@ -659,6 +696,8 @@ Connection::sendMsg_now( msg_ptr msg )
     Q_ASSERT( QThread::currentThread() == thread() );
 //    Q_ASSERT( this->isRunning() );
 
+    d->tx_msgs_queued--;
+
     if ( d->sock.isNull() || !d->sock->isOpen() || !d->sock->isWritable() )
     {
         tDebug() << "***** Socket problem, whilst in sendMsg(). Cleaning up. *****";
@@ -666,7 +705,8 @@ Connection::sendMsg_now( msg_ptr msg )
         return;
     }
 
-    if ( !msg->write( d->sock.data() ) )
+    // small msgs are coalesced until the outgoing queue is empty, see flushMsgs()
+    if ( !d->framer.write( msg ) )
     {
         //qDebug() << "Error writing to socket in sendMsg() *************";
         shutdown( false );
@@ -675,13 +715,34 @@ Connection::sendMsg_now( msg_ptr msg )
 }
 
 
+void
+Connection::flushMsgs()
+{
+    Q_D( Connection );
+
+    if ( d->sock.isNull() || !d->sock->isOpen() )
+        return;
+
+    if ( !d->framer.flush() )
+    {
+        tDebug() << "***** Failed writing to socket, cleaning up. *****";
+        shutdown( false );
+    }
+}
+
+
 void
 Connection::bytesWritten( qint64 i )
 {
     d_func()->tx_bytes += i;
     // if we are waiting to shutdown, and have sent all queued data, do actual shutdown:
     if ( d_func()->do_shutdown && d_func()->tx_bytes == d_func()->tx_bytes_requested )
+    {
         actualShutdown();
+        return;
+    }
+
+    emit dataWritten();
 }
 
 
@@ -24,6 +24,8 @@
 #include "Typedefs.h"
 #include "DllMacro.h"
 
+#include "network/MsgCompression.h"
+
 #include <QHostAddress>
 #include <QPointer>
 #include <QString>
@@ -80,8 +82,20 @@ public:
     qint64 bytesSent() const;
     qint64 bytesReceived() const;
 
+    /// Messages handed to sendMsg() that haven't been written to the socket yet.
+    int queuedMessages() const;
+    /// Bytes written to the socket that it hasn't sent yet.
+    qint64 bytesToWrite() const;
+
+    /// Bytes we didn't have to send or receive thanks to compression.
+    qint64 compressionBytesSaved() const;
+    /// Time spent compressing and uncompressing msgs, in ms.
+    qint64 compressionTime() const;
+
     void setMsgProcessorModeOut( quint32 m );
     void setMsgProcessorModeIn( quint32 m );
+    /// Codec for outgoing msgs, the peer has to support it. Incoming msgs may use any codec.
+    void setCompressionCodec( MsgCompression::Codec codec );
 
     const QHostAddress peerIpAddress() const;
 
@@ -109,6 +123,8 @@ signals:
     void failed();
     void finished();
     void statsTick( qint64 tx_bytes_sec, qint64 rx_bytes_sec );
+    /// The socket sent some data, there may be room for more messages now.
+    void dataWritten();
     void socketClosed();
     void socketErrored( QAbstractSocket::SocketError );
 
@@ -129,6 +145,7 @@ public slots:
 private slots:
     void handleIncomingQueueEmpty();
     void sendMsg_now( msg_ptr );
+    void flushMsgs();
     void socketDisconnected();
     void socketDisconnectedError( QAbstractSocket::SocketError );
     void readyRead();
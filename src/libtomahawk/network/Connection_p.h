@@ -23,6 +23,7 @@
 
 #include "Connection.h"
 
+#include "MsgFramer.h"
 #include "MsgProcessor.h"
 
 #include <QReadWriteLock>
@@ -44,6 +45,7 @@ public:
         , setup( false )
         , tx_bytes( 0 )
         , tx_bytes_requested( 0 )
+        , tx_msgs_queued( 0 )
         , rx_bytes( 0 )
         , id( "Connection()" )
         , peerport( 0 )
@@ -71,11 +73,13 @@ private:
     bool setup;
     qint64 tx_bytes;
     qint64 tx_bytes_requested;
+    int tx_msgs_queued;
     qint64 rx_bytes;
     QString id;
     QString name;
     QString nodeid;
     mutable QReadWriteLock nodeidLock;
+    MsgFramer framer;
     msg_ptr msg;
     msg_ptr firstmsg;
     int peerport;
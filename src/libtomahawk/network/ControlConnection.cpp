@@ -22,6 +22,7 @@
 
 #include "database/Database.h"
 #include "database/DatabaseCommand_CollectionStats.h"
+#include "network/DbOpCodec.h"
 #include "network/DbSyncConnection.h"
 #include "network/Msg.h"
 #include "network/MsgProcessor.h"
@@ -128,6 +129,14 @@ ControlConnection::setup()
     QSharedPointer<QMutexLocker> locker = d->source->acquireLock();
     if ( d->source->setControlConnection( this ) )
     {
+        // tell the peer which optional protocol features we support,
+        // older peers just ignore this message
+        QVariantMap features;
+        features.insert( "method", "features" );
+        features.insert( "features", QStringList() << DbOpCodec::featureName() << MsgCompression::features()
+                                     << StreamConnection::windowFeatureName() );
+        sendMsg( features );
+
         // We are the new ControlConnection for this source
 
         // delay setting up collection/etc until source is synced.
@@ -304,6 +313,12 @@ ControlConnection::handleMsg( msg_ptr msg )
             d->dbconnkey = m.value( "key" ).toString() ;
             setupDbSyncConnection();
         }
+        else if ( m.value( "method" ).toString() == "features" )
+        {
+            d->peerFeatures = m.value( "features" ).toStringList().toSet();
+            tDebug( LOGVERBOSE ) << id() << "Peer supports:" << d->peerFeatures;
+            setCompressionCodec( compressionCodec() );
+        }
         else if ( m.value( "method" ) == "protovercheckfail" )
         {
             qDebug() << "*** Remote peer protocol version mismatch, connection closed";
@@ -396,3 +411,24 @@ ControlConnection::peerInfos() const
     Q_D( const ControlConnection );
     return d->peerInfos;
 }
+
+
+bool
+ControlConnection::peerSupports( const QString& feature ) const
+{
+    Q_D( const ControlConnection );
+    return d->peerFeatures.contains( feature );
+}
+
+
+MsgCompression::Codec
+ControlConnection::compressionCodec() const
+{
+    foreach ( MsgCompression::Codec codec, MsgCompression::availableCodecs() )
+    {
+        if ( codec == MsgCompression::Zlib || peerSupports( MsgCompression::featureName( codec ) ) )
+            return codec;
+    }
+
+    return MsgCompression::Zlib;
+}
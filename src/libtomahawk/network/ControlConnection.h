@@ -59,6 +59,11 @@ public:
     void setShutdownOnEmptyPeerInfos( bool shutdownOnEmptyPeerInfos );
     const QSet< Tomahawk::peerinfo_ptr > peerInfos() const;
 
+    /// Whether the peer advertised the given protocol feature in the handshake.
+    bool peerSupports( const QString& feature ) const;
+    /// The best codec for msgs to the peer we both support.
+    MsgCompression::Codec compressionCodec() const;
+
 protected:
     virtual void setup();
 
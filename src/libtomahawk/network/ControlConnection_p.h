@@ -58,6 +58,7 @@ private:
     QTime pingtimer_mark;
 
     QSet< Tomahawk::peerinfo_ptr > peerInfos;
+    QSet< QString > peerFeatures;
 };
 
 #endif // CONTROLCONNECTION_P_H
@@ -0,0 +1,479 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "DbOpCodec.h"
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include <string.h>
+
+// Bumped on incompatible changes, decode() rejects other versions
+#define CODEC_VERSION 1
+// Longer strings are unlikely to repeat and not worth hashing
+#define MAX_INTERNED_LENGTH 64
+// Sanity limit for element counts, so garbage input can't make us allocate gigabytes
+#define MAX_ELEMENTS ( 16 * 1024 * 1024 )
+// Ops are a handful of levels deep, anything beyond that is garbage and would only eat our stack
+#define MAX_DEPTH 32
+
+
+namespace
+{
+
+enum Tag
+{
+    TagNull = 0,
+    TagFalse,
+    TagTrue,
+    TagInt,
+    TagDouble,
+    TagString,      // not interned
+    TagNewString,   // interned, added to the table
+    TagStringRef,   // index into the table
+    TagList,
+    TagMap,
+    TagTable
+};
+
+
+class Encoder
+{
+public:
+    QByteArray data;
+
+    void writeVarint( quint64 v )
+    {
+        while ( v >= 0x80 )
+        {
+            data.append( char( ( v & 0x7f ) | 0x80 ) );
+            v >>= 7;
+        }
+        data.append( char( v ) );
+    }
+
+    void writeString( const QString& s )
+    {
+        if ( s.length() <= MAX_INTERNED_LENGTH )
+        {
+            QHash< QString, int >::const_iterator it = m_strings.constFind( s );
+            if ( it != m_strings.constEnd() )
+            {
+                data.append( char( TagStringRef ) );
+                writeVarint( it.value() );
+                return;
+            }
+
+            m_strings.insert( s, m_strings.count() );
+            data.append( char( TagNewString ) );
+        }
+        else
+            data.append( char( TagString ) );
+
+        const QByteArray utf8 = s.toUtf8();
+        writeVarint( utf8.length() );
+        data.append( utf8 );
+    }
+
+    void writeValue( const QVariant& v )
+    {
+        switch ( v.type() )
+        {
+            case QVariant::Invalid:
+                data.append( char( TagNull ) );
+                break;
+
+            case QVariant::Bool:
+                data.append( char( v.toBool() ? TagTrue : TagFalse ) );
+                break;
+
+            case QVariant::Int:
+            case QVariant::UInt:
+            case QVariant::LongLong:
+            case QVariant::ULongLong:
+            {
+                const qint64 i = v.toLongLong();
+                data.append( char( TagInt ) );
+                writeVarint( ( quint64( i ) << 1 ) ^ quint64( i >> 63 ) );
+                break;
+            }
+
+            case QVariant::Double:
+            {
+                const double d = v.toDouble();
+                quint64 bits;
+                memcpy( &bits, &d, sizeof( bits ) );
+
+                data.append( char( TagDouble ) );
+                for ( int shift = 56; shift >= 0; shift -= 8 )
+                    data.append( char( bits >> shift ) );
+                break;
+            }
+
+            case QVariant::List:
+            case QVariant::StringList:
+                writeList( v.toList() );
+                break;
+
+            case QVariant::Map:
+                writeMap( v.toMap() );
+                break;
+
+            case QVariant::Hash:
+            {
+                // like toJson(), hashes go out as maps
+                QVariantMap map;
+                const QVariantHash hash = v.toHash();
+                for ( QVariantHash::const_iterator it = hash.constBegin(); it != hash.constEnd(); ++it )
+                    map.insert( it.key(), it.value() );
+                writeMap( map );
+                break;
+            }
+
+            default:
+                if ( v.isNull() )
+                    data.append( char( TagNull ) );
+                else
+                    writeString( v.toString() );
+                break;
+        }
+    }
+
+    void writeMap( const QVariantMap& map )
+    {
+        data.append( char( TagMap ) );
+        writeVarint( map.count() );
+        for ( QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it )
+        {
+            writeString( it.key() );
+            writeValue( it.value() );
+        }
+    }
+
+    void writeList( const QVariantList& list )
+    {
+        // all maps with the same keys? then the keys only need to be sent once
+        QStringList keys;
+        bool table = list.count() > 1;
+        for ( int i = 0; table && i < list.count(); i++ )
+        {
+            if ( list.at( i ).type() != QVariant::Map )
+                table = false;
+            else if ( i == 0 )
+            {
+                keys = list.at( i ).toMap().keys();
+                // a table without columns can't be told apart from garbage, see Decoder
+                table = !keys.isEmpty();
+            }
+            else
+                table = list.at( i ).toMap().keys() == keys;
+        }
+
+        if ( !table )
+        {
+            data.append( char( TagList ) );
+            writeVarint( list.count() );
+            foreach ( const QVariant& v, list )
+                writeValue( v );
+            return;
+        }
+
+        data.append( char( TagTable ) );
+        writeVarint( list.count() );
+        writeVarint( keys.count() );
+        foreach ( const QString& key, keys )
+            writeString( key );
+
+        foreach ( const QVariant& v, list )
+        {
+            // QVariantMap iterates in key order, same as keys()
+            const QVariantMap map = v.toMap();
+            for ( QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it )
+                writeValue( it.value() );
+        }
+    }
+
+private:
+    QHash< QString, int > m_strings;
+};
+
+
+class Decoder
+{
+public:
+    Decoder( const QByteArray& data )
+        : m_data( data.constData() )
+        , m_pos( 0 )
+        , m_size( data.size() )
+        , m_depth( 0 )
+        , m_ok( true )
+    {
+    }
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos >= m_size; }
+
+    quint8 readByte()
+    {
+        if ( m_pos >= m_size )
+        {
+            m_ok = false;
+            return 0;
+        }
+
+        return quint8( m_data[ m_pos++ ] );
+    }
+
+    quint64 readVarint()
+    {
+        quint64 v = 0;
+        for ( int shift = 0; shift < 64 && m_ok; shift += 7 )
+        {
+            const quint8 b = readByte();
+            v |= quint64( b & 0x7f ) << shift;
+            if ( !( b & 0x80 ) )
+                return v;
+        }
+
+        m_ok = false;
+        return 0;
+    }
+
+    // Every element takes up at least minSize bytes, so there can't be more of them than that fits into what's left
+    int readCount( int minSize = 1 )
+    {
+        const quint64 count = readVarint();
+        if ( !m_ok || count > MAX_ELEMENTS || count > quint64( m_size - m_pos ) / minSize )
+        {
+            m_ok = false;
+            return 0;
+        }
+
+        return int( count );
+    }
+
+    QString readString()
+    {
+        const quint8 tag = readByte();
+        if ( tag == TagString || tag == TagNewString )
+            return readStringData( tag == TagNewString );
+        if ( tag == TagStringRef )
+            return readStringRef();
+
+        m_ok = false;
+        return QString();
+    }
+
+    QString readStringData( bool intern )
+    {
+        const quint64 length = readVarint();
+        if ( !m_ok || length > quint64( m_size - m_pos ) )
+        {
+            m_ok = false;
+            return QString();
+        }
+
+        const QString s = QString::fromUtf8( m_data + m_pos, int( length ) );
+        m_pos += int( length );
+
+        if ( intern )
+            m_strings.append( s );
+
+        return s;
+    }
+
+    QString readStringRef()
+    {
+        const quint64 index = readVarint();
+        if ( !m_ok || index >= quint64( m_strings.count() ) )
+        {
+            m_ok = false;
+            return QString();
+        }
+
+        return m_strings.at( int( index ) );
+    }
+
+    QVariant readValue()
+    {
+        const quint8 tag = readByte();
+        if ( !m_ok )
+            return QVariant();
+
+        if ( tag == TagList || tag == TagMap || tag == TagTable )
+        {
+            if ( m_depth >= MAX_DEPTH )
+            {
+                m_ok = false;
+                return QVariant();
+            }
+
+            m_depth++;
+            const QVariant v = readContainer( tag );
+            m_depth--;
+            return v;
+        }
+
+        switch ( tag )
+        {
+            case TagNull:
+                return QVariant();
+
+            case TagFalse:
+                return false;
+
+            case TagTrue:
+                return true;
+
+            case TagInt:
+            {
+                const quint64 v = readVarint();
+                return qlonglong( ( v >> 1 ) ^ ( ~( v & 1 ) + 1 ) );
+            }
+
+            case TagDouble:
+            {
+                quint64 bits = 0;
+                for ( int i = 0; i < 8; i++ )
+                    bits = ( bits << 8 ) | readByte();
+
+                double d;
+                memcpy( &d, &bits, sizeof( d ) );
+                return d;
+            }
+
+            case TagString:
+            case TagNewString:
+                return readStringData( tag == TagNewString );
+
+            case TagStringRef:
+                return readStringRef();
+
+            default:
+                m_ok = false;
+                return QVariant();
+        }
+    }
+
+    QVariant readContainer( quint8 tag )
+    {
+        switch ( tag )
+        {
+            case TagList:
+            {
+                QVariantList list;
+                const int count = readCount();
+                for ( int i = 0; i < count && m_ok; i++ )
+                    list << readValue();
+                return list;
+            }
+
+            case TagMap:
+            {
+                QVariantMap map;
+                // key and value
+                const int count = readCount( 2 );
+                for ( int i = 0; i < count && m_ok; i++ )
+                {
+                    const QString key = readString();
+                    map.insert( key, readValue() );
+                }
+                return map;
+            }
+
+            case TagTable:
+            {
+                const int rows = readCount();
+                const int columns = readCount();
+
+                // every row needs a value per column. Without columns, rows would
+                // take up no space at all and a few bytes could ask for millions of maps
+                if ( !m_ok || ( rows > 0 && ( columns == 0 || rows > ( m_size - m_pos ) / columns ) ) )
+                {
+                    m_ok = false;
+                    return QVariant();
+                }
+
+                QVector< QString > keys;
+                for ( int i = 0; i < columns && m_ok; i++ )
+                    keys << readString();
+
+                QVariantList list;
+                for ( int row = 0; row < rows && m_ok; row++ )
+                {
+                    QVariantMap map;
+                    for ( int i = 0; i < keys.count() && m_ok; i++ )
+                        map.insert( keys.at( i ), readValue() );
+                    list << map;
+                }
+                return list;
+            }
+
+            default:
+                m_ok = false;
+                return QVariant();
+        }
+    }
+
+private:
+    const char* m_data;
+    int m_pos;
+    int m_size;
+    int m_depth;
+    bool m_ok;
+    QVector< QString > m_strings;
+};
+
+}
+
+
+QString
+DbOpCodec::featureName()
+{
+    return QLatin1String( "dbop-binary" );
+}
+
+
+QByteArray
+DbOpCodec::encode( const QVariant& value )
+{
+    Encoder encoder;
+    encoder.data.append( char( CODEC_VERSION ) );
+    encoder.writeValue( value );
+
+    return encoder.data;
+}
+
+
+QVariant
+DbOpCodec::decode( const QByteArray& data, bool* ok )
+{
+    Decoder decoder( data );
+
+    QVariant value;
+    if ( decoder.readByte() == CODEC_VERSION )
+        value = decoder.readValue();
+
+    const bool success = decoder.ok() && decoder.atEnd() && !data.isEmpty() && quint8( data.at( 0 ) ) == CODEC_VERSION;
+    if ( ok )
+        *ok = success;
+
+    return success ? value : QVariant();
+}
@@ -0,0 +1,57 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+    Binary encoding for the JSON documents of DB ops.
+    =================================================
+    A single version byte, followed by one value. Values are tagged:
+
+    - null, false, true
+    - integers as zigzag varints, doubles as 8 bytes big endian
+    - strings as varint length + utf8. Short strings are interned: the first
+      occurrence is added to a table, later ones are sent as a table index.
+      This covers map keys, artist and album names and the like.
+    - lists and maps with a varint element count
+    - tables: lists of maps that all share the same keys (e.g. the files of
+      an addfiles op), sent as the keys once followed by the values row by row
+
+    Peers advertise support in the ControlConnection handshake, the JSON
+    encoding remains the fallback.
+*/
+
+#pragma once
+#ifndef DBOPCODEC_H
+#define DBOPCODEC_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QVariant>
+
+class DLLEXPORT DbOpCodec
+{
+public:
+    /// Name of the feature peers advertise in the ControlConnection handshake.
+    static QString featureName();
+
+    static QByteArray encode( const QVariant& value );
+    static QVariant decode( const QByteArray& data, bool* ok = 0 );
+};
+
+#endif // DBOPCODEC_H
@@ -21,11 +21,15 @@
     Database syncing using the oplog table.
     =======================================
     Load the last GUID we applied for the peer, tell them it.
-    In return, they send us all new ops since that guid.
+    In return, they send us up to OPS_PER_PAGE new ops since that guid.
 
-    We then apply those new ops to our cache of their data
+    We then apply those new ops to our cache of their data, which also
+    records the last applied GUID, and ask for the next page.
 
-    Synced.
+    Synced, once they have nothing left to send.
+
+    As every page is applied before the next is requested, a sync that
+    got interrupted resumes from the last applied op.
 
 */
 
@@ -35,7 +39,10 @@
 #include "database/DatabaseCommand.h"
 #include "database/DatabaseCommand_CollectionStats.h"
 #include "database/DatabaseCommand_LoadOps.h"
+#include "network/ControlConnection.h"
+#include "network/DbOpCodec.h"
 #include "utils/Logger.h"
+#include "utils/TomahawkUtils.h"
 
 #include "Msg.h"
 #include "MsgProcessor.h"
@@ -43,6 +50,12 @@
 #include "Source.h"
 #include "SourceList.h"
 
+// Ops loaded from the oplog and sent per fetchops request
+#define OPS_PER_PAGE 1000
+// Stop queueing ops while this much output is waiting to be sent
+#define MAX_QUEUED_MSGS 64
+#define MAX_QUEUED_BYTES ( 512 * 1024 )
+
 using namespace Tomahawk;
 
 
@@ -50,6 +63,8 @@ DBSyncConnection::DBSyncConnection( Servent* s, const source_ptr& src )
     : Connection( s )
     , m_fetchCount( 0 )
     , m_source( src )
+    , m_sentOps( 0 )
+    , m_fetchedOps( 0 )
     , m_state( UNKNOWN )
 {
     qDebug() << Q_FUNC_INFO << src->id() << thread();
@@ -59,10 +74,11 @@ DBSyncConnection::DBSyncConnection( Servent* s, const source_ptr& src )
              m_source.data(),   SLOT( onStateChanged( Tomahawk::DBSyncConnectionState, Tomahawk::DBSyncConnectionState, QString ) ) );
     connect( m_source.data(), SIGNAL( commandsFinished() ),
              this,              SLOT( lastOpApplied() ) );
+    connect( this, SIGNAL( dataWritten() ), SLOT( sendQueuedOps() ) );
 
     this->setMsgProcessorModeIn( MsgProcessor::PARSE_JSON | MsgProcessor::UNCOMPRESS_ALL );
 
-    // msgs are stored compressed in the db, so not typically needed here, but doesnt hurt:
+    // JSON ops are stored compressed in the db, binary ones get compressed here:
     this->setMsgProcessorModeOut( MsgProcessor::COMPRESS_IF_LARGE );
 }
 
@@ -153,6 +169,13 @@ DBSyncConnection::fetchOpsData( const QString& sinceguid )
 {
     changeState( FETCHING );
 
+    // only the first sync (nothing synced yet) is worth the statistics, not every check for new ops
+    if ( sinceguid.isEmpty() && !m_fetchTimer.isValid() )
+    {
+        m_fetchTimer.start();
+        m_fetchedOps = 0;
+    }
+
     tLog() << "Sending a FETCHOPS cmd since:" << sinceguid << "- source:" << m_source->id();
 
     QVariantMap msg;
@@ -177,6 +200,13 @@ DBSyncConnection::handleMsg( msg_ptr msg )
     {
         changeState( SYNCED );
 
+        if ( m_fetchTimer.isValid() )
+        {
+            tLog() << "Synced" << m_fetchedOps << "ops from source" << m_source->id() << "in" << m_fetchTimer.elapsed() << "ms,"
+                   << "peak memory usage:" << TomahawkUtils::peakMemoryUsage() / ( 1024 * 1024 ) << "MB";
+            m_fetchTimer.invalidate();
+        }
+
         // calc the collection stats, to updates the "X tracks" in the sidebar etc
         // this is done automatically if you run a dbcmd to add files.
         DatabaseCommand_CollectionStats* cmd = new DatabaseCommand_CollectionStats( m_source );
@@ -204,6 +234,7 @@ DBSyncConnection::handleMsg( msg_ptr msg )
         {
             m_source->addCommand( cmd );
         }
+        m_fetchedOps++;
 
         if ( !msg->is( Msg::FRAGMENT ) ) // last msg in this batch
         {
@@ -247,11 +278,23 @@ DBSyncConnection::lastOpApplied()
 void
 DBSyncConnection::sendOps()
 {
-    tLog() << "Will send peer" << m_source->id() << "all ops since" << m_uscache.value( "lastop" ).toString();
+    tLog() << "Will send peer" << m_source->id() << "ops since" << m_uscache.value( "lastop" ).toString();
+
+    if ( m_uscache.value( "lastop" ).toString().isEmpty() && !m_sendTimer.isValid() )
+    {
+        m_sendTimer.start();
+        m_sentOps = 0;
+    }
 
     source_ptr src = SourceList::instance()->getLocal();
 
     DatabaseCommand_loadOps* cmd = new DatabaseCommand_loadOps( src, m_uscache.value( "lastop" ).toString() );
+    cmd->setLimit( OPS_PER_PAGE );
+
+    // fall back to JSON unless the peer told us it understands binary ops
+    ControlConnection* cc = m_source->controlConnection();
+    cmd->setBinary( cc && cc->peerSupports( DbOpCodec::featureName() ) );
+    setCompressionCodec( cc ? cc->compressionCodec() : MsgCompression::Zlib );
     connect( cmd, SIGNAL( done( QString, QString, QList< dbop_ptr > ) ),
                     SLOT( sendOpsData( QString, QString, QList< dbop_ptr > ) ) );
 
@@ -272,22 +315,43 @@ DBSyncConnection::sendOpsData( QString sinceguid, QString lastguid, QList< dbop_
     {
         tLog( LOGVERBOSE ) << "Sending ok" << m_source->id() << m_source->friendlyName();
         sendMsg( Msg::factory( "ok", Msg::DBOP ) );
+
+        if ( m_sendTimer.isValid() )
+        {
+            tLog() << "Sent" << m_sentOps << "ops to source" << m_source->id() << "in" << m_sendTimer.elapsed() << "ms,"
+                   << "peak memory usage:" << TomahawkUtils::peakMemoryUsage() / ( 1024 * 1024 ) << "MB";
+            m_sendTimer.invalidate();
+        }
         return;
     }
 
     tLog( LOGVERBOSE ) << Q_FUNC_INFO << sinceguid << lastguid << "Num ops to send:" << ops.length();
 
-    int i;
-    for( i = 0; i < ops.length(); ++i )
+    // the peer only asks for the next page once it applied this one
+    m_queuedOps = ops;
+    sendQueuedOps();
+}
+
+
+void
+DBSyncConnection::sendQueuedOps()
+{
+    // Hand ops to the socket as it drains, instead of queueing the whole page at once
+    while ( !m_queuedOps.isEmpty() && m_state != SHUTDOWN &&
+            queuedMessages() < MAX_QUEUED_MSGS && bytesToWrite() < MAX_QUEUED_BYTES )
     {
-        quint8 flags = Msg::JSON | Msg::DBOP;
+        const dbop_ptr op = m_queuedOps.takeFirst();
 
-        if ( ops.at( i )->compressed )
+        quint8 flags = Msg::JSON | Msg::DBOP;
+        if ( op->compressed )
             flags |= Msg::COMPRESSED;
-        if ( i != ops.length() - 1 )
+        if ( op->binary )
+            flags |= Msg::BINARY;
+        if ( !m_queuedOps.isEmpty() )
             flags |= Msg::FRAGMENT;
 
-        sendMsg( Msg::factory( ops.at( i )->payload, flags ) );
+        sendMsg( Msg::factory( op->payload, flags ) );
+        m_sentOps++;
     }
 }
 
@@ -25,6 +25,7 @@
 #include "database/Op.h"
 #include "Typedefs.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
 #include <QSharedPointer>
@@ -61,6 +62,7 @@ private slots:
 
     void fetchOpsData( const QString& sinceguid );
     void sendOpsData( QString sinceguid, QString lastguid, QList< dbop_ptr > ops );
+    void sendQueuedOps();
     void lastOpApplied();
 
     void check();
@@ -74,6 +76,14 @@ private:
     QVariantMap m_uscache;
 
     QString m_lastSentOp;
+    // the page of ops currently being streamed to the peer
+    QList< dbop_ptr > m_queuedOps;
+
+    // first sync statistics, in both directions
+    QElapsedTimer m_sendTimer;
+    int m_sentOps;
+    QElapsedTimer m_fetchTimer;
+    int m_fetchedOps;
 
     Tomahawk::DBSyncConnectionState m_state;
 };
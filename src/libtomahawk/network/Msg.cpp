@@ -19,6 +19,7 @@
 
 #include "Msg_p.h"
 
+#include "DbOpCodec.h"
 #include "utils/Json.h"
 
 #include <QtEndian>
@@ -48,11 +49,11 @@ Msg::factory( const QByteArray& ba, char f )
 
 
 msg_ptr
-Msg::begin( char* headerToParse )
+Msg::begin( const char* headerToParse )
 {
-    quint32 lenBE = *( (quint32*) headerToParse );
-    quint8 flags = *( (quint8*) (headerToParse+4) );
-    return msg_ptr( new Msg( qFromBigEndian(lenBE), flags ) );
+    quint32 len = qFromBigEndian< quint32 >( (const uchar*) headerToParse );
+    quint8 flags = *( (const quint8*) (headerToParse+4) );
+    return msg_ptr( new Msg( len, flags ) );
 }
 
 
@@ -71,15 +72,23 @@ bool
 Msg::write( QIODevice * device )
 {
     Q_D( Msg );
-    quint32 size  = qToBigEndian( d->length );
-    quint8  flags = d->flags;
-    if( device->write( (const char*) &size,  sizeof(quint32) ) != sizeof(quint32) ) return false;
-    if( device->write( (const char*) &flags, sizeof(quint8) )  != sizeof(quint8)  ) return false;
+    char header[ headerSize() ];
+    writeHeader( header );
+    if( device->write( header, headerSize() ) != headerSize() ) return false;
     if( device->write( (const char*) d->payload.data(), d->length ) != d->length ) return false;
     return true;
 }
 
 
+void
+Msg::writeHeader( char* header ) const
+{
+    Q_D( const Msg );
+    qToBigEndian< quint32 >( d->length, (uchar*) header );
+    header[ 4 ] = d->flags;
+}
+
+
 quint8
 Msg::headerSize()
 {
@@ -124,7 +133,10 @@ Msg::json()
     if( !d->json_parsed )
     {
         bool ok;
-        d->json = TomahawkUtils::parseJson( d->payload, &ok );
+        if ( is( BINARY ) )
+            d->json = DbOpCodec::decode( d->payload, &ok );
+        else
+            d->json = TomahawkUtils::parseJson( d->payload, &ok );
         d->json_parsed = true;
     }
     return d->json;
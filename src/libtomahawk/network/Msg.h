@@ -31,6 +31,7 @@
 #ifndef MSG_H
 #define MSG_H
 
+#include "DllMacro.h"
 #include "Typedefs.h"
 
 #include <QSharedPointer>
@@ -39,7 +40,7 @@ class MsgPrivate;
 class QByteArray;
 class QIODevice;
 
-class Msg
+class DLLEXPORT Msg
 {
     friend class MsgProcessor;
 
@@ -52,7 +53,7 @@ public:
         COMPRESSED = 8,
         DBOP = 16,
         PING = 32,
-        RESERVED_1 = 64,
+        BINARY = 64, // with JSON: the document is in DbOpCodec's binary encoding
         SETUP = 128 // used to handshake/auth the connection prior to handing over to Connection subclass
     };
 
@@ -66,7 +67,7 @@ public:
     /**
      * constructs an incomplete new msg that is missing the payload data
      */
-    static msg_ptr begin( char* headerToParse );
+    static msg_ptr begin( const char* headerToParse );
 
     /**
      * completes msg construction by providing payload data
@@ -78,6 +79,11 @@ public:
      */
     bool write( QIODevice * device );
 
+    /**
+     * writes the header for this msg to header, which has to have room for headerSize() bytes
+     */
+    void writeHeader( char* header ) const;
+
     // len(4) + flags(1)
     static quint8 headerSize();
 
@@ -0,0 +1,150 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MsgCompression.h"
+
+#include "config.h"
+#include "utils/Logger.h"
+
+#include <QtEndian>
+
+#ifdef LZ4_FOUND
+    #include <lz4.h>
+#endif
+
+// First byte of frames that aren't plain qCompress() output
+#define FRAME_MARKER 0xff
+// marker, codec, uncompressed length
+#define FRAME_HEADER_SIZE 6
+// Sanity limit, so garbage input can't make us allocate gigabytes
+#define MAX_UNCOMPRESSED_SIZE ( 256 * 1024 * 1024 )
+
+#define ZLIB_LEVEL_FAST 1
+#define ZLIB_LEVEL_STRONG 6
+// LZ4 trades ratio for speed with growing acceleration values, 1 is its default
+#define LZ4_ACCELERATION_FAST 4
+#define LZ4_ACCELERATION_STRONG 1
+
+
+QList< MsgCompression::Codec >
+MsgCompression::availableCodecs()
+{
+    QList< Codec > codecs;
+#ifdef LZ4_FOUND
+    codecs << LZ4;
+#endif
+    codecs << Zlib;
+
+    return codecs;
+}
+
+
+QString
+MsgCompression::featureName( Codec codec )
+{
+    switch ( codec )
+    {
+        case LZ4:
+            return QLatin1String( "compression-lz4" );
+        case Zlib:
+            break;
+    }
+
+    return QString();
+}
+
+
+QStringList
+MsgCompression::features()
+{
+    QStringList features;
+    foreach ( Codec codec, availableCodecs() )
+    {
+        if ( codec != Zlib )
+            features << featureName( codec );
+    }
+
+    return features;
+}
+
+
+QByteArray
+MsgCompression::compress( const QByteArray& data, Codec codec, Level level )
+{
+#ifdef LZ4_FOUND
+    if ( codec == LZ4 )
+    {
+        QByteArray frame( FRAME_HEADER_SIZE + LZ4_compressBound( data.size() ), Qt::Uninitialized );
+        frame[ 0 ] = char( FRAME_MARKER );
+        frame[ 1 ] = char( LZ4 );
+        qToBigEndian< quint32 >( data.size(), (uchar*)frame.data() + 2 );
+
+        const int size = LZ4_compress_fast( data.constData(), frame.data() + FRAME_HEADER_SIZE, data.size(),
+                                            frame.size() - FRAME_HEADER_SIZE,
+                                            level == Fast ? LZ4_ACCELERATION_FAST : LZ4_ACCELERATION_STRONG );
+        if ( size > 0 )
+        {
+            frame.resize( FRAME_HEADER_SIZE + size );
+            return frame;
+        }
+
+        tLog() << Q_FUNC_INFO << "LZ4 compression failed, falling back to zlib";
+    }
+#else
+    Q_ASSERT( codec == Zlib );
+#endif
+
+    return qCompress( data, level == Fast ? ZLIB_LEVEL_FAST : ZLIB_LEVEL_STRONG );
+}
+
+
+QByteArray
+MsgCompression::uncompress( const QByteArray& data, bool* ok )
+{
+    QByteArray result;
+
+    if ( !data.isEmpty() && quint8( data.at( 0 ) ) != FRAME_MARKER )
+    {
+        result = qUncompress( data );
+    }
+    else if ( data.size() >= FRAME_HEADER_SIZE )
+    {
+        const quint32 size = qFromBigEndian< quint32 >( (const uchar*)data.constData() + 2 );
+
+#ifdef LZ4_FOUND
+        if ( data.at( 1 ) == char( LZ4 ) && size > 0 && size <= MAX_UNCOMPRESSED_SIZE )
+        {
+            result.resize( size );
+            const int read = LZ4_decompress_safe( data.constData() + FRAME_HEADER_SIZE, result.data(),
+                                                  data.size() - FRAME_HEADER_SIZE, size );
+            if ( read != int( size ) )
+                result.clear();
+        }
+#else
+        Q_UNUSED( size );
+#endif
+    }
+
+    if ( ok )
+        *ok = !result.isEmpty();
+    if ( result.isEmpty() )
+        tLog() << Q_FUNC_INFO << "Failed to uncompress frame of" << data.size() << "bytes";
+
+    return result;
+}
@@ -0,0 +1,69 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+    Compression for the payload of Msg::COMPRESSED frames.
+    ======================================================
+    zlib frames are plain qCompress() output, which every peer understands.
+    Other codecs are only used towards peers that advertised them in the
+    ControlConnection handshake, their frames start with a marker byte
+    qCompress() output can't start with (it starts with the big endian
+    uncompressed length, and payloads are well below 2GB), followed by the
+    codec and the uncompressed length.
+*/
+
+#pragma once
+#ifndef MSGCOMPRESSION_H
+#define MSGCOMPRESSION_H
+
+#include "DllMacro.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+
+class DLLEXPORT MsgCompression
+{
+public:
+    enum Codec
+    {
+        Zlib = 0,
+        LZ4 = 1
+    };
+
+    enum Level
+    {
+        Fast = 0,
+        Strong
+    };
+
+    /// Codecs this build supports, the preferred one first. Always includes Zlib.
+    static QList< Codec > availableCodecs();
+
+    /// Name of the feature peers advertise in the ControlConnection handshake.
+    static QString featureName( Codec codec );
+    /// Features to advertise, there is none for Zlib as every peer supports it.
+    static QStringList features();
+
+    static QByteArray compress( const QByteArray& data, Codec codec, Level level );
+    /// Handles frames of any available codec, returns an empty QByteArray on failure.
+    static QByteArray uncompress( const QByteArray& data, bool* ok = 0 );
+};
+
+#endif // MSGCOMPRESSION_H
@@ -0,0 +1,111 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "MsgFramer.h"
+
+#include "network/Msg.h"
+#include "utils/Logger.h"
+
+#include <QIODevice>
+
+// Larger payloads are handed to the device directly instead of being copied into the buffer
+#define MAX_COALESCED_PAYLOAD ( 16 * 1024 )
+// The buffer is flushed once it grows beyond this
+#define MAX_BUFFER_SIZE ( 64 * 1024 )
+
+
+MsgFramer::MsgFramer( QIODevice* device )
+    : m_device( device )
+{
+}
+
+
+void
+MsgFramer::setDevice( QIODevice* device )
+{
+    Q_ASSERT( m_buffer.isEmpty() );
+    m_device = device;
+}
+
+
+msg_ptr
+MsgFramer::read( bool* ok )
+{
+    if ( ok )
+        *ok = true;
+
+    if ( !m_device || m_device->bytesAvailable() < Msg::headerSize() )
+        return msg_ptr();
+
+    char header[ Msg::headerSize() ];
+    if ( m_device->peek( header, Msg::headerSize() ) != Msg::headerSize() )
+        return msg_ptr();
+
+    msg_ptr msg = Msg::begin( header );
+    if ( m_device->bytesAvailable() < Msg::headerSize() + (qint64)msg->length() )
+        return msg_ptr();
+
+    QByteArray payload( msg->length(), Qt::Uninitialized );
+    if ( m_device->read( header, Msg::headerSize() ) != Msg::headerSize() ||
+         m_device->read( payload.data(), payload.size() ) != payload.size() )
+    {
+        tDebug() << Q_FUNC_INFO << "Failed to read msg of" << msg->length() << "bytes";
+        if ( ok )
+            *ok = false;
+        return msg_ptr();
+    }
+
+    msg->fill( payload );
+    return msg;
+}
+
+
+bool
+MsgFramer::write( const msg_ptr& msg )
+{
+    Q_ASSERT( m_device );
+
+    char header[ Msg::headerSize() ];
+    msg->writeHeader( header );
+    m_buffer.append( header, Msg::headerSize() );
+
+    if ( msg->length() > MAX_COALESCED_PAYLOAD )
+    {
+        return flush() && m_device->write( msg->payload() ) == msg->length();
+    }
+
+    m_buffer.append( msg->payload() );
+    if ( m_buffer.size() > MAX_BUFFER_SIZE )
+        return flush();
+
+    return true;
+}
+
+
+bool
+MsgFramer::flush()
+{
+    if ( m_buffer.isEmpty() )
+        return true;
+
+    const bool success = m_device && m_device->write( m_buffer ) == m_buffer.size();
+    m_buffer.clear();
+
+    return success;
+}
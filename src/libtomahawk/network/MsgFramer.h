@@ -0,0 +1,70 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+    MsgFramer reads and writes Msgs on a device, usually a Connection's socket.
+
+    Reading peeks at the header in the device's buffer and only takes a msg
+    off the device once its payload is complete, so all msgs that arrived
+    can be read in one go and no state is kept for partial msgs.
+
+    Writing collects the frames of small msgs in a buffer that is handed to
+    the device with a single write on flush(), or once it is big enough.
+    Large payloads go to the device as they are, without being copied into
+    the buffer first.
+*/
+
+#pragma once
+#ifndef MSGFRAMER_H
+#define MSGFRAMER_H
+
+#include "DllMacro.h"
+#include "Typedefs.h"
+
+#include <QByteArray>
+
+class QIODevice;
+
+class DLLEXPORT MsgFramer
+{
+public:
+    explicit MsgFramer( QIODevice* device = 0 );
+
+    void setDevice( QIODevice* device );
+    QIODevice* device() const { return m_device; }
+
+    /**
+     * Returns the next complete msg on the device, or a null msg_ptr if
+     * there is none (yet). Sets ok to false if reading from the device failed.
+     */
+    msg_ptr read( bool* ok = 0 );
+
+    /// Frames msg, it is written to the device by the next flush() at the latest.
+    bool write( const msg_ptr& msg );
+    bool flush();
+
+    /// Bytes passed to write() that haven't been handed to the device yet.
+    qint64 bufferedBytes() const { return m_buffer.size(); }
+
+private:
+    QIODevice* m_device;
+    QByteArray m_buffer;
+};
+
+#endif // MSGFRAMER_H
@@ -18,24 +18,127 @@
 
 #include "MsgProcessor.h"
 
+#include "network/DbOpCodec.h"
 #include "network/Msg_p.h"
 #include "network/Servent.h"
 #include "utils/Json.h"
 #include "utils/Logger.h"
 #include "utils/TomahawkUtils.h"
 
+#include <QElapsedTimer>
 #include <QThread>
+#include <QThreadPool>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <qtconcurrentrun.h>
 
+// Msg types are told apart by these flags, each gets its own compression policy
+#define POLICY_FLAGS ( Msg::RAW | Msg::DBOP | Msg::BINARY )
+// Types saving less than this get their threshold raised, until we stop compressing them
+#define POOR_RATIO 0.9
+// Types saving more than this get their threshold lowered again
+#define GOOD_RATIO 0.5
+#define MAX_THRESHOLD ( 64 * 1024 )
+// Every n-th msg below a raised threshold is compressed anyway, to find out if the type compresses well again
+#define PROBE_INTERVAL 32
+
+
+namespace
+{
+
+// Keep (de)compression of network traffic from competing with everything
+// else that runs on the global pool, e.g. the MusicScanner
+class CompressionThreadPool : public QThreadPool
+{
+public:
+    CompressionThreadPool()
+    {
+        setMaxThreadCount( qMax( 2, QThread::idealThreadCount() / 2 ) );
+    }
+};
+
+}
+
+Q_GLOBAL_STATIC( CompressionThreadPool, s_pool )
+
+
 MsgProcessor::MsgProcessor( quint32 mode, quint32 t ) :
-    QObject(), m_mode( mode ), m_threshold( t ), m_totmsgsize( 0 )
+    QObject(), m_mode( mode ), m_threshold( t ), m_codec( MsgCompression::Zlib ),
+    m_bytesSaved( 0 ), m_compressionNsecs( 0 ), m_totmsgsize( 0 )
 {
     moveToThread( Servent::instance()->thread() );
 }
 
 
+QThreadPool*
+MsgProcessor::pool()
+{
+    return s_pool();
+}
+
+
+MsgProcessor::Policy&
+MsgProcessor::policy( const msg_ptr& msg )
+{
+    const quint8 type = msg->flags() & POLICY_FLAGS;
+
+    QHash< quint8, Policy >::iterator it = m_policies.find( type );
+    if ( it == m_policies.end() )
+    {
+        Policy p;
+        p.threshold = m_threshold;
+        p.level = MsgCompression::Fast;
+        p.ratio = 0.5;
+        p.skipped = 0;
+
+        if ( type == Msg::DBOP )
+        {
+            // JSON ops are bulky and very redundant, a sync is bound by the network
+            p.level = MsgCompression::Strong;
+        }
+        else if ( type == ( Msg::DBOP | Msg::BINARY ) )
+        {
+            // already compact, small ones aren't worth it
+            p.threshold = m_threshold * 4;
+        }
+
+        p.baseThreshold = p.threshold;
+        it = m_policies.insert( type, p );
+    }
+
+    return it.value();
+}
+
+
+void
+MsgProcessor::updatePolicy( const Job& job )
+{
+    m_compressionNsecs += job.nsecs;
+    if ( job.compressedBytes == 0 || job.uncompressedBytes == 0 )
+        return;
+
+    m_bytesSaved += job.uncompressedBytes - job.compressedBytes;
+    if ( !( job.mode & COMPRESS_IF_LARGE ) )
+        return;
+
+    Policy& p = policy( job.msg );
+    p.ratio = 0.8 * p.ratio + 0.2 * ( (float)job.compressedBytes / job.uncompressedBytes );
+
+    if ( p.ratio > POOR_RATIO && p.threshold < MAX_THRESHOLD )
+    {
+        p.threshold = qMin< quint32 >( p.threshold * 2, MAX_THRESHOLD );
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Msgs of type" << ( job.msg->flags() & POLICY_FLAGS )
+                             << "hardly compress, raising threshold to" << p.threshold;
+    }
+    else if ( p.ratio < GOOD_RATIO && p.threshold > p.baseThreshold )
+    {
+        p.threshold = qMax( p.threshold / 2, p.baseThreshold );
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Msgs of type" << ( job.msg->flags() & POLICY_FLAGS )
+                             << "compress well again, lowering threshold to" << p.threshold;
+    }
+}
+
+
 void
 MsgProcessor::append( msg_ptr msg )
 {
@@ -58,8 +161,36 @@ MsgProcessor::append( msg_ptr msg )
         return;
     }
 
-    QFuture<msg_ptr> fut = QtConcurrent::run(&MsgProcessor::process, msg, m_mode, m_threshold);
-    QFutureWatcher<msg_ptr> * watcher = new QFutureWatcher<msg_ptr>;
+    Job job;
+    job.msg = msg;
+    job.mode = m_mode;
+    job.codec = m_codec;
+    if ( m_mode & COMPRESS_IF_LARGE )
+    {
+        Policy& p = policy( msg );
+        job.threshold = p.threshold;
+        job.level = p.level;
+
+        // Msgs below a raised threshold don't tell us anything about the ratio
+        // anymore, without a probe now and then it could never come down again
+        if ( msg->length() > p.baseThreshold && msg->length() <= p.threshold && ++p.skipped >= PROBE_INTERVAL )
+        {
+            job.threshold = p.baseThreshold;
+            p.skipped = 0;
+        }
+    }
+    else
+    {
+        job.threshold = m_threshold;
+        job.level = MsgCompression::Fast;
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 4, 0 )
+    QFuture<Job> fut = QtConcurrent::run( pool(), &MsgProcessor::process, job );
+#else
+    QFuture<Job> fut = QtConcurrent::run( &MsgProcessor::process, job );
+#endif
+    QFutureWatcher<Job> * watcher = new QFutureWatcher<Job>;
     connect( watcher, SIGNAL( finished() ),
              this, SLOT( processed() ),
              Qt::QueuedConnection );
@@ -71,10 +202,11 @@ MsgProcessor::append( msg_ptr msg )
 void
 MsgProcessor::processed()
 {
-    QFutureWatcher<msg_ptr> * watcher = (QFutureWatcher<msg_ptr> *) sender();
-    msg_ptr msg = watcher->result();
+    QFutureWatcher<Job> * watcher = (QFutureWatcher<Job> *) sender();
+    const Job job = watcher->result();
     watcher->deleteLater();
-    handleProcessedMsg( msg );
+    updatePolicy( job );
+    handleProcessedMsg( job.msg );
 }
 
 
@@ -106,38 +238,68 @@ MsgProcessor::handleProcessedMsg( msg_ptr msg )
 
 
 /// This method is run by QtConcurrent:
-msg_ptr
-MsgProcessor::process( msg_ptr msg, quint32 mode, quint32 threshold )
+MsgProcessor::Job
+MsgProcessor::process( Job job )
 {
+    msg_ptr msg = job.msg;
+    job.compressedBytes = 0;
+    job.uncompressedBytes = 0;
+    job.nsecs = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
     // uncompress if needed
-    if( (mode & UNCOMPRESS_ALL) && msg->is( Msg::COMPRESSED ) )
+    if( (job.mode & UNCOMPRESS_ALL) && msg->is( Msg::COMPRESSED ) )
     {
 //        qDebug() << "MsgProcessor::UNCOMPRESSING";
-        msg->d_func()->payload = qUncompress( msg->payload() );
+        job.compressedBytes = msg->length();
+        msg->d_func()->payload = MsgCompression::uncompress( msg->payload() );
         msg->d_func()->length  = msg->d_func()->payload.length();
         msg->d_func()->flags ^= Msg::COMPRESSED;
+        job.uncompressedBytes = msg->length();
+        job.nsecs = timer.nsecsElapsed();
     }
 
     // parse json payload into qvariant if needed
-    if( (mode & PARSE_JSON) &&
+    if( (job.mode & PARSE_JSON) &&
         msg->is( Msg::JSON ) &&
         msg->d_func()->json_parsed == false )
     {
 //        qDebug() << "MsgProcessor::PARSING JSON";
         bool ok;
-        msg->d_func()->json = TomahawkUtils::parseJson( msg->payload(), &ok );
+        if ( msg->is( Msg::BINARY ) )
+            msg->d_func()->json = DbOpCodec::decode( msg->payload(), &ok );
+        else
+            msg->d_func()->json = TomahawkUtils::parseJson( msg->payload(), &ok );
         msg->d_func()->json_parsed = true;
     }
 
     // compress if needed
-    if( (mode & COMPRESS_IF_LARGE) &&
+    if( (job.mode & COMPRESS_IF_LARGE) &&
         !msg->is( Msg::COMPRESSED )
-        && msg->length() > threshold )
+        && msg->length() > job.threshold )
     {
 //        qDebug() << "MsgProcessor::COMPRESSING";
-        msg->d_func()->payload = qCompress( msg->payload(), 9 );
-        msg->d_func()->length  = msg->d_func()->payload.length();
-        msg->d_func()->flags |= Msg::COMPRESSED;
+        timer.restart();
+        const QByteArray compressed = MsgCompression::compress( msg->payload(), job.codec, job.level );
+        job.nsecs = timer.nsecsElapsed();
+        job.uncompressedBytes = msg->length();
+        job.compressedBytes = compressed.length();
+
+        // incompressible payloads go out as they are
+        if ( compressed.length() < msg->payload().length() )
+        {
+            msg->d_func()->payload = compressed;
+            msg->d_func()->length  = msg->d_func()->payload.length();
+            msg->d_func()->flags |= Msg::COMPRESSED;
+        }
+        else
+        {
+            job.compressedBytes = job.uncompressedBytes;
+        }
     }
-    return msg;
+
+    job.msg = msg;
+    return job;
 }
@@ -23,7 +23,15 @@
     It can be configured to auto-compress, or de-compress msgs for sending
     or receiving.
 
-    It uses QtConcurrent, but preserves msg order.
+    It uses QtConcurrent on a pool shared by all MsgProcessors, but preserves
+    msg order.
+
+    Outgoing msgs are compressed with the codec set for the connection. The
+    size threshold and compression level are kept per msg type (control msgs,
+    JSON DB ops, binary DB ops, raw data) and adapt to how well each type
+    compresses, so we stop spending CPU on payloads that hardly shrink. Some
+    msgs below a raised threshold still get compressed as probes, so the
+    threshold comes down again once the payloads change.
 
     NOT threadsafe.
 */
@@ -32,9 +40,13 @@
 
 #include "Typedefs.h"
 #include "Msg.h" // Needed because we have msg_ptr in a slot
+#include "MsgCompression.h"
 
+#include <QHash>
 #include <QObject>
 
+class QThreadPool;
+
 class MsgProcessor : public QObject
 {
 Q_OBJECT
@@ -47,14 +59,35 @@ public:
         PARSE_JSON = 4
     };
 
+    struct Job
+    {
+        msg_ptr msg;
+        quint32 mode;
+        quint32 threshold;
+        MsgCompression::Codec codec;
+        MsgCompression::Level level;
+
+        // filled in by process()
+        qint64 compressedBytes;
+        qint64 uncompressedBytes;
+        qint64 nsecs;
+    };
+
     explicit MsgProcessor( quint32 mode = NOTHING, quint32 t = 512 );
 
     void setMode( quint32 m ) { m_mode = m ; }
+    void setCodec( MsgCompression::Codec codec ) { m_codec = codec; }
+    MsgCompression::Codec codec() const { return m_codec; }
 
-    static msg_ptr process( msg_ptr msg, quint32 mode, quint32 threshold );
+    static Job process( Job job );
 
     int length() const { return m_msgs.length(); }
 
+    /// Bytes that didn't have to go over the wire thanks to compression
+    qint64 bytesSaved() const { return m_bytesSaved; }
+    /// Time spent compressing / uncompressing, in ms
+    qint64 compressionTime() const { return m_compressionNsecs / 1000000; }
+
 signals:
     void ready( msg_ptr );
     void empty();
@@ -64,10 +97,27 @@ public slots:
     void processed();
 
 private:
+    struct Policy
+    {
+        quint32 threshold;
+        quint32 baseThreshold; // where threshold started, it never drops below
+        MsgCompression::Level level;
+        float ratio; // moving average of compressed / uncompressed size
+        quint32 skipped; // msgs left uncompressed since the last probe
+    };
+
+    static QThreadPool* pool();
+
     void handleProcessedMsg( msg_ptr msg );
+    Policy& policy( const msg_ptr& msg );
+    void updatePolicy( const Job& job );
 
     quint32 m_mode;
     quint32 m_threshold;
+    MsgCompression::Codec m_codec;
+    QHash< quint8, Policy > m_policies;
+    qint64 m_bytesSaved;
+    qint64 m_compressionNsecs;
     QList<msg_ptr> m_msgs;
     QMap< Msg*, bool> m_msg_ready;
     unsigned int m_totmsgsize;
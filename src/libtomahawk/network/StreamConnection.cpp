@@ -31,11 +31,32 @@
 #include "MsgProcessor.h"
 #include "Result.h"
 #include "SourceList.h"
+#include "TomahawkSettings.h"
 #include "UrlHandler.h"
 
 #include <QFile>
+#include <QtEndian>
 #include <QTimer>
 
+#include <string.h>
+
+// Block size we ask for in windowed transfers, and the range senders accept
+#define WINDOW_BLOCK_SIZE ( 64 * 1024 )
+#define MIN_BLOCK_SIZE 4096
+#define MAX_BLOCK_SIZE ( 1024 * 1024 )
+// Blocks a receiver keeps in flight, enough to cover a few 100ms of latency
+#define MAX_BLOCKS_IN_FLIGHT 8
+// Blocks a sender keeps queued on its socket
+#define MAX_QUEUED_BLOCKS 4
+// Ranges a sender accepts before it's done with them. A receiver only asks for
+// MAX_BLOCKS_IN_FLIGHT blocks at a time, anything beyond that is a misbehaving peer
+#define MAX_QUEUED_RANGES ( 4 * MAX_BLOCKS_IN_FLIGHT )
+// "chunk" + block index
+#define CHUNK_HEADER_SIZE 9
+// How long a sender waits for the window request the peer announced before it
+// starts a sequential transfer, so a lost or late request can't stall us
+#define WINDOW_REQUEST_TIMEOUT 5000
+
 using namespace Tomahawk;
 
 
@@ -50,6 +71,15 @@ StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString f
     , m_allok( false )
     , m_result( result )
     , m_transferRate( 0 )
+    , m_windowed( false )
+    , m_windowRequested( false )
+    , m_waitForWindow( false )
+    , m_blockSize( BufferIODevice::defaultBlockSize() )
+    , m_uploadLimit( 0 )
+    , m_uploadQuota( 0 )
+    , m_throttleTimer( this ) // moves along with us to the connection's thread
+    , m_sentLast( false )
+    , m_awaitedBlock( 0 )
 {
     qDebug() << Q_FUNC_INFO;
 
@@ -82,6 +112,15 @@ StreamConnection::StreamConnection( Servent* s, ControlConnection* cc, QString f
     , m_bsent( 0 )
     , m_allok( false )
     , m_transferRate( 0 )
+    , m_windowed( false )
+    , m_windowRequested( false )
+    , m_waitForWindow( false )
+    , m_blockSize( BufferIODevice::defaultBlockSize() )
+    , m_uploadLimit( 0 )
+    , m_uploadQuota( 0 )
+    , m_throttleTimer( this ) // moves along with us to the connection's thread
+    , m_sentLast( false )
+    , m_awaitedBlock( 0 )
 {
     Servent::instance()->registerStreamConnection( this );
     // auto delete when connection closes:
@@ -117,6 +156,13 @@ StreamConnection::id() const
 }
 
 
+QString
+StreamConnection::windowFeatureName()
+{
+    return QLatin1String( "stream-window" );
+}
+
+
 Tomahawk::source_ptr
 StreamConnection::source() const
 {
@@ -124,6 +170,13 @@ StreamConnection::source() const
 }
 
 
+BufferIODevice*
+StreamConnection::bufferDevice() const
+{
+    return (BufferIODevice*)m_iodev.data();
+}
+
+
 void
 StreamConnection::showStats( qint64 tx, qint64 rx )
 {
@@ -157,14 +210,34 @@ StreamConnection::setup()
     }
 
     connect( this, SIGNAL( statsTick( qint64, qint64 ) ), SLOT( showStats( qint64, qint64 ) ) );
+    const bool peerSupportsWindow = m_cc && m_cc->peerSupports( windowFeatureName() );
     if ( m_type == RECEIVING )
     {
         qDebug() << "in RX mode";
+        m_latencyTimer.start();
+
+        // The peer waits for our answer. We need to know the size to tell which
+        // blocks are missing, asking for block size 0 gets us a sequential transfer.
+        if ( peerSupportsWindow )
+        {
+            m_windowRequested = true;
+            const int blockSize = bufferDevice()->size() > 0 ? WINDOW_BLOCK_SIZE : 0;
+            sendMsg( Msg::factory( QString( "window%1" ).arg( blockSize ).toLatin1(), Msg::RAW | Msg::FRAGMENT ) );
+        }
+
         emit updated();
         return;
     }
 
     qDebug() << "in TX mode, fid:" << m_fid;
+    m_waitForWindow = peerSupportsWindow;
+    if ( m_waitForWindow )
+        QTimer::singleShot( WINDOW_REQUEST_TIMEOUT, this, SLOT( onWindowRequestTimeout() ) );
+
+    m_uploadLimit = qint64( TomahawkSettings::instance()->uploadRateLimit() ) * 1024;
+    m_throttleTimer.setSingleShot( true );
+    connect( &m_throttleTimer, SIGNAL( timeout() ), SLOT( sendSome() ) );
+    connect( this, SIGNAL( dataWritten() ), SLOT( sendSome() ) );
 
     DatabaseCommand_LoadFiles* cmd = new DatabaseCommand_LoadFiles( m_fid.toUInt() );
     connect( cmd, SIGNAL( result( Tomahawk::result_ptr ) ), SLOT( startSending( Tomahawk::result_ptr ) ) );
@@ -207,21 +280,141 @@ StreamConnection::reallyStartSending( const Tomahawk::result_ptr result, const Q
     }
 
     m_readdev = QSharedPointer<QIODevice>( io );
-    sendSome();
+    if ( !m_waitForWindow || m_windowRequested )
+        beginSending();
 
     emit updated();
 }
 
 
+void
+StreamConnection::onWindowRequestTimeout()
+{
+    if ( !m_waitForWindow || m_windowRequested )
+        return;
+
+    tLog() << id() << "Peer didn't ask for a window in time, sending" << m_fid << "sequentially";
+    m_waitForWindow = false;
+    if ( m_readdev )
+        beginSending();
+}
+
+
+void
+StreamConnection::beginSending()
+{
+    m_quotaTimer.start();
+
+    // ranges can only be served from devices we can seek in
+    if ( m_windowRequested && m_blockSize >= MIN_BLOCK_SIZE && m_blockSize <= MAX_BLOCK_SIZE &&
+         !m_readdev->isSequential() )
+    {
+        m_windowed = true;
+        sendMsg( Msg::factory( "windowok", Msg::RAW | Msg::FRAGMENT ) );
+        return;
+    }
+
+    if ( m_windowRequested )
+    {
+        tDebug() << Q_FUNC_INFO << "Falling back to a sequential transfer, block size:" << m_blockSize;
+        sendMsg( Msg::factory( "windowno", Msg::RAW | Msg::FRAGMENT ) );
+    }
+
+    m_blockSize = BufferIODevice::defaultBlockSize();
+    sendSome();
+}
+
+
 void
 StreamConnection::handleMsg( msg_ptr msg )
 {
     Q_ASSERT( msg->is( Msg::RAW ) );
 
-    if ( msg->payload().startsWith( "block" ) )
+    if ( msg->payload().startsWith( "chunk" ) && msg->length() >= CHUNK_HEADER_SIZE )
+    {
+        const int block = qFromBigEndian< quint32 >( (const uchar*)msg->payload().constData() + 5 );
+        m_requestedBlocks.remove( block );
+
+        // an empty chunk: the peer can't read that block, we won't ever get the whole file
+        if ( msg->length() == CHUNK_HEADER_SIZE )
+        {
+            tLog() << id() << "Peer failed to send block" << block << "of" << m_fid;
+            shutdown();
+            return;
+        }
+
+        m_badded += msg->length() - CHUNK_HEADER_SIZE;
+
+        if ( block == m_awaitedBlock && m_latencyTimer.isValid() )
+        {
+            tLog( LOGVERBOSE ) << id() << "Got block" << block << "after" << m_latencyTimer.elapsed() << "ms";
+            m_latencyTimer.invalidate();
+        }
+
+        bufferDevice()->addData( block, msg->payload().mid( CHUNK_HEADER_SIZE ) );
+        requestBlocks( bufferDevice()->pos() / m_blockSize );
+    }
+    else if ( msg->payload().startsWith( "fetch" ) )
+    {
+        const QStringList range = QString( msg->payload() ).mid( 5 ).split( '-' );
+        if ( m_windowed && range.count() == 2 )
+        {
+            // the range comes from the peer, only serve blocks the file actually has
+            bool firstOk, lastOk;
+            const int blocks = int( ( m_readdev->size() + m_blockSize - 1 ) / m_blockSize );
+            const int first = qMax( range.at( 0 ).toInt( &firstOk ), 0 );
+            const int last = qMin( range.at( 1 ).toInt( &lastOk ), blocks - 1 );
+
+            if ( !firstOk || !lastOk || last < first )
+                tDebug() << id() << "Ignoring invalid range:" << msg->payload();
+            else if ( m_ranges.count() >= MAX_QUEUED_RANGES )
+                tDebug() << id() << "Too many ranges queued, ignoring:" << msg->payload();
+            else
+            {
+                m_ranges << qMakePair( first, last );
+                sendSome();
+            }
+        }
+    }
+    else if ( msg->payload() == "cancel" )
+    {
+        m_ranges.clear();
+    }
+    else if ( msg->payload() == "windowok" )
+    {
+        m_windowed = true;
+        m_blockSize = WINDOW_BLOCK_SIZE;
+        bufferDevice()->setBlockSize( m_blockSize );
+        requestBlocks( bufferDevice()->pos() / m_blockSize );
+    }
+    else if ( msg->payload() == "windowno" )
+    {
+        // the peer sends the file from the start, catch up with seeks we ignored while waiting
+        m_windowRequested = false;
+        const int block = bufferDevice()->pos() / m_blockSize;
+        if ( block > 0 )
+            onBlockRequest( block );
+    }
+    else if ( msg->payload().startsWith( "window" ) )
+    {
+        // too late, we're already sending the file from the start
+        if ( !m_waitForWindow && m_quotaTimer.isValid() )
+        {
+            tDebug() << id() << "Window requested after the transfer started, staying sequential";
+            sendMsg( Msg::factory( "windowno", Msg::RAW | Msg::FRAGMENT ) );
+            return;
+        }
+
+        m_windowRequested = true;
+        m_blockSize = QString( msg->payload() ).mid( 6 ).toUInt();
+        if ( m_readdev )
+            beginSending();
+    }
+    else if ( msg->payload().startsWith( "block" ) )
     {
         int block = QString( msg->payload() ).mid( 5 ).toInt();
-        m_readdev->seek( block * BufferIODevice::blockSize() );
+        m_readdev->seek( block * BufferIODevice::defaultBlockSize() );
+        m_sentLast = false;
 
         qDebug() << "Seeked to block:" << block;
 
@@ -234,27 +427,33 @@ StreamConnection::handleMsg( msg_ptr msg )
     else if ( msg->payload().startsWith( "doneblock" ) )
     {
         int block = QString( msg->payload() ).mid( 9 ).toInt();
-        ( (BufferIODevice*)m_iodev.data() )->seeked( block );
+        bufferDevice()->seeked( block );
 
         m_curBlock = block;
         qDebug() << "Next block is now:" << block;
     }
     else if ( msg->payload().startsWith( "data" ) )
     {
+        if ( m_latencyTimer.isValid() )
+        {
+            tLog( LOGVERBOSE ) << id() << "Got block" << m_curBlock << "after" << m_latencyTimer.elapsed() << "ms";
+            m_latencyTimer.invalidate();
+        }
+
         m_badded += msg->payload().length() - 4;
-        ( (BufferIODevice*)m_iodev.data() )->addData( m_curBlock++, msg->payload().mid( 4 ) );
+        bufferDevice()->addData( m_curBlock++, msg->payload().mid( 4 ) );
     }
 
     //qDebug() << Q_FUNC_INFO << "flags" << (int) msg->flags()
     //         << "payload len" << msg->payload().length()
     //         << "written to device so far: " << m_badded;
 
-    if ( m_iodev && ( (BufferIODevice*)m_iodev.data() )->nextEmptyBlock() < 0 )
+    if ( m_iodev && bufferDevice()->nextEmptyBlock() < 0 )
     {
         m_allok = true;
 
         // tell our iodev there is no more data to read, no args meaning a success:
-        ( (BufferIODevice*)m_iodev.data() )->inputComplete();
+        bufferDevice()->inputComplete();
 
         shutdown();
     }
@@ -274,24 +473,120 @@ StreamConnection::sendSome()
 {
     Q_ASSERT( m_type == StreamConnection::SENDING );
 
-    QByteArray ba = "data";
-    ba.append( m_readdev->read( BufferIODevice::blockSize() ) );
-    m_bsent += ba.length() - 4;
+    if ( m_readdev.isNull() || ( m_waitForWindow && !m_windowRequested ) )
+        return;
 
-    if ( m_readdev->atEnd() )
+    // Hand blocks to the socket as it drains, instead of one block per event loop turn
+    while ( queuedMessages() < MAX_QUEUED_BLOCKS &&
+            bytesToWrite() < qint64( MAX_QUEUED_BLOCKS ) * m_blockSize )
     {
-        sendMsg( Msg::factory( ba, Msg::RAW ) );
-        return;
+        if ( m_windowed ? m_ranges.isEmpty() : m_sentLast )
+            return;
+        if ( !takeUploadQuota( m_blockSize ) )
+            return; // m_throttleTimer calls us again
+
+        if ( m_windowed )
+        {
+            const int block = m_ranges.first().first;
+            if ( ++m_ranges.first().first > m_ranges.first().second )
+                m_ranges.removeFirst();
+
+            QByteArray ba( CHUNK_HEADER_SIZE + m_blockSize, Qt::Uninitialized );
+            memcpy( ba.data(), "chunk", 5 );
+            qToBigEndian< quint32 >( block, (uchar*)ba.data() + 5 );
+
+            // Blocks we can't serve are answered with an empty chunk, otherwise
+            // they'd stay in flight on the peer's side and stall the transfer
+            qint64 read = -1;
+            const qint64 offset = qint64( block ) * m_blockSize;
+            if ( m_readdev->pos() == offset || m_readdev->seek( offset ) )
+                read = m_readdev->read( ba.data() + CHUNK_HEADER_SIZE, m_blockSize );
+            if ( read <= 0 )
+            {
+                tDebug() << Q_FUNC_INFO << "Can't read block" << block << "of" << m_fid;
+                read = 0;
+            }
+
+            ba.resize( CHUNK_HEADER_SIZE + read );
+            m_bsent += read;
+
+            sendMsg( Msg::factory( ba, Msg::RAW | Msg::FRAGMENT ) );
+            continue;
+        }
+
+        // read the block right behind the "data" prefix instead of concatenating the two
+        QByteArray ba( 4 + m_blockSize, Qt::Uninitialized );
+        memcpy( ba.data(), "data", 4 );
+        const qint64 read = m_readdev->read( ba.data() + 4, m_blockSize );
+        ba.resize( 4 + qMax( read, qint64( 0 ) ) );
+        m_bsent += ba.length() - 4;
+
+        if ( m_readdev->atEnd() )
+        {
+            m_sentLast = true;
+            sendMsg( Msg::factory( ba, Msg::RAW ) );
+        }
+        else
+        {
+            // more to come -> FRAGMENT
+            sendMsg( Msg::factory( ba, Msg::RAW | Msg::FRAGMENT ) );
+        }
     }
-    else
+}
+
+
+bool
+StreamConnection::takeUploadQuota( qint64 bytes )
+{
+    if ( m_uploadLimit <= 0 )
+        return true;
+
+    // allow bursts of up to a second worth of data
+    m_uploadQuota = qMin( m_uploadLimit, m_uploadQuota + m_uploadLimit * m_quotaTimer.restart() / 1000 );
+    if ( m_uploadQuota > 0 )
+    {
+        m_uploadQuota -= bytes;
+        return true;
+    }
+
+    if ( !m_throttleTimer.isActive() )
+        m_throttleTimer.start( qMax< qint64 >( 1, ( -m_uploadQuota + 1 ) * 1000 / m_uploadLimit ) );
+
+    return false;
+}
+
+
+void
+StreamConnection::requestBlocks( int fromBlock )
+{
+    if ( !m_windowed )
+        return;
+
+    BufferIODevice* bio = bufferDevice();
+    const int maxBlocks = bio->maxBlocks();
+
+    // start at the playhead and wrap around to fill the gaps before it
+    int first = -1;
+    int last = -1;
+    for ( int i = 0; i < maxBlocks && m_requestedBlocks.count() < MAX_BLOCKS_IN_FLIGHT; i++ )
     {
-        // more to come -> FRAGMENT
-        sendMsg( Msg::factory( ba, Msg::RAW | Msg::FRAGMENT ) );
+        const int block = ( fromBlock + i ) % maxBlocks;
+        if ( !bio->isBlockEmpty( block ) || m_requestedBlocks.contains( block ) )
+            continue;
+
+        if ( last < 0 || block != last + 1 )
+        {
+            if ( last >= 0 )
+                sendMsg( Msg::factory( QString( "fetch%1-%2" ).arg( first ).arg( last ).toLatin1(), Msg::RAW | Msg::FRAGMENT ) );
+            first = block;
+        }
+
+        last = block;
+        m_requestedBlocks << block;
     }
 
-    // HINT: change the 0 to 50 to transmit at 640Kbps, for example
-    //       (this is where upload throttling could be implemented)
-    QTimer::singleShot( 0, this, SLOT( sendSome() ) );
+    if ( last >= 0 )
+        sendMsg( Msg::factory( QString( "fetch%1-%2" ).arg( first ).arg( last ).toLatin1(), Msg::RAW | Msg::FRAGMENT ) );
 }
 
 
@@ -300,9 +595,27 @@ StreamConnection::onBlockRequest( int block )
 {
     qDebug() << Q_FUNC_INFO << block;
 
-    if ( m_curBlock == block )
+    if ( m_windowed )
+    {
+        if ( m_requestedBlocks.contains( block ) )
+            return;
+
+        // drop what the peer hasn't sent yet, blocks already on the way are still welcome
+        sendMsg( Msg::factory( "cancel", Msg::RAW | Msg::FRAGMENT ) );
+        m_requestedBlocks.clear();
+
+        m_awaitedBlock = block;
+        m_latencyTimer.start();
+        requestBlocks( block );
+        return;
+    }
+
+    // we'll catch up once the peer answered our window request
+    if ( m_windowRequested || m_curBlock == block )
         return;
 
+    m_latencyTimer.start();
+
     QByteArray sm;
     sm.append( QString( "block%1" ).arg( block ) );
 
@@ -21,9 +21,12 @@
 #ifndef STREAMCONNECTION_H
 #define STREAMCONNECTION_H
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 #include <QIODevice>
+#include <QTimer>
 
 #include "network/Connection.h"
 #include "Result.h"
@@ -51,6 +54,10 @@ public:
 
     virtual ~StreamConnection();
 
+    /// Name of the feature peers advertise in the ControlConnection handshake
+    /// if they support windowed transfers.
+    static QString windowFeatureName();
+
     QString id() const;
     void setup();
     Connection* clone();
@@ -78,8 +85,17 @@ private slots:
     void showStats( qint64 tx, qint64 rx );
 
     void onBlockRequest( int pos );
+    void onWindowRequestTimeout();
 
 private:
+    BufferIODevice* bufferDevice() const;
+
+    // TX:
+    void beginSending();
+    bool takeUploadQuota( qint64 bytes );
+    // RX:
+    void requestBlocks( int fromBlock );
+
     QSharedPointer<QIODevice> m_iodev;
     ControlConnection* m_cc;
     QString m_fid;
@@ -94,6 +110,29 @@ private:
     Tomahawk::source_ptr m_source;
     Tomahawk::result_ptr m_result;
     qint64 m_transferRate;
+
+    /*
+        Windowed transfers, if both peers support them: the receiver asks
+        for ranges of blocks around the playhead and keeps several of them
+        in flight, a seek cancels whatever the sender hasn't sent yet.
+    */
+    bool m_windowed;
+    bool m_windowRequested; // RX: we asked for it, TX: the peer did
+    bool m_waitForWindow; // TX: the peer will ask, don't start sending yet
+    unsigned int m_blockSize;
+    QList< QPair< int, int > > m_ranges; // TX: first and last block of the ranges still to send
+    QSet< int > m_requestedBlocks; // RX: in flight
+
+    // TX: upload rate limiting
+    qint64 m_uploadLimit; // bytes per second, 0 for unlimited
+    qint64 m_uploadQuota;
+    QElapsedTimer m_quotaTimer;
+    QTimer m_throttleTimer;
+    bool m_sentLast; // TX: sequential transfers only
+
+    // RX: time to first byte, after setup and after seeks
+    QElapsedTimer m_latencyTimer;
+    int m_awaitedBlock;
 };
 
 #endif // STREAMCONNECTION_H
@@ -137,10 +137,7 @@ AlbumModel::addAlbums( const QList<Tomahawk::album_ptr>& albums )
 
     foreach( const album_ptr& album, trimmedAlbums )
     {
-        PlayableItem* albumitem = new PlayableItem( album, rootItem() );
-        albumitem->index = createIndex( rootItem()->children.count() - 1, 0, albumitem );
-
-        connect( albumitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+        new PlayableItem( album, rootItem() );
     }
 
     emit endInsertRows();
@@ -182,10 +179,7 @@ AlbumModel::addArtists( const QList<Tomahawk::artist_ptr>& artists )
 
     foreach ( const artist_ptr& artist, trimmedArtists )
     {
-        PlayableItem* albumitem = new PlayableItem( artist, rootItem() );
-        albumitem->index = createIndex( rootItem()->children.count() - 1, 0, albumitem );
-
-        connect( albumitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+        new PlayableItem( artist, rootItem() );
     }
 
     emit endInsertRows();
@@ -210,10 +204,7 @@ AlbumModel::addQueries( const QList<Tomahawk::query_ptr>& queries )
 
     foreach ( const query_ptr& query, queries )
     {
-        PlayableItem* albumitem = new PlayableItem( query, rootItem() );
-        albumitem->index = createIndex( rootItem()->children.count() - 1, 0, albumitem );
-
-        connect( albumitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+        new PlayableItem( query, rootItem() );
     }
 
     emit endInsertRows();
@@ -201,7 +201,9 @@ GridItemDelegate::paint( QPainter* painter, const QStyleOptionViewItem& option,
         const int cropIn = pct * ( (qreal)cover.width() * 0.10 );
         const QRect crop = cover.rect().adjusted( cropIn, cropIn, -cropIn, -cropIn );
 
-        painter->drawPixmap( r, cover.copy( crop ).scaled( r.size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation ) );
+        // let the painter scale the cropped part, instead of copying and rescaling the cover on every frame
+        painter->setRenderHint( QPainter::SmoothPixmapTransform );
+        painter->drawPixmap( r, cover, crop );
 
         painter->setOpacity( 1.0 - opacity );
         painter->setPen( Qt::transparent );
@@ -573,6 +573,9 @@ GridView::onScrollTimeout()
     {
         m_proxyModel->updateDetailedInfo( m_proxyModel->index( i, 0 ) );
     }
+
+    // look ahead a page in both directions
+    m_proxyModel->setVisibleRows( left.row(), right.row(), right.row() - left.row() + 1 );
 }
 
 
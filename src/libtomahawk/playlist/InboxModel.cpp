@@ -138,11 +138,9 @@ InboxModel::insertEntries( const QList< Tomahawk::plentry_ptr >& entries, int /*
                 emit beginInsertRows( QModelIndex(), crows.first, crows.second );
 
                 PlayableItem* item = new PlayableItem( sa.source, rootItem() );
-                item->index = createIndex( rootItem()->children.count() - 1, 0, item );
-                connect( item, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
 
                 emit endInsertRows();
-                parent = item->index;
+                parent = item->index();
             }
 
             QList< Tomahawk::plentry_ptr > el;
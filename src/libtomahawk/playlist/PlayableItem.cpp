@@ -23,14 +23,122 @@
 
 #include "Artist.h"
 #include "Album.h"
+#include "PlayableModel.h"
 #include "PlaylistEntry.h"
 #include "Query.h"
 #include "Result.h"
 #include "Source.h"
 
+#include <QMutex>
+
+#include <climits>
+
+#define ARENA_CHUNK_ITEMS 1024
+
 using namespace Tomahawk;
 
 
+/**
+ * Fixed size slots for PlayableItems, handed out from large chunks and
+ * recycled through a free list. The chunks are released once the last
+ * item is gone.
+ */
+class PlayableItemArena
+{
+public:
+    PlayableItemArena()
+        : m_free( 0 )
+        , m_used( ARENA_CHUNK_ITEMS )
+        , m_live( 0 )
+    {
+    }
+
+    void* allocate()
+    {
+        QMutexLocker lock( &m_mutex );
+        m_live++;
+
+        if ( m_free )
+        {
+            FreeSlot* slot = m_free;
+            m_free = slot->next;
+            return slot;
+        }
+
+        if ( m_used == ARENA_CHUNK_ITEMS )
+        {
+            m_chunks << static_cast< char* >( ::operator new( ARENA_CHUNK_ITEMS * sizeof( PlayableItem ) ) );
+            m_used = 0;
+        }
+
+        return m_chunks.last() + sizeof( PlayableItem ) * m_used++;
+    }
+
+    void release( void* p )
+    {
+        QMutexLocker lock( &m_mutex );
+
+        FreeSlot* slot = static_cast< FreeSlot* >( p );
+        slot->next = m_free;
+        m_free = slot;
+
+        if ( --m_live == 0 )
+        {
+            foreach ( char* chunk, m_chunks )
+                ::operator delete( chunk );
+
+            m_chunks.clear();
+            m_free = 0;
+            m_used = ARENA_CHUNK_ITEMS;
+        }
+    }
+
+private:
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+    QMutex m_mutex;
+    QList< char* > m_chunks;
+    FreeSlot* m_free;
+    int m_used; // slots handed out from the last chunk
+    int m_live;
+};
+
+
+static PlayableItemArena*
+arena()
+{
+    // never destroyed, items may outlive static destruction
+    static PlayableItemArena* s_arena = new PlayableItemArena;
+    return s_arena;
+}
+
+
+void*
+PlayableItem::operator new( size_t size )
+{
+    if ( size != sizeof( PlayableItem ) )
+        return ::operator new( size );
+
+    return arena()->allocate();
+}
+
+
+void
+PlayableItem::operator delete( void* p, size_t size )
+{
+    if ( !p )
+        return;
+
+    if ( size != sizeof( PlayableItem ) )
+        ::operator delete( p );
+    else
+        arena()->release( p );
+}
+
+
 PlayableItem::~PlayableItem()
 {
     // Don't use qDeleteAll here! The children will remove themselves
@@ -39,78 +147,91 @@ PlayableItem::~PlayableItem()
     for ( int i = children.count() - 1; i >= 0; i-- )
         delete children.at( i );
 
-    if ( m_parent && index.isValid() )
+    if ( m_model && m_parent )
+        m_model->unregisterItem( this );
+
+    if ( m_parent )
     {
-        m_parent->children.removeAt( index.row() );
+        const int r = row();
+        m_parent->children.removeAt( r );
+        m_parent->m_staleChildRow = qMin( m_parent->m_staleChildRow, r );
     }
+
+    delete m_playbackLog;
+}
+
+
+PlayableItem::PlayableItem( PlayableModel* model )
+    : m_model( model )
+    , m_parent( 0 )
+    , m_playbackLog( 0 )
+    , m_row( -1 )
+    , m_staleChildRow( INT_MAX )
+    , m_type( Root )
+    , m_fetchingMore( false )
+    , m_isPlaying( false )
+{
 }
 
 
-PlayableItem::PlayableItem( PlayableItem* parent )
-    : QObject( parent )
+PlayableItem::PlayableItem( ItemType type, PlayableItem* parent )
+    : m_model( parent ? parent->m_model : 0 )
     , m_parent( parent )
+    , m_playbackLog( 0 )
+    , m_row( -1 )
+    , m_staleChildRow( INT_MAX )
+    , m_type( type )
+    , m_fetchingMore( false )
+    , m_isPlaying( false )
 {
-    init();
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::album_ptr& album, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_album( album )
-    , m_parent( parent )
+    : PlayableItem( AlbumItem, parent )
 {
+    m_object = album;
     init( row );
-
-    connect( album.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::artist_ptr& artist, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_artist( artist )
-    , m_parent( parent )
+    : PlayableItem( ArtistItem, parent )
 {
+    m_object = artist;
     init( row );
-
-    connect( artist.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::result_ptr& result, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_result( result )
-    , m_parent( parent )
+    : PlayableItem( ResultItem, parent )
 {
+    m_result = result;
     init( row );
-
-    connect( result.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::query_ptr& query, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_query( query )
-    , m_parent( parent )
+    : PlayableItem( QueryItem, parent )
 {
+    m_query = query;
     init( row );
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::plentry_ptr& entry, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_entry( entry )
-    , m_query( entry->query() )
-    , m_parent( parent )
+    : PlayableItem( EntryItem, parent )
 {
+    m_object = entry;
+    m_query = entry->query();
     init( row );
 }
 
 
 PlayableItem::PlayableItem( const Tomahawk::source_ptr& source, PlayableItem* parent, int row )
-    : QObject( parent )
-    , m_source( source )
-    , m_parent( parent )
+    : PlayableItem( SourceItem, parent )
 {
+    m_object = source;
     init( row );
 }
 
@@ -118,68 +239,144 @@ PlayableItem::PlayableItem( const Tomahawk::source_ptr& source, PlayableItem* pa
 void
 PlayableItem::init( int row )
 {
-    track_ptr track;
-    if ( m_query )
-    {
-        connect( m_query.data(), SIGNAL( resultsChanged() ), SLOT( onResultsChanged() ) );
-        track = m_query->track();
-    }
-    else if ( m_result )
-    {
-        track = m_result->track();
-    }
-
-    if ( track )
-    {
-        connect( track.data(), SIGNAL( socialActionsLoaded() ), SIGNAL( dataChanged() ) );
-        connect( track.data(), SIGNAL( attributesLoaded() ), SIGNAL( dataChanged() ) );
-        connect( track.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
-    }
-
     if ( m_parent )
     {
-        if ( row < 0 )
+        if ( row < 0 || row >= m_parent->children.count() )
         {
+            m_row = m_parent->children.count();
             m_parent->children.append( this );
         }
         else
         {
+            m_row = row;
             m_parent->children.insert( row, this );
+            m_parent->m_staleChildRow = qMin( m_parent->m_staleChildRow, row );
         }
     }
 
     if ( m_query )
-    {
-        onResultsChanged();
-    }
+        updateResult();
+
+    if ( m_model && m_parent )
+        m_model->registerItem( this );
 }
 
 
-void
-PlayableItem::onResultsChanged()
+bool
+PlayableItem::updateResult()
 {
+    result_ptr result;
     if ( m_query && !m_query->results().isEmpty() )
+        result = m_query->results().first();
+
+    if ( result == m_result )
+        return false;
+
+    m_result = result;
+    return true;
+}
+
+
+void
+PlayableItem::emitDataChanged()
+{
+    if ( m_model && m_parent )
+        m_model->itemChanged( this );
+}
+
+
+int
+PlayableItem::row() const
+{
+    if ( !m_parent )
+        return -1;
+
+    // renumber the siblings in one go after rows got inserted or removed before us
+    if ( m_row >= m_parent->m_staleChildRow )
     {
-        m_result = m_query->results().first();
-        connect( m_result.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ), Qt::UniqueConnection );
+        const QList< PlayableItem* >& siblings = m_parent->children;
+        for ( int i = m_parent->m_staleChildRow; i < siblings.count(); i++ )
+            siblings.at( i )->m_row = i;
+
+        m_parent->m_staleChildRow = INT_MAX;
     }
-    else
-        m_result = result_ptr();
 
-    emit dataChanged();
+    return m_row;
+}
+
+
+QModelIndex
+PlayableItem::index() const
+{
+    if ( !m_model || !m_parent )
+        return QModelIndex();
+
+    return m_model->createIndex( row(), 0, const_cast< PlayableItem* >( this ) );
+}
+
+
+Tomahawk::artist_ptr
+PlayableItem::artist() const
+{
+    if ( m_type != ArtistItem )
+        return artist_ptr();
+
+    return m_object.staticCast< Tomahawk::Artist >();
+}
+
+
+Tomahawk::album_ptr
+PlayableItem::album() const
+{
+    if ( m_type != AlbumItem )
+        return album_ptr();
+
+    return m_object.staticCast< Tomahawk::Album >();
+}
+
+
+Tomahawk::plentry_ptr
+PlayableItem::entry() const
+{
+    if ( m_type != EntryItem )
+        return plentry_ptr();
+
+    return m_object.staticCast< Tomahawk::PlaylistEntry >();
+}
+
+
+Tomahawk::source_ptr
+PlayableItem::source() const
+{
+    if ( m_type != SourceItem )
+        return source_ptr();
+
+    return m_object.staticCast< Tomahawk::Source >();
+}
+
+
+Tomahawk::track_ptr
+PlayableItem::track() const
+{
+    if ( m_query )
+        return m_query->track();
+    if ( m_result )
+        return m_result->track();
+
+    return track_ptr();
 }
 
 
 QString
 PlayableItem::name() const
 {
-    if ( m_artist )
+    if ( m_type == ArtistItem )
     {
-        return m_artist->name();
+        return artist()->name();
     }
-    else if ( m_album )
+    else if ( m_type == AlbumItem )
     {
-        return m_album->name();
+        return album()->name();
     }
     else if ( m_result )
     {
@@ -243,12 +440,18 @@ PlayableItem::result() const
 Tomahawk::PlaybackLog
 PlayableItem::playbackLog() const
 {
-    return m_playbackLog;
+    if ( !m_playbackLog )
+        return Tomahawk::PlaybackLog();
+
+    return *m_playbackLog;
 }
 
 
 void
 PlayableItem::setPlaybackLog( const Tomahawk::PlaybackLog& log )
 {
-    m_playbackLog = log;
+    if ( !m_playbackLog )
+        m_playbackLog = new Tomahawk::PlaybackLog( log );
+    else
+        *m_playbackLog = log;
 }
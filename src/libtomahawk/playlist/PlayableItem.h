@@ -24,43 +24,56 @@
 #include <QPersistentModelIndex>
 #include <QPixmap>
 
+#include "PlaybackLog.h"
 #include "Track.h"
 #include "Typedefs.h"
 #include "DllMacro.h"
 
-class DLLEXPORT PlayableItem : public QObject
-{
-Q_OBJECT
+class PlayableModel;
 
+/**
+ * A row of a PlayableModel. Rows are plain objects allocated from a shared
+ * arena, their model watches the artists, albums, queries and results they
+ * show and notifies all rows showing an object when it changes.
+ */
+class DLLEXPORT PlayableItem
+{
 public:
     ~PlayableItem();
 
-    explicit PlayableItem( PlayableItem* parent = 0 );
-    explicit PlayableItem( const Tomahawk::artist_ptr& artist, PlayableItem* parent = 0, int row = -1 );
-    explicit PlayableItem( const Tomahawk::album_ptr& album, PlayableItem* parent = 0, int row = -1 );
-    explicit PlayableItem( const Tomahawk::result_ptr& result, PlayableItem* parent = 0, int row = -1 );
-    explicit PlayableItem( const Tomahawk::query_ptr& query, PlayableItem* parent = 0, int row = -1 );
-    explicit PlayableItem( const Tomahawk::plentry_ptr& entry, PlayableItem* parent = 0, int row = -1 );
-    explicit PlayableItem( const Tomahawk::source_ptr& source, PlayableItem* parent = 0, int row = -1 );
+    explicit PlayableItem( PlayableModel* model );
+    explicit PlayableItem( const Tomahawk::artist_ptr& artist, PlayableItem* parent, int row = -1 );
+    explicit PlayableItem( const Tomahawk::album_ptr& album, PlayableItem* parent, int row = -1 );
+    explicit PlayableItem( const Tomahawk::result_ptr& result, PlayableItem* parent, int row = -1 );
+    explicit PlayableItem( const Tomahawk::query_ptr& query, PlayableItem* parent, int row = -1 );
+    explicit PlayableItem( const Tomahawk::plentry_ptr& entry, PlayableItem* parent, int row = -1 );
+    explicit PlayableItem( const Tomahawk::source_ptr& source, PlayableItem* parent, int row = -1 );
 
-    const Tomahawk::artist_ptr& artist() const { return m_artist; }
-    const Tomahawk::album_ptr& album() const { return m_album; }
+    static void* operator new( size_t size );
+    static void operator delete( void* p, size_t size );
+
+    Tomahawk::artist_ptr artist() const;
+    Tomahawk::album_ptr album() const;
     const Tomahawk::query_ptr& query() const { return m_query; }
-    const Tomahawk::plentry_ptr& entry() const { return m_entry; }
-    const Tomahawk::source_ptr& source() const { return m_source; }
+    Tomahawk::plentry_ptr entry() const;
+    Tomahawk::source_ptr source() const;
     const Tomahawk::result_ptr& result() const;
 
     Tomahawk::PlaybackLog playbackLog() const;
     void setPlaybackLog( const Tomahawk::PlaybackLog& log );
 
     PlayableItem* parent() const { return m_parent; }
-    void forceUpdate() { emit dataChanged(); }
+    /// The row's index in its model, invalid for the root item.
+    QModelIndex index() const;
+    int row() const;
+
+    void forceUpdate() { emitDataChanged(); }
 
     bool isPlaying() const { return m_isPlaying; }
-    void setIsPlaying( bool b ) { m_isPlaying = b; emit dataChanged(); }
+    void setIsPlaying( bool b ) { m_isPlaying = b; emitDataChanged(); }
     bool fetchingMore() const { return m_fetchingMore; }
     void setFetchingMore( bool b ) { m_fetchingMore = b; }
-    void requestRepaint() { emit dataChanged(); }
+    void requestRepaint() { emitDataChanged(); }
 
     QString name() const;
     QString artistName() const;
@@ -68,29 +81,43 @@ public:
 
     QList<PlayableItem*> children;
 
-    QPersistentModelIndex index;
-
-signals:
-    void dataChanged();
-
-private slots:
-    void onResultsChanged();
-
 private:
-    void init( int row = -1 );
+    friend class PlayableModel;
+
+    enum ItemType
+    {
+        Root = 0,
+        ArtistItem,
+        AlbumItem,
+        ResultItem,
+        QueryItem,
+        EntryItem,
+        SourceItem
+    };
+
+    PlayableItem( ItemType type, PlayableItem* parent );
+    void init( int row );
+    void emitDataChanged();
+    /// Picks up the query's best result, returns whether it changed.
+    bool updateResult();
+    Tomahawk::track_ptr track() const;
+
+    PlayableModel* m_model;
+    PlayableItem* m_parent;
 
-    Tomahawk::artist_ptr m_artist;
-    Tomahawk::album_ptr m_album;
-    Tomahawk::plentry_ptr m_entry;
-    Tomahawk::result_ptr m_result;
+    // the artist, album, playlist entry or source this row shows
+    QSharedPointer< QObject > m_object;
     Tomahawk::query_ptr m_query;
-    Tomahawk::source_ptr m_source;
+    Tomahawk::result_ptr m_result;
+    Tomahawk::PlaybackLog* m_playbackLog;
 
-    PlayableItem* m_parent;
-    bool m_fetchingMore = false;
-    bool m_isPlaying = false;
+    // rows are only renumbered on demand, children from this one on may be off
+    int m_row;
+    int m_staleChildRow;
 
-    Tomahawk::PlaybackLog m_playbackLog;
+    unsigned char m_type;
+    bool m_fetchingMore;
+    bool m_isPlaying;
 };
 
 #endif // PLAYABLEITEM_H
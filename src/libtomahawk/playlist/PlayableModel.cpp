@@ -74,6 +74,7 @@ PlayableModel::~PlayableModel()
 {
     Q_D( PlayableModel );
     tDebug() << Q_FUNC_INFO;
+    unwatchAll();
     delete d->rootItem;
 }
 
@@ -154,8 +155,7 @@ PlayableModel::parent( const QModelIndex& child ) const
     if ( !grandparentEntry )
         return QModelIndex();
 
-    int row = grandparentEntry->children.indexOf( parentEntry );
-    return createIndex( row, 0, parentEntry );
+    return createIndex( parentEntry->row(), 0, parentEntry );
 }
 
 
@@ -637,9 +637,10 @@ PlayableModel::clear()
         finishLoading();
 
         emit beginResetModel();
+        unwatchAll();
         delete d->rootItem;
         d->rootItem = 0;
-        d->rootItem = new PlayableItem( 0 );
+        d->rootItem = new PlayableItem( this );
         emit endResetModel();
     }
 }
@@ -681,28 +682,11 @@ PlayableModel::insertInternal( const QList< T >& items, int row, const QList< To
 
     emit beginInsertRows( parent, crows.first, crows.second );
 
+    PlayableItem* pItem = itemFromIndex( parent );
     int i = 0;
     foreach ( const T& item, items )
     {
-        PlayableItem* pItem = itemFromIndex( parent );
         PlayableItem* plitem = new PlayableItem( item, pItem, row + i );
-        plitem->index = createIndex( row + i, 0, plitem );
-
-        if ( plitem->query() )
-        {
-            if ( !plitem->query()->playable() )
-            {
-                connect( plitem->query().data(), SIGNAL( playableStateChanged( bool ) ),
-                         SLOT( onQueryBecamePlayable( bool ) ),
-                         Qt::UniqueConnection );
-            }
-            if ( !plitem->query()->resolvingFinished() )
-            {
-                connect( plitem->query().data(), SIGNAL( resolvingFinished( bool ) ),
-                         SLOT( onQueryResolved( bool ) ),
-                         Qt::UniqueConnection );
-            }
-        }
 
         if ( logs.count() > i )
             plitem->setPlaybackLog( logs.at( i ) );
@@ -710,9 +694,7 @@ PlayableModel::insertInternal( const QList< T >& items, int row, const QList< To
         i++;
 
 /*        if ( item->id() == currentItemUuid() )
-            setCurrentItem( plitem->index );*/
-
-        connect( plitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+            setCurrentItem( plitem->index() );*/
     }
 
     emit endInsertRows();
@@ -861,7 +843,8 @@ PlayableModel::ensureResolved( const QModelIndex& parent )
             ql << query;
     }
 
-    Pipeline::instance()->resolve( ql );
+    // views move the rows they show to the front, see PlayableProxyModel::setVisibleRows()
+    Pipeline::instance()->resolve( ql, false );
 }
 
 
@@ -923,11 +906,139 @@ PlayableModel::scoreText( float score ) const
 
 
 void
-PlayableModel::onDataChanged()
+PlayableModel::registerItem( PlayableItem* item )
+{
+    if ( item->m_type == PlayableItem::ArtistItem || item->m_type == PlayableItem::AlbumItem )
+    {
+        if ( watch( item->m_object.data(), item ) )
+            connect( item->m_object.data(), SIGNAL( updated() ), SLOT( onItemChanged() ) );
+    }
+
+    if ( item->m_query )
+    {
+        Query* query = item->m_query.data();
+        if ( watch( query, item ) )
+        {
+            connect( query, SIGNAL( resultsChanged() ), SLOT( onQueryResultsChanged() ) );
+
+            if ( !query->playable() )
+                connect( query, SIGNAL( playableStateChanged( bool ) ), SLOT( onQueryBecamePlayable( bool ) ), Qt::UniqueConnection );
+            if ( !query->resolvingFinished() )
+                connect( query, SIGNAL( resolvingFinished( bool ) ), SLOT( onQueryResolved( bool ) ), Qt::UniqueConnection );
+        }
+    }
+
+    if ( item->m_result && watch( item->m_result.data(), item ) )
+        connect( item->m_result.data(), SIGNAL( updated() ), SLOT( onItemChanged() ) );
+
+    const track_ptr track = item->track();
+    if ( track && watch( track.data(), item ) )
+    {
+        connect( track.data(), SIGNAL( socialActionsLoaded() ), SLOT( onItemChanged() ) );
+        connect( track.data(), SIGNAL( attributesLoaded() ), SLOT( onItemChanged() ) );
+        connect( track.data(), SIGNAL( updated() ), SLOT( onItemChanged() ) );
+    }
+}
+
+
+void
+PlayableModel::unregisterItem( PlayableItem* item )
+{
+    if ( item->m_object )
+        unwatch( item->m_object.data(), item );
+    if ( item->m_query )
+        unwatch( item->m_query.data(), item );
+    if ( item->m_result )
+        unwatch( item->m_result.data(), item );
+
+    const track_ptr track = item->track();
+    if ( track )
+        unwatch( track.data(), item );
+}
+
+
+bool
+PlayableModel::watch( QObject* object, PlayableItem* item )
+{
+    Q_D( PlayableModel );
+
+    // only the first row showing an object connects to it
+    const bool first = !d->watchedItems.contains( object );
+    d->watchedItems.insertMulti( object, item );
+
+    return first;
+}
+
+
+void
+PlayableModel::unwatch( QObject* object, PlayableItem* item )
+{
+    Q_D( PlayableModel );
+
+    if ( !d->watchedItems.remove( object, item ) || d->watchedItems.contains( object ) )
+        return;
+
+    disconnect( object, 0, this, SLOT( onItemChanged() ) );
+    disconnect( object, 0, this, SLOT( onQueryResultsChanged() ) );
+    disconnect( object, 0, this, SLOT( onQueryBecamePlayable( bool ) ) );
+    disconnect( object, 0, this, SLOT( onQueryResolved( bool ) ) );
+}
+
+
+void
+PlayableModel::unwatchAll()
+{
+    Q_D( PlayableModel );
+
+    foreach ( const QObject* object, d->watchedItems.uniqueKeys() )
+    {
+        disconnect( object, 0, this, SLOT( onItemChanged() ) );
+        disconnect( object, 0, this, SLOT( onQueryResultsChanged() ) );
+        disconnect( object, 0, this, SLOT( onQueryBecamePlayable( bool ) ) );
+        disconnect( object, 0, this, SLOT( onQueryResolved( bool ) ) );
+    }
+
+    d->watchedItems.clear();
+}
+
+
+void
+PlayableModel::itemChanged( PlayableItem* item )
+{
+    const QModelIndex index = item->index();
+    if ( index.isValid() )
+        emit dataChanged( index, index.sibling( index.row(), columnCount() - 1 ) );
+}
+
+
+void
+PlayableModel::onItemChanged()
+{
+    Q_D( PlayableModel );
+
+    foreach ( PlayableItem* item, d->watchedItems.values( sender() ) )
+        itemChanged( item );
+}
+
+
+void
+PlayableModel::onQueryResultsChanged()
 {
-    PlayableItem* p = (PlayableItem*)sender();
-    if ( p && p->index.isValid() )
-        emit dataChanged( p->index, p->index.sibling( p->index.row(), columnCount() - 1 ) );
+    Q_D( PlayableModel );
+
+    foreach ( PlayableItem* item, d->watchedItems.values( sender() ) )
+    {
+        const result_ptr previous = item->m_result;
+        if ( item->updateResult() )
+        {
+            if ( previous )
+                unwatch( previous.data(), item );
+            if ( item->m_result && watch( item->m_result.data(), item ) )
+                connect( item->m_result.data(), SIGNAL( updated() ), SLOT( onItemChanged() ) );
+        }
+
+        itemChanged( item );
+    }
 }
 
 
@@ -1188,6 +1299,7 @@ PlayableModel::itemCount() const
 void
 PlayableModel::onQueryBecamePlayable( bool playable )
 {
+    Q_D( PlayableModel );
     Q_UNUSED( playable );
 
     Tomahawk::Query* q = qobject_cast< Query* >( sender() );
@@ -1197,11 +1309,9 @@ PlayableModel::onQueryBecamePlayable( bool playable )
         return;
     }
 
-    Tomahawk::query_ptr query = q->weakRef().toStrongRef();
-    PlayableItem* item = itemFromQuery( query );
-    if ( item )
+    foreach ( PlayableItem* item, d->watchedItems.values( q ) )
     {
-        emit indexPlayable( item->index );
+        emit indexPlayable( item->index() );
     }
 }
 
@@ -1209,6 +1319,7 @@ PlayableModel::onQueryBecamePlayable( bool playable )
 void
 PlayableModel::onQueryResolved( bool hasResults )
 {
+    Q_D( PlayableModel );
     Q_UNUSED( hasResults );
 
     Tomahawk::Query* q = qobject_cast< Query* >( sender() );
@@ -1218,11 +1329,9 @@ PlayableModel::onQueryResolved( bool hasResults )
         return;
     }
 
-    Tomahawk::query_ptr query = q->weakRef().toStrongRef();
-    PlayableItem* item = itemFromQuery( query );
-    if ( item )
+    foreach ( PlayableItem* item, d->watchedItems.values( q ) )
     {
-        emit indexResolved( item->index );
+        emit indexResolved( item->index() );
     }
 }
 
@@ -1233,27 +1342,11 @@ PlayableModel::itemFromQuery( const Tomahawk::query_ptr& query, const QModelInde
     if ( !query )
         return 0;
 
-    for ( int i = 0; i < rowCount( parent ); i++ )
-    {
-        QModelIndex idx = index( i, 0, parent );
-        if ( hasChildren( idx ) )
-        {
-            PlayableItem* subItem = itemFromQuery( query, idx );
-            if ( subItem )
-                return subItem;
-        }
-
-        PlayableItem* item = itemFromIndex( idx );
-        if ( item && item->query() == query )
-        {
-            return item;
-        }
-    }
-
-    if ( !parent.isValid() )
+    PlayableItem* item = firstItem( query.data(), parent );
+    if ( !item && !parent.isValid() )
         tDebug() << Q_FUNC_INFO << "Could not find item for query in entire model:" << query->toString();
 
-    return 0;
+    return item;
 }
 
 
@@ -1263,27 +1356,35 @@ PlayableModel::itemFromResult( const Tomahawk::result_ptr& result, const QModelI
     if ( !result )
         return 0;
 
-    for ( int i = 0; i < rowCount( parent ); i++ )
+    PlayableItem* item = firstItem( result.data(), parent );
+    if ( !item && !parent.isValid() )
+        tDebug() << Q_FUNC_INFO << "Could not find item for result in entire model:" << result->toString();
+
+    return item;
+}
+
+
+PlayableItem*
+PlayableModel::firstItem( const QObject* object, const QModelIndex& parent ) const
+{
+    Q_D( const PlayableModel );
+    PlayableItem* parentItem = itemFromIndex( parent );
+
+    // the topmost row below parent showing the object
+    PlayableItem* first = 0;
+    QMultiHash< const QObject*, PlayableItem* >::const_iterator it = d->watchedItems.constFind( object );
+    for ( ; it != d->watchedItems.constEnd() && it.key() == object; ++it )
     {
-        QModelIndex idx = index( i, 0, parent );
-        if ( hasChildren( idx ) )
-        {
-            PlayableItem* subItem = itemFromResult( result, idx );
-            if ( subItem )
-                return subItem;
-        }
+        PlayableItem* item = it.value();
+        PlayableItem* ancestor = item->parent();
+        while ( ancestor && ancestor != parentItem )
+            ancestor = ancestor->parent();
 
-        PlayableItem* item = itemFromIndex( idx );
-        if ( item && item->result() == result )
-        {
-            return item;
-        }
+        if ( ancestor && ( !first || item->row() < first->row() ) )
+            first = item;
     }
 
-    if ( !parent.isValid() )
-        tDebug() << Q_FUNC_INFO << "Could not find item for result in entire model:" << result->toString();
-
-    return 0;
+    return first;
 }
 
 
@@ -193,7 +193,8 @@ protected:
     QModelIndex createIndex( int row, int column, PlayableItem* item = 0 ) const;
 
 private slots:
-    void onDataChanged();
+    void onItemChanged();
+    void onQueryResultsChanged();
 
     void onQueryBecamePlayable( bool playable );
     void onQueryResolved( bool hasResults );
@@ -202,7 +203,18 @@ private slots:
     void onPlaybackStopped();
 
 private:
+    friend class PlayableItem;
+
     void init();
+
+    void registerItem( PlayableItem* item );
+    void unregisterItem( PlayableItem* item );
+    bool watch( QObject* object, PlayableItem* item );
+    void unwatch( QObject* object, PlayableItem* item );
+    void unwatchAll();
+    void itemChanged( PlayableItem* item );
+    PlayableItem* firstItem( const QObject* object, const QModelIndex& parent ) const;
+
     template <typename T>
     void insertInternal( const QList< T >& items, int row, const QList< Tomahawk::PlaybackLog >& logs = QList< Tomahawk::PlaybackLog >(), const QModelIndex& parent = QModelIndex() );
 
@@ -27,6 +27,7 @@
 
 #include "PlayableItem.h"
 
+#include <QMultiHash>
 #include <QPixmap>
 #include <QStringList>
 
@@ -35,7 +36,7 @@ class PlayableModelPrivate
 public:
     PlayableModelPrivate( PlayableModel* q, bool _loading )
         : q_ptr( q )
-        , rootItem( new PlayableItem( 0 ) )
+        , rootItem( new PlayableItem( q ) )
         , readOnly( true )
         , loading( _loading )
     {
@@ -46,6 +47,8 @@ public:
 
 private:
     PlayableItem* rootItem;
+    // the rows showing an artist, album, query, track or result
+    QMultiHash< const QObject*, PlayableItem* > watchedItems;
     QPersistentModelIndex currentIndex;
     Tomahawk::QID currentUuid;
 
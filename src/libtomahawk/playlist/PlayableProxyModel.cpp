@@ -23,6 +23,7 @@
 
 #include "Artist.h"
 #include "Album.h"
+#include "Pipeline.h"
 #include "PlayableItem.h"
 #include "PlayableProxyModelPlaylistInterface.h"
 #include "Query.h"
@@ -696,17 +697,21 @@ PlayableProxyModel::updateDetailedInfo( const QModelIndex& index )
 {
     PlayableItem* item = itemFromIndex( mapToSource( index ) );
 
+    // only kick off loading, decoding full size covers here would stall scrolling
     if ( item->album() )
     {
-        item->album()->cover( QSize( 0, 0 ) );
+        if ( !item->album()->coverLoaded() )
+            item->album()->cover( QSize( 0, 0 ) );
     }
     else if ( item->artist() )
     {
-        item->artist()->cover( QSize( 0, 0 ) );
+        if ( !item->artist()->coverLoaded() )
+            item->artist()->cover( QSize( 0, 0 ) );
     }
     else if ( item->query() )
     {
-        item->query()->track()->cover( QSize( 0, 0 ) );
+        if ( !item->query()->track()->coverLoaded() )
+            item->query()->track()->cover( QSize( 0, 0 ) );
 
 /*        if ( style() == PlayableProxyModel::Fancy )
         {
@@ -716,6 +721,45 @@ PlayableProxyModel::updateDetailedInfo( const QModelIndex& index )
 }
 
 
+void
+PlayableProxyModel::setVisibleRows( int first, int last, int lookAhead )
+{
+    QList< Tomahawk::query_ptr > visible;
+    QList< Tomahawk::query_ptr > prefetch;
+    QSet< Tomahawk::QID > scheduled;
+
+    const int from = qMax( 0, first - lookAhead );
+    const int to = qMin( rowCount() - 1, last + lookAhead );
+    for ( int i = from; i <= to; i++ )
+    {
+        PlayableItem* item = itemFromIndex( mapToSource( index( i, 0 ) ) );
+        if ( !item || !item->query() || item->query()->resolvingFinished() )
+            continue;
+
+        const Tomahawk::query_ptr& query = item->query();
+        if ( i >= first && i <= last )
+            visible << query;
+        else
+            prefetch << query;
+
+        scheduled << query->id();
+    }
+
+    QList< Tomahawk::query_ptr > hidden;
+    foreach ( const Tomahawk::query_ptr& query, m_visibleQueries )
+    {
+        if ( !scheduled.contains( query->id() ) )
+            hidden << query;
+    }
+
+    m_visibleQueries = visible + prefetch;
+
+    Tomahawk::Pipeline::instance()->deprioritize( hidden );
+    Tomahawk::Pipeline::instance()->schedule( prefetch, Tomahawk::Pipeline::LanePrefetch );
+    Tomahawk::Pipeline::instance()->schedule( visible, Tomahawk::Pipeline::LaneVisible );
+}
+
+
 void
 PlayableProxyModel::setFilter( const QString& pattern )
 {
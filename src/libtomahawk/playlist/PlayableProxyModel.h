@@ -98,6 +98,13 @@ public:
     virtual void setFilter( const QString& pattern );
     virtual void updateDetailedInfo( const QModelIndex& index );
 
+    /**
+     * Resolve the queries of rows first to last before anything else and
+     * the ones up to lookAhead rows around them next. Queries that left
+     * that window since the last call go back to the background lane.
+     */
+    void setVisibleRows( int first, int last, int lookAhead );
+
 signals:
     void filterChanged( const QString& filter );
 
@@ -148,6 +155,8 @@ private:
 
     QHash< PlayableItemStyle, QList<PlayableModel::Columns> > m_headerStyle;
     PlayableItemStyle m_style;
+
+    QList< Tomahawk::query_ptr > m_visibleQueries;
 };
 
 #endif // TRACKPROXYMODEL_H
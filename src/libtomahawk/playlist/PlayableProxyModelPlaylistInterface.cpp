@@ -114,7 +114,7 @@ PlayableProxyModelPlaylistInterface::setCurrentIndex( qint64 index )
         if ( m_shuffled && m_shuffleHistory.count() > 1 )
         {
             if ( m_proxyModel.data()->itemFromQuery( m_shuffleHistory.at( m_shuffleHistory.count() - 2 ) ) &&
-               ( m_proxyModel.data()->mapFromSource( item->index ) == m_proxyModel.data()->mapFromSource( m_proxyModel.data()->itemFromQuery( m_shuffleHistory.at( m_shuffleHistory.count() - 2 ) )->index ) ) )
+               ( m_proxyModel.data()->mapFromSource( item->index() ) == m_proxyModel.data()->mapFromSource( m_proxyModel.data()->itemFromQuery( m_shuffleHistory.at( m_shuffleHistory.count() - 2 ) )->index() ) ) )
             {
                 // Note: the following lines aren't by mistake:
                 // We detected that we're going to the previous track in our shuffle history and hence we want to remove the currently playing and the previous track from the shuffle history.
@@ -124,7 +124,7 @@ PlayableProxyModelPlaylistInterface::setCurrentIndex( qint64 index )
             }
         }
 
-        m_proxyModel.data()->setCurrentIndex( m_proxyModel.data()->mapFromSource( item->index ) );
+        m_proxyModel.data()->setCurrentIndex( m_proxyModel.data()->mapFromSource( item->index() ) );
         m_shuffleHistory << queryAt( index );
         m_shuffleCache = QPersistentModelIndex();
     }
@@ -157,7 +157,7 @@ PlayableProxyModelPlaylistInterface::siblingIndex( int itemsAway, qint64 rootInd
                 {
                     if ( proxyModel->itemFromQuery( m_shuffleHistory.at( m_shuffleHistory.count() - 2 ) ) ) {
                         int historyIndex = m_shuffleHistory.count() - 2;
-                        idx = proxyModel->mapFromSource( proxyModel->itemFromQuery( m_shuffleHistory.at( historyIndex ) )->index );
+                        idx = proxyModel->mapFromSource( proxyModel->itemFromQuery( m_shuffleHistory.at( historyIndex ) )->index() );
                     }
                 }
                 else
@@ -212,10 +212,10 @@ PlayableProxyModelPlaylistInterface::siblingIndex( int itemsAway, qint64 rootInd
                 else
                 {
                     PlayableItem* pitem = reinterpret_cast<PlayableItem*>( (void*)rootIndex );
-                    if ( !pitem || !pitem->index.isValid() )
+                    if ( !pitem || !pitem->index().isValid() )
                         return -1;
 
-                    idx = proxyModel->mapFromSource( pitem->index );
+                    idx = proxyModel->mapFromSource( pitem->index() );
                 }
 
                 idx = proxyModel->index( idx.row() + itemsAway, 0, idx.parent() );
@@ -243,7 +243,7 @@ PlayableProxyModelPlaylistInterface::siblingIndex( int itemsAway, qint64 rootInd
         PlayableItem* item = proxyModel->itemFromIndex( proxyModel->mapToSource( idx ) );
         if ( item )
         {
-            return (qint64)( item->index.internalPointer() );
+            return (qint64)( item->index().internalPointer() );
         }
 
         idx = proxyModel->index( idx.row() + ( itemsAway > 0 ? 1 : -1 ), 0, idx.parent() );
@@ -305,7 +305,7 @@ PlayableProxyModelPlaylistInterface::indexOfResult( const Tomahawk::result_ptr&
 
     PlayableItem* item = m_proxyModel.data()->itemFromResult( result );
     if ( item )
-        return (qint64)( item->index.internalPointer() );
+        return (qint64)( item->index().internalPointer() );
 
     return -1;
 }
@@ -319,7 +319,7 @@ PlayableProxyModelPlaylistInterface::indexOfQuery( const Tomahawk::query_ptr& qu
 
     PlayableItem* item = m_proxyModel.data()->itemFromQuery( query );
     if ( item )
-        return (qint64)( item->index.internalPointer() );
+        return (qint64)( item->index().internalPointer() );
 
     return -1;
 }
@@ -294,7 +294,6 @@ PlaylistModel::insertEntries( const QList< Tomahawk::plentry_ptr >& entries, int
     {
         PlayableItem* pItem = itemFromIndex( parent );
         PlayableItem* plitem = new PlayableItem( entry, pItem, row + i );
-        plitem->index = createIndex( row + i, 0, plitem );
 
         if ( logs.count() > i )
             plitem->setPlaybackLog( logs.at( i ) );
@@ -302,26 +301,22 @@ PlaylistModel::insertEntries( const QList< Tomahawk::plentry_ptr >& entries, int
         i++;
 
         if ( entry->query()->id() == currentItemUuid() )
-            setCurrentIndex( plitem->index );
+            setCurrentIndex( plitem->index() );
 
         if ( !entry->query()->resolvingFinished() && !entry->query()->playable() )
         {
             queries << entry->query();
-            d->waitingForResolved.append( entry->query().data() );
-            connect( entry->query().data(), SIGNAL( playableStateChanged( bool ) ),
-                     SLOT( onQueryBecamePlayable( bool ) ),
-                     Qt::UniqueConnection );
+            d->waitingForResolved.insert( entry->query().data() );
             connect( entry->query().data(), SIGNAL( resolvingFinished( bool ) ),
                      SLOT( trackResolved( bool ) ) );
         }
-
-        connect( plitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
     }
 
     if ( !d->waitingForResolved.isEmpty() )
     {
         startLoading();
-        Pipeline::instance()->resolve( queries );
+        // views move the rows they show to the front, see PlayableProxyModel::setVisibleRows()
+        Pipeline::instance()->resolve( queries, false );
     }
     else
     {
@@ -349,7 +344,7 @@ PlaylistModel::trackResolved( bool )
 
     if ( d->waitingForResolved.contains( q ) )
     {
-        d->waitingForResolved.removeAll( q );
+        d->waitingForResolved.remove( q );
         disconnect( q, SIGNAL( resolvingFinished( bool ) ), this, SLOT( trackResolved( bool ) ) );
     }
 
@@ -598,7 +593,7 @@ PlaylistModel::removeIndex( const QModelIndex& index, bool moreToCome )
     if ( item && d->waitingForResolved.contains( item->query().data() ) )
     {
         disconnect( item->query().data(), SIGNAL( resolvingFinished( bool ) ), this, SLOT( trackResolved( bool ) ) );
-        d->waitingForResolved.removeAll( item->query().data() );
+        d->waitingForResolved.remove( item->query().data() );
         if ( d->waitingForResolved.isEmpty() )
             finishLoading();
     }
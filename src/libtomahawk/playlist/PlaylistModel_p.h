@@ -24,6 +24,8 @@
 #include "PlaylistModel.h"
 #include "PlayableModel_p.h"
 
+#include <QSet>
+
 class PlaylistModelPrivate : public PlayableModelPrivate
 {
 public:
@@ -45,7 +47,7 @@ private:
     bool changesOngoing;
     bool isLoading;
     bool acceptPlayableQueriesOnly;
-    QList< Tomahawk::Query* > waitingForResolved;
+    QSet< Tomahawk::Query* > waitingForResolved;
     QStringList waitForRevision;
 
     int savedInsertPos;
@@ -109,9 +109,7 @@ RecentlyPlayedModel::onSourceAdded( const Tomahawk::source_ptr& source )
     int c = rowCount( QModelIndex() );
     emit beginInsertRows( QModelIndex(), c, c );
 
-    PlayableItem* item = new PlayableItem( source, rootItem() );
-    item->index = createIndex( rootItem()->children.count() - 1, 0, item );
-    connect( item, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+    new PlayableItem( source, rootItem() );
 
     emit endInsertRows();
 }
@@ -89,10 +89,10 @@ TrackView::TrackView( QWidget* parent )
 
     m_timer.setInterval( SCROLL_TIMEOUT );
 
-    // enable those connects if you want to enable lazily loading extra information for visible items
-//    connect( verticalScrollBar(), SIGNAL( rangeChanged( int, int ) ), SLOT( onViewChanged() ) );
-//    connect( verticalScrollBar(), SIGNAL( valueChanged( int ) ), SLOT( onViewChanged() ) );
-//    connect( &m_timer, SIGNAL( timeout() ), SLOT( onScrollTimeout() ) );
+    // resolve and load extra information for the visible items lazily
+    connect( verticalScrollBar(), SIGNAL( rangeChanged( int, int ) ), SLOT( onViewChanged() ) );
+    connect( verticalScrollBar(), SIGNAL( valueChanged( int ) ), SLOT( onViewChanged() ) );
+    connect( &m_timer, SIGNAL( timeout() ), SLOT( onScrollTimeout() ) );
 
     connect( this, SIGNAL( doubleClicked( QModelIndex ) ), SLOT( onItemActivated( QModelIndex ) ) );
     connect( this, SIGNAL( customContextMenuRequested( const QPoint& ) ), SLOT( onCustomContextMenu( const QPoint& ) ) );
@@ -318,18 +318,16 @@ TrackView::onScrollTimeout()
     while ( right.isValid() && right.parent().isValid() )
         right = right.parent();
 
-    int max = m_proxyModel->playlistInterface()->trackCount();
+    if ( !left.isValid() )
+        return;
+
+    // the view isn't filled up to its bottom
+    int max = m_proxyModel->rowCount() - 1;
     if ( right.isValid() )
         max = right.row();
 
-    if ( !max )
-        return;
-
-    //FIXME
-    for ( int i = left.row(); i <= max; i++ )
-    {
-        m_proxyModel->updateDetailedInfo( m_proxyModel->index( i, 0 ) );
-    }
+    // look ahead a page in both directions
+    m_proxyModel->setVisibleRows( left.row(), max, max - left.row() + 1 );
 }
 
 
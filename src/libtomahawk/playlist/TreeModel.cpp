@@ -197,10 +197,8 @@ TreeModel::addAlbums( const QModelIndex& parent, const QList<Tomahawk::album_ptr
     foreach( const album_ptr& album, albums )
     {
         PlayableItem* albumitem = new PlayableItem( album, parentItem );
-        albumitem->index = createIndex( parentItem->children.count() - 1, 0, albumitem );
-        connect( albumitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
 
-        getCover( albumitem->index );
+        getCover( albumitem->index() );
     }
 
     emit endInsertRows();
@@ -277,9 +275,7 @@ TreeModel::onArtistsAdded( const QList<Tomahawk::artist_ptr>& artists )
 
     foreach( const artist_ptr& artist, artists )
     {
-        PlayableItem* artistitem = new PlayableItem( artist, rootItem() );
-        artistitem->index = createIndex( rootItem()->children.count() - 1, 0, artistitem );
-        connect( artistitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+        new PlayableItem( artist, rootItem() );
     }
 
     emit endInsertRows();
@@ -307,10 +303,7 @@ TreeModel::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks, const QModel
 
     foreach( const query_ptr& query, tracks )
     {
-        PlayableItem* item = new PlayableItem( query, parentItem );
-        item->index = createIndex( parentItem->children.count() - 1, 0, item );
-
-        connect( item, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+        new PlayableItem( query, parentItem );
     }
 
     emit endInsertRows();
@@ -79,7 +79,7 @@ TreeProxyModelPlaylistInterface::setCurrentIndex( qint64 index )
     }
     else
     {
-        m_proxyModel.data()->setCurrentIndex( m_proxyModel.data()->mapFromSource( item->index ) );
+        m_proxyModel.data()->setCurrentIndex( m_proxyModel.data()->mapFromSource( item->index() ) );
     }
 }
 
@@ -103,7 +103,7 @@ TreeProxyModelPlaylistInterface::siblingIndex( int itemsAway, qint64 rootIndex )
         if ( !pitem )
             return -1;
 
-        idx = proxyModel->mapFromSource( pitem->index );
+        idx = proxyModel->mapFromSource( pitem->index() );
     }
     if ( !idx.isValid() )
         return -1;
@@ -138,7 +138,7 @@ TreeProxyModelPlaylistInterface::siblingIndex( int itemsAway, qint64 rootIndex )
         PlayableItem* item = proxyModel->itemFromIndex( proxyModel->mapToSource( idx ) );
         if ( item )
         {
-            return (qint64)( item->index.internalPointer() );
+            return (qint64)( item->index().internalPointer() );
         }
 
         idx = proxyModel->index( idx.row() + ( itemsAway > 0 ? 1 : -1 ), 0, idx.parent() );
@@ -181,7 +181,7 @@ TreeProxyModelPlaylistInterface::indexOfResult( const result_ptr& result ) const
     PlayableItem* item = m_proxyModel.data()->itemFromResult( result );
     if ( item )
     {
-        return (qint64)( item->index.internalPointer() );
+        return (qint64)( item->index().internalPointer() );
     }
 
     return -1;
@@ -197,7 +197,7 @@ TreeProxyModelPlaylistInterface::indexOfQuery( const query_ptr& query ) const
     PlayableItem* item = m_proxyModel.data()->itemFromQuery( query );
     if ( item )
     {
-        return (qint64)( item->index.internalPointer() );
+        return (qint64)( item->index().internalPointer() );
     }
 
     return -1;
@@ -53,6 +53,10 @@
 #include <QMetaProperty>
 #include <QWebFrame>
 
+// seconds, resolvers can override them in their settings
+#define DEFAULT_RESULT_CACHE_TTL 30 * 60
+#define DEFAULT_NEGATIVE_RESULT_CACHE_TTL 10 * 60
+
 using namespace Tomahawk;
 
 JSResolver::JSResolver( const QString& accountId, const QString& scriptPath, const QStringList& additionalScriptPaths )
@@ -173,6 +177,7 @@ JSResolver::reload()
     {
         init();
         d->error = Tomahawk::ExternalResolver::NoError;
+        Tomahawk::Pipeline::instance()->invalidateResultCache( this );
     } else
     {
         d->error = Tomahawk::ExternalResolver::FileNotFound;
@@ -259,8 +264,14 @@ JSResolver::init()
     d->name    = m.value( "name" ).toString();
     d->weight  = m.value( "weight", 0 ).toUInt();
     d->timeout = m.value( "timeout", 25 ).toUInt() * 1000;
+    d->resultCacheTtl = m.value( "resultCacheTtl", DEFAULT_RESULT_CACHE_TTL ).toLongLong() * 1000;
+    d->negativeResultCacheTtl = m.value( "negativeResultCacheTtl", DEFAULT_NEGATIVE_RESULT_CACHE_TTL ).toLongLong() * 1000;
     bool compressed = m.value( "compressed", "false" ).toString() == "true";
 
+    // opt-in: only resolvers implementing resolveBatch get batches, everyone else keeps getting resolve() calls
+    d->batchResolve = d->scriptAccount->evaluateJavaScriptWithResult(
+        "typeof Tomahawk.resolver.instance.resolveBatch === 'function'" ).toBool();
+
     QByteArray icoData = QByteArray::fromBase64( m.value( "icon" ).toByteArray() );
     if ( compressed )
         icoData = qUncompress( icoData );
@@ -293,7 +304,7 @@ JSResolver::init()
         d->configWidget->fillDataInWidgets( resolverUserConfig() );
     }
 
-    qDebug() << "JS" << filePath() << "READY," << "name" << d->name << "weight" << d->weight << "timeout" << d->timeout << "icon received" << success;
+    qDebug() << "JS" << filePath() << "READY," << "name" << d->name << "weight" << d->weight << "timeout" << d->timeout << "icon received" << success << "batch resolve" << d->batchResolve;
 
     d->ready = true;
 }
@@ -414,6 +425,76 @@ JSResolver::resolve( const Tomahawk::query_ptr& query )
 }
 
 
+qint64
+JSResolver::resultCacheTtl() const
+{
+    Q_D( const JSResolver );
+
+    return d->resultCacheTtl;
+}
+
+
+qint64
+JSResolver::negativeResultCacheTtl() const
+{
+    Q_D( const JSResolver );
+
+    return d->negativeResultCacheTtl;
+}
+
+
+bool
+JSResolver::supportsBatchResolve() const
+{
+    Q_D( const JSResolver );
+
+    return d->batchResolve;
+}
+
+
+void
+JSResolver::resolveBatch( const QList< Tomahawk::query_ptr >& queries )
+{
+    Q_D( JSResolver );
+
+    if ( QThread::currentThread() != thread() )
+    {
+        QMetaObject::invokeMethod( this, "resolveBatch", Qt::QueuedConnection, Q_ARG( QList< Tomahawk::query_ptr >, queries ) );
+        return;
+    }
+
+    if ( !d->batchResolve )
+    {
+        Resolver::resolveBatch( queries );
+        return;
+    }
+
+    // The queries are handed over as plain data, the script fetches them with
+    // Tomahawk.takeBatchQueries(), so there's nothing to escape or parse
+    QVariantList batch;
+    foreach ( const Tomahawk::query_ptr& query, queries )
+    {
+        QVariantMap m;
+        m[ "qid" ] = query->id();
+        if ( !query->isFullTextQuery() )
+        {
+            m[ "artist" ] = query->queryTrack()->artist();
+            m[ "album" ] = query->queryTrack()->album();
+            m[ "track" ] = query->queryTrack()->track();
+        }
+        else
+        {
+            m[ "query" ] = query->fullTextQuery();
+        }
+
+        batch << m;
+    }
+
+    d->resolverHelper->setBatchQueries( batch );
+    callOnResolver( "resolveBatch( Tomahawk.takeBatchQueries() )" );
+}
+
+
 void
 JSResolver::stop()
 {
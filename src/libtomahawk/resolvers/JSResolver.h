@@ -71,12 +71,20 @@ public:
 
     bool canParseUrl( const QString& url, UrlType type ) override;
 
+    /// True if the resolver script implements resolveBatch( queries ).
+    bool supportsBatchResolve() const override;
+
+    /// Configurable through the resultCacheTtl / negativeResultCacheTtl settings (in seconds).
+    qint64 resultCacheTtl() const override;
+    qint64 negativeResultCacheTtl() const override;
+
     QVariantMap loadDataFromWidgets();
 
     ScriptAccount* scriptAccount() const;
 
 public slots:
     void resolve( const Tomahawk::query_ptr& query ) override;
+    void resolveBatch( const QList< Tomahawk::query_ptr >& queries ) override;
     void stop() override;
     void start() override;
 
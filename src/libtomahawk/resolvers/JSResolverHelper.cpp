@@ -155,7 +155,31 @@ JSResolverHelper::addTrackResults( const QVariantMap& results )
 
     QString qid = results.value("qid").toString();
 
-    Tomahawk::Pipeline::instance()->reportResults( qid, tracks );
+    Tomahawk::Pipeline::instance()->reportResults( qid, tracks, m_resolver );
+}
+
+
+void
+JSResolverHelper::addTrackResultsBatch( const QVariantList& results )
+{
+    foreach ( const QVariant& v, results )
+        addTrackResults( v.toMap() );
+}
+
+
+void
+JSResolverHelper::setBatchQueries( const QVariantList& queries )
+{
+    m_batchQueries = queries;
+}
+
+
+QVariantList
+JSResolverHelper::takeBatchQueries()
+{
+    QVariantList queries;
+    queries.swap( m_batchQueries );
+    return queries;
 }
 
 
@@ -915,42 +939,30 @@ JSResolverHelper::nativeAsyncRequest( const int requestId, const QString& url,
         req.setRawHeader( "Authorization", credentials.toLatin1() );
     }
 
-    NetworkReply* reply = NULL;
-    if ( options.contains( "method") && options["method"].toString().toUpper() == "POST" )
-    {
-        QByteArray data;
-        if ( options.contains( "data" ) )
-        {
-            data = options["data"].toString().toLatin1();
-        }
-        reply = new NetworkReply( Tomahawk::Utils::nam()->post( req, data ) );
-    }
-    else if ( options.contains( "method") && options["method"].toString().toUpper() == "HEAD" )
-    {
-        reply = new NetworkReply( Tomahawk::Utils::nam()->head( req ) );
-    }
-    else
-    {
-        reply = new NetworkReply( Tomahawk::Utils::nam()->get( req ) );
-    }
+    // shared with the other resolvers: cached, coalesced and limited per host
+    QByteArray verb = "GET";
+    QByteArray data;
+    if ( options.contains( "method" ) )
+        verb = options["method"].toString().toUpper().toLatin1();
+    if ( verb == "POST" && options.contains( "data" ) )
+        data = options["data"].toString().toLatin1();
 
-    NewClosure( reply, SIGNAL( finished() ), this, SLOT( nativeAsyncRequestDone( int, NetworkReply* ) ), requestId, reply );
+    Tomahawk::Utils::HttpClient::instance()->send( m_resolver->name(), verb, req, data, this,
+        std::bind( &JSResolverHelper::nativeAsyncRequestDone, this, requestId, std::placeholders::_1 ) );
 }
 
 
 void
-JSResolverHelper::nativeAsyncRequestDone( int requestId, NetworkReply* reply )
+JSResolverHelper::nativeAsyncRequestDone( int requestId, const Tomahawk::Utils::HttpResponse& response )
 {
-    reply->deleteLater();
-
     QVariantMap map;
-    map["response"] = QString::fromUtf8( reply->reply()->readAll() );
+    map["response"] = QString::fromUtf8( response.body );
     map["responseText"] = map["response"];
     map["responseType"] = QString(); // Default, indicates a string in map["response"]
     map["readyState"] = 4;
-    map["status"] = reply->reply()->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+    map["status"] = response.status;
     map["statusText"] = QString("%1 %2").arg( map["status"].toString() )
-            .arg( reply->reply()->attribute( QNetworkRequest::HttpReasonPhraseAttribute ).toString() );
+            .arg( response.reasonPhrase );
 
     bool ok = false;
     QString json = QString::fromUtf8( TomahawkUtils::toJson( map, &ok ) );
@@ -1131,6 +1143,7 @@ JSResolverHelper::deleteFuzzyIndex()
 void
 JSResolverHelper::readdResolver()
 {
+    Pipeline::instance()->invalidateResultCache( m_resolver );
     Pipeline::instance()->removeResolver( m_resolver );
     Pipeline::instance()->addResolver( m_resolver );
 }
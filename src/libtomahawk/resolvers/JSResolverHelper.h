@@ -26,6 +26,7 @@
 #include "Typedefs.h"
 #include "UrlHandler.h"
 #include "database/fuzzyindex/FuzzyIndex.h"
+#include "utils/HttpClient.h"
 #include "utils/NetworkReply.h"
 
 #include <QObject>
@@ -121,6 +122,14 @@ public:
      */
     Q_INVOKABLE void readdResolver();
 
+    /**
+     * Queries of the batch currently handed to resolveBatch(), as a list of
+     * { qid, artist, album, track } or { qid, query } objects.
+     *
+     * INTERNAL USE ONLY!
+     */
+    Q_INVOKABLE QVariantList takeBatchQueries();
+
 
     /**
      * INTERNAL USE ONLY!
@@ -128,6 +137,11 @@ public:
     void customIODeviceFactory( const Tomahawk::result_ptr&, const QString& url,
                                 std::function< void( const QString&, QSharedPointer< QIODevice >& ) > callback ); // async
 
+    /**
+     * INTERNAL USE ONLY!
+     */
+    void setBatchQueries( const QVariantList& queries );
+
 
 public slots:
     QByteArray readRaw( const QString& fileName );
@@ -143,6 +157,8 @@ public slots:
     bool fakeEnv() { return false; }
 
     void addTrackResults( const QVariantMap& results );
+    /// A list of { qid, results } objects, as reported for a batch.
+    void addTrackResultsBatch( const QVariantList& results );
 
     void addUrlResult( const QString& url, const QVariantMap& result );
 
@@ -157,9 +173,9 @@ private slots:
     void gotStreamUrl( IODeviceCallback callback, NetworkReply* reply );
     void tracksAdded( const QList<Tomahawk::query_ptr>& tracks, const Tomahawk::ModelMode, const Tomahawk::collection_ptr& collection );
     void pltemplateTracksLoadedForUrl( const QString& url, const Tomahawk::playlisttemplate_ptr& pltemplate );
-    void nativeAsyncRequestDone( int requestId, NetworkReply* reply );
 
 private:
+    void nativeAsyncRequestDone( int requestId, const Tomahawk::Utils::HttpResponse& response );
     Tomahawk::query_ptr parseTrack( const QVariantMap& track );
     void returnStreamUrl( const QString& streamUrl, const QMap<QString, QString>& headers,
                           std::function< void( const QString&, QSharedPointer< QIODevice >& ) > callback );
@@ -175,6 +191,7 @@ private:
     bool m_urlCallbackIsAsync;
     QString m_pendingUrl;
     Tomahawk::album_ptr m_pendingAlbum;
+    QVariantList m_batchQueries;
 };
 
 } // ns: Tomahawk
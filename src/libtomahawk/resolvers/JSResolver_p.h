@@ -41,6 +41,9 @@ public:
         , accountId( pAccountId )
         , ready( false )
         , stopped( true )
+        , batchResolve( false )
+        , resultCacheTtl( 0 )
+        , negativeResultCacheTtl( 0 )
         , error( Tomahawk::ExternalResolver::NoError )
         , resolverHelper( new JSResolverHelper( scriptPath, q ) )
         , requiredScriptPaths( additionalScriptPaths )
@@ -58,6 +61,8 @@ private:
 
     bool ready;
     bool stopped;
+    bool batchResolve;
+    qint64 resultCacheTtl, negativeResultCacheTtl; // msecs
     Tomahawk::ExternalResolver::ErrorState error;
 
     JSResolverHelper* resolverHelper;
@@ -24,3 +24,11 @@ Tomahawk::Resolver::icon( const QSize& ) const
 {
     return QPixmap();
 }
+
+
+void
+Tomahawk::Resolver::resolveBatch( const QList< Tomahawk::query_ptr >& queries )
+{
+    foreach ( const Tomahawk::query_ptr& query, queries )
+        resolve( query );
+}
@@ -49,8 +49,24 @@ public:
 
     virtual QPixmap icon( const QSize& size ) const override;
 
+    /**
+     * Resolvers that can handle many queries in a single call return true,
+     * the Pipeline then dispatches pending queries to them via resolveBatch().
+     */
+    virtual bool supportsBatchResolve() const { return false; }
+
+    /**
+     * For how many milliseconds the Pipeline may reuse the results (or the
+     * lack thereof) this resolver reported for a track. 0 disables caching.
+     */
+    virtual qint64 resultCacheTtl() const { return 0; }
+    virtual qint64 negativeResultCacheTtl() const { return 0; }
+
 public slots:
     virtual void resolve( const Tomahawk::query_ptr& query ) = 0;
+
+    /// Results are still reported per query. Falls back to one resolve() per query.
+    virtual void resolveBatch( const QList< Tomahawk::query_ptr >& queries );
 };
 
 } //ns
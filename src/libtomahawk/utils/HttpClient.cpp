@@ -0,0 +1,326 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "HttpClient.h"
+
+#include "utils/Logger.h"
+#include "utils/NetworkReply.h"
+#include "TomahawkSettings.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
+#include <QThread>
+
+#define HTTP_CACHE_SIZE 50 * 1024 * 1024
+#define MAX_REQUESTS_PER_HOST 4
+#define URL_VERDICT_TTL 15 * 60 * 1000
+#define INVALID_URL_VERDICT_TTL 2 * 60 * 1000
+#define MAX_URL_VERDICTS 10000
+
+using namespace Tomahawk::Utils;
+
+HttpClient* HttpClient::s_instance = 0;
+
+
+HttpClient*
+HttpClient::instance()
+{
+    static QMutex mutex;
+    QMutexLocker lock( &mutex );
+
+    if ( !s_instance )
+    {
+        s_instance = new HttpClient( TomahawkSettings::instance()->storageCacheLocation() + "/HttpCache/" );
+        s_instance->moveToThread( QCoreApplication::instance()->thread() );
+    }
+
+    return s_instance;
+}
+
+
+HttpClient::HttpClient( const QString& cacheDir, QObject* parent )
+    : QObject( parent )
+    , m_nam( new QNetworkAccessManager( this ) )
+    , m_maxRequestsPerHost( MAX_REQUESTS_PER_HOST )
+{
+    // proxy settings are picked up from the application wide proxy factory
+    QNetworkDiskCache* cache = new QNetworkDiskCache( m_nam );
+    cache->setCacheDirectory( cacheDir );
+    cache->setMaximumCacheSize( HTTP_CACHE_SIZE );
+    m_nam->setCache( cache );
+}
+
+
+HttpClient::~HttpClient()
+{
+    foreach ( const QString& client, m_statistics.keys() )
+    {
+        const Statistics& stats = m_statistics[ client ];
+        tLog() << "HTTP statistics for" << client << "- requests:" << stats.requests << "cache hits:" << stats.cacheHits
+               << "coalesced:" << stats.coalesced << "url checks:" << stats.urlChecks << "(" << stats.urlCheckHits << "cached )"
+               << "avg latency:" << stats.averageLatency() << "ms max latency:" << stats.maxLatency << "ms";
+    }
+
+    foreach ( NetworkReply* reply, m_transfers.keys() )
+        delete reply;
+    qDeleteAll( m_transfers );
+    foreach ( const QQueue< Transfer* >& queue, m_queued )
+        qDeleteAll( queue );
+
+    if ( s_instance == this )
+        s_instance = 0;
+}
+
+
+QString
+HttpClient::coalescingKey( const QByteArray& verb, const QNetworkRequest& request )
+{
+    // requests with side effects have to go out every time
+    if ( verb != "GET" && verb != "HEAD" )
+        return QString();
+
+    QList< QByteArray > headers = request.rawHeaderList();
+    qSort( headers );
+
+    QByteArray key = verb + ' ' + request.url().toEncoded();
+    foreach ( const QByteArray& header, headers )
+        key += '\n' + header + ": " + request.rawHeader( header );
+
+    return QString::fromUtf8( key );
+}
+
+
+void
+HttpClient::send( const QString& client, const QByteArray& verb, const QNetworkRequest& request, const QByteArray& data,
+                  QObject* context, Callback callback )
+{
+    Q_ASSERT( QThread::currentThread() == thread() );
+
+    Waiter waiter;
+    waiter.client = client;
+    waiter.context = context;
+    waiter.hasContext = ( context != 0 );
+    waiter.callback = callback;
+    waiter.started = QDateTime::currentMSecsSinceEpoch();
+
+    const QString key = coalescingKey( verb, request );
+    if ( !key.isEmpty() && m_inFlight.contains( key ) )
+    {
+        m_statistics[ client ].coalesced++;
+        m_inFlight.value( key )->waiters << waiter;
+        return;
+    }
+
+    Transfer* transfer = new Transfer;
+    transfer->key = key;
+    transfer->host = request.url().host();
+    transfer->verb = verb;
+    transfer->request = request;
+    transfer->data = data;
+    transfer->waiters << waiter;
+
+    if ( !key.isEmpty() )
+        m_inFlight.insert( key, transfer );
+
+    if ( m_running.value( transfer->host ) < m_maxRequestsPerHost )
+        start( transfer );
+    else
+        m_queued[ transfer->host ].enqueue( transfer );
+}
+
+
+void
+HttpClient::checkUrl( const QString& client, const QUrl& url, QObject* context, std::function< void( bool ) > callback )
+{
+    Statistics& stats = m_statistics[ client ];
+    stats.urlChecks++;
+
+    bool valid;
+    if ( cachedUrlVerdict( url, &valid ) )
+    {
+        stats.urlCheckHits++;
+        callback( valid );
+        return;
+    }
+
+    send( client, "HEAD", QNetworkRequest( url ), QByteArray(), context,
+          std::bind( &HttpClient::urlChecked, this, url, callback, std::placeholders::_1 ) );
+}
+
+
+bool
+HttpClient::cachedUrlVerdict( const QUrl& url, bool* valid )
+{
+    QMutexLocker lock( &m_urlVerdictsMutex );
+
+    QHash< QString, QPair< bool, qint64 > >::iterator it = m_urlVerdicts.find( url.toString() );
+    if ( it == m_urlVerdicts.end() )
+        return false;
+
+    if ( it->second < QDateTime::currentMSecsSinceEpoch() )
+    {
+        m_urlVerdicts.erase( it );
+        return false;
+    }
+
+    *valid = it->first;
+    return true;
+}
+
+
+void
+HttpClient::setUrlVerdict( const QUrl& url, bool valid )
+{
+    QMutexLocker lock( &m_urlVerdictsMutex );
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if ( m_urlVerdicts.count() >= MAX_URL_VERDICTS )
+    {
+        QHash< QString, QPair< bool, qint64 > >::iterator it = m_urlVerdicts.begin();
+        while ( it != m_urlVerdicts.end() )
+        {
+            if ( it->second < now )
+                it = m_urlVerdicts.erase( it );
+            else
+                ++it;
+        }
+
+        if ( m_urlVerdicts.count() >= MAX_URL_VERDICTS )
+            m_urlVerdicts.clear();
+    }
+
+    m_urlVerdicts.insert( url.toString(), qMakePair( valid, now + ( valid ? URL_VERDICT_TTL : INVALID_URL_VERDICT_TTL ) ) );
+}
+
+
+void
+HttpClient::urlChecked( const QUrl& url, std::function< void( bool ) > callback, const HttpResponse& response )
+{
+    const bool valid = ( response.error == QNetworkReply::NoError );
+    setUrlVerdict( url, valid );
+
+    callback( valid );
+}
+
+
+QStringList
+HttpClient::clients() const
+{
+    return m_statistics.keys();
+}
+
+
+HttpClient::Statistics
+HttpClient::statistics( const QString& client ) const
+{
+    return m_statistics.value( client );
+}
+
+
+void
+HttpClient::start( Transfer* transfer )
+{
+    QNetworkReply* reply;
+    if ( transfer->verb == "GET" )
+        reply = m_nam->get( transfer->request );
+    else if ( transfer->verb == "HEAD" )
+        reply = m_nam->head( transfer->request );
+    else if ( transfer->verb == "POST" )
+        reply = m_nam->post( transfer->request, transfer->data );
+    else if ( transfer->verb == "PUT" )
+        reply = m_nam->put( transfer->request, transfer->data );
+    else if ( transfer->verb == "DELETE" )
+        reply = m_nam->deleteResource( transfer->request );
+    else
+        reply = m_nam->sendCustomRequest( transfer->request, transfer->verb );
+
+    m_running[ transfer->host ]++;
+
+    NetworkReply* networkReply = new NetworkReply( reply );
+    m_transfers.insert( networkReply, transfer );
+    connect( networkReply, SIGNAL( finished() ), SLOT( onFinished() ) );
+}
+
+
+void
+HttpClient::startQueued( const QString& host )
+{
+    while ( m_running.value( host ) < m_maxRequestsPerHost && !m_queued.value( host ).isEmpty() )
+    {
+        Transfer* transfer = m_queued[ host ].dequeue();
+        start( transfer );
+    }
+
+    if ( m_queued.contains( host ) && m_queued.value( host ).isEmpty() )
+        m_queued.remove( host );
+}
+
+
+void
+HttpClient::onFinished()
+{
+    NetworkReply* networkReply = qobject_cast< NetworkReply* >( sender() );
+    if ( !networkReply || !m_transfers.contains( networkReply ) )
+        return;
+
+    networkReply->deleteLater();
+    Transfer* transfer = m_transfers.take( networkReply );
+
+    HttpResponse response;
+    QNetworkReply* reply = networkReply->reply();
+    if ( reply )
+    {
+        response.error = reply->error();
+        response.status = reply->attribute( QNetworkRequest::HttpStatusCodeAttribute ).toInt();
+        response.reasonPhrase = reply->attribute( QNetworkRequest::HttpReasonPhraseAttribute ).toString();
+        response.body = reply->readAll();
+        response.fromCache = reply->attribute( QNetworkRequest::SourceIsFromCacheAttribute ).toBool();
+    }
+    else
+        response.error = QNetworkReply::OperationCanceledError;
+
+    if ( !transfer->key.isEmpty() && m_inFlight.value( transfer->key ) == transfer )
+        m_inFlight.remove( transfer->key );
+
+    if ( --m_running[ transfer->host ] <= 0 )
+        m_running.remove( transfer->host );
+    startQueued( transfer->host );
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    foreach ( const Waiter& waiter, transfer->waiters )
+    {
+        Statistics& stats = m_statistics[ waiter.client ];
+        const qint64 latency = now - waiter.started;
+        stats.requests++;
+        stats.totalLatency += latency;
+        stats.maxLatency = qMax( stats.maxLatency, latency );
+        if ( response.fromCache )
+            stats.cacheHits++;
+
+        if ( waiter.hasContext && waiter.context.isNull() )
+            continue;
+
+        waiter.callback( response );
+    }
+
+    delete transfer;
+}
@@ -0,0 +1,166 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+#ifndef TOMAHAWK_UTILS_HTTPCLIENT_H
+#define TOMAHAWK_UTILS_HTTPCLIENT_H
+
+#include "DllMacro.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QQueue>
+#include <QStringList>
+
+#include <functional>
+
+class QNetworkAccessManager;
+class NetworkReply;
+
+namespace Tomahawk
+{
+namespace Utils
+{
+
+struct HttpResponse
+{
+    HttpResponse() : error( QNetworkReply::NoError ), status( 0 ), fromCache( false ) {}
+
+    QNetworkReply::NetworkError error;
+    int status;
+    QString reasonPhrase;
+    QByteArray body;
+    bool fromCache;
+};
+
+/**
+ * The HTTP layer shared by script resolvers and the ResultUrlChecker.
+ *
+ * Responses are cached on disk following the usual HTTP caching rules
+ * (Cache-Control, Expires, validators). Identical GET and HEAD requests
+ * that are in flight at the same time only hit the network once, and no
+ * more than a few requests per host are running at any time, the rest is
+ * queued. Verdicts of url checks are remembered for a while, so the same
+ * stream url isn't checked over and over again.
+ *
+ * Every request is accounted to a client (e.g. the resolver's name), see
+ * statistics(). Apart from the url verdicts, only use it from the main thread.
+ */
+class DLLEXPORT HttpClient : public QObject
+{
+Q_OBJECT
+
+public:
+    typedef std::function< void( const Tomahawk::Utils::HttpResponse& ) > Callback;
+
+    struct Statistics
+    {
+        Statistics() : requests( 0 ), cacheHits( 0 ), coalesced( 0 ), urlChecks( 0 ), urlCheckHits( 0 ), totalLatency( 0 ), maxLatency( 0 ) {}
+
+        quint64 requests;
+        /// Requests answered from the disk cache, without a full download.
+        quint64 cacheHits;
+        /// Requests that piggybacked on an identical one already in flight.
+        quint64 coalesced;
+        quint64 urlChecks;
+        quint64 urlCheckHits;
+        qint64 totalLatency; // msecs
+        qint64 maxLatency;
+
+        qint64 averageLatency() const { return requests ? totalLatency / (qint64)requests : 0; }
+    };
+
+    static HttpClient* instance();
+
+    explicit HttpClient( const QString& cacheDir, QObject* parent = 0 );
+    virtual ~HttpClient();
+
+    /**
+     * Send a request, the callback is invoked once it finished unless the
+     * context object got deleted in the meantime.
+     *
+     * @param verb GET, HEAD, POST or any other method
+     */
+    void send( const QString& client, const QByteArray& verb, const QNetworkRequest& request, const QByteArray& data,
+               QObject* context, Callback callback );
+
+    /// Check that an url is reachable with a HEAD request, or take a recent verdict.
+    void checkUrl( const QString& client, const QUrl& url, QObject* context, std::function< void( bool ) > callback );
+
+    /// Recent url check verdicts, these two may be used from any thread.
+    bool cachedUrlVerdict( const QUrl& url, bool* valid );
+    void setUrlVerdict( const QUrl& url, bool valid );
+
+    QStringList clients() const;
+    Statistics statistics( const QString& client ) const;
+
+    void setMaxRequestsPerHost( int max ) { m_maxRequestsPerHost = max; }
+
+private slots:
+    void onFinished();
+
+private:
+    struct Waiter
+    {
+        QString client;
+        QPointer< QObject > context;
+        bool hasContext;
+        Callback callback;
+        qint64 started;
+    };
+
+    struct Transfer
+    {
+        QString key;
+        QString host;
+        QByteArray verb;
+        QNetworkRequest request;
+        QByteArray data;
+        QList< Waiter > waiters;
+    };
+
+    static QString coalescingKey( const QByteArray& verb, const QNetworkRequest& request );
+    void start( Transfer* transfer );
+    void urlChecked( const QUrl& url, std::function< void( bool ) > callback, const Tomahawk::Utils::HttpResponse& response );
+    void startQueued( const QString& host );
+
+    QNetworkAccessManager* m_nam;
+    int m_maxRequestsPerHost;
+
+    QHash< QString, Transfer* > m_inFlight; // by coalescing key
+    QHash< NetworkReply*, Transfer* > m_transfers;
+    QHash< QString, QQueue< Transfer* > > m_queued; // by host
+    QHash< QString, int > m_running; // by host
+
+    QMutex m_urlVerdictsMutex;
+    QHash< QString, QPair< bool, qint64 > > m_urlVerdicts; // url -> valid, expiry
+    QHash< QString, Statistics > m_statistics;
+
+    static HttpClient* s_instance;
+};
+
+}
+}
+
+#endif // TOMAHAWK_UTILS_HTTPCLIENT_H
@@ -141,7 +141,9 @@ NetworkReply::load( const QUrl& url )
     m_formerUrls << url.toString();
     QNetworkRequest request( url );
 
-    Q_ASSERT( Tomahawk::Utils::nam() != 0 );
+    // follow redirects with the manager the request was sent through, it may have a cache of its own
+    QNetworkAccessManager* manager = m_reply->manager() ? m_reply->manager() : Tomahawk::Utils::nam();
+    Q_ASSERT( manager != 0 );
 
     QNetworkAccessManager::Operation op = m_reply->operation();
     m_reply->deleteLater();
@@ -149,11 +151,11 @@ NetworkReply::load( const QUrl& url )
     switch ( op )
     {
         case QNetworkAccessManager::HeadOperation:
-            m_reply = Tomahawk::Utils::nam()->head( request );
+            m_reply = manager->head( request );
             break;
 
         default:
-            m_reply = Tomahawk::Utils::nam()->get( request );
+            m_reply = manager->get( request );
     }
 
     connectReplySignals();
@@ -55,7 +55,7 @@ PixmapDelegateFader::PixmapDelegateFader( const artist_ptr& artist, const QSize&
         connect( m_artist.data(), SIGNAL( updated() ), SLOT( artistChanged() ) );
         connect( m_artist.data(), SIGNAL( coverChanged() ), SLOT( artistChanged() ) );
 
-        m_currentReference = m_artist->cover( size, forceLoad );
+        m_currentReference = m_artist->thumbnail( size, forceLoad );
     }
 
     init();
@@ -72,7 +72,7 @@ PixmapDelegateFader::PixmapDelegateFader( const album_ptr& album, const QSize& s
         connect( m_album.data(), SIGNAL( updated() ), SLOT( albumChanged() ) );
         connect( m_album.data(), SIGNAL( coverChanged() ), SLOT( albumChanged() ) );
 
-        m_currentReference = m_album->cover( size, forceLoad );
+        m_currentReference = m_album->thumbnail( size, forceLoad );
     }
 
     init();
@@ -90,7 +90,7 @@ PixmapDelegateFader::PixmapDelegateFader( const query_ptr& track, const QSize& s
         connect( m_track->track().data(), SIGNAL( updated() ), SLOT( trackChanged() ) );
         connect( m_track->track().data(), SIGNAL( coverChanged() ), SLOT( trackChanged() ) );
 
-        m_currentReference = m_track->track()->cover( size, forceLoad );
+        m_currentReference = m_track->track()->thumbnail( size, forceLoad );
     }
 
     init();
@@ -146,12 +146,17 @@ PixmapDelegateFader::setSize( const QSize& size )
     }
     else
     {
+        QPixmap pixmap;
         if ( !m_album.isNull() )
-            m_currentReference = m_album->cover( m_size );
+            pixmap = m_album->thumbnail( m_size );
         else if ( !m_artist.isNull() )
-            m_currentReference = m_artist->cover( m_size );
+            pixmap = m_artist->thumbnail( m_size );
         else if ( !m_track.isNull() )
-            m_currentReference = m_track->track()->cover( m_size );
+            pixmap = m_track->track()->thumbnail( m_size );
+
+        // otherwise the new size is still being scaled, coverChanged() brings it in
+        if ( !pixmap.isNull() )
+            m_currentReference = pixmap;
     }
 
     emit repaintRequest();
@@ -164,7 +169,7 @@ PixmapDelegateFader::albumChanged()
     if ( m_album.isNull() )
         return;
 
-    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_album->cover( m_size ) ) );
+    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_album->thumbnail( m_size ) ) );
 }
 
 
@@ -174,7 +179,7 @@ PixmapDelegateFader::artistChanged()
     if ( m_artist.isNull() )
         return;
 
-    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_artist->cover( m_size ) ) );
+    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_artist->thumbnail( m_size ) ) );
 }
 
 
@@ -186,7 +191,7 @@ PixmapDelegateFader::trackChanged()
 
     connect( m_track->track().data(), SIGNAL( updated() ), SLOT( trackChanged() ), Qt::UniqueConnection );
     connect( m_track->track().data(), SIGNAL( coverChanged() ), SLOT( trackChanged() ), Qt::UniqueConnection );
-    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_track->track()->cover( m_size ) ) );
+    QMetaObject::invokeMethod( this, "setPixmap", Qt::QueuedConnection, Q_ARG( QPixmap, m_track->track()->thumbnail( m_size ) ) );
 }
 
 
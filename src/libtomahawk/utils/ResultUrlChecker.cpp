@@ -21,12 +21,14 @@
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
+#include <QThread>
 #include <QUrl>
 
 #include "Query.h"
 #include "Result.h"
 #include "Source.h"
 #include "utils/Logger.h"
+#include "utils/HttpClient.h"
 #include "utils/NetworkAccessManager.h"
 
 using namespace Tomahawk;
@@ -36,8 +38,10 @@ ResultUrlChecker::ResultUrlChecker( const query_ptr& query, const QList< result_
     : QObject( 0 )
     , m_query( query )
     , m_results( results )
+    , m_pending( 0 )
 {
-    check();
+    // verdicts may be cached and come back right away, give our owner a chance to connect to done() first
+    QMetaObject::invokeMethod( this, "check", Qt::QueuedConnection );
 }
 
 
@@ -49,6 +53,7 @@ ResultUrlChecker::~ResultUrlChecker()
 void
 ResultUrlChecker::check()
 {
+    QList< QPair< result_ptr, QUrl > > urls;
     foreach ( const result_ptr& result, m_results )
     {
         tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Checking http url:" << result->url();
@@ -56,6 +61,37 @@ ResultUrlChecker::check()
         if ( url.isEmpty() || !url.toString().startsWith( "http" ) )
             continue;
 
+        urls << qMakePair( result, url );
+    }
+
+    m_pending = urls.count();
+    if ( !m_pending )
+    {
+        emit done();
+        return;
+    }
+
+    Tomahawk::Utils::HttpClient* http = Tomahawk::Utils::HttpClient::instance();
+    for ( int i = 0; i < urls.count(); i++ )
+    {
+        const result_ptr result = urls.at( i ).first;
+        const QUrl url = urls.at( i ).second;
+
+        if ( QThread::currentThread() == http->thread() )
+        {
+            http->checkUrl( "ResultUrlChecker", url, this,
+                            std::bind( &ResultUrlChecker::urlChecked, this, result, std::placeholders::_1 ) );
+            continue;
+        }
+
+        // e.g. result hints checked by a database worker, only the verdicts are shared with other threads
+        bool valid;
+        if ( http->cachedUrlVerdict( url, &valid ) )
+        {
+            urlChecked( result, valid );
+            continue;
+        }
+
         NetworkReply* reply = new NetworkReply( Tomahawk::Utils::nam()->head( QNetworkRequest( url ) ) );
         m_replies.insert( reply, result );
         connect( reply, SIGNAL( finished() ), SLOT( headFinished() ) );
@@ -72,17 +108,25 @@ ResultUrlChecker::headFinished()
     if ( !m_replies.contains( r ) )
         return;
 
-    result_ptr result = m_replies.value( r );
-    m_replies.remove( r );
+    const result_ptr result = m_replies.take( r );
+    const bool valid = ( r->reply()->error() == QNetworkReply::NoError );
+    Tomahawk::Utils::HttpClient::instance()->setUrlVerdict( QUrl::fromUserInput( result->url() ), valid );
 
-    if ( r->reply()->error() == QNetworkReply::NoError )
+    urlChecked( result, valid );
+}
+
+
+void
+ResultUrlChecker::urlChecked( const result_ptr& result, bool valid )
+{
+    if ( valid )
     {
         tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Found valid http url:" << result->url();
         m_validResults << result;
     }
     else
-        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Found invalid http url:" << result->url() << r->reply()->error();
+        tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Found invalid http url:" << result->url();
 
-    if ( m_replies.isEmpty() )
+    if ( --m_pending == 0 )
         emit done();
 }
@@ -48,10 +48,13 @@ private slots:
     void headFinished();
 
 private:
+    void urlChecked( const Tomahawk::result_ptr& result, bool valid );
+
     query_ptr m_query;
     QList< result_ptr > m_results;
     QList< result_ptr > m_validResults;
     QHash< NetworkReply*, Tomahawk::result_ptr > m_replies;
+    int m_pending;
 };
 
 }
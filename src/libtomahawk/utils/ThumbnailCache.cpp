@@ -0,0 +1,285 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThumbnailCache.h"
+
+#include "utils/Logger.h"
+#include "TomahawkSettings.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QRunnable>
+#include <QThread>
+
+#define THUMBNAIL_MEMORY_CACHE_SIZE 32 * 1024 // KB
+#define THUMBNAIL_DISK_CACHE_SIZE 100 * 1024 * 1024
+#define THUMBNAIL_MIN_BUCKET 64
+#define THUMBNAIL_MAX_BUCKET 512
+#define THUMBNAIL_JPEG_QUALITY 90
+
+using namespace Tomahawk::Utils;
+
+ThumbnailCache* ThumbnailCache::s_instance = 0;
+
+
+namespace
+{
+
+class ThumbnailJob : public QRunnable
+{
+public:
+    explicit ThumbnailJob( std::function< void() > work ) : m_work( work ) {}
+
+    void run() { m_work(); }
+
+private:
+    std::function< void() > m_work;
+};
+
+
+void
+createAndDeliver( ThumbnailCache* cache, const QString& cacheKey, int job, const QByteArray& image, const QSize& size, const QString& cacheDir )
+{
+    const QImage thumbnail = ThumbnailCache::createThumbnail( image, size, cacheDir );
+    QMetaObject::invokeMethod( cache, "onThumbnailCreated", Qt::QueuedConnection,
+                               Q_ARG( QString, cacheKey ), Q_ARG( int, job ), Q_ARG( QImage, thumbnail ) );
+}
+
+}
+
+
+ThumbnailCache*
+ThumbnailCache::instance()
+{
+    if ( !s_instance )
+        s_instance = new ThumbnailCache( TomahawkSettings::instance()->storageCacheLocation() + "/Thumbnails/" );
+
+    return s_instance;
+}
+
+
+ThumbnailCache::ThumbnailCache( const QString& cacheDir, QObject* parent )
+    : QObject( parent )
+    , m_cacheDir( cacheDir )
+    , m_priority( 0 )
+{
+    if ( !QDir().mkpath( m_cacheDir ) )
+    {
+        tLog() << Q_FUNC_INFO << "Could not create thumbnail cache directory:" << m_cacheDir;
+        m_cacheDir.clear();
+    }
+
+    // leave a core for the GUI thread
+    m_pool.setMaxThreadCount( qMax( 1, QThread::idealThreadCount() - 1 ) );
+    m_pixmaps.setMaxCost( THUMBNAIL_MEMORY_CACHE_SIZE );
+
+    if ( !m_cacheDir.isEmpty() )
+        m_pool.start( new ThumbnailJob( std::bind( &ThumbnailCache::trimDiskCache, m_cacheDir, (qint64)THUMBNAIL_DISK_CACHE_SIZE ) ), m_priority );
+}
+
+
+ThumbnailCache::~ThumbnailCache()
+{
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 2, 0 )
+    m_pool.clear();
+#endif
+    m_pool.waitForDone();
+}
+
+
+QPixmap
+ThumbnailCache::thumbnail( const QString& key, const QByteArray& image, const QSize& size,
+                           QObject* context, Callback callback )
+{
+    if ( image.isEmpty() || size.isEmpty() )
+        return QPixmap();
+
+    const QString ck = cacheKey( key, size );
+    if ( QPixmap* pixmap = m_pixmaps.object( ck ) )
+        return *pixmap;
+
+    Waiter waiter;
+    waiter.context = context;
+    waiter.hasContext = ( context != 0 );
+    waiter.callback = callback;
+
+    QHash< QString, Request >::iterator it = m_pending.find( ck );
+    if ( it != m_pending.end() )
+    {
+        it->waiters << waiter;
+        return QPixmap();
+    }
+
+    // the latest requests are the ones on screen, they go first
+    Request request;
+    request.job = ++m_priority;
+    request.waiters << waiter;
+    m_pending.insert( ck, request );
+
+    m_pool.start( new ThumbnailJob( std::bind( &createAndDeliver, this, ck, request.job, image, size, m_cacheDir ) ), request.job );
+    return QPixmap();
+}
+
+
+void
+ThumbnailCache::invalidate( const QString& key )
+{
+    const QString prefix = key + '@';
+
+    foreach ( const QString& ck, m_pixmaps.keys() )
+    {
+        if ( ck.startsWith( prefix ) )
+            m_pixmaps.remove( ck );
+    }
+
+    // results of jobs already running get dropped, see onThumbnailCreated()
+    foreach ( const QString& ck, m_pending.keys() )
+    {
+        if ( ck.startsWith( prefix ) )
+            m_pending.remove( ck );
+    }
+}
+
+
+int
+ThumbnailCache::bucket( int edge )
+{
+    if ( edge > THUMBNAIL_MAX_BUCKET )
+        return 0;
+
+    int bucket = THUMBNAIL_MIN_BUCKET;
+    while ( bucket < edge )
+        bucket *= 2;
+
+    return bucket;
+}
+
+
+QImage
+ThumbnailCache::createThumbnail( const QByteArray& image, const QSize& size, const QString& cacheDir )
+{
+    const int edge = bucket( qMax( size.width(), size.height() ) );
+
+    // named after the content, replaced images never hit stale thumbnails
+    QString path;
+    if ( edge && !cacheDir.isEmpty() )
+    {
+        const QByteArray hash = QCryptographicHash::hash( image, QCryptographicHash::Md5 ).toHex();
+        path = QDir( cacheDir ).absoluteFilePath( QString( "%1_%2" ).arg( QString::fromLatin1( hash ) ).arg( edge ) );
+    }
+
+    QImage thumbnail;
+    if ( path.isEmpty() || !thumbnail.load( path ) )
+    {
+        QImage source;
+        if ( !source.loadFromData( image ) )
+            return QImage();
+
+        // same crop as TomahawkUtils::squareCenterPixmap
+        const int sqwidth = qMin( source.width(), source.height() );
+        if ( source.width() != source.height() )
+            source = source.copy( ( source.width() - sqwidth ) / 2, ( source.height() - sqwidth ) / 2, sqwidth, sqwidth );
+
+        if ( !edge )
+            return source.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+
+        // small images are stored as they are
+        thumbnail = sqwidth > edge ? source.scaled( edge, edge, Qt::IgnoreAspectRatio, Qt::SmoothTransformation ) : source;
+
+        if ( !path.isEmpty() )
+        {
+            static const bool jpegSupported = QImageWriter::supportedImageFormats().contains( "jpg" );
+            const bool jpeg = jpegSupported && !thumbnail.hasAlphaChannel();
+
+            // another job may be reading or writing the same file
+            const QString part = QString( "%1.%2.part" ).arg( path ).arg( (quintptr)QThread::currentThreadId() );
+            if ( !thumbnail.save( part, jpeg ? "JPG" : "PNG", jpeg ? THUMBNAIL_JPEG_QUALITY : -1 ) ||
+                 !QFile::rename( part, path ) )
+            {
+                QFile::remove( part );
+            }
+        }
+    }
+
+    if ( thumbnail.size() == size )
+        return thumbnail;
+
+    return thumbnail.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+}
+
+
+void
+ThumbnailCache::onThumbnailCreated( const QString& cacheKey, int job, const QImage& image )
+{
+    QHash< QString, Request >::iterator it = m_pending.find( cacheKey );
+    if ( it == m_pending.end() || it->job != job )
+        return;
+
+    const QList< Waiter > waiters = it->waiters;
+    m_pending.erase( it );
+
+    // failures are remembered as well, so they aren't retried on every paint
+    QPixmap* pixmap = new QPixmap( QPixmap::fromImage( image ) );
+    m_pixmaps.insert( cacheKey, pixmap, qMax( 1, pixmap->width() * pixmap->height() * pixmap->depth() / 8 / 1024 ) );
+
+    if ( image.isNull() )
+        return;
+
+    foreach ( const Waiter& waiter, waiters )
+    {
+        if ( waiter.hasContext && !waiter.context )
+            continue;
+
+        waiter.callback();
+    }
+}
+
+
+QString
+ThumbnailCache::cacheKey( const QString& key, const QSize& size )
+{
+    return QString( "%1@%2x%3" ).arg( key ).arg( size.width() ).arg( size.height() );
+}
+
+
+void
+ThumbnailCache::trimDiskCache( const QString& cacheDir, qint64 maxSize )
+{
+    // oldest first
+    const QFileInfoList files = QDir( cacheDir ).entryInfoList( QDir::Files, QDir::Time | QDir::Reversed );
+
+    qint64 total = 0;
+    foreach ( const QFileInfo& fi, files )
+        total += fi.size();
+
+    if ( total <= maxSize )
+        return;
+
+    tDebug() << Q_FUNC_INFO << "Thumbnail cache is" << total / 1024 << "KB, trimming it";
+    foreach ( const QFileInfo& fi, files )
+    {
+        if ( total <= maxSize * 9 / 10 )
+            break;
+
+        if ( QFile::remove( fi.absoluteFilePath() ) )
+            total -= fi.size();
+    }
+}
@@ -0,0 +1,119 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef TOMAHAWK_UTILS_THUMBNAILCACHE_H
+#define TOMAHAWK_UTILS_THUMBNAILCACHE_H
+
+#include "DllMacro.h"
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QThreadPool>
+
+#include <functional>
+
+namespace Tomahawk
+{
+namespace Utils
+{
+
+/**
+ * Square thumbnails of album and artist art, for views showing lots of them.
+ *
+ * Images are decoded and scaled on a thread pool, never in the paint path.
+ * Each image is first scaled to a size bucket (the next power of two) and
+ * kept on disk in that size, named after a hash of the image data, so the
+ * full size image only has to be decoded once. Scaled pixmaps are kept in
+ * a bounded memory cache. Only use it from the main thread.
+ */
+class DLLEXPORT ThumbnailCache : public QObject
+{
+Q_OBJECT
+
+public:
+    typedef std::function< void() > Callback;
+
+    static ThumbnailCache* instance();
+
+    explicit ThumbnailCache( const QString& cacheDir, QObject* parent = 0 );
+    virtual ~ThumbnailCache();
+
+    /**
+     * The image cropped to a square and scaled to size, if it's ready.
+     *
+     * Otherwise a null pixmap is returned and the thumbnail gets created
+     * in the background. The callback is invoked once it's ready unless the
+     * context object got deleted in the meantime. Images that can't be
+     * decoded stay null and don't invoke the callback.
+     *
+     * @param key identifies the image in memory, e.g. the owner's infoid
+     */
+    QPixmap thumbnail( const QString& key, const QByteArray& image, const QSize& size,
+                       QObject* context, Callback callback );
+
+    /// Drop all thumbnails of key from memory, e.g. when its image got replaced.
+    void invalidate( const QString& key );
+
+    /// Memory for scaled pixmaps, in KB.
+    void setMaximumMemory( int kb ) { m_pixmaps.setMaxCost( kb ); }
+
+    /// Edge length of the size bucket an image of edge pixels is stored in on disk, 0 if it's too big for one.
+    static int bucket( int edge );
+
+    /// Does the actual work, safe to call from any thread. An empty cacheDir skips the disk cache.
+    static QImage createThumbnail( const QByteArray& image, const QSize& size, const QString& cacheDir );
+
+private slots:
+    void onThumbnailCreated( const QString& cacheKey, int job, const QImage& image );
+
+private:
+    struct Waiter
+    {
+        QPointer< QObject > context;
+        bool hasContext;
+        Callback callback;
+    };
+
+    struct Request
+    {
+        int job;
+        QList< Waiter > waiters;
+    };
+
+    static QString cacheKey( const QString& key, const QSize& size );
+    static void trimDiskCache( const QString& cacheDir, qint64 maxSize );
+
+    QString m_cacheDir;
+    QThreadPool m_pool;
+    int m_priority;
+
+    QCache< QString, QPixmap > m_pixmaps; // by cache key, cost in KB
+    QHash< QString, Request > m_pending; // by cache key
+
+    static ThumbnailCache* s_instance;
+};
+
+}
+}
+
+#endif // TOMAHAWK_UTILS_THUMBNAILCACHE_H
@@ -59,8 +59,13 @@
 #include <QMutex>
 #include <QCryptographicHash>
 #include <QProcess>
+#include <QRegExp>
 #include <QStringList>
 #include <QTranslator>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <string.h>
 
 // Qt version specific includes
 #if QT_VERSION >= QT_VERSION_CHECK( 5, 0, 0 )
@@ -77,6 +82,10 @@
     #include <sys/sysctl.h>
 #endif
 
+#ifndef Q_OS_WIN
+    #include <sys/resource.h>
+#endif
+
 #ifdef QCA2_FOUND
     #include <QtCrypto>
 #endif
@@ -331,30 +340,64 @@ filesizeToString( unsigned int size )
 }
 
 
+static QStringList
+createSupportedExtensions()
+{
+    QStringList extensions;
+    extensions << "mp3"
+               << "ogg" << "oga"
+               << "mpc"
+               << "wma"
+               << "aac" << "m4a" << "mp4"
+               << "flac"
+               << "aiff" << "aif"
+               << "wv";
+
+    #if defined(TAGLIB_MAJOR_VERSION) && defined(TAGLIB_MINOR_VERSION)
+    #if TAGLIB_MAJOR_VERSION >= 1 && TAGLIB_MINOR_VERSION >= 9
+        extensions << "opus";
+    #endif
+    #endif
+
+    return extensions;
+}
+
+
+static QMap< QString, QString >
+createExtensionToMimetype()
+{
+    QMap< QString, QString > ext2mime;
+    ext2mime.insert( "mp3",  "audio/mpeg" );
+    ext2mime.insert( "ogg",  "application/ogg" );
+    ext2mime.insert( "oga",  "application/ogg" );
+#if defined(TAGLIB_MAJOR_VERSION) && defined(TAGLIB_MINOR_VERSION)
+#if TAGLIB_MAJOR_VERSION >= 1 && TAGLIB_MINOR_VERSION >= 9
+    ext2mime.insert( "opus",  "application/opus" );
+#endif
+#endif
+    ext2mime.insert( "mpc",  "audio/x-musepack" );
+    ext2mime.insert( "wma",  "audio/x-ms-wma" );
+    ext2mime.insert( "aac",  "audio/mp4" );
+    ext2mime.insert( "m4a",  "audio/mp4" );
+    ext2mime.insert( "mp4",  "audio/mp4" );
+    ext2mime.insert( "flac", "audio/flac" );
+    ext2mime.insert( "aiff", "audio/aiff" );
+    ext2mime.insert( "aif",  "audio/aiff" );
+    ext2mime.insert( "wv",   "audio/x-wavpack" );
+
+    return ext2mime;
+}
+
+
 QStringList
 supportedExtensions()
 {
     //TODO supportedExtensions() and extensionToMimetype could share a QMap
     //TODO and this method should just return map.keys()
-    static QStringList s_extensions;
-    if ( s_extensions.isEmpty() )
-    {
-        s_extensions << "mp3"
-                     << "ogg" << "oga"
-                     << "mpc"
-                     << "wma"
-                     << "aac" << "m4a" << "mp4"
-                     << "flac"
-                     << "aiff" << "aif"
-                     << "wv";
-
-        #if defined(TAGLIB_MAJOR_VERSION) && defined(TAGLIB_MINOR_VERSION)
-        #if TAGLIB_MAJOR_VERSION >= 1 && TAGLIB_MINOR_VERSION >= 9
-            s_extensions << "opus";
-        #endif
-        #endif
-    }
 
+    // built once, the initialization of a local static is thread-safe.
+    // The music scanner's tag readers call this in parallel.
+    static const QStringList s_extensions = createSupportedExtensions();
     return s_extensions;
 }
 
@@ -362,28 +405,7 @@ supportedExtensions()
 QString
 extensionToMimetype( const QString& extension )
 {
-    static QMap<QString, QString> s_ext2mime;
-    if ( s_ext2mime.isEmpty() )
-    {
-        s_ext2mime.insert( "mp3",  "audio/mpeg" );
-        s_ext2mime.insert( "ogg",  "application/ogg" );
-        s_ext2mime.insert( "oga",  "application/ogg" );
-#if defined(TAGLIB_MAJOR_VERSION) && defined(TAGLIB_MINOR_VERSION)
-#if TAGLIB_MAJOR_VERSION >= 1 && TAGLIB_MINOR_VERSION >= 9
-        s_ext2mime.insert( "opus",  "application/opus" );
-#endif
-#endif
-        s_ext2mime.insert( "mpc",  "audio/x-musepack" );
-        s_ext2mime.insert( "wma",  "audio/x-ms-wma" );
-        s_ext2mime.insert( "aac",  "audio/mp4" );
-        s_ext2mime.insert( "m4a",  "audio/mp4" );
-        s_ext2mime.insert( "mp4",  "audio/mp4" );
-        s_ext2mime.insert( "flac", "audio/flac" );
-        s_ext2mime.insert( "aiff", "audio/aiff" );
-        s_ext2mime.insert( "aif",  "audio/aiff" );
-        s_ext2mime.insert( "wv",   "audio/x-wavpack" );
-    }
-
+    static const QMap< QString, QString > s_ext2mime = createExtensionToMimetype();
     return s_ext2mime.value( extension.toLower(), "unknown" );
 }
 
@@ -399,83 +421,225 @@ msleep( unsigned int ms )
 }
 
 
-int
-levenshtein( const QString& source, const QString& target )
+qint64
+peakMemoryUsage()
 {
-    // Step 1
-    const int n = source.length();
-    const int m = target.length();
+#ifdef Q_OS_WIN
+    return -1;
+#else
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return -1;
+
+  #ifdef Q_OS_MAC
+    return usage.ru_maxrss; // bytes
+  #else
+    return (qint64)usage.ru_maxrss * 1024; // kilobytes
+  #endif
+#endif
+}
 
-    if ( n == 0 )
-        return m;
-    if ( m == 0 )
-        return n;
 
-    // Good form to declare a TYPEDEF
-    typedef QVector< QVector<int> > Tmatrix;
-    Tmatrix matrix;
-    matrix.resize( n + 1 );
+namespace {
 
-    // Size the vectors in the 2.nd dimension. Unfortunately C++ doesn't
-    // allow for allocation on declaration of 2.nd dimension of vec of vec
-    for ( int i = 0; i <= n; i++ )
-    {
-        QVector<int> tmp;
-        tmp.resize( m + 1 );
-        matrix.insert( i, tmp );
-    }
+// Rows of the scalar fallback. Most names are short, so they stay on the stack.
+typedef QVarLengthArray< int, 256 > LevenshteinRow;
+
+
+int
+levenshteinRows( const ushort* s, int n, const ushort* t, int m, int maxDistance )
+{
+    // three rolling rows, i - 2 is needed for transpositions
+    LevenshteinRow buffer( 3 * ( m + 1 ) );
+    int* prev2 = buffer.data();
+    int* prev = prev2 + m + 1;
+    int* cur = prev + m + 1;
 
-    // Step 2
-    for ( int i = 0; i <= n; i++ )
-        matrix[i][0] = i;
     for ( int j = 0; j <= m; j++ )
-        matrix[0][j] = j;
+        prev[ j ] = j;
 
-    // Step 3
+    int prevMin = 0;
     for ( int i = 1; i <= n; i++ )
     {
-        const QChar s_i = source[i - 1];
+        const ushort s_i = s[ i - 1 ];
+        int rowMin = i;
+        cur[ 0 ] = i;
 
-        // Step 4
         for ( int j = 1; j <= m; j++ )
         {
-            const QChar t_j = target[j - 1];
+            const ushort t_j = t[ j - 1 ];
+
+            int cell = prev[ j - 1 ] + ( s_i == t_j ? 0 : 1 );
+            if ( cur[ j - 1 ] + 1 < cell )
+                cell = cur[ j - 1 ] + 1;
+            if ( prev[ j ] + 1 < cell )
+                cell = prev[ j ] + 1;
+
+            // Transposition of two adjacent characters. Like the original
+            // matrix implementation (Berghel & Roach) we do not consider it
+            // within the first two rows or columns.
+            if ( i > 2 && j > 2 && s[ i - 2 ] == t_j && s_i == t[ j - 2 ] && prev2[ j - 2 ] + 1 < cell )
+                cell = prev2[ j - 2 ] + 1;
+
+            cur[ j ] = cell;
+            if ( cell < rowMin )
+                rowMin = cell;
+        }
 
-            // Step 5
-            int cost;
-            if ( s_i == t_j )
-                cost = 0;
-            else
-                cost = 1;
-
-            // Step 6
-            const int above = matrix[i - 1][j];
-            const int left = matrix[i][j - 1];
-            const int diag = matrix[i - 1][j - 1];
-
-            int cell = ( ( ( left + 1 ) > ( diag + cost ) ) ? diag + cost : left + 1 );
-            if ( above + 1 < cell )
-                cell = above + 1;
-
-            // Step 6A: Cover transposition, in addition to deletion,
-            // insertion and substitution. This step is taken from:
-            // Berghel, Hal ; Roach, David : "An Extension of Ukkonen's
-            // Enhanced Dynamic Programming ASM Algorithm"
-            // (http://www.acm.org/~hlb/publications/asm/asm.html)
-            if ( i > 2 && j > 2 )
-            {
-                int trans = matrix[i - 2][j - 2] + 1;
+        // every path to the last cell crosses one of the last two rows
+        if ( maxDistance >= 0 && rowMin > maxDistance && prevMin > maxDistance )
+            return maxDistance + 1;
 
-                if ( source[ i - 2 ] != t_j ) trans++;
-                if ( s_i != target[ j - 2 ] ) trans++;
-                if ( cell > trans ) cell = trans;
-            }
-            matrix[i][j] = cell;
-        }
+        prevMin = rowMin;
+        int* tmp = prev2;
+        prev2 = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+    if ( maxDistance >= 0 && prev[ m ] > maxDistance )
+        return maxDistance + 1;
+
+    return prev[ m ];
+}
+
+
+/**
+ * Bit-parallel distance (Myers, with Hyyrö's extension for transpositions),
+ * processing a whole column of up to 64 rows per step. peq holds a bit mask
+ * of the positions of every Latin-1 character in the source string.
+ */
+int
+levenshteinBitParallel( const quint64* peq, int n, const ushort* t, int m, int maxDistance )
+{
+    const quint64 lastRow = Q_UINT64_C( 1 ) << ( n - 1 );
+    // no transpositions within the first two rows, see levenshteinRows()
+    const quint64 transMask = ~Q_UINT64_C( 3 );
+
+    quint64 vp = ~Q_UINT64_C( 0 );
+    quint64 vn = 0;
+    quint64 d0 = 0;
+    quint64 pmPrev = 0;
+    int score = n;
+
+    for ( int j = 0; j < m; j++ )
+    {
+        const quint64 pm = t[ j ] < 256 ? peq[ t[ j ] ] : 0;
+
+        quint64 tr = 0;
+        if ( j >= 2 )
+            tr = ( ( ( ~d0 ) & pm ) << 1 ) & pmPrev & transMask;
+
+        d0 = ( ( ( pm & vp ) + vp ) ^ vp ) | pm | vn | tr;
+        quint64 hp = vn | ~( d0 | vp );
+        const quint64 hn = vp & d0;
+
+        if ( hp & lastRow )
+            score++;
+        else if ( hn & lastRow )
+            score--;
+
+        hp = ( hp << 1 ) | 1;
+        vn = hp & d0;
+        vp = ( hn << 1 ) | ~( hp | d0 );
+        pmPrev = pm;
+
+        // the score can drop by at most one per remaining column
+        if ( maxDistance >= 0 && score - ( m - 1 - j ) > maxDistance )
+            return maxDistance + 1;
     }
 
-    // Step 7
-    return matrix[n][m];
+    if ( maxDistance >= 0 && score > maxDistance )
+        return maxDistance + 1;
+
+    return score;
+}
+
+
+/**
+ * Fills peq for levenshteinBitParallel(). Only strings of up to 64 Latin-1
+ * characters fit, returns false for anything else.
+ */
+bool
+levenshteinPattern( const QString& source, quint64* peq )
+{
+    const int n = source.length();
+    if ( n > 64 )
+        return false;
+
+    const ushort* s = source.utf16();
+    for ( int i = 0; i < n; i++ )
+    {
+        if ( s[ i ] >= 256 )
+            return false;
+    }
+
+    memset( peq, 0, 256 * sizeof( quint64 ) );
+    for ( int i = 0; i < n; i++ )
+        peq[ s[ i ] ] |= Q_UINT64_C( 1 ) << i;
+
+    return true;
+}
+
+
+int
+levenshteinTrivial( int n, int m, int maxDistance )
+{
+    const int distance = qMax( n, m );
+    if ( maxDistance >= 0 && distance > maxDistance )
+        return maxDistance + 1;
+
+    return distance;
+}
+
+}
+
+
+int
+levenshtein( const QString& source, const QString& target, int maxDistance )
+{
+    const int n = source.length();
+    const int m = target.length();
+
+    if ( n == 0 || m == 0 )
+        return levenshteinTrivial( n, m, maxDistance );
+    if ( maxDistance >= 0 && qAbs( n - m ) > maxDistance )
+        return maxDistance + 1;
+
+    // the distance is symmetric, so either string can be the bit pattern
+    quint64 peq[ 256 ];
+    if ( levenshteinPattern( source, peq ) )
+        return levenshteinBitParallel( peq, n, target.utf16(), m, maxDistance );
+    if ( levenshteinPattern( target, peq ) )
+        return levenshteinBitParallel( peq, m, source.utf16(), n, maxDistance );
+
+    return levenshteinRows( source.utf16(), n, target.utf16(), m, maxDistance );
+}
+
+
+QVector< int >
+levenshtein( const QString& source, const QStringList& targets, int maxDistance )
+{
+    QVector< int > distances( targets.count() );
+
+    quint64 peq[ 256 ];
+    const int n = source.length();
+    const bool bitParallel = n > 0 && levenshteinPattern( source, peq );
+
+    for ( int i = 0; i < targets.count(); i++ )
+    {
+        const QString& target = targets.at( i );
+        const int m = target.length();
+
+        if ( !bitParallel || m == 0 )
+            distances[ i ] = levenshtein( source, target, maxDistance );
+        else if ( maxDistance >= 0 && qAbs( n - m ) > maxDistance )
+            distances[ i ] = maxDistance + 1;
+        else
+            distances[ i ] = levenshteinBitParallel( peq, n, target.utf16(), m, maxDistance );
+    }
+
+    return distances;
 }
 
 
@@ -1007,6 +1171,34 @@ percentEncode( const QUrl& url )
 }
 
 
+bool
+parseRange( const QString& header, qint64 size, qint64& start, qint64& end )
+{
+    // a single range, for anything else (e.g. multiple ranges) we serve the whole stream
+    QRegExp rx( "^\\s*bytes\\s*=\\s*(\\d*)\\s*-\\s*(\\d*)\\s*$" );
+    if ( rx.indexIn( header ) < 0 || ( rx.cap( 1 ).isEmpty() && rx.cap( 2 ).isEmpty() ) )
+        return false;
+
+    if ( rx.cap( 1 ).isEmpty() )
+    {
+        // the last n bytes
+        const qint64 suffix = rx.cap( 2 ).toLongLong();
+        start = suffix > 0 ? qMax( Q_INT64_C( 0 ), size - suffix ) : size;
+        end = size - 1;
+        return true;
+    }
+
+    // leave start and end alone when ignoring the header, the caller serves them as they are
+    const qint64 first = rx.cap( 1 ).toLongLong();
+    if ( !rx.cap( 2 ).isEmpty() && rx.cap( 2 ).toLongLong() < first )
+        return false;
+
+    start = first;
+    end = rx.cap( 2 ).isEmpty() ? size - 1 : qMin( rx.cap( 2 ).toLongLong(), size - 1 );
+    return true;
+}
+
+
 QByteArray
 encodedQuery( const QUrl& url )
 {
@@ -27,6 +27,7 @@
 #include <QtCore/QThread>
 #include <QtNetwork/QNetworkProxy>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <Typedefs.h>
 
 #define RESPATH ":/data/"
@@ -156,12 +157,31 @@ namespace TomahawkUtils
     DLLEXPORT QString filesizeToString( unsigned int size );
     DLLEXPORT QByteArray percentEncode( const QUrl& url );
 
+    /**
+     * Parses a "bytes=first-last" HTTP Range header. Returns false if there's
+     * no single range in it, start is beyond size if it can't be satisfied.
+     */
+    DLLEXPORT bool parseRange( const QString& header, qint64 size, qint64& start, qint64& end );
+
     DLLEXPORT QStringList supportedExtensions();
     DLLEXPORT QString extensionToMimetype( const QString& extension );
 
     DLLEXPORT void msleep( unsigned int ms );
+    /// Peak resident set size of this process in bytes, -1 if unknown.
+    DLLEXPORT qint64 peakMemoryUsage();
     DLLEXPORT bool newerVersion( const QString& oldVersion, const QString& newVersion );
-    DLLEXPORT int levenshtein( const QString& source, const QString& target );
+
+    /**
+     * Edit distance between two strings, counting insertions, deletions,
+     * substitutions and transpositions of adjacent characters.
+     *
+     * If maxDistance is not negative, any distance above it is reported
+     * as maxDistance + 1, which allows bailing out early.
+     */
+    DLLEXPORT int levenshtein( const QString& source, const QString& target, int maxDistance = -1 );
+    /// Distances between one string and many others, sharing the setup for source
+    DLLEXPORT QVector< int > levenshtein( const QString& source, const QStringList& targets, int maxDistance = -1 );
+
 
     DLLEXPORT quint64 infosystemRequestId();
 
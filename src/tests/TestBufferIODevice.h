@@ -0,0 +1,91 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTBUFFERIODEVICE_H
+#define TOMAHAWK_TESTBUFFERIODEVICE_H
+
+#include <QtTest>
+
+#include "libtomahawk/network/BufferIoDevice.h"
+
+class TestBufferIODevice : public QObject
+{
+    Q_OBJECT
+private:
+    QByteArray blockData( int block, int size )
+    {
+        QByteArray data( size, Qt::Uninitialized );
+        for ( int i = 0; i < size; i++ )
+            data[ i ] = char( block * 7 + i );
+
+        return data;
+    }
+
+private slots:
+    void testBlocks()
+    {
+        const int blockSize = BufferIODevice::defaultBlockSize();
+        BufferIODevice dev( blockSize * 3 + 100 );
+        dev.open( QIODevice::ReadOnly );
+        QCOMPARE( dev.maxBlocks(), 4 );
+        QCOMPARE( dev.nextEmptyBlock(), 0 );
+
+        dev.addData( 1, blockData( 1, blockSize ) );
+        dev.addData( 3, blockData( 3, 100 ) );
+        QVERIFY( dev.isBlockEmpty( 0 ) );
+        QVERIFY( !dev.isBlockEmpty( 1 ) );
+        QCOMPARE( dev.nextEmptyBlock(), 0 );
+
+        dev.addData( 0, blockData( 0, blockSize ) );
+        QCOMPARE( dev.nextEmptyBlock(), 2 );
+
+        // reads across blocks, starting in the middle of one
+        QVERIFY( dev.seek( blockSize - 10 ) );
+        const QByteArray read = dev.read( 20 );
+        QCOMPARE( read, blockData( 0, blockSize ).right( 10 ) + blockData( 1, blockSize ).left( 10 ) );
+
+        // stops at the gap
+        QCOMPARE( dev.read( blockSize * 2 ).count(), blockSize - 10 );
+
+        dev.addData( 2, blockData( 2, blockSize ) );
+        QCOMPARE( dev.nextEmptyBlock(), -1 );
+    }
+
+    void testSpillover()
+    {
+        const int blockSize = BufferIODevice::defaultBlockSize();
+        const int blocks = 2048; // 8MB
+        BufferIODevice dev( blockSize * blocks );
+        dev.open( QIODevice::ReadOnly );
+
+        // odd blocks first, as they'd arrive after a seek
+        for ( int i = 1; i < blocks; i += 2 )
+            dev.addData( i, blockData( i, blockSize ) );
+        for ( int i = 0; i < blocks; i += 2 )
+            dev.addData( i, blockData( i, blockSize ) );
+
+        QCOMPARE( dev.nextEmptyBlock(), -1 );
+        QVERIFY( dev.memoryUsage() <= 2 * 1024 * 1024 );
+
+        for ( int i = 0; i < blocks; i++ )
+            QCOMPARE( dev.read( blockSize ), blockData( i, blockSize ) );
+        QVERIFY( dev.atEnd() );
+    }
+};
+
+#endif // TOMAHAWK_TESTBUFFERIODEVICE_H
@@ -22,7 +22,22 @@
 #include <QtTest>
 
 #include "database/Database.h"
+#include "database/DatabaseCommand_AddFiles.h"
+#include "database/DatabaseCommand_CompactPlaylistRevisions.h"
+#include "database/DatabaseCommand_LoadPlaylistEntries.h"
 #include "database/DatabaseCommand_LogPlayback.h"
+#include "database/DatabaseCommand_Resolve.h"
+#include "database/DatabaseCommand_SetPlaylistRevision.h"
+#include "database/DatabaseCommand_UpdateSearchIndex.h"
+#include "database/DatabaseIdCache.h"
+#include "database/DatabaseImpl.h"
+#include "database/DatabaseStatistics.h"
+#include "database/PlaylistRevisionStore.h"
+#include "database/LocalCollection.h"
+#include "database/fuzzyindex/FuzzyIndex.h"
+#include "utils/Json.h"
+#include "Source.h"
+#include "SourceList.h"
 
 
 class TestDatabaseCommand : public Tomahawk::DatabaseCommand
@@ -31,12 +46,149 @@ Q_OBJECT
     virtual QString commandname() const { return "TestCommand"; }
 };
 
+class TestLoadPlaylistEntries : public Tomahawk::DatabaseCommand_LoadPlaylistEntries
+{
+public:
+    explicit TestLoadPlaylistEntries( const QString& revision ) : Tomahawk::DatabaseCommand_LoadPlaylistEntries( revision ) {}
+
+    QStringList guids() const { return m_guids; }
+    QStringList oldEntries() const { return m_oldentries; }
+    int entryCount() const { return m_entrymap.count(); }
+};
+
 class TestDatabase : public QObject
 {
     Q_OBJECT
 private:
     Tomahawk::Database* db;
 
+    // Fills the local collection with the tracks benchmarkResolve looks for and indexes them
+    void populateResolveData()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        TomahawkSqlQuery query = impl->newquery();
+        query.exec( "SELECT COUNT(*) FROM file" );
+        if ( query.next() && query.value( 0 ).toInt() > 0 )
+            return;
+
+        Tomahawk::source_ptr src( new Tomahawk::Source( 0, impl->dbid() ) );
+        Tomahawk::collection_ptr coll( new Tomahawk::LocalCollection( src ) );
+        coll->setWeakRef( coll.toWeakRef() );
+        src->addCollection( coll );
+        SourceList::instance()->setLocal( src );
+
+        QList< Tomahawk::ScannedFile > files;
+        for ( int i = 0; i < 1000; i++ )
+        {
+            Tomahawk::ScannedFile file;
+            file.url = QString( "file:///music/%1.mp3" ).arg( i );
+            file.mtime = 1;
+            file.size = 1000;
+            file.mimetype = "audio/mpeg";
+            file.duration = 180;
+            file.bitrate = 192;
+            file.artist = QString( "Artist %1" ).arg( i / 10 );
+            file.album = QString( "Album %1" ).arg( i / 100 );
+            file.track = QString( "Track %1" ).arg( i );
+            file.albumpos = i % 10 + 1;
+            files << file;
+        }
+
+        Tomahawk::DatabaseCommand_AddFiles addFiles( files, src );
+        impl->database().transaction();
+        addFiles._exec( impl );
+        impl->database().commit();
+
+        Tomahawk::DatabaseCommand_UpdateSearchIndex updateIndex;
+        updateIndex._exec( impl );
+    }
+
+    // Stores a playlist with count revisions like SetPlaylistRevision does, each one adding an entry
+    // and every other one dropping another. entries gets the expected guids of every revision.
+    bool createPlaylist( int count, QString& playlist, QStringList& revisions, QList< QStringList >& entries )
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+        playlist = uuid();
+
+        impl->database().transaction();
+
+        TomahawkSqlQuery query = impl->newquery();
+        query.prepare( "INSERT INTO playlist( guid, title ) VALUES( ?, ? )" );
+        query.addBindValue( playlist );
+        query.addBindValue( "Revisions" );
+        query.exec();
+
+        TomahawkSqlQuery addItem = impl->newquery();
+        addItem.prepare( "INSERT INTO playlist_item( guid, playlist, trackname, artistname ) VALUES( ?, ?, ?, ? )" );
+        TomahawkSqlQuery addRevision = impl->newquery();
+        addRevision.prepare( "INSERT INTO playlist_revision( guid, playlist, entries, previous_revision ) VALUES( ?, ?, ?, ? )" );
+
+        QStringList current;
+        for ( int i = 0; i < count; i++ )
+        {
+            // the first revision starts out with 100 entries
+            const int added = i ? 1 : 100;
+            for ( int j = 0; j < added; j++ )
+            {
+                const QString guid = uuid();
+                addItem.bindValue( 0, guid );
+                addItem.bindValue( 1, playlist );
+                addItem.bindValue( 2, QString( "Track %1-%2" ).arg( i ).arg( j ) );
+                addItem.bindValue( 3, "Artist" );
+                addItem.exec();
+
+                current.insert( ( i * 7 + j ) % ( current.count() + 1 ), guid );
+            }
+            if ( i % 2 )
+                current.removeAt( ( i * 13 ) % current.count() );
+
+            const QString revision = uuid();
+            const QString previous = revisions.isEmpty() ? QString() : revisions.last();
+
+            addRevision.bindValue( 0, revision );
+            addRevision.bindValue( 1, playlist );
+            addRevision.bindValue( 2, impl->playlistRevisions()->encode( impl, revision, previous, current ) );
+            addRevision.bindValue( 3, previous.isEmpty() ? QVariant( QVariant::String ) : previous );
+            addRevision.exec();
+
+            revisions << revision;
+            entries << current;
+        }
+
+        query.prepare( "UPDATE playlist SET currentrevision = ? WHERE guid = ?" );
+        query.addBindValue( revisions.last() );
+        query.addBindValue( playlist );
+        query.exec();
+
+        return impl->database().commit();
+    }
+
+    bool compactPlaylists()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        impl->database().transaction();
+        Tomahawk::DatabaseCommand_CompactPlaylistRevisions compact;
+        compact._exec( impl );
+
+        return impl->database().commit();
+    }
+
+    QVariant storedEntries( const QString& revision, QString* previous = 0 )
+    {
+        TomahawkSqlQuery query = db->impl()->newquery();
+        query.prepare( "SELECT entries, previous_revision FROM playlist_revision WHERE guid = ?" );
+        query.addBindValue( revision );
+        if ( !query.exec() || !query.next() )
+            return QVariant();
+
+        if ( previous )
+            *previous = query.value( 1 ).toString();
+
+        return TomahawkUtils::parseJson( query.value( 0 ).toByteArray() );
+    }
+
 private slots:
     void initTestCase()
     {
@@ -73,6 +225,306 @@ private slots:
         TestDatabaseCommand* tCmd = qobject_cast< TestDatabaseCommand* >( command.data() );
         QVERIFY( tCmd );
     }
+
+    void testStatistics()
+    {
+        QCOMPARE( Tomahawk::DatabaseCommandStatistics::bucket( 0 ), 0 );
+        QCOMPARE( Tomahawk::DatabaseCommandStatistics::bucket( 1 ), 1 );
+        QCOMPARE( Tomahawk::DatabaseCommandStatistics::bucket( 1000 ), 10 );
+        QCOMPARE( Tomahawk::DatabaseCommandStatistics::bucket( Q_INT64_C( 1 ) << 40 ),
+                  (int)Tomahawk::DatabaseCommandStatistics::BucketCount - 1 );
+
+        Tomahawk::DatabaseStatistics stats;
+        for ( int i = 0; i < 99; i++ )
+            stats.record( "resolve", 10, 100 );
+        stats.record( "resolve", 5000, 100000 );
+        stats.record( "alltracks", 0, 1000000 );
+
+        const Tomahawk::DatabaseCommandStatistics resolve = stats.statistics( "resolve" );
+        QCOMPARE( resolve.count(), Q_UINT64_C( 100 ) );
+        QCOMPARE( resolve.maxExecTime(), Q_INT64_C( 100000 ) );
+        QCOMPARE( resolve.execTimeQuantile( 0.5 ), Q_INT64_C( 128 ) );
+        QCOMPARE( resolve.execTimeQuantile( 1.0 ), Q_INT64_C( 131072 ) );
+        QCOMPARE( resolve.queueTimeQuantile( 0.99 ), Q_INT64_C( 16 ) );
+
+        QCOMPARE( stats.snapshot().count(), 2 );
+        stats.reset();
+        QCOMPARE( stats.statistics( "resolve" ).count(), Q_UINT64_C( 0 ) );
+    }
+
+    void testIdCache()
+    {
+        Tomahawk::DatabaseIdCache cache( 2, 10, 10 );
+
+        QCOMPARE( cache.id( Tomahawk::DatabaseIdCache::Artist, 0, "Bloc Party" ), 0 );
+        cache.insert( Tomahawk::DatabaseIdCache::Artist, 0, "Bloc Party", 1 );
+        cache.insert( Tomahawk::DatabaseIdCache::Artist, 0, "Mogwai", 2 );
+        cache.insert( Tomahawk::DatabaseIdCache::Album, 1, "Silent Alarm", 5 );
+        cache.insert( Tomahawk::DatabaseIdCache::Track, 1, "Helicopter", 7 );
+        cache.insert( Tomahawk::DatabaseIdCache::Track, 2, "Helicopter", 8 );
+
+        QCOMPARE( cache.id( Tomahawk::DatabaseIdCache::Artist, 0, "Bloc Party" ), 1 );
+        QCOMPARE( cache.id( Tomahawk::DatabaseIdCache::Track, 2, "Helicopter" ), 8 );
+        QCOMPARE( cache.hits( Tomahawk::DatabaseIdCache::Artist ), Q_UINT64_C( 1 ) );
+        QCOMPARE( cache.misses( Tomahawk::DatabaseIdCache::Artist ), Q_UINT64_C( 1 ) );
+
+        // bounded, the least recently used artist has to go
+        cache.insert( Tomahawk::DatabaseIdCache::Artist, 0, "Low", 3 );
+        QCOMPARE( cache.count( Tomahawk::DatabaseIdCache::Artist ), 2 );
+        QCOMPARE( cache.id( Tomahawk::DatabaseIdCache::Artist, 0, "Mogwai" ), 0 );
+        QCOMPARE( cache.id( Tomahawk::DatabaseIdCache::Artist, 0, "Bloc Party" ), 1 );
+    }
+
+    void testIdCacheOnlyCommittedIds()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        impl->database().transaction();
+        const int id = impl->artistId( "Rolled Back Artist", true );
+        QVERIFY( id > 0 );
+
+        // known to the transaction that created it, but not shared yet
+        QCOMPARE( impl->artistId( "Rolled Back Artist", false ), id );
+        QCOMPARE( impl->idCache()->id( Tomahawk::DatabaseIdCache::Artist, 0, "Rolled Back Artist" ), 0 );
+
+        impl->database().rollback();
+        impl->discardCreatedIds();
+        QCOMPARE( impl->artistId( "Rolled Back Artist", false ), 0 );
+
+        impl->database().transaction();
+        const int committed = impl->artistId( "Committed Artist", true );
+        QVERIFY( committed > 0 );
+        QVERIFY( impl->database().commit() );
+        impl->commitCreatedIds();
+        QCOMPARE( impl->idCache()->id( Tomahawk::DatabaseIdCache::Artist, 0, "Committed Artist" ), committed );
+    }
+
+    void testFuzzyIndexUpdates()
+    {
+        FuzzyIndex index( 0, "test.lucene", true );
+
+        Tomahawk::IndexData track;
+        track.id = 7;
+        track.artistId = 1;
+        track.artist = "Bloc Party";
+        track.track = "Helicopter";
+
+        Tomahawk::IndexData album;
+        album.id = 5;
+        album.artistId = 0;
+        album.album = "Silent Alarm";
+
+        const QList< Tomahawk::IndexData > data = QList< Tomahawk::IndexData >() << track << album;
+        QCOMPARE( index.missingDocuments( data ).count(), 2 );
+
+        index.updateDocuments( data );
+        const Tomahawk::query_ptr query = Tomahawk::Query::get( "Bloc Party", "Helicopter", QString() );
+        QVERIFY( index.search( query ).contains( 7 ) );
+        QVERIFY( index.missingDocuments( data ).isEmpty() );
+
+        // updating a document replaces it
+        index.updateDocuments( QList< Tomahawk::IndexData >() << track );
+        QCOMPARE( index.search( query ).count(), 1 );
+
+        index.removeDocuments( QList< unsigned int >() << 7, QList< unsigned int >() );
+        QVERIFY( index.search( query ).isEmpty() );
+        QCOMPARE( index.missingDocuments( data ).count(), 1 );
+
+        index.deleteIndex();
+    }
+
+    void testPlaylistRevisionDelta()
+    {
+        QStringList from;
+        for ( int i = 0; i < 100; i++ )
+            from << QString( "entry-%1" ).arg( i );
+
+        // insert a run, drop another one and drag a third one to the top
+        QStringList to = from;
+        to.insert( 50, "new-1" );
+        to.insert( 51, "new-2" );
+        to.erase( to.begin() + 10, to.begin() + 13 );
+        const QStringList dragged = to.mid( 80, 5 );
+        to.erase( to.begin() + 80, to.begin() + 85 );
+        to = dragged + to;
+
+        bool ok;
+        const QVariantList ops = Tomahawk::PlaylistRevisionStore::diff( from, to, &ok );
+        QVERIFY( ok );
+        QCOMPARE( ops.count(), 3 );
+
+        QStringList applied = from;
+        QVERIFY( Tomahawk::PlaylistRevisionStore::apply( applied, ops ) );
+        QCOMPARE( applied, to );
+
+        // unchanged order, e.g. metadata updates
+        QVERIFY( Tomahawk::PlaylistRevisionStore::diff( from, from, &ok ).isEmpty() );
+        QVERIFY( ok );
+
+        // a whole new list isn't worth a delta
+        QStringList other;
+        for ( int i = 0; i < 100; i++ )
+            other << QString( "other-%1" ).arg( i );
+        Tomahawk::PlaylistRevisionStore::diff( from, other, &ok );
+        QVERIFY( !ok );
+
+        // ops that don't fit are rejected
+        QStringList small = from.mid( 0, 5 );
+        QVERIFY( !Tomahawk::PlaylistRevisionStore::apply( small, ops ) );
+    }
+
+    void testPlaylistRevisionRoundTrip()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        QString playlist;
+        QStringList revisions;
+        QList< QStringList > entries;
+        QVERIFY( createPlaylist( 60, playlist, revisions, entries ) );
+
+        // a snapshot every SNAPSHOT_INTERVAL (50) revisions, deltas in between
+        for ( int i = 0; i < revisions.count(); i++ )
+        {
+            const QVariant stored = storedEntries( revisions.at( i ) );
+            QVERIFY( stored.isValid() );
+            QCOMPARE( stored.type() == QVariant::List, i % 50 == 0 );
+        }
+
+        // reconstructed from the database, not from what encode() cached
+        impl->playlistRevisions()->clear();
+        for ( int i = 0; i < revisions.count(); i++ )
+        {
+            TestLoadPlaylistEntries cmd( revisions.at( i ) );
+            cmd._exec( impl );
+
+            QCOMPARE( cmd.guids(), entries.at( i ) );
+            QCOMPARE( cmd.entryCount(), entries.at( i ).count() );
+            if ( i > 0 )
+                QCOMPARE( cmd.oldEntries(), entries.at( i - 1 ) );
+        }
+    }
+
+    void testCompactPlaylistRevisions()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        QString playlist;
+        QStringList revisions;
+        QList< QStringList > entries;
+        QVERIFY( createPlaylist( 60, playlist, revisions, entries ) );
+        QVERIFY( compactPlaylists() );
+
+        // the latest KEEP_REVISIONS (20) are left
+        TomahawkSqlQuery query = impl->newquery();
+        query.prepare( "SELECT COUNT(*) FROM playlist_revision WHERE playlist = ?" );
+        query.addBindValue( playlist );
+        QVERIFY( query.exec() && query.next() );
+        QCOMPARE( query.value( 0 ).toInt(), 20 );
+        for ( int i = 0; i < 40; i++ )
+            QVERIFY( !storedEntries( revisions.at( i ) ).isValid() );
+
+        // and the oldest of them doesn't depend on the deleted ones anymore
+        QString previous = "none";
+        const QVariant oldest = storedEntries( revisions.at( 40 ), &previous );
+        QCOMPARE( oldest.type(), QVariant::List );
+        QVERIFY( previous.isEmpty() );
+
+        impl->playlistRevisions()->clear();
+        for ( int i = 40; i < revisions.count(); i++ )
+        {
+            TestLoadPlaylistEntries cmd( revisions.at( i ) );
+            cmd._exec( impl );
+            QCOMPARE( cmd.guids(), entries.at( i ) );
+        }
+    }
+
+    void testIncomingRevisionAfterCompaction()
+    {
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        QString playlist;
+        QStringList revisions;
+        QList< QStringList > entries;
+        QVERIFY( createPlaylist( 60, playlist, revisions, entries ) );
+        QVERIFY( compactPlaylists() );
+
+        TomahawkSqlQuery query = impl->newquery();
+        query.prepare( "INSERT INTO source( name, friendlyname ) VALUES( ?, ? )" );
+        query.addBindValue( uuid() );
+        query.addBindValue( "Peer" );
+        QVERIFY( query.exec() );
+        Tomahawk::source_ptr peer( new Tomahawk::Source( query.lastInsertId().toInt(), "peer" ) );
+
+        // a peer that hasn't seen the compaction yet builds on a revision that's gone here
+        QStringList orderedguids = entries.at( 30 );
+        orderedguids.move( 0, orderedguids.count() - 1 );
+        const QString revision = uuid();
+
+        Tomahawk::DatabaseCommand_SetPlaylistRevision cmd( peer, playlist, revision, revisions.at( 30 ), orderedguids,
+                                                           QList< Tomahawk::plentry_ptr >(), QList< Tomahawk::plentry_ptr >() );
+        impl->database().transaction();
+        cmd._exec( impl );
+        QVERIFY( impl->database().commit() );
+
+        QString previous = "none";
+        QCOMPARE( storedEntries( revision, &previous ).type(), QVariant::List );
+        QVERIFY( previous.isEmpty() );
+
+        // optimistic locking failed, the current revision stays
+        query.prepare( "SELECT currentrevision FROM playlist WHERE guid = ?" );
+        query.addBindValue( playlist );
+        QVERIFY( query.exec() && query.next() );
+        QCOMPARE( query.value( 0 ).toString(), revisions.last() );
+
+        impl->playlistRevisions()->clear();
+        TestLoadPlaylistEntries load( revision );
+        load._exec( impl );
+        QCOMPARE( load.guids(), orderedguids );
+    }
+
+    void benchmarkResolve_data()
+    {
+        QTest::addColumn< bool >( "batched" );
+
+        QTest::newRow( "one command per query" ) << false;
+        QTest::newRow( "batched" ) << true;
+    }
+
+    void benchmarkResolve()
+    {
+        QFETCH( bool, batched );
+
+        // resolving against an empty collection doesn't tell us anything
+        populateResolveData();
+
+        QList< Tomahawk::query_ptr > queries;
+        for ( int i = 0; i < 1000; i++ )
+        {
+            queries << Tomahawk::Query::get( QString( "Artist %1" ).arg( i / 10 ),
+                                             QString( "Track %1" ).arg( i ),
+                                             QString( "Album %1" ).arg( i / 100 ) );
+        }
+
+        // run the commands right here, we only want to measure the commands themselves
+        Tomahawk::DatabaseImpl* impl = db->impl();
+
+        QBENCHMARK
+        {
+            if ( batched )
+            {
+                Tomahawk::DatabaseCommand_Resolve cmd( queries );
+                cmd._exec( impl );
+            }
+            else
+            {
+                foreach ( const Tomahawk::query_ptr& query, queries )
+                {
+                    Tomahawk::DatabaseCommand_Resolve cmd( query );
+                    cmd._exec( impl );
+                }
+            }
+        }
+    }
 };
 
 #endif // TOMAHAWK_TESTDATABASE_H
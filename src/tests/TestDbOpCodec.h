@@ -0,0 +1,221 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTDBOPCODEC_H
+#define TOMAHAWK_TESTDBOPCODEC_H
+
+#include <QtTest>
+
+#include "libtomahawk/network/DbOpCodec.h"
+#include "libtomahawk/utils/Json.h"
+
+class TestDbOpCodec : public QObject
+{
+    Q_OBJECT
+private:
+    // roughly what an addfiles op from a MusicScanner batch looks like
+    QVariantMap addFilesOp( int count )
+    {
+        QVariantList files;
+        for ( int i = 0; i < count; i++ )
+        {
+            QVariantMap file;
+            file[ "id" ] = i + 1;
+            file[ "url" ] = QString::number( i + 1 );
+            file[ "mtime" ] = 1420070400 + i;
+            file[ "size" ] = 5000000 + i * 17;
+            file[ "hash" ] = QString();
+            file[ "mimetype" ] = "audio/mpeg";
+            file[ "duration" ] = 180 + i % 120;
+            file[ "bitrate" ] = 320;
+            file[ "artist" ] = QString( "Artist %1" ).arg( i / 100 );
+            file[ "albumartist" ] = QString( "Artist %1" ).arg( i / 100 );
+            file[ "album" ] = QString( "Album %1" ).arg( i / 10 );
+            file[ "track" ] = QString( "Track %1" ).arg( i );
+            file[ "composer" ] = QString();
+            file[ "albumpos" ] = i % 10 + 1;
+            file[ "discnumber" ] = 1;
+            file[ "year" ] = 2015;
+            files << file;
+        }
+
+        QVariantMap op;
+        op[ "command" ] = "addfiles";
+        op[ "guid" ] = "d2b3c4a5-0000-4000-8000-000000000000";
+        op[ "files" ] = files;
+        return op;
+    }
+
+private slots:
+    void testRoundTrip()
+    {
+        QVariantMap m;
+        m[ "null" ] = QVariant();
+        m[ "true" ] = true;
+        m[ "false" ] = false;
+        m[ "int" ] = -42;
+        m[ "big" ] = Q_INT64_C( 1099511627776 );
+        m[ "double" ] = 0.25;
+        m[ "string" ] = QString::fromUtf8( "Sigur R\xc3\xb3s" );
+        m[ "long" ] = QString( 200, 'x' );
+        m[ "list" ] = QVariantList() << 1 << "Sigur R\xc3\xb3s" << QVariantList();
+        m[ "map" ] = QVariantMap();
+
+        bool ok = false;
+        const QVariantMap decoded = DbOpCodec::decode( DbOpCodec::encode( m ), &ok ).toMap();
+        QVERIFY( ok );
+        QCOMPARE( decoded.keys(), m.keys() );
+        QVERIFY( decoded.value( "null" ).isNull() );
+        QCOMPARE( decoded.value( "true" ).toBool(), true );
+        QCOMPARE( decoded.value( "false" ).toBool(), false );
+        QCOMPARE( decoded.value( "int" ).toInt(), -42 );
+        QCOMPARE( decoded.value( "big" ).toLongLong(), Q_INT64_C( 1099511627776 ) );
+        QCOMPARE( decoded.value( "double" ).toDouble(), 0.25 );
+        QCOMPARE( decoded.value( "string" ).toString(), m.value( "string" ).toString() );
+        QCOMPARE( decoded.value( "long" ).toString(), m.value( "long" ).toString() );
+        QCOMPARE( decoded.value( "list" ).toList().count(), 3 );
+        QCOMPARE( decoded.value( "list" ).toList().at( 1 ).toString(), m.value( "string" ).toString() );
+
+        // tables of maps with shared keys
+        const QVariantMap op = addFilesOp( 100 );
+        const QVariantMap decodedOp = DbOpCodec::decode( DbOpCodec::encode( op ), &ok ).toMap();
+        QVERIFY( ok );
+        QCOMPARE( decodedOp.value( "files" ).toList().count(), 100 );
+        QCOMPARE( decodedOp.value( "files" ).toList().at( 42 ).toMap().value( "track" ).toString(), QString( "Track 42" ) );
+        QCOMPARE( decodedOp.value( "files" ).toList().at( 42 ).toMap().value( "size" ).toInt(), 5000000 + 42 * 17 );
+    }
+
+    void testMalformed()
+    {
+        const QByteArray data = DbOpCodec::encode( addFilesOp( 10 ) );
+
+        bool ok = true;
+        QVERIFY( DbOpCodec::decode( data.left( data.length() - 1 ), &ok ).isNull() );
+        QVERIFY( !ok );
+        DbOpCodec::decode( QByteArray(), &ok );
+        QVERIFY( !ok );
+        DbOpCodec::decode( data + 'x', &ok );
+        QVERIFY( !ok );
+        DbOpCodec::decode( "{\"command\":\"addfiles\"}", &ok );
+        QVERIFY( !ok );
+    }
+
+    void testHostile()
+    {
+        bool ok = true;
+
+        // a table of 16M rows without columns, that's six bytes asking for 16M maps
+        DbOpCodec::decode( QByteArray::fromHex( "010a8080800800" ), &ok );
+        QVERIFY( !ok );
+
+        // element counts (and rows times columns) beyond what's left in the input
+        DbOpCodec::decode( QByteArray::fromHex( "010880808008" ), &ok );
+        QVERIFY( !ok );
+        DbOpCodec::decode( QByteArray::fromHex( "01098080800800" ), &ok );
+        QVERIFY( !ok );
+        DbOpCodec::decode( QByteArray::fromHex( "010a0302066b" ), &ok );
+        QVERIFY( !ok );
+
+        // nesting that would otherwise exhaust the stack
+        QByteArray deep( "\x01" );
+        for ( int i = 0; i < 100000; i++ )
+            deep.append( QByteArray::fromHex( "0801" ) );
+        deep.append( char( 0 ) );
+        DbOpCodec::decode( deep, &ok );
+        QVERIFY( !ok );
+
+        // reasonable nesting is fine
+        QVariant nested = 1;
+        for ( int i = 0; i < 16; i++ )
+            nested = QVariantList() << nested;
+        DbOpCodec::decode( DbOpCodec::encode( nested ), &ok );
+        QVERIFY( ok );
+
+        // lists of empty maps aren't encoded as tables
+        const QVariantList empty = QVariantList() << QVariantMap() << QVariantMap();
+        QCOMPARE( DbOpCodec::decode( DbOpCodec::encode( empty ), &ok ).toList().count(), 2 );
+        QVERIFY( ok );
+
+        // every truncation and random corruption of a valid op has to be rejected
+        // or decoded, but never crash or blow up
+        const QByteArray data = DbOpCodec::encode( addFilesOp( 20 ) );
+        for ( int i = 0; i < data.length(); i++ )
+        {
+            DbOpCodec::decode( data.left( i ), &ok );
+            QVERIFY( !ok );
+        }
+
+        qsrand( 42 );
+        for ( int i = 0; i < 10000; i++ )
+        {
+            QByteArray corrupt = data;
+            for ( int j = qrand() % 4; j >= 0; j-- )
+                corrupt[ qrand() % corrupt.length() ] = char( qrand() % 256 );
+
+            DbOpCodec::decode( corrupt, &ok );
+        }
+    }
+
+    void benchmarkEncode_data()
+    {
+        QTest::addColumn< bool >( "binary" );
+
+        QTest::newRow( "json" ) << false;
+        QTest::newRow( "binary" ) << true;
+    }
+
+    void benchmarkEncode()
+    {
+        QFETCH( bool, binary );
+        const QVariantMap op = addFilesOp( 5000 );
+
+        QByteArray data;
+        QBENCHMARK
+        {
+            data = binary ? DbOpCodec::encode( op ) : TomahawkUtils::toJson( op );
+        }
+
+        if ( binary )
+            QVERIFY( data.size() < TomahawkUtils::toJson( op ).size() );
+    }
+
+    void benchmarkDecode_data()
+    {
+        QTest::addColumn< bool >( "binary" );
+
+        QTest::newRow( "json" ) << false;
+        QTest::newRow( "binary" ) << true;
+    }
+
+    void benchmarkDecode()
+    {
+        QFETCH( bool, binary );
+        const QVariantMap op = addFilesOp( 5000 );
+        const QByteArray data = binary ? DbOpCodec::encode( op ) : TomahawkUtils::toJson( op );
+
+        QVariant decoded;
+        QBENCHMARK
+        {
+            decoded = binary ? DbOpCodec::decode( data ) : TomahawkUtils::parseJson( data );
+        }
+
+        QCOMPARE( decoded.toMap().value( "files" ).toList().count(), 5000 );
+    }
+};
+
+#endif // TOMAHAWK_TESTDBOPCODEC_H
@@ -0,0 +1,159 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTHTTPCLIENT_H
+#define TOMAHAWK_TESTHTTPCLIENT_H
+
+#include <QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "libtomahawk/utils/HttpClient.h"
+#include "libtomahawk/utils/TomahawkUtils.h"
+
+// Answers every request with a small, cacheable response
+class TestHttpServer : public QTcpServer
+{
+Q_OBJECT
+public:
+    TestHttpServer() : requests( 0 ) {}
+
+    int requests;
+
+private slots:
+    void onNewConnection()
+    {
+        while ( hasPendingConnections() )
+        {
+            QTcpSocket* socket = nextPendingConnection();
+            connect( socket, SIGNAL( readyRead() ), SLOT( onReadyRead() ) );
+            connect( socket, SIGNAL( disconnected() ), socket, SLOT( deleteLater() ) );
+        }
+    }
+
+    void onReadyRead()
+    {
+        QTcpSocket* socket = qobject_cast< QTcpSocket* >( sender() );
+        QByteArray& buffer = m_buffers[ socket ];
+        buffer += socket->readAll();
+        if ( !buffer.contains( "\r\n\r\n" ) )
+            return;
+
+        requests++;
+        m_buffers.remove( socket );
+        socket->write( "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/plain\r\n"
+                       "Content-Length: 5\r\n"
+                       "Cache-Control: max-age=600\r\n"
+                       "Connection: close\r\n"
+                       "\r\n"
+                       "hello" );
+        socket->disconnectFromHost();
+    }
+
+public:
+    bool start()
+    {
+        connect( this, SIGNAL( newConnection() ), SLOT( onNewConnection() ) );
+        return listen( QHostAddress::LocalHost );
+    }
+
+private:
+    QHash< QTcpSocket*, QByteArray > m_buffers;
+};
+
+class TestHttpClient : public QObject
+{
+    Q_OBJECT
+private:
+    QList< Tomahawk::Utils::HttpResponse > responses;
+
+    void gotResponse( const Tomahawk::Utils::HttpResponse& response )
+    {
+        responses << response;
+    }
+
+private slots:
+    void testCoalescingAndCache()
+    {
+        const QString cacheDir = QDir::temp().absoluteFilePath( "tomahawk-test-httpcache" );
+        TomahawkUtils::removeDirectory( cacheDir );
+
+        TestHttpServer server;
+        QVERIFY( server.start() );
+        const QUrl url( QString( "http://127.0.0.1:%1/track" ).arg( server.serverPort() ) );
+
+        Tomahawk::Utils::HttpClient http( cacheDir );
+        responses.clear();
+
+        // three identical requests in flight at once go out as one
+        for ( int i = 0; i < 3; i++ )
+        {
+            http.send( "resolver", "GET", QNetworkRequest( url ), QByteArray(), this,
+                       std::bind( &TestHttpClient::gotResponse, this, std::placeholders::_1 ) );
+        }
+        QTRY_COMPARE( responses.count(), 3 );
+        QCOMPARE( server.requests, 1 );
+        foreach ( const Tomahawk::Utils::HttpResponse& response, responses )
+        {
+            QCOMPARE( response.status, 200 );
+            QCOMPARE( response.body, QByteArray( "hello" ) );
+        }
+
+        // a fresh response comes from the disk cache
+        http.send( "resolver", "GET", QNetworkRequest( url ), QByteArray(), this,
+                   std::bind( &TestHttpClient::gotResponse, this, std::placeholders::_1 ) );
+        QTRY_COMPARE( responses.count(), 4 );
+        QCOMPARE( server.requests, 1 );
+        QVERIFY( responses.last().fromCache );
+        QCOMPARE( responses.last().body, QByteArray( "hello" ) );
+
+        // POSTs always go out
+        http.send( "other", "POST", QNetworkRequest( url ), QByteArray( "data" ), this,
+                   std::bind( &TestHttpClient::gotResponse, this, std::placeholders::_1 ) );
+        QTRY_COMPARE( responses.count(), 5 );
+        QCOMPARE( server.requests, 2 );
+
+        const Tomahawk::Utils::HttpClient::Statistics stats = http.statistics( "resolver" );
+        QCOMPARE( stats.requests, Q_UINT64_C( 4 ) );
+        QCOMPARE( stats.coalesced, Q_UINT64_C( 2 ) );
+        QCOMPARE( stats.cacheHits, Q_UINT64_C( 1 ) );
+        QCOMPARE( http.statistics( "other" ).requests, Q_UINT64_C( 1 ) );
+
+        TomahawkUtils::removeDirectory( cacheDir );
+    }
+
+    void testUrlVerdicts()
+    {
+        Tomahawk::Utils::HttpClient http( QDir::temp().absoluteFilePath( "tomahawk-test-httpcache" ) );
+        const QUrl url( "http://example.com/track.mp3" );
+
+        bool valid = false;
+        QVERIFY( !http.cachedUrlVerdict( url, &valid ) );
+
+        http.setUrlVerdict( url, true );
+        QVERIFY( http.cachedUrlVerdict( url, &valid ) );
+        QVERIFY( valid );
+
+        http.setUrlVerdict( url, false );
+        QVERIFY( http.cachedUrlVerdict( url, &valid ) );
+        QVERIFY( !valid );
+    }
+};
+
+#endif // TOMAHAWK_TESTHTTPCLIENT_H
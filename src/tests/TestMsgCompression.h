@@ -0,0 +1,121 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTMSGCOMPRESSION_H
+#define TOMAHAWK_TESTMSGCOMPRESSION_H
+
+#include <QtTest>
+
+#include "libtomahawk/network/MsgCompression.h"
+
+Q_DECLARE_METATYPE( MsgCompression::Codec )
+Q_DECLARE_METATYPE( MsgCompression::Level )
+
+class TestMsgCompression : public QObject
+{
+    Q_OBJECT
+private:
+    // JSON of an addfiles op, the bulk of what we compress
+    QByteArray payload()
+    {
+        QByteArray data = "{\"command\":\"addfiles\",\"files\":[";
+        for ( int i = 0; i < 5000; i++ )
+        {
+            data += QString( "{\"album\":\"Album %1\",\"albumpos\":%2,\"artist\":\"Artist %3\","
+                             "\"bitrate\":320,\"duration\":%4,\"mimetype\":\"audio/mpeg\","
+                             "\"mtime\":%5,\"size\":%6,\"track\":\"Track %7\",\"url\":\"%8\"}," )
+                    .arg( i / 10 ).arg( i % 10 + 1 ).arg( i / 100 ).arg( 180 + i % 120 )
+                    .arg( 1420070400 + i ).arg( 5000000 + i * 17 ).arg( i ).arg( i + 1 ).toUtf8();
+        }
+        data.chop( 1 );
+        data += "]}";
+
+        return data;
+    }
+
+private slots:
+    void testRoundTrip()
+    {
+        const QByteArray data = payload();
+
+        foreach ( MsgCompression::Codec codec, MsgCompression::availableCodecs() )
+        {
+            const QByteArray compressed = MsgCompression::compress( data, codec, MsgCompression::Fast );
+            QVERIFY( compressed.size() < data.size() );
+
+            bool ok = false;
+            QCOMPARE( MsgCompression::uncompress( compressed, &ok ), data );
+            QVERIFY( ok );
+        }
+
+        // zlib frames have to stay readable by peers that only know qUncompress()
+        QCOMPARE( qUncompress( MsgCompression::compress( data, MsgCompression::Zlib, MsgCompression::Strong ) ), data );
+        QCOMPARE( MsgCompression::uncompress( qCompress( data, 9 ) ), data );
+    }
+
+    void testMalformed()
+    {
+        bool ok = true;
+        QVERIFY( MsgCompression::uncompress( QByteArray(), &ok ).isEmpty() );
+        QVERIFY( !ok );
+
+        // unknown codec
+        MsgCompression::uncompress( QByteArray::fromHex( "ff7f00000010deadbeef" ), &ok );
+        QVERIFY( !ok );
+
+        foreach ( MsgCompression::Codec codec, MsgCompression::availableCodecs() )
+        {
+            const QByteArray compressed = MsgCompression::compress( payload(), codec, MsgCompression::Fast );
+            MsgCompression::uncompress( compressed.left( compressed.size() / 2 ), &ok );
+            QVERIFY( !ok );
+        }
+    }
+
+    void benchmarkCompress_data()
+    {
+        QTest::addColumn< MsgCompression::Codec >( "codec" );
+        QTest::addColumn< MsgCompression::Level >( "level" );
+        QTest::addColumn< int >( "zlibLevel" );
+
+        QTest::newRow( "zlib level 9" ) << MsgCompression::Zlib << MsgCompression::Fast << 9;
+        foreach ( MsgCompression::Codec codec, MsgCompression::availableCodecs() )
+        {
+            const QString name = codec == MsgCompression::Zlib ? QString( "zlib" ) : MsgCompression::featureName( codec );
+            QTest::newRow( qPrintable( name + " fast" ) ) << codec << MsgCompression::Fast << -1;
+            QTest::newRow( qPrintable( name + " strong" ) ) << codec << MsgCompression::Strong << -1;
+        }
+    }
+
+    void benchmarkCompress()
+    {
+        QFETCH( MsgCompression::Codec, codec );
+        QFETCH( MsgCompression::Level, level );
+        QFETCH( int, zlibLevel );
+        const QByteArray data = payload();
+
+        QByteArray compressed;
+        QBENCHMARK
+        {
+            compressed = zlibLevel > 0 ? qCompress( data, zlibLevel ) : MsgCompression::compress( data, codec, level );
+        }
+
+        QVERIFY( compressed.size() < data.size() / 2 );
+    }
+};
+
+#endif // TOMAHAWK_TESTMSGCOMPRESSION_H
@@ -0,0 +1,351 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTPIPELINE_H
+#define TOMAHAWK_TESTPIPELINE_H
+
+#include <QtTest>
+
+#include "libtomahawk/Pipeline.h"
+#include "libtomahawk/Query.h"
+#include "libtomahawk/Result.h"
+#include "libtomahawk/ResultCache.h"
+#include "libtomahawk/Track.h"
+#include "libtomahawk/resolvers/Resolver.h"
+
+class TestResolver : public Tomahawk::Resolver
+{
+Q_OBJECT
+public:
+    TestResolver( bool batch ) : resolveCalls( 0 ), ttl( 0 ), negativeTtl( 0 ), m_batch( batch ) {}
+
+    QString name() const { return "TestResolver"; }
+    unsigned int weight() const { return 100; }
+    unsigned int timeout() const { return 0; }
+    bool supportsBatchResolve() const { return m_batch; }
+    qint64 resultCacheTtl() const { return ttl; }
+    qint64 negativeResultCacheTtl() const { return negativeTtl; }
+
+    QList< int > batches;
+    int resolveCalls;
+    qint64 ttl, negativeTtl;
+    // every query we were asked, in order
+    QList< Tomahawk::query_ptr > dispatched;
+
+public slots:
+    void resolve( const Tomahawk::query_ptr& query ) { resolveCalls++; dispatched << query; }
+    void resolveBatch( const QList< Tomahawk::query_ptr >& queries ) { batches << queries.count(); dispatched << queries; }
+
+private:
+    bool m_batch;
+};
+
+class TestPipeline : public QObject
+{
+    Q_OBJECT
+private:
+    // drives the background budgets, so they only refill when we say so
+    qint64 m_now;
+    qint64 now() const { return m_now; }
+
+    QList< Tomahawk::query_ptr > createQueries( int count )
+    {
+        QList< Tomahawk::query_ptr > queries;
+        for ( int i = 0; i < count; i++ )
+        {
+            queries << Tomahawk::Query::get( QString( "Artist %1" ).arg( i / 10 ),
+                                             QString( "Track %1" ).arg( i ),
+                                             QString( "Album %1" ).arg( i / 100 ) );
+        }
+
+        return queries;
+    }
+
+    QStringList trackNames( const QList< Tomahawk::query_ptr >& queries )
+    {
+        QStringList names;
+        foreach ( const Tomahawk::query_ptr& query, queries )
+            names << query->queryTrack()->track();
+
+        return names;
+    }
+
+private slots:
+    void testDedupe()
+    {
+        // The Pipeline isn't started yet, so queries stay pending
+        Tomahawk::Pipeline pipeline;
+        pipeline.setBackgroundResolveRate( 0 );
+        QList< Tomahawk::query_ptr > queries = createQueries( 100 );
+
+        pipeline.resolve( queries, false );
+        QCOMPARE( pipeline.pendingQueryCount(), 100u );
+
+        // re-submitted queries move up to the more important lane, never down
+        pipeline.schedule( queries.mid( 50, 10 ), Tomahawk::Pipeline::LaneVisible );
+        pipeline.resolve( queries.mid( 50, 20 ), false );
+        pipeline.deprioritize( queries.mid( 0, 10 ) );
+        QCOMPARE( pipeline.pendingQueryCount(), 100u );
+        QCOMPARE( pipeline.activeQueryCount(), 0u );
+
+        TestResolver resolver( true );
+        pipeline.addResolver( &resolver );
+        pipeline.start();
+
+        // answer whatever got dispatched, so the next batch follows
+        int answered = 0;
+        while ( answered < queries.count() )
+        {
+            QTRY_VERIFY( resolver.dispatched.count() > answered );
+            for ( ; answered < resolver.dispatched.count(); answered++ )
+                pipeline.reportResults( resolver.dispatched.at( answered )->id(), QList< Tomahawk::result_ptr >() );
+        }
+
+        const QList< Tomahawk::query_ptr > expected = queries.mid( 50, 10 ) + queries.mid( 10, 40 ) + queries.mid( 60 ) + queries.mid( 0, 10 );
+        QCOMPARE( trackNames( resolver.dispatched ), trackNames( expected ) );
+        QCOMPARE( pipeline.pendingQueryCount(), 0u );
+
+        pipeline.removeResolver( &resolver );
+    }
+
+    void testBatchDispatch()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( true );
+        pipeline.addResolver( &resolver );
+
+        pipeline.resolve( createQueries( 250 ) );
+        pipeline.start();
+
+        // one call for the first batch, which fills all query slots but doesn't exceed them
+        const unsigned int slots = pipeline.maxConcurrentQueries();
+        QVERIFY( slots > 1 );
+        QCOMPARE( resolver.batches, QList< int >() << (int)slots );
+        QCOMPARE( resolver.resolveCalls, 0 );
+        QCOMPARE( pipeline.activeQueryCount(), slots );
+        QCOMPARE( pipeline.pendingQueryCount(), 250u - slots );
+
+        pipeline.removeResolver( &resolver );
+    }
+
+    void testLegacyDispatch()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( false );
+        pipeline.addResolver( &resolver );
+
+        pipeline.resolve( createQueries( 250 ) );
+        pipeline.start();
+
+        QTRY_VERIFY( resolver.resolveCalls > 0 );
+        QVERIFY( resolver.batches.isEmpty() );
+
+        pipeline.removeResolver( &resolver );
+    }
+
+    void testBackgroundThrottle()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( true );
+        pipeline.addResolver( &resolver );
+        m_now = 0;
+        pipeline.setBudgetClock( std::bind( &TestPipeline::now, this ) );
+        // stay below the query slots we get on any machine
+        pipeline.setBackgroundResolveRate( 4 );
+        QVERIFY( pipeline.maxConcurrentQueries() >= 4 );
+
+        QList< Tomahawk::query_ptr > queries = createQueries( 50 );
+        pipeline.resolve( queries, false );
+        pipeline.start();
+
+        // a second's worth of background queries, then the budget is used up
+        QCOMPARE( resolver.batches, QList< int >() << 4 );
+        foreach ( const Tomahawk::query_ptr& query, queries.mid( 0, 4 ) )
+            pipeline.reportResults( query->id(), QList< Tomahawk::result_ptr >() );
+        QCOMPARE( pipeline.activeQueryCount(), 0u );
+
+        // visible queries don't have to wait for it
+        pipeline.schedule( queries.mid( 46 ), Tomahawk::Pipeline::LaneVisible );
+        QCOMPARE( resolver.batches, QList< int >() << 4 << 4 );
+        QCOMPARE( pipeline.pendingQueryCount(), 42u );
+
+        // half a second later there's room for two more
+        foreach ( const Tomahawk::query_ptr& query, queries.mid( 46 ) )
+            pipeline.reportResults( query->id(), QList< Tomahawk::result_ptr >() );
+        m_now += 500;
+        QTRY_COMPARE( resolver.batches, QList< int >() << 4 << 4 << 2 );
+        QCOMPARE( pipeline.pendingQueryCount(), 40u );
+
+        pipeline.removeResolver( &resolver );
+    }
+
+    void testThrottledQueriesFreeSlots()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( false );
+        pipeline.addResolver( &resolver );
+        m_now = 0;
+        pipeline.setBudgetClock( std::bind( &TestPipeline::now, this ) );
+        pipeline.setBackgroundResolveRate( 1 );
+        pipeline.start();
+
+        // every call takes a query before the first one is charged, so more
+        // of them get a slot than the budget allows
+        const unsigned int slots = pipeline.maxConcurrentQueries();
+        QList< Tomahawk::query_ptr > queries = createQueries( slots + 10 );
+        foreach ( const Tomahawk::query_ptr& query, queries )
+            pipeline.resolve( query, false );
+        QCOMPARE( pipeline.activeQueryCount(), slots );
+
+        // only one is dispatched, the others wait in the background lane again
+        QTRY_COMPARE( pipeline.activeQueryCount(), 1u );
+        QCOMPARE( resolver.resolveCalls, 1 );
+        QCOMPARE( pipeline.pendingQueryCount(), slots + 9 );
+
+        // so visible queries still get through
+        const Tomahawk::query_ptr visible = Tomahawk::Query::get( "Visible", "Track", QString() );
+        pipeline.resolve( visible );
+        QTRY_COMPARE( resolver.resolveCalls, 2 );
+        QVERIFY( pipeline.isResolving( visible ) );
+
+        // and the waiting ones carry on once there's budget
+        m_now += 1000;
+        QTRY_COMPARE( resolver.resolveCalls, 3 );
+        QCOMPARE( pipeline.activeQueryCount(), 3u );
+        QCOMPARE( pipeline.pendingQueryCount(), slots + 8 );
+
+        pipeline.removeResolver( &resolver );
+    }
+
+    void testResultCache()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( false );
+        Tomahawk::ResultCache cache;
+
+        const Tomahawk::query_ptr found = Tomahawk::Query::get( "Bloc Party", "Helicopter", "Silent Alarm" );
+        const Tomahawk::query_ptr missing = Tomahawk::Query::get( "Mogwai", "Helicopter", QString() );
+        const Tomahawk::result_ptr result = Tomahawk::Result::get( "http://example.com/helicopter.mp3", found->queryTrack() );
+        result->setMimetype( "audio/mpeg" );
+
+        // resolvers have to opt in
+        QList< Tomahawk::result_ptr > results;
+        cache.insert( &resolver, found, QList< Tomahawk::result_ptr >() << result );
+        QVERIFY( !cache.lookup( &resolver, found, results ) );
+        QCOMPARE( cache.count(), 0 );
+
+        resolver.ttl = 60000;
+        resolver.negativeTtl = 60000;
+        cache.insert( &resolver, found, QList< Tomahawk::result_ptr >() << result );
+        cache.insert( &resolver, missing, QList< Tomahawk::result_ptr >() );
+        QCOMPARE( cache.count(), 2 );
+
+        // keys are normalized
+        QVERIFY( cache.lookup( &resolver, Tomahawk::Query::get( "bloc  party", "HELICOPTER", "silent alarm" ), results ) );
+        QCOMPARE( results.count(), 1 );
+        QCOMPARE( results.first()->url(), result->url() );
+        QVERIFY( results.first()->checked() );
+
+        QVERIFY( cache.lookup( &resolver, missing, results ) );
+        QVERIFY( results.isEmpty() );
+        QVERIFY( !cache.lookup( &resolver, Tomahawk::Query::get( "Low", "Words", QString() ), results ) );
+
+        Tomahawk::ResultCache::Statistics stats = cache.statistics( resolver.name() );
+        QCOMPARE( stats.hits, Q_UINT64_C( 2 ) );
+        QCOMPARE( stats.negativeHits, Q_UINT64_C( 1 ) );
+        QCOMPARE( stats.misses, Q_UINT64_C( 1 ) );
+
+        // persisted across restarts
+        const QString path = QDir::temp().absoluteFilePath( "tomahawk-test-resultcache.dat" );
+        QVERIFY( cache.save( path ) );
+        Tomahawk::ResultCache restored;
+        QVERIFY( restored.load( path ) );
+        QCOMPARE( restored.count(), 2 );
+        QVERIFY( restored.lookup( &resolver, found, results ) );
+        QCOMPARE( results.count(), 1 );
+
+        QFile::remove( path );
+
+        restored.invalidate( resolver.name() );
+        QCOMPARE( restored.count(), 0 );
+        QVERIFY( !restored.lookup( &resolver, found, results ) );
+
+        // expired entries don't count
+        resolver.negativeTtl = 1;
+        cache.insert( &resolver, missing, QList< Tomahawk::result_ptr >() );
+        QTest::qWait( 10 );
+        QVERIFY( !cache.lookup( &resolver, missing, results ) );
+    }
+
+    void testResultCacheEviction()
+    {
+        Tomahawk::Pipeline pipeline;
+        TestResolver resolver( false );
+        resolver.negativeTtl = 60000;
+        Tomahawk::ResultCache cache( 10 );
+
+        const QList< Tomahawk::query_ptr > queries = createQueries( 11 );
+        for ( int i = 0; i < 10; i++ )
+            cache.insert( &resolver, queries.at( i ), QList< Tomahawk::result_ptr >() );
+        QCOMPARE( cache.count(), 10 );
+
+        // a hit makes the oldest entry the most recently used one
+        QList< Tomahawk::result_ptr > results;
+        QVERIFY( cache.lookup( &resolver, queries.at( 0 ), results ) );
+
+        // going over capacity shrinks the cache to 90%, dropping the two least recently used
+        cache.insert( &resolver, queries.at( 10 ), QList< Tomahawk::result_ptr >() );
+        QCOMPARE( cache.count(), 9 );
+
+        QVERIFY( cache.lookup( &resolver, queries.at( 0 ), results ) );
+        QVERIFY( !cache.lookup( &resolver, queries.at( 1 ), results ) );
+        QVERIFY( !cache.lookup( &resolver, queries.at( 2 ), results ) );
+        for ( int i = 3; i < 11; i++ )
+            QVERIFY( cache.lookup( &resolver, queries.at( i ), results ) );
+    }
+
+    void benchmarkResolve_data()
+    {
+        QTest::addColumn< int >( "count" );
+
+        QTest::newRow( "10k" ) << 10000;
+        QTest::newRow( "50k" ) << 50000;
+        QTest::newRow( "100k" ) << 100000;
+    }
+
+    void benchmarkResolve()
+    {
+        QFETCH( int, count );
+
+        // Queries hook up to the Pipeline instance, so it has to exist first
+        Tomahawk::Pipeline pipeline;
+        QList< Tomahawk::query_ptr > queries = createQueries( count );
+
+        QBENCHMARK_ONCE
+        {
+            // initial batch, then the same batch again as a view would re-request it
+            pipeline.resolve( queries );
+            pipeline.resolve( queries );
+            pipeline.deprioritize( queries.mid( 0, count / 2 ) );
+        }
+
+        QCOMPARE( pipeline.pendingQueryCount(), (unsigned int)count );
+    }
+};
+
+#endif // TOMAHAWK_TESTPIPELINE_H
@@ -0,0 +1,134 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTPLAYABLEMODEL_H
+#define TOMAHAWK_TESTPLAYABLEMODEL_H
+
+#include <QtTest>
+
+#include "libtomahawk/Pipeline.h"
+#include "libtomahawk/Query.h"
+#include "libtomahawk/playlist/PlayableItem.h"
+#include "libtomahawk/playlist/PlayableModel.h"
+
+class TestPlayableModel : public QObject
+{
+    Q_OBJECT
+private:
+    QList< Tomahawk::query_ptr > createQueries( int count, const QString& prefix = QString( "Track" ) )
+    {
+        QList< Tomahawk::query_ptr > queries;
+        for ( int i = 0; i < count; i++ )
+        {
+            queries << Tomahawk::Query::get( QString( "Artist %1" ).arg( i / 10 ),
+                                             QString( "%1 %2" ).arg( prefix ).arg( i ),
+                                             QString( "Album %1" ).arg( i / 100 ) );
+        }
+
+        return queries;
+    }
+
+private slots:
+    void testRows()
+    {
+        // Queries hook up to the Pipeline instance, so it has to exist first
+        Tomahawk::Pipeline pipeline;
+        PlayableModel model( 0, false );
+
+        QList< Tomahawk::query_ptr > queries = createQueries( 10 );
+        model.appendQueries( queries );
+        QCOMPARE( model.rowCount( QModelIndex() ), 10 );
+
+        // rows behind an insert get renumbered
+        QList< Tomahawk::query_ptr > inserted = createQueries( 2, "Inserted" );
+        model.insertQueries( inserted, 5 );
+        QCOMPARE( model.rowCount( QModelIndex() ), 12 );
+        QCOMPARE( model.itemFromQuery( inserted.first() )->index().row(), 5 );
+        QCOMPARE( model.itemFromQuery( queries.at( 5 ) )->index().row(), 7 );
+        QCOMPARE( model.itemFromQuery( queries.last() )->index().row(), 11 );
+
+        // and again after a remove
+        model.removeIndex( model.index( 0, 0, QModelIndex() ) );
+        QCOMPARE( model.rowCount( QModelIndex() ), 11 );
+        QVERIFY( !model.itemFromQuery( queries.first() ) );
+        QCOMPARE( model.itemFromQuery( queries.at( 5 ) )->index().row(), 6 );
+        QCOMPARE( model.itemFromIndex( model.index( 4, 0, QModelIndex() ) )->query(), inserted.first() );
+
+        // the same query may show up more than once, the first row wins
+        model.appendQueries( QList< Tomahawk::query_ptr >() << queries.at( 1 ) );
+        QCOMPARE( model.rowCount( QModelIndex() ), 12 );
+        QCOMPARE( model.itemFromQuery( queries.at( 1 ) )->index().row(), 0 );
+
+        model.clear();
+        QCOMPARE( model.rowCount( QModelIndex() ), 0 );
+        QVERIFY( !model.itemFromQuery( queries.at( 1 ) ) );
+    }
+
+    void testSharedQueryUpdates()
+    {
+        Tomahawk::Pipeline pipeline;
+        PlayableModel model( 0, false );
+
+        QList< Tomahawk::query_ptr > queries = createQueries( 3 );
+        model.appendQueries( queries );
+        model.appendQueries( QList< Tomahawk::query_ptr >() << queries.at( 1 ) );
+        QCOMPARE( model.rowCount( QModelIndex() ), 4 );
+
+        // only the first row connects to the query, but every row showing it has to be updated
+        QSignalSpy spy( &model, SIGNAL( dataChanged( QModelIndex, QModelIndex ) ) );
+        QVERIFY( QMetaObject::invokeMethod( queries.at( 1 ).data(), "resultsChanged" ) );
+
+        QList< int > rows;
+        for ( int i = 0; i < spy.count(); i++ )
+        {
+            const QModelIndex topLeft = spy.at( i ).at( 0 ).value< QModelIndex >();
+            const QModelIndex bottomRight = spy.at( i ).at( 1 ).value< QModelIndex >();
+            QCOMPARE( bottomRight.row(), topLeft.row() );
+            QCOMPARE( bottomRight.column(), model.columnCount() - 1 );
+            rows << topLeft.row();
+        }
+        qSort( rows );
+        QCOMPARE( rows, QList< int >() << 1 << 3 );
+    }
+
+    void benchmarkInsert_data()
+    {
+        QTest::addColumn< int >( "count" );
+
+        QTest::newRow( "10k" ) << 10000;
+        QTest::newRow( "100k" ) << 100000;
+    }
+
+    void benchmarkInsert()
+    {
+        QFETCH( int, count );
+
+        Tomahawk::Pipeline pipeline;
+        QList< Tomahawk::query_ptr > queries = createQueries( count );
+        PlayableModel model( 0, false );
+
+        QBENCHMARK_ONCE
+        {
+            model.appendQueries( queries );
+        }
+
+        QCOMPARE( model.rowCount( QModelIndex() ), count );
+    }
+};
+
+#endif // TOMAHAWK_TESTPLAYABLEMODEL_H
@@ -19,12 +19,47 @@
 #ifndef TOMAHAWK_TESTQUERY_H
 #define TOMAHAWK_TESTQUERY_H
 
+#include <QtTest>
+
+#include "libtomahawk/Pipeline.h"
 #include "libtomahawk/Query.h"
+#include "libtomahawk/Result.h"
 #include "libtomahawk/Source.h"
+#include "libtomahawk/Track.h"
+#include "libtomahawk/resolvers/Resolver.h"
+
+// Results only count as online if a resolver reported them
+class TestQueryResolver : public Tomahawk::Resolver
+{
+Q_OBJECT
+public:
+    QString name() const { return "TestQueryResolver"; }
+    unsigned int weight() const { return 100; }
+    unsigned int timeout() const { return 0; }
+
+public slots:
+    void resolve( const Tomahawk::query_ptr& ) {}
+};
 
 class TestQuery : public QObject
 {
     Q_OBJECT
+private:
+    Tomahawk::result_ptr result( Tomahawk::Resolver* resolver, const QString& artist, const QString& track, const QString& url )
+    {
+        Tomahawk::result_ptr r = Tomahawk::Result::get( url, Tomahawk::Track::get( artist, track ) );
+        r->setResolvedByResolver( resolver );
+        return r;
+    }
+
+    QStringList urls( const QList< Tomahawk::result_ptr >& results )
+    {
+        QStringList list;
+        foreach ( const Tomahawk::result_ptr& r, results )
+            list << r->url();
+
+        return list;
+    }
 
 private slots:
     void testGet()
@@ -32,6 +67,42 @@ private slots:
         Tomahawk::query_ptr q = Tomahawk::Query::get( "", "", "" );
         QVERIFY( !q );
     }
+
+    void testResultOrder()
+    {
+        // Queries and results hook up to the Pipeline instance, so it has to exist first
+        Tomahawk::Pipeline pipeline;
+        TestQueryResolver resolver;
+
+        Tomahawk::query_ptr q = Tomahawk::Query::get( "Bloc Party", "Helicopter", "Silent Alarm" );
+        const Tomahawk::result_ptr exact = result( &resolver, "Bloc Party", "Helicopter", "http://example.com/exact.mp3" );
+        const Tomahawk::result_ptr same = result( &resolver, "Bloc Party", "Helicopter", "http://example.com/same.mp3" );
+        const Tomahawk::result_ptr close = result( &resolver, "Bloc Party", "Helicopters", "http://example.com/close.mp3" );
+        const Tomahawk::result_ptr far = result( &resolver, "Mogwai", "Helicopter", "http://example.com/far.mp3" );
+
+        // best first, equally good ones in the order they came in
+        q->addResults( QList< Tomahawk::result_ptr >() << far << exact );
+        q->addResults( QList< Tomahawk::result_ptr >() << close << same );
+        QCOMPARE( urls( q->results() ), urls( QList< Tomahawk::result_ptr >() << exact << same << close << far ) );
+        QVERIFY( q->howSimilar( exact ) > q->howSimilar( close ) );
+        QVERIFY( q->howSimilar( close ) > q->howSimilar( far ) );
+
+        // a score doesn't change once computed, asking again gets the same one
+        const float closeScore = q->howSimilar( close );
+        QCOMPARE( q->howSimilar( close ), closeScore );
+
+        // removed results are scored again if they come back, and land in the same spot
+        q->removeResult( close );
+        QCOMPARE( urls( q->results() ), urls( QList< Tomahawk::result_ptr >() << exact << same << far ) );
+        q->addResults( QList< Tomahawk::result_ptr >() << close );
+        QCOMPARE( urls( q->results() ), urls( QList< Tomahawk::result_ptr >() << exact << same << close << far ) );
+        QCOMPARE( q->howSimilar( close ), closeScore );
+
+        q->clearResults();
+        QVERIFY( q->results().isEmpty() );
+        q->addResults( QList< Tomahawk::result_ptr >() << far << close );
+        QCOMPARE( urls( q->results() ), urls( QList< Tomahawk::result_ptr >() << close << far ) );
+    }
 };
 
 #endif
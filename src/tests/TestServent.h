@@ -20,8 +20,12 @@
 #define TOMAHAWK_TESTDATABASE_H
 
 #include <QNetworkInterface>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QtTest>
 
+#include "network/Msg.h"
+#include "network/MsgFramer.h"
 #include "network/Servent.h"
 #include "sip/SipInfo.h"
 
@@ -132,6 +136,67 @@ private slots:
 
         delete servent;
     }
+
+    void benchmarkLoopback_data()
+    {
+        QTest::addColumn< int >( "payloadSize" );
+        QTest::addColumn< int >( "count" );
+        QTest::addColumn< bool >( "coalesce" );
+
+        QTest::newRow( "control msgs, one write each" ) << 100 << 50000 << false;
+        QTest::newRow( "control msgs, coalesced" ) << 100 << 50000 << true;
+        QTest::newRow( "stream blocks, one write each" ) << 4100 << 10000 << false;
+        QTest::newRow( "stream blocks, coalesced" ) << 4100 << 10000 << true;
+    }
+
+    void benchmarkLoopback()
+    {
+        QFETCH( int, payloadSize );
+        QFETCH( int, count );
+        QFETCH( bool, coalesce );
+
+        QTcpServer server;
+        QVERIFY( server.listen( QHostAddress::LocalHost ) );
+        QTcpSocket client;
+        client.connectToHost( QHostAddress::LocalHost, server.serverPort() );
+        QVERIFY( client.waitForConnected( 5000 ) );
+        QVERIFY( server.waitForNewConnection( 5000 ) );
+        QTcpSocket* peer = server.nextPendingConnection();
+
+        const msg_ptr msg = Msg::factory( QByteArray( payloadSize, 'x' ), Msg::RAW | Msg::FRAGMENT );
+        MsgFramer writer( &client );
+        MsgFramer reader( peer );
+
+        QBENCHMARK
+        {
+            int sent = 0;
+            int received = 0;
+            while ( received < count )
+            {
+                // keep a window of msgs in flight, like a Connection's outgoing queue
+                while ( sent < count && sent - received < 256 )
+                {
+                    if ( coalesce )
+                        writer.write( msg );
+                    else
+                        msg->write( &client );
+                    sent++;
+                }
+                writer.flush();
+                client.flush();
+
+                if ( peer->bytesAvailable() < Msg::headerSize() + payloadSize )
+                    peer->waitForReadyRead( 100 );
+
+                msg_ptr in;
+                while ( !( in = reader.read() ).isNull() )
+                {
+                    QCOMPARE( (int)in->length(), payloadSize );
+                    received++;
+                }
+            }
+        }
+    }
 };
 
 #endif // TOMAHAWK_TESTDATABASE_H
@@ -0,0 +1,450 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTSTREAMCONNECTION_H
+#define TOMAHAWK_TESTSTREAMCONNECTION_H
+
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <QtTest>
+
+#include "database/Database.h"
+#include "database/DatabaseCommand_AddFiles.h"
+#include "database/DatabaseImpl.h"
+#include "database/LocalCollection.h"
+#include "network/BufferIoDevice.h"
+#include "network/ControlConnection.h"
+#include "network/Msg.h"
+#include "network/MsgFramer.h"
+#include "network/Servent.h"
+#include "network/StreamConnection.h"
+#include "utils/TomahawkUtils.h"
+#include "Result.h"
+#include "Source.h"
+#include "SourceList.h"
+#include "TomahawkSettings.h"
+#include "Track.h"
+
+// What receivers ask for in windowed transfers
+#define WINDOW_BLOCK_SIZE ( 64 * 1024 )
+#define FILE_BLOCKS 20
+
+
+class TestStreamConnection : public QObject
+{
+    Q_OBJECT
+private:
+    QTemporaryDir m_dir;
+    TomahawkSettings* m_settings;
+    Tomahawk::Database* m_db;
+    Servent* m_servent;
+    QByteArray m_data;
+    QString m_fid;
+
+    // A control connection whose peer announced windowed transfers in the handshake
+    ControlConnection* windowPeer()
+    {
+        QVariantMap features;
+        features.insert( "method", "features" );
+        features.insert( "features", QStringList() << StreamConnection::windowFeatureName() );
+
+        ControlConnection* cc = new ControlConnection( m_servent );
+        QMetaObject::invokeMethod( cc, "handleMsg", Qt::DirectConnection,
+                                   Q_ARG( msg_ptr, Msg::factory( TomahawkUtils::toJson( features ), Msg::JSON ) ) );
+        return cc;
+    }
+
+    Tomahawk::result_ptr remoteResult()
+    {
+        Tomahawk::result_ptr result = Tomahawk::Result::get( QString( "servent://peer\t%1" ).arg( m_fid ),
+                                                             Tomahawk::Track::get( "Artist", "Track" ) );
+        result->setSize( m_data.size() );
+        return result;
+    }
+
+    // Two connected loopback sockets, the second one is the accepted side
+    void loopback( QTcpServer* server, QTcpSocket** client, QTcpSocket** accepted )
+    {
+        QVERIFY( server->listen( QHostAddress::LocalHost ) );
+        *client = new QTcpSocket( server );
+        (*client)->connectToHost( QHostAddress::LocalHost, server->serverPort() );
+        QVERIFY( (*client)->waitForConnected( 5000 ) );
+        QVERIFY( server->waitForNewConnection( 5000 ) );
+        *accepted = server->nextPendingConnection();
+        QVERIFY( *accepted );
+    }
+
+    // The connection under test lives in this thread, keep its event loop running while we wait
+    msg_ptr receive( MsgFramer& framer, int timeout = 5000 )
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        msg_ptr msg;
+        while ( ( msg = framer.read() ).isNull() && timer.elapsed() < timeout )
+            QTest::qWait( 10 );
+
+        return msg;
+    }
+
+    void send( MsgFramer& framer, const QByteArray& payload, char flags = Msg::RAW | Msg::FRAGMENT )
+    {
+        framer.write( Msg::factory( payload, flags ) );
+        framer.flush();
+    }
+
+    // Plays the outbound side of the handshake, the connection under test sends the protocol version
+    void handshake( MsgFramer& framer )
+    {
+        const msg_ptr msg = receive( framer );
+        QVERIFY( !msg.isNull() );
+        QVERIFY( msg->is( Msg::SETUP ) );
+        send( framer, "ok", Msg::SETUP );
+    }
+
+    void sendChunk( MsgFramer& framer, int block )
+    {
+        QByteArray ba( 9, Qt::Uninitialized );
+        memcpy( ba.data(), "chunk", 5 );
+        qToBigEndian< quint32 >( block, (uchar*)ba.data() + 5 );
+        send( framer, ba + m_data.mid( block * WINDOW_BLOCK_SIZE, WINDOW_BLOCK_SIZE ) );
+    }
+
+    int chunkIndex( const msg_ptr& msg )
+    {
+        if ( msg.isNull() || !msg->payload().startsWith( "chunk" ) )
+            return -1;
+
+        return qFromBigEndian< quint32 >( (const uchar*)msg->payload().constData() + 5 );
+    }
+
+    void verifyContent( QIODevice* dev )
+    {
+        QVERIFY( dev->seek( 0 ) );
+        const QByteArray data = dev->read( m_data.size() );
+        QCOMPARE( data.size(), m_data.size() );
+        QVERIFY( data == m_data );
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY( m_dir.isValid() );
+        m_settings = new TomahawkSettings( this );
+        m_settings->setUploadRateLimit( 0 );
+
+        // a partial last block, so ranges have to be clamped to the file
+        m_data.resize( FILE_BLOCKS * WINDOW_BLOCK_SIZE + 1000 );
+        for ( int i = 0; i < m_data.size(); i++ )
+            m_data[ i ] = char( ( i * 7 + i / WINDOW_BLOCK_SIZE ) % 251 );
+
+        QFile file( m_dir.path() + "/track.mp3" );
+        QVERIFY( file.open( QIODevice::WriteOnly ) );
+        QCOMPARE( file.write( m_data ), qint64( m_data.size() ) );
+        file.close();
+
+        m_db = new Tomahawk::Database( m_dir.path() + "/tomahawk.db" );
+        QTRY_VERIFY_WITH_TIMEOUT( m_db->isReady(), 10000 );
+        Tomahawk::DatabaseImpl* impl = m_db->impl();
+
+        Tomahawk::source_ptr src( new Tomahawk::Source( 0, impl->dbid() ) );
+        Tomahawk::collection_ptr coll( new Tomahawk::LocalCollection( src ) );
+        coll->setWeakRef( coll.toWeakRef() );
+        src->addCollection( coll );
+        SourceList::instance()->setLocal( src );
+
+        Tomahawk::ScannedFile scanned;
+        scanned.url = "file://" + file.fileName();
+        scanned.mtime = 1;
+        scanned.size = m_data.size();
+        scanned.mimetype = "audio/mpeg";
+        scanned.duration = 180;
+        scanned.bitrate = 192;
+        scanned.artist = "Artist";
+        scanned.album = "Album";
+        scanned.track = "Track";
+
+        Tomahawk::DatabaseCommand_AddFiles addFiles( QList< Tomahawk::ScannedFile >() << scanned, src );
+        impl->database().transaction();
+        addFiles._exec( impl );
+        impl->database().commit();
+
+        TomahawkSqlQuery query = impl->newquery();
+        query.prepare( "SELECT id FROM file WHERE url = ?" );
+        query.bindValue( 0, scanned.url );
+        query.exec();
+        QVERIFY( query.next() );
+        m_fid = query.value( 0 ).toString();
+
+        m_servent = new Servent();
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_servent;
+        delete m_db;
+        delete m_settings;
+    }
+
+    void testWindowedTransfer()
+    {
+        QTcpServer server;
+        QTcpSocket* rxSock = 0;
+        QTcpSocket* txSock = 0;
+        loopback( &server, &rxSock, &txSock );
+        QVERIFY( rxSock && txSock );
+
+        ControlConnection* rxCc = windowPeer();
+        ControlConnection* txCc = windowPeer();
+
+        QPointer< StreamConnection > tx = new StreamConnection( m_servent, txCc, m_fid );
+        QPointer< StreamConnection > rx = new StreamConnection( m_servent, rxCc, m_fid, remoteResult() );
+        rx->setOutbound( true );
+        rx->setFirstMessage( Msg::factory( "stream", Msg::RAW ) );
+        QSharedPointer< QIODevice > dev = rx->iodevice();
+        BufferIODevice* bio = qobject_cast< BufferIODevice* >( dev.data() );
+        QVERIFY( bio );
+
+        QSignalSpy readySpy( rx.data(), SIGNAL( ready() ) );
+        tx->start( txSock );
+        rx->start( rxSock );
+
+        // seek as soon as we can, the blocks before the playhead are fetched last
+        QTRY_VERIFY( readySpy.count() > 0 );
+        QVERIFY( dev->seek( ( FILE_BLOCKS - 2 ) * WINDOW_BLOCK_SIZE ) );
+
+        QTRY_VERIFY_WITH_TIMEOUT( bio->nextEmptyBlock() < 0, 10000 );
+        QCOMPARE( bio->blockSize(), (unsigned int)WINDOW_BLOCK_SIZE );
+        verifyContent( dev.data() );
+
+        // both sides are done once the receiver has everything
+        QTRY_VERIFY( rx.isNull() && tx.isNull() );
+        delete rxCc;
+        delete txCc;
+    }
+
+    void testFetchOnSeek()
+    {
+        QTcpServer server;
+        QTcpSocket* peerSock = 0;
+        QTcpSocket* rxSock = 0;
+        loopback( &server, &peerSock, &rxSock );
+        QVERIFY( peerSock && rxSock );
+
+        ControlConnection* cc = windowPeer();
+        QPointer< StreamConnection > rx = new StreamConnection( m_servent, cc, m_fid, remoteResult() );
+        QSharedPointer< QIODevice > dev = rx->iodevice();
+        BufferIODevice* bio = qobject_cast< BufferIODevice* >( dev.data() );
+        rx->start( rxSock );
+
+        MsgFramer peer( peerSock );
+        handshake( peer );
+
+        msg_ptr msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QString( "window%1" ).arg( WINDOW_BLOCK_SIZE ).toLatin1() );
+        send( peer, "windowok" );
+
+        msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "fetch0-7" ) );
+
+        // answer backwards, every chunk frees a slot for the next block
+        for ( int block = 7; block > 0; block-- )
+            sendChunk( peer, block );
+        for ( int block = 8; block < 15; block++ )
+        {
+            msg = receive( peer );
+            QVERIFY( !msg.isNull() );
+            QCOMPARE( msg->payload(), QString( "fetch%1-%1" ).arg( block ).toLatin1() );
+        }
+
+        // a seek drops what's in flight and fetches from the new position on
+        QVERIFY( dev->seek( 17 * WINDOW_BLOCK_SIZE ) );
+        msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "cancel" ) );
+        msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "fetch17-20" ) );
+
+        // serve everything else out of order, too
+        QList< int > pending;
+        pending << 20 << 19 << 18 << 17;
+        QElapsedTimer timer;
+        timer.start();
+        while ( bio->nextEmptyBlock() >= 0 && timer.elapsed() < 10000 )
+        {
+            while ( !pending.isEmpty() )
+                sendChunk( peer, pending.takeFirst() );
+
+            msg = receive( peer, 500 );
+            if ( msg.isNull() || !msg->payload().startsWith( "fetch" ) )
+                continue;
+
+            const QList< QByteArray > range = msg->payload().mid( 5 ).split( '-' );
+            QCOMPARE( range.count(), 2 );
+            for ( int block = range.at( 1 ).toInt(); block >= range.at( 0 ).toInt(); block-- )
+                pending << block;
+        }
+
+        QCOMPARE( bio->nextEmptyBlock(), -1 );
+        verifyContent( dev.data() );
+
+        QTRY_VERIFY( rx.isNull() );
+        delete cc;
+    }
+
+    void testCancel()
+    {
+        // a block every 250ms, slow enough to cancel the rest of a range
+        m_settings->setUploadRateLimit( 4 * WINDOW_BLOCK_SIZE / 1024 );
+
+        QTcpServer server;
+        QTcpSocket* peerSock = 0;
+        QTcpSocket* txSock = 0;
+        loopback( &server, &peerSock, &txSock );
+        QVERIFY( peerSock && txSock );
+
+        ControlConnection* cc = windowPeer();
+        QPointer< StreamConnection > tx = new StreamConnection( m_servent, cc, m_fid );
+        tx->start( txSock );
+
+        MsgFramer peer( peerSock );
+        handshake( peer );
+        send( peer, QString( "window%1" ).arg( WINDOW_BLOCK_SIZE ).toLatin1() );
+
+        msg_ptr msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "windowok" ) );
+
+        send( peer, "fetch0-9" );
+        QCOMPARE( chunkIndex( receive( peer ) ), 0 );
+
+        send( peer, "cancel" );
+        send( peer, "fetch15-15" );
+        QCOMPARE( chunkIndex( receive( peer ) ), 15 );
+
+        // nothing left of the cancelled range
+        QVERIFY( receive( peer, 1000 ).isNull() );
+
+        // ranges past the end of the file are clamped to it
+        send( peer, "fetch20-100" );
+        msg = receive( peer );
+        QCOMPARE( chunkIndex( msg ), 20 );
+        QCOMPARE( msg->payload().mid( 9 ), m_data.mid( 20 * WINDOW_BLOCK_SIZE ) );
+        QVERIFY( receive( peer, 1000 ).isNull() );
+
+        m_settings->setUploadRateLimit( 0 );
+        peerSock->disconnectFromHost();
+        QTRY_VERIFY( tx.isNull() );
+        delete cc;
+    }
+
+    void testWindowNoFallback()
+    {
+        const int blockSize = BufferIODevice::defaultBlockSize();
+
+        QTcpServer server;
+        QTcpSocket* peerSock = 0;
+        QTcpSocket* rxSock = 0;
+        loopback( &server, &peerSock, &rxSock );
+        QVERIFY( peerSock && rxSock );
+
+        ControlConnection* cc = windowPeer();
+        QPointer< StreamConnection > rx = new StreamConnection( m_servent, cc, m_fid, remoteResult() );
+        QSharedPointer< QIODevice > dev = rx->iodevice();
+        BufferIODevice* bio = qobject_cast< BufferIODevice* >( dev.data() );
+        rx->start( rxSock );
+
+        MsgFramer peer( peerSock );
+        handshake( peer );
+
+        msg_ptr msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QVERIFY( msg->payload().startsWith( "window" ) );
+
+        // a seek while we wait for the answer is caught up with once it's a no
+        QVERIFY( dev->seek( 2 * blockSize ) );
+        send( peer, "windowno" );
+
+        msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "block2" ) );
+
+        // a sequential sender, from the requested block to the end
+        send( peer, "doneblock2" );
+        const int blocks = ( m_data.size() + blockSize - 1 ) / blockSize;
+        for ( int block = 2; block < blocks; block++ )
+            send( peer, "data" + m_data.mid( block * blockSize, blockSize ), block + 1 < blocks ? Msg::RAW | Msg::FRAGMENT : Msg::RAW );
+
+        // with the tail in place the gap at the start is asked for
+        msg = receive( peer );
+        QVERIFY( !msg.isNull() );
+        QCOMPARE( msg->payload(), QByteArray( "block0" ) );
+        send( peer, "doneblock0" );
+        send( peer, "data" + m_data.mid( 0, blockSize ) );
+        send( peer, "data" + m_data.mid( blockSize, blockSize ) );
+
+        QTRY_COMPARE( bio->nextEmptyBlock(), -1 );
+        verifyContent( dev.data() );
+
+        QTRY_VERIFY( rx.isNull() );
+        delete cc;
+    }
+
+    void testLateWindowRequest()
+    {
+        QTcpServer server;
+        QTcpSocket* peerSock = 0;
+        QTcpSocket* txSock = 0;
+        loopback( &server, &peerSock, &txSock );
+        QVERIFY( peerSock && txSock );
+
+        ControlConnection* cc = windowPeer();
+        QPointer< StreamConnection > tx = new StreamConnection( m_servent, cc, m_fid );
+        tx->start( txSock );
+
+        MsgFramer peer( peerSock );
+        handshake( peer );
+
+        // the window request got lost, the sender gives up waiting for it
+        msg_ptr msg = receive( peer, 15000 );
+        QVERIFY( !msg.isNull() );
+        QVERIFY( msg->payload().startsWith( "data" ) );
+
+        // and doesn't switch modes in the middle of the transfer
+        send( peer, QString( "window%1" ).arg( WINDOW_BLOCK_SIZE ).toLatin1() );
+        bool windowNo = false;
+        while ( !windowNo && !( msg = receive( peer ) ).isNull() )
+        {
+            windowNo = msg->payload() == "windowno";
+            QVERIFY( windowNo || msg->payload().startsWith( "data" ) );
+        }
+        QVERIFY( windowNo );
+
+        peerSock->disconnectFromHost();
+        QTRY_VERIFY( tx.isNull() );
+        delete cc;
+    }
+};
+
+#endif // TOMAHAWK_TESTSTREAMCONNECTION_H
@@ -0,0 +1,264 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2026, The Tomahawk Authors (see AUTHORS)
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_TESTTOMAHAWKUTILS_H
+#define TOMAHAWK_TESTTOMAHAWKUTILS_H
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "libtomahawk/utils/ThumbnailCache.h"
+#include "libtomahawk/utils/TomahawkUtils.h"
+
+class TestTomahawkUtils : public QObject
+{
+    Q_OBJECT
+private:
+    // The full matrix implementation levenshtein() used to be, kept as reference
+    int referenceLevenshtein( const QString& source, const QString& target )
+    {
+        const int n = source.length();
+        const int m = target.length();
+        if ( n == 0 )
+            return m;
+        if ( m == 0 )
+            return n;
+
+        QVector< QVector<int> > matrix( n + 1, QVector<int>( m + 1 ) );
+        for ( int i = 0; i <= n; i++ )
+            matrix[i][0] = i;
+        for ( int j = 0; j <= m; j++ )
+            matrix[0][j] = j;
+
+        for ( int i = 1; i <= n; i++ )
+        {
+            for ( int j = 1; j <= m; j++ )
+            {
+                const int cost = source[i - 1] == target[j - 1] ? 0 : 1;
+                int cell = qMin( matrix[i][j - 1] + 1, matrix[i - 1][j - 1] + cost );
+                cell = qMin( cell, matrix[i - 1][j] + 1 );
+
+                if ( i > 2 && j > 2 )
+                {
+                    int trans = matrix[i - 2][j - 2] + 1;
+                    if ( source[i - 2] != target[j - 1] ) trans++;
+                    if ( source[i - 1] != target[j - 2] ) trans++;
+                    cell = qMin( cell, trans );
+                }
+                matrix[i][j] = cell;
+            }
+        }
+
+        return matrix[n][m];
+    }
+
+    QString randomString( int maxLength, const QString& alphabet )
+    {
+        QString s;
+        const int length = qrand() % ( maxLength + 1 );
+        for ( int i = 0; i < length; i++ )
+            s += alphabet.at( qrand() % alphabet.length() );
+
+        return s;
+    }
+
+    QStringList names()
+    {
+        return QStringList() << "radiohead" << "the beatles" << "beatles" << "sigur ros" << "sigur rós"
+                             << "everything in its right place" << "paranoid android"
+                             << "bohemian rhapsody" << "queen" << "godspeed you black emperor"
+                             << "lift your skinny fists like antennas to heaven" << "坂本龍一"
+                             << "merry christmas mr lawrence" << "boards of canada" << "roygbiv"
+                             << "an extremely long track title that does not fit into a single machine word at all";
+    }
+
+private slots:
+    void testLevenshtein()
+    {
+        QCOMPARE( TomahawkUtils::levenshtein( "", "" ), 0 );
+        QCOMPARE( TomahawkUtils::levenshtein( "abc", "" ), 3 );
+        QCOMPARE( TomahawkUtils::levenshtein( "kitten", "sitting" ), 3 );
+        QCOMPARE( TomahawkUtils::levenshtein( "radiohead", "raidohead" ), 1 );
+        QCOMPARE( TomahawkUtils::levenshtein( "radiohead", "radiohead" ), 0 );
+
+        const QStringList n = names();
+        foreach ( const QString& a, n )
+        {
+            foreach ( const QString& b, n )
+                QCOMPARE( TomahawkUtils::levenshtein( a, b ), referenceLevenshtein( a, b ) );
+        }
+
+        qsrand( 42 );
+        const QString alphabets[] = { QString( "ab" ), QString( "abcde " ), QString::fromUtf8( "aböé坂" ) };
+        for ( int i = 0; i < 20000; i++ )
+        {
+            const QString& alphabet = alphabets[ i % 3 ];
+            const QString a = randomString( i % 10 ? 20 : 90, alphabet );
+            const QString b = randomString( i % 10 ? 20 : 90, alphabet );
+            const int distance = referenceLevenshtein( a, b );
+            QCOMPARE( TomahawkUtils::levenshtein( a, b ), distance );
+
+            const int maxDistance = i % 6;
+            QCOMPARE( TomahawkUtils::levenshtein( a, b, maxDistance ), qMin( distance, maxDistance + 1 ) );
+        }
+    }
+
+    void testLevenshteinBatch()
+    {
+        const QStringList n = names();
+        foreach ( const QString& a, n )
+        {
+            const QVector< int > distances = TomahawkUtils::levenshtein( a, n );
+            const QVector< int > bounded = TomahawkUtils::levenshtein( a, n, 3 );
+            for ( int i = 0; i < n.count(); i++ )
+            {
+                QCOMPARE( distances.at( i ), referenceLevenshtein( a, n.at( i ) ) );
+                QCOMPARE( bounded.at( i ), qMin( distances.at( i ), 4 ) );
+            }
+        }
+    }
+
+    void testThumbnail()
+    {
+        using Tomahawk::Utils::ThumbnailCache;
+
+        QCOMPARE( ThumbnailCache::bucket( 1 ), 64 );
+        QCOMPARE( ThumbnailCache::bucket( 64 ), 64 );
+        QCOMPARE( ThumbnailCache::bucket( 65 ), 128 );
+        QCOMPARE( ThumbnailCache::bucket( 512 ), 512 );
+        QCOMPARE( ThumbnailCache::bucket( 513 ), 0 );
+
+        // a landscape image, red on the left, green in the center
+        QImage source( 300, 200, QImage::Format_RGB32 );
+        source.fill( qRgb( 255, 0, 0 ) );
+        for ( int x = 50; x < 250; x++ )
+            for ( int y = 0; y < 200; y++ )
+                source.setPixel( x, y, qRgb( 0, 255, 0 ) );
+
+        QByteArray data;
+        QBuffer buffer( &data );
+        buffer.open( QIODevice::WriteOnly );
+        QVERIFY( source.save( &buffer, "PNG" ) );
+
+        // a fresh directory per run, leftovers of earlier runs would spoil the file counts
+        QTemporaryDir tempDir;
+        QVERIFY( tempDir.isValid() );
+        const QString cacheDir = tempDir.path();
+
+        // cropped to the square in the center
+        const QImage thumbnail = ThumbnailCache::createThumbnail( data, QSize( 50, 50 ), cacheDir );
+        QCOMPARE( thumbnail.size(), QSize( 50, 50 ) );
+        QVERIFY( qGreen( thumbnail.pixel( 2, 25 ) ) > 200 && qRed( thumbnail.pixel( 2, 25 ) ) < 50 );
+
+        // the bucket went to disk and is used from there
+        const QStringList files = QDir( cacheDir ).entryList( QDir::Files );
+        QCOMPARE( files.count(), 1 );
+        QVERIFY( files.first().endsWith( "_64" ) );
+        QCOMPARE( ThumbnailCache::createThumbnail( data, QSize( 60, 60 ), cacheDir ).size(), QSize( 60, 60 ) );
+        QCOMPARE( QDir( cacheDir ).entryList( QDir::Files ).count(), 1 );
+
+        QVERIFY( ThumbnailCache::createThumbnail( "no image", QSize( 50, 50 ), cacheDir ).isNull() );
+    }
+
+    void testParseRange_data()
+    {
+        QTest::addColumn< QString >( "header" );
+        QTest::addColumn< bool >( "partial" );
+        QTest::addColumn< qint64 >( "start" );
+        QTest::addColumn< qint64 >( "end" );
+
+        // for a 1000 byte file, a start past its end means 416
+        QTest::newRow( "open end" ) << "bytes=0-" << true << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "range" ) << "bytes=100-199" << true << Q_INT64_C( 100 ) << Q_INT64_C( 199 );
+        QTest::newRow( "end past eof" ) << "bytes=900-2000" << true << Q_INT64_C( 900 ) << Q_INT64_C( 999 );
+        QTest::newRow( "suffix" ) << "bytes=-500" << true << Q_INT64_C( 500 ) << Q_INT64_C( 999 );
+        QTest::newRow( "suffix longer than file" ) << "bytes=-5000" << true << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "empty suffix" ) << "bytes=-0" << true << Q_INT64_C( 1000 ) << Q_INT64_C( 999 );
+        QTest::newRow( "start at eof" ) << "bytes=1000-" << true << Q_INT64_C( 1000 ) << Q_INT64_C( 999 );
+        QTest::newRow( "start past eof" ) << "bytes=2000-3000" << true << Q_INT64_C( 2000 ) << Q_INT64_C( 999 );
+
+        // ignored, the whole file gets served
+        QTest::newRow( "end before start" ) << "bytes=500-100" << false << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "multiple ranges" ) << "bytes=0-99,200-299" << false << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "no range" ) << "bytes=-" << false << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "other unit" ) << "items=0-9" << false << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+        QTest::newRow( "no header" ) << QString() << false << Q_INT64_C( 0 ) << Q_INT64_C( 999 );
+    }
+
+    void testParseRange()
+    {
+        QFETCH( QString, header );
+        QFETCH( bool, partial );
+        QFETCH( qint64, start );
+        QFETCH( qint64, end );
+
+        // what Api_v1 serves unless the header says otherwise
+        qint64 first = 0;
+        qint64 last = 999;
+        QCOMPARE( TomahawkUtils::parseRange( header, 1000, first, last ), partial );
+        QCOMPARE( first, start );
+        QCOMPARE( last, end );
+    }
+
+    void benchmarkLevenshtein_data()
+    {
+        QTest::addColumn< int >( "mode" );
+
+        QTest::newRow( "reference" ) << 0;
+        QTest::newRow( "single" ) << 1;
+        QTest::newRow( "bounded" ) << 2;
+        QTest::newRow( "batch" ) << 3;
+    }
+
+    void benchmarkLevenshtein()
+    {
+        QFETCH( int, mode );
+        const QStringList n = names();
+        int sum = 0;
+
+        QBENCHMARK
+        {
+            foreach ( const QString& a, n )
+            {
+                switch ( mode )
+                {
+                    case 0:
+                        foreach ( const QString& b, n )
+                            sum += referenceLevenshtein( a, b );
+                        break;
+                    case 1:
+                        foreach ( const QString& b, n )
+                            sum += TomahawkUtils::levenshtein( a, b );
+                        break;
+                    case 2:
+                        foreach ( const QString& b, n )
+                            sum += TomahawkUtils::levenshtein( a, b, 3 );
+                        break;
+                    case 3:
+                        foreach ( int distance, TomahawkUtils::levenshtein( a, n ) )
+                            sum += distance;
+                        break;
+                }
+            }
+        }
+
+        QVERIFY( sum >= 0 );
+    }
+};
+
+#endif // TOMAHAWK_TESTTOMAHAWKUTILS_H
@@ -68,6 +68,7 @@
 #include "utils/Logger.h"
 #include "utils/TomahawkUtilsGui.h"
 #include "utils/TomahawkCache.h"
+#include "utils/HttpClient.h"
 #include "widgets/SplashWidget.h"
 
 #include "resolvers/JSResolver.h"
@@ -322,6 +323,7 @@ TomahawkApp::~TomahawkApp()
         delete m_infoSystem.data();
 
     delete TomahawkUtils::Cache::instance();
+    delete Tomahawk::Utils::HttpClient::instance();
 
     tDebug( LOGVERBOSE ) << "Finished shutdown.";
 }
@@ -1,7 +1,16 @@
 #include"filemetadata/MusicScanner.h"
+#include "database/DatabaseCommand_AddFiles.h"
+#include "database/DatabaseImpl.h"
+#include "database/LocalCollection.h"
+#include "Source.h"
+#include "SourceList.h"
 
 #include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtConcurrentMap>
 
 #include <iostream>
 
@@ -9,15 +18,104 @@ void
 usage()
 {
     std::cout << "Usage:" << std::endl;
-    std::cout << "\ttomahawk-test-musicscan <path>" << std::endl;
+    std::cout << "\ttomahawk-test-musicscan <path> [threads]" << std::endl;
     std::cout << std::endl;
     std::cout << "\tpath\tEither an audio file or a directory" << std::endl;
+    std::cout << "\tthreads\tNumber of tag reading threads. If omitted, a directory is" << std::endl;
+    std::cout << "\t\tscanned once per thread count from 1 up to the number of cores" << std::endl;
+    std::cout << std::endl;
+    std::cout << "\tThe files found in a directory are then added to a temporary" << std::endl;
+    std::cout << "\tdatabase to measure the insert rate (rows/sec)." << std::endl;
+}
+
+
+void
+scan( const QString& path, int threads, bool verbose )
+{
+    QStringList paths;
+    paths << path;
+    MusicScanner scanner( MusicScanner::DirScan, paths, 0 );
+
+    // We want a dry-run of the scanner and not update any internal data.
+    scanner.setDryRun( true );
+    scanner.setVerbose( verbose );
+    scanner.setThreadCount( threads );
+
+    // Start the MusicScanner in its own thread
+    QThread scannerThread( 0 );
+    scannerThread.start();
+    // We need to do this or the finished() signal/quit() SLOT is not called.
+    scannerThread.moveToThread( &scannerThread );
+    scanner.moveToThread( &scannerThread );
+    QObject::connect( &scanner, SIGNAL( finished() ), &scannerThread, SLOT( quit() ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    QMetaObject::invokeMethod( &scanner, "scan", Qt::QueuedConnection );
+
+    // Wait until the scanner has done its work.
+    scannerThread.wait();
+
+    const qint64 elapsed = qMax( timer.elapsed(), (qint64)1 );
+    std::cout << threads << " thread(s): " << scanner.scannedFiles() << " files in " << elapsed << " ms, "
+              << ( scanner.scannedFiles() * 1000.0 / elapsed ) << " files/sec" << std::endl;
+}
+
+
+// The local source with its collection, set up like the player does
+Tomahawk::source_ptr
+localSource( Tomahawk::DatabaseImpl* impl )
+{
+    Tomahawk::source_ptr src( new Tomahawk::Source( 0, impl->dbid() ) );
+    Tomahawk::collection_ptr coll( new Tomahawk::LocalCollection( src ) );
+    coll->setWeakRef( coll.toWeakRef() );
+    src->addCollection( coll );
+    SourceList::instance()->setLocal( src );
+
+    return src;
+}
+
+
+void
+ingest( const QString& path )
+{
+    QList< QFileInfo > files;
+    QDirIterator it( path, QDir::Files, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks );
+    while ( it.hasNext() )
+    {
+        it.next();
+        files << it.fileInfo();
+    }
+
+    QList< Tomahawk::ScannedFile > scanned;
+    foreach ( const Tomahawk::ScannedFile& file, QtConcurrent::blockingMapped( files, &MusicScanner::readScannedFile ) )
+    {
+        if ( file.isValid() )
+            scanned << file;
+    }
+
+    // Insert everything into a throwaway database, the same way a scan commits its batch.
+    // Its search index lives in the temporary directory as well, not in the player's data dir.
+    QTemporaryDir dir;
+    Tomahawk::DatabaseImpl impl( dir.path() + "/tomahawk.db", QString( dir.path() + "/tomahawk.lucene" ) );
+    Tomahawk::DatabaseCommand_AddFiles cmd( scanned, localSource( &impl ) );
+
+    QElapsedTimer timer;
+    timer.start();
+
+    impl.database().transaction();
+    cmd._exec( &impl );
+    impl.database().commit();
+
+    const qint64 elapsed = qMax( timer.elapsed(), (qint64)1 );
+    std::cout << "database: " << scanned.count() << " files in " << elapsed << " ms, "
+              << ( scanned.count() * 1000.0 / elapsed ) << " rows/sec" << std::endl;
 }
 
 int
 main( int argc, char* argv[] )
 {
-    if ( argc != 2 )
+    if ( argc != 2 && argc != 3 )
     {
         usage();
     }
@@ -41,26 +139,20 @@ main( int argc, char* argv[] )
         qRegisterMetaType< QDir >( "QDir" );
         qRegisterMetaType< QFileInfo >( "QFileInfo" );
 
-        // Create the MusicScanner instance
-        QStringList paths;
-        paths << pathInfo.canonicalFilePath();
-        MusicScanner scanner( MusicScanner::DirScan, paths, 0 );
-
-        // We want a dry-run of the scanner and not update any internal data.
-        scanner.setDryRun( true );
-        scanner.setVerbose( true );
-
-        // Start the MusicScanner in its own thread
-        QThread scannerThread( 0 );
-        scannerThread.start();
-        // We need to do this or the finished() signal/quit() SLOT is not called.
-        scannerThread.moveToThread( &scannerThread );
-        scanner.moveToThread( &scannerThread );
-        QObject::connect( &scanner, SIGNAL( finished() ), &scannerThread, SLOT( quit() ) );
-        QMetaObject::invokeMethod( &scanner, "scan", Qt::QueuedConnection );
-
-        // Wait until the scanner has done its work.
-        scannerThread.wait();
+        if ( argc == 3 )
+        {
+            scan( pathInfo.canonicalFilePath(), QString( argv[2] ).toInt(), true );
+        }
+        else
+        {
+            // Note that the first run also warms up the file system cache
+            const int maxThreads = qMax( 1, QThread::idealThreadCount() );
+            for ( int threads = 1; threads < maxThreads; threads *= 2 )
+                scan( pathInfo.canonicalFilePath(), threads, false );
+            scan( pathInfo.canonicalFilePath(), maxThreads, false );
+        }
+
+        ingest( pathInfo.canonicalFilePath() );
     }
     else
     {